@@ -0,0 +1,247 @@
+﻿#ifndef _INCLUDE_AGGREGATE_MAP_H_
+#define _INCLUDE_AGGREGATE_MAP_H_
+
+// 这个头文件包含一个模板类 aggregate_map
+// aggregate_map : 映射，键值不允许重复，可以在 O(log n) 时间内求任意键值区间内实值的聚合（和、最小值、最大值等）
+
+// notes:
+//
+// 每个节点保存以它为根的子树中所有实值按键值顺序用 BinaryOp 聚合的结果，由 rb_tree 的子树信息维护策略在
+// 插入、删除和旋转时更新；BinaryOp 必须满足结合律，不要求交换律，要能默认构造
+// 为了让聚合结果始终正确，只提供 const_iterator，修改实值要通过 assign
+
+#include "rb_tree.h"
+
+namespace yastl {
+
+// aggregate_map 的子树信息维护策略，节点保存子树中实值的聚合结果
+template <class Value, class T, class BinaryOp>
+struct aggregate_augment : public rb_tree_augment_base<Value, T> {
+  typedef rb_tree_augment_base<Value, T> base;
+  typedef typename base::base_ptr base_ptr;
+
+  void update(base_ptr x) const {
+    BinaryOp op;
+    T result = base::value(x).second;
+    if (x->left != nullptr) {
+      result = op(base::data(x->left), result);
+    }
+    if (x->right != nullptr) {
+      result = op(result, base::data(x->right));
+    }
+    base::data(x) = yastl::move(result);
+  }
+};
+
+// 模板类 aggregate_map，键值不允许重复
+// 参数一代表键值类型，参数二代表实值类型，参数三代表实值的聚合方式，缺省使用 yastl::plus，参数四代表键值的比较方式
+template <class Key, class T, class BinaryOp = yastl::plus<T>, class Compare = yastl::less<Key>>
+class aggregate_map {
+public:
+  // aggregate_map 的嵌套型别定义
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef yastl::pair<const Key, T> value_type;
+  typedef Compare key_compare;
+  typedef BinaryOp aggregate_op;
+
+private:
+  typedef aggregate_augment<value_type, T, BinaryOp> augment_type;
+  typedef yastl::rb_tree<value_type, key_compare, augment_type> base_type;
+  typedef typename base_type::base_ptr base_ptr;
+  base_type tree_;
+
+public:
+  typedef typename base_type::const_iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::const_reverse_iterator reverse_iterator;
+  typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  aggregate_map() = default;
+
+  template <class InputIterator>
+  aggregate_map(InputIterator first, InputIterator last) {
+    tree_.insert_unique(first, last);
+  }
+
+  aggregate_map(std::initializer_list<value_type> ilist) {
+    tree_.insert_unique(ilist.begin(), ilist.end());
+  }
+
+  // 迭代器相关
+  const_iterator begin() const noexcept {
+    return tree_.begin();
+  }
+  const_iterator end() const noexcept {
+    return tree_.end();
+  }
+  const_reverse_iterator rbegin() const noexcept {
+    return tree_.rbegin();
+  }
+  const_reverse_iterator rend() const noexcept {
+    return tree_.rend();
+  }
+
+  // 容量相关
+  bool empty() const noexcept {
+    return tree_.empty();
+  }
+  size_type size() const noexcept {
+    return tree_.size();
+  }
+
+  // 插入删除相关
+
+  pair<const_iterator, bool> insert(const value_type& value) {
+    return tree_.insert_unique(value);
+  }
+
+  // key 不存在时插入，存在时覆盖实值并更新聚合结果
+  pair<const_iterator, bool> assign(const key_type& key, const mapped_type& value) {
+    auto result = tree_.try_emplace_unique(key, value);
+    if (!result.second) {
+      result.first->second = value;
+      tree_.update_path(result.first);
+    }
+    return result;
+  }
+
+  const_iterator erase(const_iterator position) {
+    return tree_.erase(position);
+  }
+  size_type erase(const key_type& key) {
+    return tree_.erase_unique(key);
+  }
+  void erase(const_iterator first, const_iterator last) {
+    tree_.erase(first, last);
+  }
+
+  void clear() {
+    tree_.clear();
+  }
+
+  // 查找相关
+
+  const_iterator find(const key_type& key) const {
+    return tree_.find(key);
+  }
+  size_type count(const key_type& key) const {
+    return tree_.count_unique(key);
+  }
+  const_iterator lower_bound(const key_type& key) const {
+    return tree_.lower_bound(key);
+  }
+  const_iterator upper_bound(const key_type& key) const {
+    return tree_.upper_bound(key);
+  }
+
+  key_compare key_comp() const {
+    return tree_.key_comp();
+  }
+
+  // 聚合相关
+
+  // 返回 init 与所有实值按键值顺序聚合的结果
+  T accumulate(T init) const {
+    auto root = tree_.root_node();
+    return root == nullptr ? init : BinaryOp()(init, augment_type::data(root));
+  }
+
+  // 返回 init 与键值在 [first, last) 内的实值按键值顺序聚合的结果
+  T accumulate(const key_type& first, const key_type& last, T init) const;
+
+  void swap(aggregate_map& rhs) noexcept {
+    tree_.swap(rhs.tree_);
+  }
+
+public:
+  friend bool operator==(const aggregate_map& lhs, const aggregate_map& rhs) {
+    return lhs.size() == rhs.size() && yastl::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+  friend bool operator!=(const aggregate_map& lhs, const aggregate_map& rhs) {
+    return !(lhs == rhs);
+  }
+
+private:
+  const key_type& key_of(base_ptr x) const {
+    return augment_type::value(x).first;
+  }
+
+  // 子树 x 中键值 >= first 的部分
+  T accumulate_from(base_ptr x, const key_type& first, T init) const;
+  // 子树 x 中键值 < last 的部分
+  T accumulate_before(base_ptr x, const key_type& last, T init) const;
+};
+
+/*****************************************************************************************/
+
+// 先找到第一个键值落在 [first, last) 内的节点 x，区间分成 x 的左子树中 >= first 的部分、x、x 的右子树中 < last 的部分
+template <class Key, class T, class BinaryOp, class Compare>
+T aggregate_map<Key, T, BinaryOp, Compare>::accumulate(const key_type& first, const key_type& last, T init) const {
+  auto comp = key_comp();
+  auto x = tree_.root_node();
+  while (x != nullptr) {
+    if (comp(key_of(x), first)) { // x < first
+      x = x->right;
+    } else if (!comp(key_of(x), last)) { // x >= last
+      x = x->left;
+    } else {
+      break;
+    }
+  }
+  if (x == nullptr) {
+    return init;
+  }
+  init = accumulate_from(x->left, first, yastl::move(init));
+  init = BinaryOp()(init, augment_type::value(x).second);
+  return accumulate_before(x->right, last, yastl::move(init));
+}
+
+template <class Key, class T, class BinaryOp, class Compare>
+T aggregate_map<Key, T, BinaryOp, Compare>::accumulate_from(base_ptr x, const key_type& first, T init) const {
+  auto comp = key_comp();
+  BinaryOp op;
+  while (x != nullptr && comp(key_of(x), first)) { // x 与它的左子树都在区间之外
+    x = x->right;
+  }
+  if (x == nullptr) {
+    return init;
+  }
+  // x 在区间内，右子树整个在区间内，左子树继续查找
+  init = accumulate_from(x->left, first, yastl::move(init));
+  init = op(init, augment_type::value(x).second);
+  if (x->right != nullptr) {
+    init = op(init, augment_type::data(x->right));
+  }
+  return init;
+}
+
+template <class Key, class T, class BinaryOp, class Compare>
+T aggregate_map<Key, T, BinaryOp, Compare>::accumulate_before(base_ptr x, const key_type& last, T init) const {
+  auto comp = key_comp();
+  BinaryOp op;
+  while (x != nullptr) {
+    if (!comp(key_of(x), last)) { // x 与它的右子树都在区间之外
+      x = x->left;
+      continue;
+    }
+    // x 在区间内，左子树整个在区间内，右子树继续查找
+    if (x->left != nullptr) {
+      init = op(init, augment_type::data(x->left));
+    }
+    init = op(init, augment_type::value(x).second);
+    x = x->right;
+  }
+  return init;
+}
+
+// 重载 yastl 的 swap
+template <class Key, class T, class BinaryOp, class Compare>
+void swap(aggregate_map<Key, T, BinaryOp, Compare>& lhs, aggregate_map<Key, T, BinaryOp, Compare>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+} // namespace yastl
+#endif // _INCLUDE_AGGREGATE_MAP_H_
@@ -3,6 +3,7 @@
 
 // 这个头文件包含了 yastl 的一系列算法
 
+#include <cmath>
 #include <cstddef>
 #include <ctime>
 
@@ -60,7 +61,7 @@ bool none_of(InputIter first, InputIter last, UnaryPredicate unary_pred) {
 // 对[first, last)区间内的元素与给定值进行比较，缺省使用 operator==，返回元素相等的个数
 /*****************************************************************************************/
 template <class InputIter, class T>
-size_t count(InputIter first, InputIter last, const T& value) {
+size_t count_cat(InputIter first, InputIter last, const T& value, m_false_type) {
   size_t n = 0;
   for (; first != last; ++first) {
     if (*first == value) {
@@ -70,6 +71,17 @@ size_t count(InputIter first, InputIter last, const T& value) {
   return n;
 }
 
+// 连续的算术类型区间使用 SIMD
+template <class U, class T>
+size_t count_cat(U* first, U* last, const T& value, m_true_type) {
+  return yastl::simd_count<T>(first, last, value);
+}
+
+template <class InputIter, class T>
+size_t count(InputIter first, InputIter last, const T& value) {
+  return yastl::count_cat(first, last, value, simd_contiguous<InputIter, T>());
+}
+
 /*****************************************************************************************/
 // count_if
 // 对[first, last)区间内的每个元素都进行一元 unary_pred 操作，返回结果为 true 的个数
@@ -90,13 +102,48 @@ size_t count_if(InputIter first, InputIter last, UnaryPredicate unary_pred) {
 // 在[first, last)区间内找到等于 value 的元素，返回指向该元素的迭代器
 /*****************************************************************************************/
 template <class InputIter, class T>
-InputIter find(InputIter first, InputIter last, const T& value) {
+InputIter find_cat(InputIter first, InputIter last, const T& value, m_false_type) {
   while (first != last && *first != value) {
     ++first;
   }
   return first;
 }
 
+// 连续的算术类型区间使用 SIMD
+template <class U, class T>
+U* find_cat(U* first, U* last, const T& value, m_true_type) {
+  return first + (yastl::simd_find<T>(first, last, value) - first);
+}
+
+// 分段迭代器逐段查找，段内是指针区间，可以使用 SIMD
+template <class SegIter, class T>
+SegIter find_segmented(SegIter first, SegIter last, const T& value, m_true_type) {
+  typedef segmented_iterator_traits<SegIter> traits;
+  typedef simd_contiguous<typename traits::local_iterator, T> simd;
+  auto sfirst = traits::segment(first);
+  const auto slast = traits::segment(last);
+  auto lfirst = traits::local(first);
+  for (; sfirst != slast; ++sfirst, lfirst = traits::begin(sfirst)) {
+    const auto llast = traits::end(sfirst);
+    const auto pos = yastl::find_cat(lfirst, llast, value, simd());
+    if (pos != llast) {
+      return traits::compose(sfirst, pos);
+    }
+  }
+  const auto pos = yastl::find_cat(lfirst, traits::local(last), value, simd());
+  return pos == traits::local(last) ? last : traits::compose(slast, pos);
+}
+
+template <class InputIter, class T>
+InputIter find_segmented(InputIter first, InputIter last, const T& value, m_false_type) {
+  return yastl::find_cat(first, last, value, simd_contiguous<InputIter, T>());
+}
+
+template <class InputIter, class T>
+InputIter find(InputIter first, InputIter last, const T& value) {
+  return yastl::find_segmented(first, last, value, m_bool_constant<is_segmented_iterator<InputIter>::value>());
+}
+
 /*****************************************************************************************/
 // find_if
 // 在[first, last)区间内找到第一个令一元操作 unary_pred 为 true 的元素并返回指向该元素的迭代器
@@ -126,7 +173,8 @@ InputIter find_if_not(InputIter first, InputIter last, UnaryPredicate unary_pred
 // 在[first1, last1)中查找[first2, last2)的首次出现点
 /*****************************************************************************************/
 template <class ForwardIter1, class ForwardIter2>
-ForwardIter1 search(ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2, ForwardIter2 last2) {
+ForwardIter1 search_cat(ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2, ForwardIter2 last2,
+                        m_false_type) {
   auto d1 = yastl::distance(first1, last1);
   auto d2 = yastl::distance(first2, last2);
   if (d1 < d2) {
@@ -151,6 +199,33 @@ ForwardIter1 search(ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2
   return first1; // 循环结束，找到了
 }
 
+// 连续的单字节区间：模式只有一个字节时用 memchr，否则用 SIMD 同时比较首字节和末字节筛选候选位置
+template <class T1, class T2>
+T1* search_cat(T1* first1, T1* last1, T2* first2, T2* last2, m_true_type) {
+  typedef typename std::remove_cv<T1>::type value_type;
+  const size_t n = static_cast<size_t>(last1 - first1);
+  const size_t m = static_cast<size_t>(last2 - first2);
+  if (m == 0) {
+    return first1;
+  }
+  if (m > n) {
+    return last1;
+  }
+  if (m == 1) {
+    const void* p = std::memchr(first1, static_cast<unsigned char>(*first2), n);
+    return p == nullptr ? last1 : first1 + (static_cast<const value_type*>(p) - first1);
+  }
+  return first1 + (yastl::simd_search<value_type>(first1, last1, first2, last2) - first1);
+}
+
+template <class ForwardIter1, class ForwardIter2>
+ForwardIter1 search(ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2, ForwardIter2 last2) {
+  typedef typename iterator_traits<ForwardIter1>::value_type value_type;
+  return yastl::search_cat(first1, last1, first2, last2,
+                           m_bool_constant<simd_contiguous_pair<ForwardIter1, ForwardIter2>::value &&
+                                           std::is_integral<value_type>::value && sizeof(value_type) == 1>());
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class ForwardIter1, class ForwardIter2, class Compared>
 ForwardIter1 search(ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2, ForwardIter2 last2, Compared comp) {
@@ -178,6 +253,12 @@ ForwardIter1 search(ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2
   return first1;
 }
 
+// 使用搜索器（见 searcher.h）查找
+template <class ForwardIter, class Searcher>
+ForwardIter search(ForwardIter first, ForwardIter last, const Searcher& searcher) {
+  return searcher(first, last).first;
+}
+
 /*****************************************************************************************/
 // search_n
 // 在[first, last)中查找连续 n 个 value 所形成的子序列，返回一个迭代器指向该子序列的起始处
@@ -352,7 +433,7 @@ ForwardIter1 find_end(ForwardIter1 first1, ForwardIter1 last1,
 // 在[first1, last1)中查找[first2, last2)中的某些元素，返回指向第一次出现的元素的迭代器
 /*****************************************************************************************/
 template <class InputIter, class ForwardIter>
-InputIter find_first_of(InputIter first1, InputIter last1, ForwardIter first2, ForwardIter last2) {
+InputIter find_first_of_cat(InputIter first1, InputIter last1, ForwardIter first2, ForwardIter last2, m_false_type) {
   for (; first1 != last1; ++first1) { // 两两比较
     for (auto iter = first2; iter != last2; ++iter) {
       if (*first1 == *iter) {
@@ -363,6 +444,31 @@ InputIter find_first_of(InputIter first1, InputIter last1, ForwardIter first2, F
   return last1; // 没找到
 }
 
+// 单字节整数：先把[first2, last2)记录到 256 项的表中，每个元素只需查一次表
+template <class InputIter, class ForwardIter>
+InputIter find_first_of_cat(InputIter first1, InputIter last1, ForwardIter first2, ForwardIter last2, m_true_type) {
+  bool table[256] = {false};
+  for (; first2 != last2; ++first2) {
+    table[static_cast<unsigned char>(*first2)] = true;
+  }
+  for (; first1 != last1; ++first1) {
+    if (table[static_cast<unsigned char>(*first1)]) {
+      return first1;
+    }
+  }
+  return last1;
+}
+
+template <class InputIter, class ForwardIter>
+InputIter find_first_of(InputIter first1, InputIter last1, ForwardIter first2, ForwardIter last2) {
+  typedef typename iterator_traits<InputIter>::value_type value_type1;
+  typedef typename iterator_traits<ForwardIter>::value_type value_type2;
+  return yastl::find_first_of_cat(first1, last1, first2, last2,
+                                  m_bool_constant<std::is_same<value_type1, value_type2>::value &&
+                                                  std::is_integral<value_type1>::value &&
+                                                  sizeof(value_type1) == 1>());
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class InputIter, class ForwardIter, class Compared>
 InputIter find_first_of(InputIter first1, InputIter last1, ForwardIter first2, ForwardIter last2, Compared comp) {
@@ -382,13 +488,37 @@ InputIter find_first_of(InputIter first1, InputIter last1, ForwardIter first2, F
 // f() 可返回一个值，但该值会被忽略
 /*****************************************************************************************/
 template <class InputIter, class Function>
-Function for_each(InputIter first, InputIter last, Function f) {
+void for_each_range(InputIter first, InputIter last, Function& f) {
   for (; first != last; ++first) {
     f(*first);
   }
+}
+
+template <class InputIter, class Function>
+Function for_each_segmented(InputIter first, InputIter last, Function f, m_false_type) {
+  for_each_range(first, last, f);
+  return f;
+}
+
+// 分段迭代器逐段遍历，段内的循环只移动指针
+template <class SegIter, class Function>
+Function for_each_segmented(SegIter first, SegIter last, Function f, m_true_type) {
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  const auto slast = traits::segment(last);
+  auto lfirst = traits::local(first);
+  for (; sfirst != slast; ++sfirst, lfirst = traits::begin(sfirst)) {
+    for_each_range(lfirst, traits::end(sfirst), f);
+  }
+  for_each_range(lfirst, traits::local(last), f);
   return f;
 }
 
+template <class InputIter, class Function>
+Function for_each(InputIter first, InputIter last, Function f) {
+  return yastl::for_each_segmented(first, last, f, m_bool_constant<is_segmented_iterator<InputIter>::value>());
+}
+
 /*****************************************************************************************/
 // adjacent_find
 // 找出第一对匹配的相邻元素，缺省使用 operator== 比较，如果找到返回一个迭代器，指向这对元素的第一个元素
@@ -521,6 +651,24 @@ ForwardIter lower_bound(ForwardIter first, ForwardIter last, const T& value, Com
   return yastl::lbound_dispatch(first, last, value, iterator_category(first), comp);
 }
 
+/*****************************************************************************************/
+// gallop_lower_bound
+// 与 lower_bound 结果相同，但先从 first 开始按 1、2、4、8... 倍增地向后探测，再在最后一段中二分查找
+// 结果距离 first 为 d 时只需 O(log d) 次比较，适合在有序区间中从前往后多次查找
+/*****************************************************************************************/
+template <class RandomIter, class T, class Compared>
+RandomIter gallop_lower_bound(RandomIter first, RandomIter last, const T& value, Compared comp) {
+  if (first == last || !comp(*first, value)) {
+    return first;
+  }
+  const auto len = last - first;
+  decltype(last - first) bound = 1;  // 已知 first[bound / 2] < value
+  while (bound < len && comp(first[bound], value)) {
+    bound *= 2;
+  }
+  return yastl::lower_bound(first + (bound / 2 + 1), first + (bound < len ? bound : len), value, comp);
+}
+
 /*****************************************************************************************/
 // upper_bound
 // 在[first, last)中查找第一个 大于value 的元素，并返回指向它的迭代器，若没有则返回 last
@@ -778,12 +926,30 @@ void generate_n(ForwardIter first, Size n, Generator gen) {
 // includes
 // 判断序列一S1 是否包含序列二S2 序列需要有序
 /*****************************************************************************************/
-template <class InputIter1, class InputIter2>
-bool includes(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2) {
+constexpr static size_t kSetGallopRatio = 16;  // 两个区间长度相差超过这个倍数时使用倍增查找
+
+// 较短区间的长度乘以 kSetGallopRatio 仍小于较长区间时使用倍增查找
+template <class Distance1, class Distance2>
+bool set_use_gallop(Distance1 small, Distance2 large) {
+  return static_cast<size_t>(small) * kSetGallopRatio < static_cast<size_t>(large);
+}
+
+// includes 与 set_algo.h 中不带 comp 的版本使用 operator< 比较，两个区间的元素类型可以不同
+struct set_less {
+  template <class T1, class T2>
+  bool operator()(const T1& lhs, const T2& rhs) const {
+    return lhs < rhs;
+  }
+};
+
+// includes_dispatch 的 input_iterator_tag 版本
+template <class InputIter1, class InputIter2, class Compared>
+bool includes_dispatch(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+                       Compared comp, input_iterator_tag, input_iterator_tag) {
   while (first1 != last1 && first2 != last2) {
-    if (*first2 < *first1) {
+    if (comp(*first2, *first1)) {
       return false;
-    } else if (*first1 < *first2) {
+    } else if (comp(*first1, *first2)) {
       ++first1;
     } else { // 相等
       ++first1, ++first2;
@@ -792,19 +958,38 @@ bool includes(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2
   return first2 == last2;
 }
 
+// includes_dispatch 的 random_access_iterator_tag 版本
+// S2 比 S1 长时一定不包含，S2 远比 S1 短时逐个在 S1 中倍增查找
+template <class RandomIter1, class RandomIter2, class Compared>
+bool includes_dispatch(RandomIter1 first1, RandomIter1 last1, RandomIter2 first2, RandomIter2 last2,
+                       Compared comp, random_access_iterator_tag, random_access_iterator_tag) {
+  if (last2 - first2 > last1 - first1) {
+    return false;
+  }
+  if (set_use_gallop(last2 - first2, last1 - first1)) {
+    for (; first2 != last2; ++first1, ++first2) {
+      first1 = yastl::gallop_lower_bound(first1, last1, *first2, comp);
+      if (first1 == last1 || comp(*first2, *first1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return yastl::includes_dispatch(first1, last1, first2, last2, comp,
+                                  input_iterator_tag(), input_iterator_tag());
+}
+
+template <class InputIter1, class InputIter2>
+bool includes(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2) {
+  return yastl::includes_dispatch(first1, last1, first2, last2, set_less(),
+                                  iterator_category(first1), iterator_category(first2));
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class InputIter1, class InputIter2, class Compared>
 bool includes(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2, Compared comp) {
-  while (first1 != last1 && first2 != last2) {
-    if (comp(*first2, *first1)) {
-      return false;
-    } else if (comp(*first1, *first2)) {
-      ++first1;
-    } else {
-      ++first1, ++first2;
-    }
-  }
-  return first2 == last2;
+  return yastl::includes_dispatch(first1, last1, first2, last2, comp,
+                                  iterator_category(first1), iterator_category(first2));
 }
 
 /*****************************************************************************************/
@@ -925,7 +1110,7 @@ const T& median(const T& left, const T& mid, const T& right, Compared comp) {
 // 返回一个迭代器，指向序列中最大的元素
 /*****************************************************************************************/
 template <class ForwardIter>
-ForwardIter max_element(ForwardIter first, ForwardIter last) {
+ForwardIter max_element_cat(ForwardIter first, ForwardIter last, m_false_type) {
   if (first == last) {
     return first;
   }
@@ -938,6 +1123,24 @@ ForwardIter max_element(ForwardIter first, ForwardIter last) {
   return result;
 }
 
+// 连续的算术类型区间先用 SIMD 求出最大值，再找到它第一次出现的位置，有 NaN 时退回逐个比较
+template <class T>
+T* max_element_cat(T* first, T* last, m_true_type) {
+  typedef typename std::remove_cv<T>::type value_type;
+  value_type lo;
+  value_type hi;
+  if (first == last || !yastl::simd_minmax<value_type>(first, last, &lo, &hi)) {
+    return yastl::max_element_cat(first, last, m_false_type());
+  }
+  return first + (yastl::simd_find<value_type>(first, last, hi) - first);
+}
+
+template <class ForwardIter>
+ForwardIter max_element(ForwardIter first, ForwardIter last) {
+  typedef typename iterator_traits<ForwardIter>::value_type value_type;
+  return yastl::max_element_cat(first, last, simd_contiguous<ForwardIter, value_type>());
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class ForwardIter, class Compared>
 ForwardIter max_element(ForwardIter first, ForwardIter last, Compared comp) {
@@ -958,7 +1161,7 @@ ForwardIter max_element(ForwardIter first, ForwardIter last, Compared comp) {
 // 返回一个迭代器，指向序列中最小的元素
 /*****************************************************************************************/
 template <class ForwardIter>
-ForwardIter min_elememt(ForwardIter first, ForwardIter last) {
+ForwardIter min_element_cat(ForwardIter first, ForwardIter last, m_false_type) {
   if (first == last) {
     return first;
   }
@@ -971,9 +1174,33 @@ ForwardIter min_elememt(ForwardIter first, ForwardIter last) {
   return result;
 }
 
+// 连续的算术类型区间先用 SIMD 求出最小值，再找到它第一次出现的位置，有 NaN 时退回逐个比较
+template <class T>
+T* min_element_cat(T* first, T* last, m_true_type) {
+  typedef typename std::remove_cv<T>::type value_type;
+  value_type lo;
+  value_type hi;
+  if (first == last || !yastl::simd_minmax<value_type>(first, last, &lo, &hi)) {
+    return yastl::min_element_cat(first, last, m_false_type());
+  }
+  return first + (yastl::simd_find<value_type>(first, last, lo) - first);
+}
+
+template <class ForwardIter>
+ForwardIter min_element(ForwardIter first, ForwardIter last) {
+  typedef typename iterator_traits<ForwardIter>::value_type value_type;
+  return yastl::min_element_cat(first, last, simd_contiguous<ForwardIter, value_type>());
+}
+
+// 保留原来拼错的名字
+template <class ForwardIter>
+ForwardIter min_elememt(ForwardIter first, ForwardIter last) {
+  return yastl::min_element(first, last);
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class ForwardIter, class Compared>
-ForwardIter min_elememt(ForwardIter first, ForwardIter last, Compared comp) {
+ForwardIter min_element(ForwardIter first, ForwardIter last, Compared comp) {
   if (first == last) {
     return first;
   }
@@ -986,6 +1213,80 @@ ForwardIter min_elememt(ForwardIter first, ForwardIter last, Compared comp) {
   return result;
 }
 
+template <class ForwardIter, class Compared>
+ForwardIter min_elememt(ForwardIter first, ForwardIter last, Compared comp) {
+  return yastl::min_element(first, last, comp);
+}
+
+/*****************************************************************************************/
+// minmax_element
+// 一次遍历找出最小和最大的元素，返回的 pair 中 first 指向第一个最小的元素，second 指向最后一个最大的元素
+// 每次取两个元素先互相比较，较小的与当前最小值比较，较大的与当前最大值比较，共约 3n/2 次比较
+/*****************************************************************************************/
+template <class ForwardIter, class Compared>
+yastl::pair<ForwardIter, ForwardIter> minmax_element(ForwardIter first, ForwardIter last, Compared comp) {
+  yastl::pair<ForwardIter, ForwardIter> result(first, first);
+  if (first == last || ++first == last) {
+    return result;
+  }
+  if (comp(*first, *result.first)) {
+    result.first = first;
+  } else {
+    result.second = first;
+  }
+  while (++first != last) {
+    ForwardIter i = first;
+    if (++first == last) {
+      if (comp(*i, *result.first)) {
+        result.first = i;
+      } else if (!comp(*i, *result.second)) {
+        result.second = i;
+      }
+      break;
+    }
+    if (comp(*first, *i)) {
+      if (comp(*first, *result.first)) {
+        result.first = first;
+      }
+      if (!comp(*i, *result.second)) {
+        result.second = i;
+      }
+    } else {
+      if (comp(*i, *result.first)) {
+        result.first = i;
+      }
+      if (!comp(*first, *result.second)) {
+        result.second = first;
+      }
+    }
+  }
+  return result;
+}
+
+template <class ForwardIter>
+yastl::pair<ForwardIter, ForwardIter> minmax_element_cat(ForwardIter first, ForwardIter last, m_false_type) {
+  return yastl::minmax_element(first, last, yastl::less<typename iterator_traits<ForwardIter>::value_type>());
+}
+
+// 连续的算术类型区间用 SIMD 一次求出最小值和最大值，再分别从前、从后找到它们的位置
+template <class T>
+yastl::pair<T*, T*> minmax_element_cat(T* first, T* last, m_true_type) {
+  typedef typename std::remove_cv<T>::type value_type;
+  value_type lo;
+  value_type hi;
+  if (first == last || !yastl::simd_minmax<value_type>(first, last, &lo, &hi)) {
+    return yastl::minmax_element_cat(first, last, m_false_type());
+  }
+  return yastl::pair<T*, T*>(first + (yastl::simd_find<value_type>(first, last, lo) - first),
+                             first + (yastl::simd_find_last<value_type>(first, last, hi) - first));
+}
+
+template <class ForwardIter>
+yastl::pair<ForwardIter, ForwardIter> minmax_element(ForwardIter first, ForwardIter last) {
+  typedef typename iterator_traits<ForwardIter>::value_type value_type;
+  return yastl::minmax_element_cat(first, last, simd_contiguous<ForwardIter, value_type>());
+}
+
 /*****************************************************************************************/
 // swap_ranges
 // 将[first1, last1)从 first2 开始，交换相同个数元素
@@ -1808,33 +2109,6 @@ void inplace_merge(BidirectionalIter first, BidirectionalIter middle, Bidirectio
   yastl::inplace_merge_aux(first, middle, last, value_type(first), comp);
 }
 
-/*****************************************************************************************/
-// partial_sort
-// 对整个序列做部分排序，保证较小的 N 个元素以递增顺序置于[first, first + N)中
-/*****************************************************************************************/
-template <class RandomIter>
-void partial_sort(RandomIter first, RandomIter middle, RandomIter last) {
-  yastl::make_heap(first, middle);
-  for (auto i = middle; i < last; ++i) {
-    if (*i < *first) { // 如果后面有比根顶还小的元素，就把根顶弹出 (大顶堆)
-      yastl::pop_heap_aux(first, middle, i, *i, distance_type(first));
-    }
-  }
-  yastl::sort_heap(first, middle); // 排序
-}
-
-// 重载版本使用函数对象 comp 代替比较操作
-template <class RandomIter, class Compared>
-void partial_sort(RandomIter first, RandomIter middle, RandomIter last, Compared comp) {
-  yastl::make_heap(first, middle, comp);
-  for (auto i = middle; i < last; ++i) {
-    if (comp(*i, *first)) {
-      yastl::pop_heap_aux(first, middle, i, *i, distance_type(first), comp);
-    }
-  }
-  yastl::sort_heap(first, middle, comp);
-}
-
 /*****************************************************************************************/
 // partial_sort_copy
 // 行为与 partial_sort 类似，不同的是把排序结果复制到 result 容器中
@@ -1941,13 +2215,64 @@ yastl::pair<OutputIter1, OutputIter2> partition_copy(InputIter first, InputIter
   return yastl::pair<OutputIter1, OutputIter2>(result_true, result_false);
 }
 
+/*****************************************************************************************/
+// stable_partition
+// 行为与 partition 类似，但保持元素的原始相对位置
+// 缓冲区足够时一次遍历完成，否则二分递归，再用 rotate 把两半拼起来
+/*****************************************************************************************/
+template <class BidirectionalIter, class UnaryPredicate, class Distance, class Pointer>
+BidirectionalIter stable_partition_adaptive(BidirectionalIter first, BidirectionalIter last,
+                                            UnaryPredicate unary_pred, Distance len,
+                                            Pointer buffer, Distance buffer_size) {
+  if (len <= buffer_size) {
+    while (first != last && unary_pred(*first)) { // 开头满足条件的元素不用移动
+      ++first;
+    }
+    BidirectionalIter result = first;
+    Pointer buffer_end = buffer;
+    for (; first != last; ++first) {
+      if (unary_pred(*first)) {
+        *result = yastl::move(*first);
+        ++result;
+      } else {
+        *buffer_end = yastl::move(*first);
+        ++buffer_end;
+      }
+    }
+    yastl::move(buffer, buffer_end, result);
+    return result;
+  }
+  if (len == 1) {
+    return unary_pred(*first) ? last : first;
+  }
+  BidirectionalIter middle = first;
+  yastl::advance(middle, len / 2);
+  BidirectionalIter left_split =
+    yastl::stable_partition_adaptive(first, middle, unary_pred, len / 2, buffer, buffer_size);
+  BidirectionalIter right_split =
+    yastl::stable_partition_adaptive(middle, last, unary_pred, len - len / 2, buffer, buffer_size);
+  return yastl::rotate(left_split, middle, right_split);
+}
+
+template <class BidirectionalIter, class UnaryPredicate>
+BidirectionalIter stable_partition(BidirectionalIter first, BidirectionalIter last, UnaryPredicate unary_pred) {
+  typedef typename iterator_traits<BidirectionalIter>::difference_type Distance;
+  typedef typename iterator_traits<BidirectionalIter>::value_type T;
+  first = yastl::find_if_not(first, last, unary_pred);
+  if (first == last) {
+    return first;
+  }
+  const Distance len = yastl::distance(first, last);
+  temporary_buffer<BidirectionalIter, T> buf(first, last);
+  return yastl::stable_partition_adaptive(first, last, unary_pred, len, buf.begin(),
+                                          static_cast<Distance>(buf.size()));
+}
+
 /*****************************************************************************************/
 // sort
 // 将[first, last)内的元素以递增的方式排序
 /*****************************************************************************************/
-constexpr static size_t kSmallSectionSize = 128;  // 小型区间的大小，在这个大小内采用插入排序
-
-                                                  // 用于控制分割恶化的情况
+// 用于控制分割恶化的情况
 template <class Size>
 Size slg2(Size n) { // 找出 lgk <= n 的 k 的最大值
   Size k = 0;
@@ -1976,23 +2301,6 @@ RandomIter unchecked_partition(RandomIter first, RandomIter last, const T& pivot
   }
 }
 
-// 内省式排序，先进行 quick sort，当分割行为有恶化倾向时，改用 heap sort
-template <class RandomIter, class Size>
-void intro_sort(RandomIter first, RandomIter last, Size depth_limit) {
-  while (static_cast<size_t>(last - first) > kSmallSectionSize) {
-    if (depth_limit == 0) {
-      // 到达最大分割深度限制
-      yastl::partial_sort(first, last, last);  // 改用 heap_sort
-      return;
-    }
-    --depth_limit;
-    auto mid = yastl::median(*(first), *(first + (last - first) / 2), *(last - 1));
-    auto cut = yastl::unchecked_partition(first, last, mid); // 快排 分割左右两部分
-    yastl::intro_sort(cut, last, depth_limit); // 迭代排右侧
-    last = cut;
-  }
-}
-
 // 插入排序辅助函数 unchecked_linear_insert，找到插入位置并插入 value(从小到大排序)
 template <class RandomIter, class T>
 void unchecked_linear_insert(RandomIter last, const T& value) {
@@ -2010,7 +2318,8 @@ void unchecked_linear_insert(RandomIter last, const T& value) {
 template <class RandomIter>
 void unchecked_insertion_sort(RandomIter first, RandomIter last) {
   for (auto i = first; i != last; ++i) {
-    yastl::unchecked_linear_insert(i, *i); // 依次插入
+    auto value = *i; // 先取出，插入过程中 *i 会被覆盖
+    yastl::unchecked_linear_insert(i, value); // 依次插入
   }
 }
 
@@ -2031,26 +2340,6 @@ void insertion_sort(RandomIter first, RandomIter last) {
   }
 }
 
-// 最终插入排序函数 final_insertion_sort
-template <class RandomIter>
-void final_insertion_sort(RandomIter first, RandomIter last) {
-  if (static_cast<size_t>(last - first) > kSmallSectionSize) { // 大于阈值后 先排序一部分再插依次插入
-    yastl::insertion_sort(first, first + kSmallSectionSize);
-    yastl::unchecked_insertion_sort(first + kSmallSectionSize, last);
-  } else { // 区间大小小于阈值直接插入排序
-    yastl::insertion_sort(first, last);
-  }
-}
-
-template <class RandomIter>
-void sort(RandomIter first, RandomIter last) {
-  if (first != last) {
-    // 内省式排序，将区间分为一个个小区间，然后对整体进行插入排序
-    yastl::intro_sort(first, last, slg2(last - first) * 2);
-    yastl::final_insertion_sort(first, last);
-  }
-}
-
 // 重载版本使用函数对象 comp 代替比较操作
 // 分割函数 unchecked_partition, 以pivot为中轴，划分两边元素,返回值 first 左边 <=pivot，右边都 >=pivot
 template <class RandomIter, class T, class Compared>
@@ -2071,22 +2360,6 @@ RandomIter unchecked_partition(RandomIter first, RandomIter last, const T& pivot
   }
 }
 
-// 内省式排序，先进行 quick sort，当分割行为有恶化倾向时，改用 heap sort
-template <class RandomIter, class Size, class Compared>
-void intro_sort(RandomIter first, RandomIter last, Size depth_limit, Compared comp) {
-  while (static_cast<size_t>(last - first) > kSmallSectionSize) {
-    if (depth_limit == 0) {                            // 到达最大分割深度限制
-      yastl::partial_sort(first, last, last, comp);  // 改用 heap_sort
-      return;
-    }
-    --depth_limit;
-    auto mid = yastl::median(*(first), *(first + (last - first) / 2), *(last - 1));
-    auto cut = yastl::unchecked_partition(first, last, mid, comp);
-    yastl::intro_sort(cut, last, depth_limit, comp); // 快排
-    last = cut;
-  }
-}
-
 // 插入排序辅助函数 unchecked_linear_insert，带比较函数
 template <class RandomIter, class T, class Compared>
 void unchecked_linear_insert(RandomIter last, const T& value, Compared comp) {
@@ -2104,7 +2377,8 @@ void unchecked_linear_insert(RandomIter last, const T& value, Compared comp) {
 template <class RandomIter, class Compared>
 void unchecked_insertion_sort(RandomIter first, RandomIter last, Compared comp) {
   for (auto i = first; i != last; ++i) {
-    yastl::unchecked_linear_insert(i, *i, comp);
+    auto value = *i;
+    yastl::unchecked_linear_insert(i, value, comp);
   }
 }
 
@@ -2125,63 +2399,707 @@ void insertion_sort(RandomIter first, RandomIter last, Compared comp) {
   }
 }
 
-// 最终插入排序函数 final_insertion_sort
+
+// 以下为 sort 使用的 pattern-defeating quicksort（pdqsort）
+// 1. 区间较小时使用插入排序，阈值按元素大小调整
+// 2. 枢轴取三数中值，区间较大时取九数中值（ninther），枢轴移动到首位，不额外拷贝
+// 3. 分割后若区间本来就已分好，尝试有限次数的插入排序，对已排序或接近有序的输入接近线性
+// 4. 分割极不平衡时打乱部分元素来破坏对抗性的输入，次数过多时改用 heap sort
+// 5. 算术类型配合 less / greater 时使用按块记录偏移量的无分支分割
+
+// 插入排序的阈值，元素越大阈值越小
+template <class T>
+struct pdq_insertion_threshold
+  : m_integral_constant<size_t, (sizeof(T) <= 8 ? 24 : (sizeof(T) <= 32 ? 16 : 8))> {};
+
+constexpr static size_t kPdqNintherThreshold = 128;        // 超过这个大小时使用九数取中
+constexpr static size_t kPdqPartialInsertionLimit = 8;     // 尝试插入排序时最多允许移动的元素个数
+constexpr static size_t kPdqBlockSize = 64;                // 无分支分割每块的元素个数
+
+// 是否使用无分支分割：比较本身很便宜且没有分支时才有收益
+template <class T, class Compared>
+struct pdq_use_branchless : m_false_type {};
+
+template <class T>
+struct pdq_use_branchless<T, yastl::less<T>> : m_bool_constant<std::is_arithmetic<T>::value> {};
+
+template <class T>
+struct pdq_use_branchless<T, yastl::greater<T>> : m_bool_constant<std::is_arithmetic<T>::value> {};
+
+// 带边界检查的插入排序
 template <class RandomIter, class Compared>
-void final_insertion_sort(RandomIter first, RandomIter last, Compared comp) {
-  if (static_cast<size_t>(last - first) > kSmallSectionSize) {
-    yastl::insertion_sort(first, first + kSmallSectionSize, comp);
-    yastl::unchecked_insertion_sort(first + kSmallSectionSize, last, comp);
+void pdq_insertion_sort(RandomIter first, RandomIter last, Compared comp) {
+  if (first == last) {
+    return;
+  }
+  for (RandomIter cur = first + 1; cur != last; ++cur) {
+    RandomIter sift = cur;
+    RandomIter sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      auto tmp = yastl::move(*sift);
+      do {
+        *sift-- = yastl::move(*sift_1);
+      } while (sift != first && comp(tmp, *--sift_1));
+      *sift = yastl::move(tmp);
+    }
+  }
+}
+
+// 不检查边界的插入排序，要求 first 之前的元素不大于区间内所有元素
+template <class RandomIter, class Compared>
+void pdq_unguarded_insertion_sort(RandomIter first, RandomIter last, Compared comp) {
+  if (first == last) {
+    return;
+  }
+  for (RandomIter cur = first + 1; cur != last; ++cur) {
+    RandomIter sift = cur;
+    RandomIter sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      auto tmp = yastl::move(*sift);
+      do {
+        *sift-- = yastl::move(*sift_1);
+      } while (comp(tmp, *--sift_1));
+      *sift = yastl::move(tmp);
+    }
+  }
+}
+
+// 尝试插入排序，移动的元素超过 kPdqPartialInsertionLimit 时放弃并返回 false
+template <class RandomIter, class Compared>
+bool pdq_partial_insertion_sort(RandomIter first, RandomIter last, Compared comp) {
+  if (first == last) {
+    return true;
+  }
+  size_t limit = 0;
+  for (RandomIter cur = first + 1; cur != last; ++cur) {
+    if (limit > kPdqPartialInsertionLimit) {
+      return false;
+    }
+    RandomIter sift = cur;
+    RandomIter sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      auto tmp = yastl::move(*sift);
+      do {
+        *sift-- = yastl::move(*sift_1);
+      } while (sift != first && comp(tmp, *--sift_1));
+      *sift = yastl::move(tmp);
+      limit += static_cast<size_t>(cur - sift);
+    }
+  }
+  return true;
+}
+
+template <class RandomIter, class Compared>
+void pdq_sort2(RandomIter a, RandomIter b, Compared comp) {
+  if (comp(*b, *a)) {
+    yastl::iter_swap(a, b);
+  }
+}
+
+// 把 *a, *b, *c 排好序，中值放在 b
+template <class RandomIter, class Compared>
+void pdq_sort3(RandomIter a, RandomIter b, RandomIter c, Compared comp) {
+  yastl::pdq_sort2(a, b, comp);
+  yastl::pdq_sort2(b, c, comp);
+  yastl::pdq_sort2(a, b, comp);
+}
+
+// 交换两侧记录下来的错位元素，两侧个数相同时逐对交换，否则沿一个环依次移动
+template <class RandomIter>
+void pdq_swap_offsets(RandomIter first, RandomIter last, unsigned char* offsets_l, unsigned char* offsets_r,
+                      size_t num, bool use_swaps) {
+  if (use_swaps) {
+    for (size_t i = 0; i < num; ++i) {
+      yastl::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+    }
+  } else if (num > 0) {
+    RandomIter l = first + offsets_l[0];
+    RandomIter r = last - offsets_r[0];
+    auto tmp = yastl::move(*l);
+    *l = yastl::move(*r);
+    for (size_t i = 1; i < num; ++i) {
+      l = first + offsets_l[i];
+      *r = yastl::move(*l);
+      r = last - offsets_r[i];
+      *l = yastl::move(*r);
+    }
+    *r = yastl::move(tmp);
+  }
+}
+
+// 以 *first 为枢轴分割，等于枢轴的元素放在右侧，返回枢轴的最终位置以及区间是否本来就已分好
+// 先按块扫描，把需要交换的元素的偏移量记录下来，比较结果只用于加法，不产生分支
+template <class RandomIter, class Compared>
+yastl::pair<RandomIter, bool> pdq_partition_right_branchless(RandomIter begin, RandomIter end, Compared comp) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  auto pivot = yastl::move(*begin);
+  RandomIter first = begin;
+  RandomIter last = end;
+
+  // 找到第一个不小于枢轴的元素，首位是三数中值，一定能停下
+  while (comp(*++first, pivot)) {
+  }
+  // 左侧没有移动时右侧要检查边界
+  if (first - 1 == begin) {
+    while (first < last && !comp(*--last, pivot)) {
+    }
   } else {
-    yastl::insertion_sort(first, last, comp);
+    while (!comp(*--last, pivot)) {
+    }
+  }
+
+  const bool already_partitioned = first >= last;
+  if (!already_partitioned) {
+    yastl::iter_swap(first, last);
+    ++first;
+
+    unsigned char offsets_l[kPdqBlockSize];
+    unsigned char offsets_r[kPdqBlockSize];
+    RandomIter offsets_l_base = first;
+    RandomIter offsets_r_base = last;
+    size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+    while (first < last) {
+      // 剩余不足两块时，把剩余部分分给还没有待交换元素的一侧
+      const size_t num_unknown = static_cast<size_t>(last - first);
+      const size_t left_split = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+      const size_t right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+      if (left_split >= kPdqBlockSize) {
+        for (size_t i = 0; i < kPdqBlockSize; ++i) {
+          offsets_l[num_l] = static_cast<unsigned char>(i);
+          num_l += !comp(*first, pivot);
+          ++first;
+        }
+      } else {
+        for (size_t i = 0; i < left_split; ++i) {
+          offsets_l[num_l] = static_cast<unsigned char>(i);
+          num_l += !comp(*first, pivot);
+          ++first;
+        }
+      }
+
+      if (right_split >= kPdqBlockSize) {
+        for (size_t i = 0; i < kPdqBlockSize; ) {
+          offsets_r[num_r] = static_cast<unsigned char>(++i);
+          num_r += comp(*--last, pivot);
+        }
+      } else {
+        for (size_t i = 0; i < right_split; ) {
+          offsets_r[num_r] = static_cast<unsigned char>(++i);
+          num_r += comp(*--last, pivot);
+        }
+      }
+
+      const size_t num = yastl::min(num_l, num_r);
+      yastl::pdq_swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r,
+                              num, num_l == num_r);
+      num_l -= num;
+      num_r -= num;
+      start_l += num;
+      start_r += num;
+      if (num_l == 0) {
+        start_l = 0;
+        offsets_l_base = first;
+      }
+      if (num_r == 0) {
+        start_r = 0;
+        offsets_r_base = last;
+      }
+    }
+
+    // 某一侧还有剩余的待交换元素，把它们移到分界处
+    if (num_l) {
+      while (num_l--) {
+        yastl::iter_swap(offsets_l_base + static_cast<Distance>(offsets_l[start_l + num_l]), --last);
+      }
+      first = last;
+    }
+    if (num_r) {
+      while (num_r--) {
+        yastl::iter_swap(offsets_r_base - static_cast<Distance>(offsets_r[start_r + num_r]), first);
+        ++first;
+      }
+      last = first;
+    }
+  }
+
+  RandomIter pivot_pos = first - 1;
+  *begin = yastl::move(*pivot_pos);
+  *pivot_pos = yastl::move(pivot);
+  return yastl::pair<RandomIter, bool>(pivot_pos, already_partitioned);
+}
+
+// 与上面相同，逐个交换的普通版本
+template <class RandomIter, class Compared>
+yastl::pair<RandomIter, bool> pdq_partition_right(RandomIter begin, RandomIter end, Compared comp) {
+  auto pivot = yastl::move(*begin);
+  RandomIter first = begin;
+  RandomIter last = end;
+
+  while (comp(*++first, pivot)) {
+  }
+  if (first - 1 == begin) {
+    while (first < last && !comp(*--last, pivot)) {
+    }
+  } else {
+    while (!comp(*--last, pivot)) {
+    }
+  }
+
+  const bool already_partitioned = first >= last;
+  while (first < last) {
+    yastl::iter_swap(first, last);
+    while (comp(*++first, pivot)) {
+    }
+    while (!comp(*--last, pivot)) {
+    }
+  }
+
+  RandomIter pivot_pos = first - 1;
+  *begin = yastl::move(*pivot_pos);
+  *pivot_pos = yastl::move(pivot);
+  return yastl::pair<RandomIter, bool>(pivot_pos, already_partitioned);
+}
+
+// 以 *first 为枢轴分割，等于枢轴的元素放在左侧
+// 用于枢轴与前一段的最大值相等的情况，此时左侧全部等于枢轴，不用再排序，大量重复元素时为线性
+template <class RandomIter, class Compared>
+RandomIter pdq_partition_left(RandomIter begin, RandomIter end, Compared comp) {
+  auto pivot = yastl::move(*begin);
+  RandomIter first = begin;
+  RandomIter last = end;
+
+  while (comp(pivot, *--last)) {
+  }
+  if (last + 1 == end) {
+    while (first < last && !comp(pivot, *++first)) {
+    }
+  } else {
+    while (!comp(pivot, *++first)) {
+    }
+  }
+
+  while (first < last) {
+    yastl::iter_swap(first, last);
+    while (comp(pivot, *--last)) {
+    }
+    while (!comp(pivot, *++first)) {
+    }
+  }
+
+  RandomIter pivot_pos = last;
+  *begin = yastl::move(*pivot_pos);
+  *pivot_pos = yastl::move(pivot);
+  return pivot_pos;
+}
+
+template <class RandomIter, class Compared, class Branchless>
+yastl::pair<RandomIter, bool> pdq_partition(RandomIter begin, RandomIter end, Compared comp, Branchless) {
+  return Branchless::value ? yastl::pdq_partition_right_branchless(begin, end, comp)
+                           : yastl::pdq_partition_right(begin, end, comp);
+}
+
+// pdqsort 主循环，leftmost 表示区间左侧没有更小的元素
+template <class RandomIter, class Compared, class Branchless>
+void pdq_sort_loop(RandomIter begin, RandomIter end, Compared comp, int bad_allowed, bool leftmost,
+                   Branchless branchless) {
+  typedef typename iterator_traits<RandomIter>::value_type T;
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const Distance insertion_threshold = static_cast<Distance>(pdq_insertion_threshold<T>::value);
+  const Distance ninther_threshold = static_cast<Distance>(kPdqNintherThreshold);
+
+  while (true) {
+    const Distance size = end - begin;
+    if (size < insertion_threshold) {
+      if (leftmost) {
+        yastl::pdq_insertion_sort(begin, end, comp);
+      } else {
+        yastl::pdq_unguarded_insertion_sort(begin, end, comp);
+      }
+      return;
+    }
+
+    // 选取枢轴并放到首位
+    const Distance s2 = size / 2;
+    if (size > ninther_threshold) {
+      yastl::pdq_sort3(begin, begin + s2, end - 1, comp);
+      yastl::pdq_sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+      yastl::pdq_sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+      yastl::pdq_sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+      yastl::iter_swap(begin, begin + s2);
+    } else {
+      yastl::pdq_sort3(begin + s2, begin, end - 1, comp);
+    }
+
+    // 枢轴等于前一段的最大值，说明有大量重复元素，等于枢轴的元素放到左侧后直接跳过
+    if (!leftmost && !comp(*(begin - 1), *begin)) {
+      begin = yastl::pdq_partition_left(begin, end, comp) + 1;
+      continue;
+    }
+
+    yastl::pair<RandomIter, bool> part = yastl::pdq_partition(begin, end, comp, branchless);
+    RandomIter pivot_pos = part.first;
+    const Distance l_size = pivot_pos - begin;
+    const Distance r_size = end - (pivot_pos + 1);
+    const bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+    if (highly_unbalanced) {
+      // 不平衡的次数过多，改用 heap sort
+      if (--bad_allowed == 0) {
+        yastl::make_heap(begin, end, comp);
+        yastl::sort_heap(begin, end, comp);
+        return;
+      }
+      // 打乱两侧的部分元素，破坏导致不平衡的模式
+      if (l_size >= insertion_threshold) {
+        yastl::iter_swap(begin, begin + l_size / 4);
+        yastl::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+        if (l_size > ninther_threshold) {
+          yastl::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+          yastl::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+          yastl::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          yastl::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+      if (r_size >= insertion_threshold) {
+        yastl::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        yastl::iter_swap(end - 1, end - r_size / 4);
+        if (r_size > ninther_threshold) {
+          yastl::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          yastl::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          yastl::iter_swap(end - 2, end - (1 + r_size / 4));
+          yastl::iter_swap(end - 3, end - (2 + r_size / 4));
+        }
+      }
+    } else if (part.second && yastl::pdq_partial_insertion_sort(begin, pivot_pos, comp) &&
+               yastl::pdq_partial_insertion_sort(pivot_pos + 1, end, comp)) {
+      // 本来就已分好且两侧几乎有序，插入排序已经完成
+      return;
+    }
+
+    // 递归排序左侧，循环处理右侧
+    yastl::pdq_sort_loop(begin, pivot_pos, comp, bad_allowed, leftmost, branchless);
+    begin = pivot_pos + 1;
+    leftmost = false;
   }
 }
 
 template <class RandomIter, class Compared>
 void sort(RandomIter first, RandomIter last, Compared comp) {
-  if (first != last) {
-    // 内省式排序，将区间分为一个个小区间，然后对整体进行插入排序
-    yastl::intro_sort(first, last, slg2(last - first) * 2, comp);
-    yastl::final_insertion_sort(first, last, comp);
+  if (last - first > 1) {
+    typedef typename iterator_traits<RandomIter>::value_type T;
+    yastl::pdq_sort_loop(first, last, comp, static_cast<int>(slg2(last - first)), true,
+                         pdq_use_branchless<T, Compared>());
+  }
+}
+
+template <class RandomIter>
+void sort(RandomIter first, RandomIter last) {
+  yastl::sort(first, last, yastl::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+/*****************************************************************************************/
+// stable_sort
+// 将[first, last)内的元素以递增的方式排序，相等元素保持原始相对位置
+// 类似 Timsort：从左到右找出自然有序段（严格递减的段原地反转），太短的段用插入排序补足 min_run 个元素，
+// 段入栈后按 Timsort 的长度不变式用 merge_adaptive 两两合并，所以已经有序或分段有序的输入接近 O(n)
+/*****************************************************************************************/
+constexpr static size_t kStableMinRun = 32;  // 不超过这个大小的区间直接插入排序
+constexpr static int kStableMaxRuns = 85;    // 段栈的最大深度，足够 64 位长度使用
+
+// 使 n / min_run 接近且不超过 2 的幂次，min_run 在 [32, 64] 之间
+template <class Size>
+Size stable_min_run(Size n) {
+  Size r = 0;
+  while (n >= 64) {
+    r |= n & 1;
+    n >>= 1;
+  }
+  return n + r;
+}
+
+// 返回从 first 开始的自然有序段的末尾，严格递减的段会被反转
+template <class RandomIter, class Compared>
+RandomIter stable_count_run(RandomIter first, RandomIter last, Compared comp) {
+  RandomIter run = first + 1;
+  if (run == last) {
+    return run;
+  }
+  if (comp(*run, *first)) {
+    ++run;
+    while (run != last && comp(*run, *(run - 1))) {
+      ++run;
+    }
+    yastl::reverse(first, run);
+  } else {
+    ++run;
+    while (run != last && !comp(*run, *(run - 1))) {
+      ++run;
+    }
+  }
+  return run;
+}
+
+// 合并相邻的两个有序段，先去掉两端已经在最终位置上的元素
+template <class RandomIter, class Distance, class Pointer, class Compared>
+void stable_merge_runs(RandomIter first, RandomIter middle, RandomIter last,
+                       Pointer buffer, Distance buffer_size, Compared comp) {
+  if (!comp(*middle, *(middle - 1))) {
+    return;
+  }
+  first = yastl::upper_bound(first, middle, *middle, comp);
+  last = yastl::lower_bound(middle, last, *(middle - 1), comp);
+  const Distance len1 = middle - first;
+  const Distance len2 = last - middle;
+  if (buffer_size > 0) {
+    yastl::merge_adaptive(first, middle, last, len1, len2, buffer, buffer_size, comp);
+  } else {
+    yastl::merge_without_buffer(first, middle, last, len1, len2, comp);
+  }
+}
+
+// 合并栈中第 k 和第 k + 1 个段
+template <class RandomIter, class Distance, class Pointer, class Compared>
+void stable_merge_at(RandomIter first, Distance* run_base, Distance* run_len, int& top, int k,
+                     Pointer buffer, Distance buffer_size, Compared comp) {
+  RandomIter middle = first + run_base[k + 1];
+  yastl::stable_merge_runs(first + run_base[k], middle, middle + run_len[k + 1], buffer, buffer_size, comp);
+  run_len[k] += run_len[k + 1];
+  if (k + 3 == top) {
+    run_base[k + 1] = run_base[k + 2];
+    run_len[k + 1] = run_len[k + 2];
+  }
+  --top;
+}
+
+template <class RandomIter, class Compared>
+void stable_sort(RandomIter first, RandomIter last, Compared comp) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  typedef typename iterator_traits<RandomIter>::value_type T;
+  const Distance n = last - first;
+  if (n <= static_cast<Distance>(kStableMinRun)) {
+    yastl::pdq_insertion_sort(first, last, comp);
+    return;
+  }
+  // 每次合并时较短的段不超过 n / 2
+  temporary_buffer<RandomIter, T> buf(first, first + (n + 1) / 2);
+  T* buffer = buf.begin();
+  const Distance buffer_size = buffer ? static_cast<Distance>(buf.size()) : 0;
+
+  const Distance min_run = yastl::stable_min_run(n);
+  Distance run_base[kStableMaxRuns];
+  Distance run_len[kStableMaxRuns];
+  int top = 0;
+  for (RandomIter cur = first; cur != last; ) {
+    Distance len = yastl::stable_count_run(cur, last, comp) - cur;
+    if (len < min_run) {
+      len = yastl::min(min_run, static_cast<Distance>(last - cur));
+      yastl::pdq_insertion_sort(cur, cur + len, comp);
+    }
+    run_base[top] = cur - first;
+    run_len[top] = len;
+    ++top;
+    cur += len;
+    // 保持 run_len[k - 1] > run_len[k] + run_len[k + 1] 且 run_len[k] > run_len[k + 1]
+    while (top > 1) {
+      int k = top - 2;
+      if ((k > 0 && run_len[k - 1] <= run_len[k] + run_len[k + 1]) ||
+          (k > 1 && run_len[k - 2] <= run_len[k - 1] + run_len[k])) {
+        if (run_len[k - 1] < run_len[k + 1]) {
+          --k;
+        }
+      } else if (run_len[k] > run_len[k + 1]) {
+        break;
+      }
+      yastl::stable_merge_at(first, run_base, run_len, top, k, buffer, buffer_size, comp);
+    }
+  }
+  while (top > 1) {
+    int k = top - 2;
+    if (k > 0 && run_len[k - 1] < run_len[k + 1]) {
+      --k;
+    }
+    yastl::stable_merge_at(first, run_base, run_len, top, k, buffer, buffer_size, comp);
   }
 }
 
+template <class RandomIter>
+void stable_sort(RandomIter first, RandomIter last) {
+  yastl::stable_sort(first, last, yastl::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
 /*****************************************************************************************/
 // nth_element
 // 对序列重排，使得所有小于第 n 个元素的元素出现在它的前面，大于它的出现在它的后面
+// introselect：用 pdqsort 的分割函数反复缩小包含 nth 的区间
+//   * 大区间用 Floyd-Rivest 抽样：在 nth 附近取约 n^(2/3) 个元素递归选出枢轴，一次分割后剩下的区间很小
+//   * 其余情况用三数取中或九数取中，枢轴与左侧相邻的上一个枢轴相等时把等于枢轴的元素一次分出去
+//   * 区间缩小得太慢的次数过多时改用中位数的中位数，保证最坏情况下也是线性时间
 /*****************************************************************************************/
-template <class RandomIter>
-void nth_element(RandomIter first, RandomIter nth, RandomIter last) {
-  if (nth == last) {
-    return;
+constexpr static size_t kSelectInsertionThreshold = 16;  // 不超过这个大小的区间直接插入排序
+constexpr static size_t kSelectSampleThreshold = 600;    // 超过这个大小时用 Floyd-Rivest 抽样选取枢轴
+
+// 中位数的中位数：每 5 个元素一组取中值，递归选出这些中值的中值作为枢轴，每轮至少去掉 3/10 的元素
+template <class RandomIter, class Compared>
+void select_median_of_medians(RandomIter begin, RandomIter nth, RandomIter end, Compared comp) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  while (end - begin > static_cast<Distance>(kSelectInsertionThreshold)) {
+    const Distance groups = (end - begin) / 5;
+    for (Distance g = 0; g < groups; ++g) {
+      RandomIter group = begin + 5 * g;
+      yastl::pdq_insertion_sort(group, group + 5, comp);
+      yastl::iter_swap(begin + g, group + 2);
+    }
+    RandomIter mid = begin + groups / 2;
+    yastl::select_median_of_medians(begin, mid, begin + groups, comp);
+    // mid 之后的中值不小于枢轴，移到末尾作为分割时的哨兵
+    yastl::iter_swap(mid + 1, end - 1);
+    yastl::iter_swap(begin, mid);
+    RandomIter lo = yastl::pdq_partition_right(begin, end, comp).first;
+    if (nth < lo) {
+      end = lo;
+      continue;
+    }
+    // 等于枢轴的元素也要分出去，否则大量重复元素时每轮只能去掉一个
+    RandomIter hi = yastl::pdq_partition_left(lo, end, comp);
+    if (nth <= hi) {
+      return;
+    }
+    begin = hi + 1;
   }
-  while (last - first > 3) { // 直到区间 <=3 够小了之后再排序
-    auto cut = yastl::unchecked_partition(first, last, yastl::median(*first, *(first + (last - first) / 2),
-                                                                     *(last - 1))); // 三分取中间值
-    if (cut <= nth) { // 如果 nth 位于右段
-      first = cut;   // 对右段进行分割
+  yastl::pdq_insertion_sort(begin, end, comp);
+}
+
+// Floyd-Rivest：在 nth 附近取一段样本，递归地把样本中排在 nth 的元素选出来作为枢轴移到 begin
+// 样本中 nth 之后的元素不小于枢轴，把其中一个移到 end - 1 作为分割时的哨兵，样本中 nth 之后没有元素时返回 false
+template <class RandomIter, class Compared>
+bool select_floyd_rivest_pivot(RandomIter begin, RandomIter nth, RandomIter end, Compared comp, int bad_allowed);
+
+template <class RandomIter, class Compared>
+void introselect(RandomIter begin, RandomIter nth, RandomIter end, Compared comp, int bad_allowed) {
+  typedef typename iterator_traits<RandomIter>::value_type T;
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const RandomIter leftmost = begin;
+  while (end - begin > static_cast<Distance>(kSelectInsertionThreshold)) {
+    const Distance size = end - begin;
+    if (nth == begin) {
+      yastl::iter_swap(begin, yastl::min_element(begin, end, comp));
+      return;
+    }
+    if (nth == end - 1) {
+      yastl::iter_swap(end - 1, yastl::max_element(begin, end, comp));
+      return;
+    }
+    if (bad_allowed <= 0) {
+      yastl::select_median_of_medians(begin, nth, end, comp);
+      return;
+    }
+
+    // 选取枢轴并放到首位，区间内另有一个不小于枢轴的元素作为哨兵
+    if (size <= static_cast<Distance>(kSelectSampleThreshold) ||
+        !yastl::select_floyd_rivest_pivot(begin, nth, end, comp, bad_allowed)) {
+      const Distance s2 = size / 2;
+      if (size > static_cast<Distance>(kPdqNintherThreshold)) {
+        yastl::pdq_sort3(begin, begin + s2, end - 1, comp);
+        yastl::pdq_sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+        yastl::pdq_sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+        yastl::pdq_sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+        yastl::iter_swap(begin, begin + s2);
+      } else {
+        yastl::pdq_sort3(begin + s2, begin, end - 1, comp);
+      }
+    }
+
+    // 枢轴等于左侧相邻的上一个枢轴，说明有大量重复元素，等于枢轴的元素都放到左侧
+    if (begin != leftmost && !comp(*(begin - 1), *begin)) {
+      RandomIter pos = yastl::pdq_partition_left(begin, end, comp);
+      if (nth <= pos) {
+        return;
+      }
+      begin = pos + 1;
+      continue;
+    }
+
+    RandomIter pivot_pos = yastl::pdq_partition(begin, end, comp, pdq_use_branchless<T, Compared>()).first;
+    if (pivot_pos == nth) {
+      return;
+    }
+    if (nth < pivot_pos) {
+      end = pivot_pos;
     } else {
-      last = cut;    // 对左段进行分割
+      begin = pivot_pos + 1;
+    }
+    if (end - begin > size - size / 8) { // 这一轮几乎没有缩小
+      --bad_allowed;
     }
   }
-  yastl::insertion_sort(first, last);
+  yastl::pdq_insertion_sort(begin, end, comp);
+}
+
+template <class RandomIter, class Compared>
+bool select_floyd_rivest_pivot(RandomIter begin, RandomIter nth, RandomIter end, Compared comp, int bad_allowed) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const Distance size = end - begin;
+  const Distance k = nth - begin;
+  const double n = static_cast<double>(size);
+  const double z = std::log(n);
+  const double s = 0.5 * std::exp(2 * z / 3);  // 样本大小
+  const double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (2 * k < size ? -1 : 1);
+  Distance l = static_cast<Distance>(static_cast<double>(k) - static_cast<double>(k) * s / n + sd);
+  Distance r = static_cast<Distance>(static_cast<double>(k) + static_cast<double>(size - k) * s / n + sd) + 1;
+  l = l < 0 ? 0 : (l > k ? k : l);
+  r = r > size ? size : r;
+  if (r <= k + 1) {
+    return false;
+  }
+  yastl::introselect(begin + l, nth, begin + r, comp, bad_allowed);
+  yastl::iter_swap(nth + 1, end - 1);
+  yastl::iter_swap(begin, nth);
+  return true;
 }
 
-// 重载版本使用函数对象 comp 代替比较操作
 template <class RandomIter, class Compared>
 void nth_element(RandomIter first, RandomIter nth, RandomIter last, Compared comp) {
-  if (nth == last) {
+  if (nth == last || last - first < 2) {
     return;
   }
-  while (last - first > 3) {
-    auto cut = yastl::unchecked_partition(first, last, yastl::median(*first, *(first + (last - first) / 2),
-										                                                 *(last - 1)), comp);
-    if (cut <= nth) { // 如果 nth 位于右段
-      first = cut;   // 对右段进行分割
-    } else {
-      last = cut;    // 对左段进行分割
+  yastl::introselect(first, nth, last, comp, static_cast<int>(slg2(last - first)));
+}
+
+template <class RandomIter>
+void nth_element(RandomIter first, RandomIter nth, RandomIter last) {
+  yastl::nth_element(first, nth, last, yastl::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+/*****************************************************************************************/
+// partial_sort
+// 对整个序列做部分排序，保证较小的 N 个元素以递增顺序置于[first, first + N)中
+// N 较小时维护一个大小为 N 的堆扫描一遍，N 较大时先用 nth_element 选出较小的 N 个元素再排序
+/*****************************************************************************************/
+constexpr static size_t kPartialSortHeapLimit = 1024;  // N 不超过这个大小并且不超过总数的 1/16 时使用堆
+
+template <class RandomIter, class Compared>
+void partial_sort(RandomIter first, RandomIter middle, RandomIter last, Compared comp) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const Distance k = middle - first;
+  if (k <= static_cast<Distance>(kPartialSortHeapLimit) && k <= (last - first) / 16) {
+    yastl::make_heap(first, middle, comp);
+    for (auto i = middle; i < last; ++i) {
+      if (comp(*i, *first)) { // 如果后面有比根顶还小的元素，就把根顶弹出 (大顶堆)
+        yastl::pop_heap_aux(first, middle, i, *i, distance_type(first), comp);
+      }
     }
+    yastl::sort_heap(first, middle, comp); // 排序
+    return;
   }
-  yastl::insertion_sort(first, last, comp);
+  yastl::nth_element(first, middle, last, comp);
+  yastl::sort(first, middle, comp);
+}
+
+template <class RandomIter>
+void partial_sort(RandomIter first, RandomIter middle, RandomIter last) {
+  yastl::partial_sort(first, middle, last, yastl::less<typename iterator_traits<RandomIter>::value_type>());
 }
 
 /*****************************************************************************************/
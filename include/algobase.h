@@ -7,6 +7,7 @@
 
 #include "iterator.h"
 #include "util.h"
+#include "simd.h"
 
 namespace yastl {
 
@@ -98,10 +99,66 @@ unchecked_copy(Tp* first, Tp* last, Up* result) {
 }
 
 template <class InputIter, class OutputIter>
-OutputIter copy(InputIter first, InputIter last, OutputIter result) {
+OutputIter copy(InputIter first, InputIter last, OutputIter result);
+
+// 输入是分段迭代器时逐段拷贝，每段是一个指针区间，输出端是否分段由 copy 继续分派
+template <class SegIter, class OutputIter, class OutSegmented>
+OutputIter copy_segmented(SegIter first, SegIter last, OutputIter result, m_true_type, OutSegmented) {
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  const auto slast = traits::segment(last);
+  if (sfirst == slast) {
+    return yastl::copy(traits::local(first), traits::local(last), result);
+  }
+  result = yastl::copy(traits::local(first), traits::end(sfirst), result);
+  for (++sfirst; sfirst != slast; ++sfirst) {
+    result = yastl::copy(traits::begin(sfirst), traits::end(sfirst), result);
+  }
+  return yastl::copy(traits::begin(slast), traits::local(last), result);
+}
+
+// 输出是分段迭代器时，按输出端每段剩余的空间切分输入区间，只对随机访问的输入有效
+template <class InputIter, class SegIter>
+SegIter copy_to_segments(InputIter first, InputIter last, SegIter result, yastl::input_iterator_tag) {
   return unchecked_copy(first, last, result);
 }
 
+template <class RandomIter, class SegIter>
+SegIter copy_to_segments(RandomIter first, RandomIter last, SegIter result, yastl::random_access_iterator_tag) {
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto seg = traits::segment(result);
+  auto local = traits::local(result);
+  for (auto n = last - first; n > 0; ) {
+    const auto room = traits::end(seg) - local;
+    const auto len = n < room ? n : room;
+    local = unchecked_copy(first, first + len, local);
+    first += len;
+    n -= len;
+    if (n > 0) {
+      ++seg;
+      local = traits::begin(seg);
+    }
+  }
+  return traits::compose(seg, local);
+}
+
+template <class InputIter, class SegIter>
+SegIter copy_segmented(InputIter first, InputIter last, SegIter result, m_false_type, m_true_type) {
+  return copy_to_segments(first, last, result, iterator_category(first));
+}
+
+template <class InputIter, class OutputIter>
+OutputIter copy_segmented(InputIter first, InputIter last, OutputIter result, m_false_type, m_false_type) {
+  return unchecked_copy(first, last, result);
+}
+
+template <class InputIter, class OutputIter>
+OutputIter copy(InputIter first, InputIter last, OutputIter result) {
+  return copy_segmented(first, last, result,
+                        m_bool_constant<is_segmented_iterator<InputIter>::value>(),
+                        m_bool_constant<is_segmented_iterator<OutputIter>::value>());
+}
+
 /*****************************************************************************************/
 // copy_backward
 // 将 [first, last)区间内的元素拷贝到 [result - (last - first), result)内
@@ -236,10 +293,65 @@ unchecked_move(Tp* first, Tp* last, Up* result) {
   return result + n;
 }
 
+template <class InputIter, class OutputIter>
+OutputIter move(InputIter first, InputIter last, OutputIter result);
+
+// 分段迭代器的处理与 copy 相同
+template <class SegIter, class OutputIter, class OutSegmented>
+OutputIter move_segmented(SegIter first, SegIter last, OutputIter result, m_true_type, OutSegmented) {
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  const auto slast = traits::segment(last);
+  if (sfirst == slast) {
+    return yastl::move(traits::local(first), traits::local(last), result);
+  }
+  result = yastl::move(traits::local(first), traits::end(sfirst), result);
+  for (++sfirst; sfirst != slast; ++sfirst) {
+    result = yastl::move(traits::begin(sfirst), traits::end(sfirst), result);
+  }
+  return yastl::move(traits::begin(slast), traits::local(last), result);
+}
+
+template <class InputIter, class SegIter>
+SegIter move_to_segments(InputIter first, InputIter last, SegIter result, yastl::input_iterator_tag) {
+  return unchecked_move(first, last, result);
+}
+
+template <class RandomIter, class SegIter>
+SegIter move_to_segments(RandomIter first, RandomIter last, SegIter result, yastl::random_access_iterator_tag) {
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto seg = traits::segment(result);
+  auto local = traits::local(result);
+  for (auto n = last - first; n > 0; ) {
+    const auto room = traits::end(seg) - local;
+    const auto len = n < room ? n : room;
+    local = unchecked_move(first, first + len, local);
+    first += len;
+    n -= len;
+    if (n > 0) {
+      ++seg;
+      local = traits::begin(seg);
+    }
+  }
+  return traits::compose(seg, local);
+}
+
+template <class InputIter, class SegIter>
+SegIter move_segmented(InputIter first, InputIter last, SegIter result, m_false_type, m_true_type) {
+  return move_to_segments(first, last, result, iterator_category(first));
+}
+
+template <class InputIter, class OutputIter>
+OutputIter move_segmented(InputIter first, InputIter last, OutputIter result, m_false_type, m_false_type) {
+  return unchecked_move(first, last, result);
+}
+
 // 把[first, last)移动到result上，first和result迭代器类型可以不同
 template <class InputIter, class OutputIter>
 OutputIter move(InputIter first, InputIter last, OutputIter result) {
-  return unchecked_move(first, last, result);
+  return move_segmented(first, last, result,
+                        m_bool_constant<is_segmented_iterator<InputIter>::value>(),
+                        m_bool_constant<is_segmented_iterator<OutputIter>::value>());
 }
 
 /*****************************************************************************************/
@@ -296,7 +408,7 @@ BidirectionalIter2 move_backward(BidirectionalIter1 first, BidirectionalIter1 la
 // equal
 // 比较第一序列在 [first, last)区间上的元素值是否和第二序列相等
 template <class InputIter1, class InputIter2>
-bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2) {
+bool equal_cat(InputIter1 first1, InputIter1 last1, InputIter2 first2, m_false_type) {
   for (; first1 != last1; ++first1, ++first2) {
     if (*first1 != *first2) {
       return false;
@@ -305,6 +417,71 @@ bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2) {
   return true;
 }
 
+// 连续的算术类型区间使用 SIMD
+template <class T1, class T2>
+bool equal_cat(T1* first1, T1* last1, T2* first2, m_true_type) {
+  return yastl::simd_mismatch<typename std::remove_cv<T1>::type>(first1, last1, first2) ==
+         static_cast<size_t>(last1 - first1);
+}
+
+template <class InputIter1, class InputIter2>
+bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2);
+
+// 第一序列是分段迭代器、第二序列可以随机访问时逐段比较
+template <class SegIter, class RandomIter>
+bool equal_segmented(SegIter first1, SegIter last1, RandomIter first2, m_true_type, m_true_type) {
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first1);
+  const auto slast = traits::segment(last1);
+  if (sfirst == slast) {
+    return yastl::equal(traits::local(first1), traits::local(last1), first2);
+  }
+  auto lfirst = traits::local(first1);
+  for (; sfirst != slast; ++sfirst, lfirst = traits::begin(sfirst)) {
+    const auto llast = traits::end(sfirst);
+    if (!yastl::equal(lfirst, llast, first2)) {
+      return false;
+    }
+    first2 += llast - lfirst;
+  }
+  return yastl::equal(traits::begin(slast), traits::local(last1), first2);
+}
+
+// 第二序列是分段迭代器、第一序列可以随机访问时，按第二序列的段切分第一序列
+template <class RandomIter, class SegIter>
+bool equal_segmented(RandomIter first1, RandomIter last1, SegIter first2, m_true_type, m_false_type) {
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto seg = traits::segment(first2);
+  auto local = traits::local(first2);
+  for (auto n = last1 - first1; n > 0; ) {
+    const auto room = traits::end(seg) - local;
+    const auto len = n < room ? n : room;
+    if (!yastl::equal(first1, first1 + len, local)) {
+      return false;
+    }
+    first1 += len;
+    n -= len;
+    ++seg;
+    local = n > 0 ? traits::begin(seg) : local;
+  }
+  return true;
+}
+
+template <class InputIter1, class InputIter2, class Seg1>
+bool equal_segmented(InputIter1 first1, InputIter1 last1, InputIter2 first2, m_false_type, Seg1) {
+  return yastl::equal_cat(first1, last1, first2, simd_contiguous_pair<InputIter1, InputIter2>());
+}
+
+template <class InputIter1, class InputIter2>
+bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2) {
+  // 第四个参数表示能否逐段比较，第五个参数表示第一序列是否分段
+  typedef m_bool_constant<
+    (is_segmented_iterator<InputIter1>::value && is_random_access_iterator<InputIter2>::value) ||
+    (is_segmented_iterator<InputIter2>::value && is_random_access_iterator<InputIter1>::value)> segmented;
+  return yastl::equal_segmented(first1, last1, first2, segmented(),
+                                m_bool_constant<is_segmented_iterator<InputIter1>::value>());
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class InputIter1, class InputIter2, class Compared>
 bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2, Compared comp) {
@@ -361,13 +538,35 @@ void fill_cat(ForwardIter first, ForwardIter last, const T& value, yastl::forwar
 // random access iter准备的填充[first, last)为value
 template <class RandomIter, class T>
 void fill_cat(RandomIter first, RandomIter last, const T& value, yastl::random_access_iterator_tag) {
-  fill_n(first, last - first, value);
+  yastl::fill_n(first, last - first, value);
+}
+
+// 分段迭代器逐段填充，每段是一个指针区间
+template <class SegIter, class T>
+void fill_segmented(SegIter first, SegIter last, const T& value, m_true_type) {
+  typedef segmented_iterator_traits<SegIter> traits;
+  auto sfirst = traits::segment(first);
+  const auto slast = traits::segment(last);
+  if (sfirst == slast) {
+    fill_cat(traits::local(first), traits::local(last), value, yastl::random_access_iterator_tag());
+    return;
+  }
+  fill_cat(traits::local(first), traits::end(sfirst), value, yastl::random_access_iterator_tag());
+  for (++sfirst; sfirst != slast; ++sfirst) {
+    fill_cat(traits::begin(sfirst), traits::end(sfirst), value, yastl::random_access_iterator_tag());
+  }
+  fill_cat(traits::begin(slast), traits::local(last), value, yastl::random_access_iterator_tag());
+}
+
+template <class ForwardIter, class T>
+void fill_segmented(ForwardIter first, ForwardIter last, const T& value, m_false_type) {
+  fill_cat(first, last, value, iterator_category(first));
 }
 
 // 为 [first, last)区间内的所有元素填充新值
 template <class ForwardIter, class T>
 void fill(ForwardIter first, ForwardIter last, const T& value) {
-  fill_cat(first, last, value, iterator_category(first));
+  fill_segmented(first, last, value, m_bool_constant<is_segmented_iterator<ForwardIter>::value>());
 }
 
 /*****************************************************************************************/
@@ -378,8 +577,8 @@ void fill(ForwardIter first, ForwardIter last, const T& value) {
 // (3)如果到达 last2 而尚未到达 last1 返回 false
 // (4)如果同时到达 last1 和 last2 返回 false
 template <class InputIter1, class InputIter2>
-bool lexicographical_compare(InputIter1 first1, InputIter1 last1,
-                             InputIter2 first2, InputIter2 last2) {
+bool lexicographical_compare_cat(InputIter1 first1, InputIter1 last1,
+                                 InputIter2 first2, InputIter2 last2, m_false_type) {
   for (; first1 != last1 && first2 != last2; ++first1, ++first2) {
     if (*first1 < *first2) {
       return true;
@@ -391,6 +590,25 @@ bool lexicographical_compare(InputIter1 first1, InputIter1 last1,
   return first1 == last1 && first2 != last2;
 }
 
+// 连续的整数区间先用 SIMD 找到第一处不同，浮点数的 NaN 不满足这种做法，仍逐个比较
+template <class T1, class T2>
+bool lexicographical_compare_cat(T1* first1, T1* last1, T2* first2, T2* last2, m_true_type) {
+  const size_t len1 = static_cast<size_t>(last1 - first1);
+  const size_t len2 = static_cast<size_t>(last2 - first2);
+  const size_t n = len1 < len2 ? len1 : len2;
+  const size_t i = yastl::simd_mismatch<typename std::remove_cv<T1>::type>(first1, first1 + n, first2);
+  return i < n ? first1[i] < first2[i] : len1 < len2;
+}
+
+template <class InputIter1, class InputIter2>
+bool lexicographical_compare(InputIter1 first1, InputIter1 last1,
+                             InputIter2 first2, InputIter2 last2) {
+  typedef typename iterator_traits<InputIter1>::value_type value_type;
+  return yastl::lexicographical_compare_cat(
+    first1, last1, first2, last2,
+    m_bool_constant<simd_contiguous_pair<InputIter1, InputIter2>::value && std::is_integral<value_type>::value>());
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class InputIter1, class InputIter2, class Compred>
 bool lexicographical_compare(InputIter1 first1, InputIter1 last1,
@@ -422,7 +640,7 @@ bool lexicographical_compare(const unsigned char* first1, const unsigned char* l
 // 平行比较两个序列，找到第一处失配的元素，返回一对迭代器，分别指向两个序列中失配的元素
 /*****************************************************************************************/
 template <class InputIter1, class InputIter2>
-yastl::pair<InputIter1, InputIter2> mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2) {
+yastl::pair<InputIter1, InputIter2> mismatch_cat(InputIter1 first1, InputIter1 last1, InputIter2 first2, m_false_type) {
   while (first1 != last1 && *first1 == *first2) {
     ++first1;
     ++first2;
@@ -430,6 +648,18 @@ yastl::pair<InputIter1, InputIter2> mismatch(InputIter1 first1, InputIter1 last1
   return yastl::pair<InputIter1, InputIter2>(first1, first2);
 }
 
+// 连续的算术类型区间使用 SIMD
+template <class T1, class T2>
+yastl::pair<T1*, T2*> mismatch_cat(T1* first1, T1* last1, T2* first2, m_true_type) {
+  const size_t i = yastl::simd_mismatch<typename std::remove_cv<T1>::type>(first1, last1, first2);
+  return yastl::pair<T1*, T2*>(first1 + i, first2 + i);
+}
+
+template <class InputIter1, class InputIter2>
+yastl::pair<InputIter1, InputIter2> mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2) {
+  return yastl::mismatch_cat(first1, last1, first2, simd_contiguous_pair<InputIter1, InputIter2>());
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class InputIter1, class InputIter2, class Compred>
 yastl::pair<InputIter1, InputIter2> mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2, Compred comp) {
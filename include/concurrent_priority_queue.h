@@ -0,0 +1,182 @@
+﻿#ifndef _INCLUDE_CONCURRENT_PRIORITY_QUEUE_H_
+#define _INCLUDE_CONCURRENT_PRIORITY_QUEUE_H_
+
+// 这个头文件包含了一个模板类 concurrent_priority_queue
+// concurrent_priority_queue : 多线程的优先队列，由多个各自带锁的二叉堆组成（relaxed multi-queue）
+
+// notes:
+//
+// push 随机选一个子堆放入，pop 随机选两个子堆，取两者堆顶中优先级更高的一个
+// 子堆的锁只用 try_lock，抢不到就换一个子堆，所以线程之间几乎不会互相等待
+// 与 priority_queue 一样，Compare 为 less 时先弹出最大的元素，用 greater 可以先弹出最早的期限
+// 弹出的顺序是近似的：每次弹出的元素在全局的排名期望为 O(子堆个数)，子堆全空时 try_pop 返回 false
+// 子堆个数在构造时确定，缺省为硬件线程数的两倍
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+
+#include "vector.h"
+#include "functional.h"
+#include "heap_algo.h"
+#include "concurrent_queue.h"
+
+namespace yastl {
+
+// 模板类 concurrent_priority_queue
+// 参数一代表数据类型，参数二代表比较权值的方式，缺省使用 yastl::less 作为比较方式
+template <class T, class Compare = yastl::less<T>>
+class concurrent_priority_queue {
+public:
+  typedef Compare value_compare;
+  typedef T value_type;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+
+private:
+  // 子堆，每个占据单独的缓存行
+  struct sub_queue {
+    std::mutex lock;
+    yastl::vector<T> heap;
+    char pad[YASTL_CACHE_LINE_SIZE];
+  };
+
+  sub_queue* queues_;            // 子堆数组
+  size_type count_;              // 子堆个数
+  value_compare comp_;           // 权值比较的标准
+  std::atomic<size_type> size_;  // 元素总个数
+
+public:
+  // 构造、析构函数
+
+  explicit concurrent_priority_queue(size_type queues = 0, const Compare& comp = Compare())
+    : queues_(nullptr), count_(queues), comp_(comp), size_(0) {
+    if (count_ == 0) {
+      count_ = 2 * static_cast<size_type>(std::thread::hardware_concurrency());
+    }
+    if (count_ < 2) {
+      count_ = 2;
+    }
+    queues_ = new sub_queue[count_];
+  }
+
+  concurrent_priority_queue(const concurrent_priority_queue&) = delete;
+  concurrent_priority_queue& operator=(const concurrent_priority_queue&) = delete;
+
+  ~concurrent_priority_queue() {
+    delete[] queues_;
+  }
+
+  // 容量相关操作，其他线程同时操作时只是一个近似值
+  bool empty() const noexcept {
+    return size_.load(std::memory_order_relaxed) == 0;
+  }
+  size_type size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }
+  size_type queue_count() const noexcept {
+    return count_;
+  }
+
+  // 修改容器相关操作
+  template <class... Args>
+  void emplace(Args&& ...args) {
+    sub_queue& q = lock_any();
+    try {
+      q.heap.emplace_back(yastl::forward<Args>(args)...);
+    } catch (...) {
+      q.lock.unlock();
+      throw;
+    }
+    yastl::push_heap(q.heap.begin(), q.heap.end(), comp_);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    q.lock.unlock();
+  }
+
+  void push(const value_type& value) {
+    emplace(value);
+  }
+  void push(value_type&& value) {
+    emplace(yastl::move(value));
+  }
+
+  // 弹出一个优先级较高的元素到 out，队列为空时返回 false
+  bool try_pop(value_type& out);
+
+  void clear() {
+    for (size_type i = 0; i < count_; ++i) {
+      std::lock_guard<std::mutex> guard(queues_[i].lock);
+      size_.fetch_sub(queues_[i].heap.size(), std::memory_order_relaxed);
+      queues_[i].heap.clear();
+    }
+  }
+
+private:
+  // helper functions
+
+  sub_queue& lock_any() {
+    for (;;) {
+      sub_queue& q = queues_[concurrent_random() % count_];
+      if (q.lock.try_lock()) {
+        return q;
+      }
+    }
+  }
+
+  // 调用者持有 q 的锁
+  void pop_locked(sub_queue& q, value_type& out) {
+    yastl::pop_heap(q.heap.begin(), q.heap.end(), comp_);
+    out = yastl::move(q.heap.back());
+    q.heap.pop_back();
+    size_.fetch_sub(1, std::memory_order_relaxed);
+  }
+};
+
+/*****************************************************************************************/
+
+template <class T, class Compare>
+bool concurrent_priority_queue<T, Compare>::try_pop(value_type& out) {
+  // 先随机挑两个子堆比较堆顶
+  for (size_type attempt = 0; attempt < count_; ++attempt) {
+    if (size_.load(std::memory_order_relaxed) == 0) {
+      break;
+    }
+    const uint64_t r = concurrent_random();
+    sub_queue* a = &queues_[r % count_];
+    sub_queue* b = &queues_[(r >> 32) % count_];
+    if (a == b || !a->lock.try_lock()) {
+      continue;
+    }
+    if (!b->lock.try_lock()) {
+      a->lock.unlock();
+      continue;
+    }
+    if (a->heap.empty() || (!b->heap.empty() && comp_(a->heap.front(), b->heap.front()))) {
+      yastl::swap(a, b);
+    }
+    const bool found = !a->heap.empty();
+    if (found) {
+      pop_locked(*a, out);
+    }
+    a->lock.unlock();
+    b->lock.unlock();
+    if (found) {
+      return true;
+    }
+  }
+  // 随机挑选一直落空，依次检查每个子堆
+  for (size_type i = 0; i < count_; ++i) {
+    sub_queue& q = queues_[i];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (!q.heap.empty()) {
+      pop_locked(q, out);
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace yastl
+#endif // _INCLUDE_CONCURRENT_PRIORITY_QUEUE_H_
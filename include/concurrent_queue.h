@@ -0,0 +1,628 @@
+﻿#ifndef _INCLUDE_CONCURRENT_QUEUE_H_
+#define _INCLUDE_CONCURRENT_QUEUE_H_
+
+// 这个头文件包含了三个模板类 spsc_queue、mpmc_queue 和 blocking_queue，以及一个等待工具 atomic_waiter
+// spsc_queue     : 单生产者单消费者的有界环形队列，无等待
+// mpmc_queue     : 多生产者多消费者的有界环形队列，无锁，每个槽位带序号（Vyukov 算法）
+// blocking_queue : 给上面两种队列加上阻塞的 push / pop
+// atomic_waiter  : 基于 32 位计数的等待 / 唤醒，Linux 下直接使用 futex，其他平台退化为 mutex + condition_variable
+
+// notes:
+//
+// 两种队列的容量在构造时确定，会向上取整为 2 的幂次，之后不再改变
+// 生产者和消费者各自修改的下标放在不同的缓存行里，避免伪共享
+// try_push / try_emplace 在队列已满时返回 false，try_pop 在队列为空时返回 false，try_push 传入的右值在失败时不会被移动
+// push_n / pop_n 批量入队、出队，返回实际处理的个数，mpmc_queue 一个批次只需要一次 CAS
+//
+// 异常保证：
+// 元素的构造函数抛出异常时队列不变；元素的移动赋值抛出异常时只保证基本异常安全
+// mpmc_queue 占住位置之后无法退回，所以要求 T 的移动构造不抛出异常，push_n 还要求拷贝构造不抛出异常
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#define YASTL_HAS_FUTEX 1
+#endif
+
+#include "iterator.h"
+#include "memory.h"
+#include "util.h"
+#include "exceptdef.h"
+
+namespace yastl {
+
+// 缓存行大小，用来隔开会被不同线程频繁修改的数据
+#ifndef YASTL_CACHE_LINE_SIZE
+#define YASTL_CACHE_LINE_SIZE 64
+#endif
+
+// 把 n 向上取整为 2 的幂次，至少为 2
+inline size_t concurrent_queue_round_up(size_t n) {
+  size_t cap = 2;
+  while (cap < n) {
+    cap <<= 1;
+  }
+  return cap;
+}
+
+// 每个线程各自的 xorshift 随机数，用来挑选子队列、窃取对象等
+inline uint64_t concurrent_random() noexcept {
+  static thread_local uint64_t state = 0;
+  if (state == 0) {
+    state = reinterpret_cast<uintptr_t>(&state) * 0x9e3779b97f4a7c15ull | 1;
+  }
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+/*****************************************************************************************/
+// atomic_waiter
+// 等待方先用 prepare_wait 取得当前的计数，再检查一次条件，条件不满足时调用 wait，
+// 通知方在改变条件之后调用 notify_one / notify_all，计数增加后等待方不会错过这次通知
+/*****************************************************************************************/
+class atomic_waiter {
+private:
+  std::atomic<uint32_t> epoch_;
+  std::atomic<uint32_t> waiters_;
+#ifndef YASTL_HAS_FUTEX
+  std::mutex mutex_;
+  std::condition_variable cond_;
+#endif
+
+public:
+  atomic_waiter() noexcept : epoch_(0), waiters_(0) {}
+
+  atomic_waiter(const atomic_waiter&) = delete;
+  atomic_waiter& operator=(const atomic_waiter&) = delete;
+
+  // 登记为等待者并返回当前计数，之后必须调用 wait 或 cancel_wait
+  uint32_t prepare_wait() noexcept {
+    waiters_.fetch_add(1);
+    return epoch_.load();
+  }
+
+  void cancel_wait() noexcept {
+    waiters_.fetch_sub(1);
+  }
+
+  // 计数仍为 epoch 时阻塞，被唤醒或计数已改变时返回
+  void wait(uint32_t epoch) noexcept {
+#ifdef YASTL_HAS_FUTEX
+    while (epoch_.load(std::memory_order_acquire) == epoch) {
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch, nullptr, nullptr, 0);
+    }
+#else
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (epoch_.load(std::memory_order_acquire) == epoch) {
+      cond_.wait(lock);
+    }
+#endif
+    waiters_.fetch_sub(1);
+  }
+
+  void notify_one() noexcept {
+    notify(1);
+  }
+
+  void notify_all() noexcept {
+    notify(INT_MAX);
+  }
+
+private:
+  void notify(int count) noexcept {
+    epoch_.fetch_add(1);
+    if (waiters_.load() == 0) {
+      return;
+    }
+#ifdef YASTL_HAS_FUTEX
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    if (count == 1) {
+      cond_.notify_one();
+    } else {
+      cond_.notify_all();
+    }
+#endif
+  }
+};
+
+/*****************************************************************************************/
+// spsc_queue
+// 生产者只写 tail_，消费者只写 head_，各自缓存对方的下标，只有缓存的值显示满 / 空时才重新读取
+/*****************************************************************************************/
+template <class T>
+class spsc_queue {
+public:
+  typedef yastl::allocator<T> allocator_type;
+  typedef yastl::allocator<T> data_allocator;
+
+  typedef typename allocator_type::value_type value_type;
+  typedef typename allocator_type::pointer pointer;
+  typedef typename allocator_type::const_pointer const_pointer;
+  typedef typename allocator_type::reference reference;
+  typedef typename allocator_type::const_reference const_reference;
+  typedef typename allocator_type::size_type size_type;
+  typedef typename allocator_type::difference_type difference_type;
+
+private:
+  // 只读数据
+  pointer buf_;
+  size_type mask_;
+  char pad0_[YASTL_CACHE_LINE_SIZE];
+
+  // 生产者使用的数据
+  std::atomic<size_type> tail_;
+  size_type head_cache_;
+  char pad1_[YASTL_CACHE_LINE_SIZE];
+
+  // 消费者使用的数据
+  std::atomic<size_type> head_;
+  size_type tail_cache_;
+  char pad2_[YASTL_CACHE_LINE_SIZE];
+
+public:
+  explicit spsc_queue(size_type capacity)
+    : buf_(nullptr), mask_(concurrent_queue_round_up(capacity) - 1), tail_(0), head_cache_(0), head_(0), tail_cache_(0) {
+    buf_ = data_allocator::allocate(mask_ + 1);
+  }
+
+  spsc_queue(const spsc_queue&) = delete;
+  spsc_queue& operator=(const spsc_queue&) = delete;
+
+  ~spsc_queue() {
+    const size_type t = tail_.load(std::memory_order_acquire);
+    for (size_type h = head_.load(std::memory_order_relaxed); h != t; ++h) {
+      data_allocator::destroy(buf_ + (h & mask_));
+    }
+    data_allocator::deallocate(buf_, mask_ + 1);
+  }
+
+  size_type capacity() const noexcept {
+    return mask_ + 1;
+  }
+  // 其他线程同时操作时只是一个近似值
+  size_type size() const noexcept {
+    const size_type h = head_.load(std::memory_order_acquire);
+    const size_type t = tail_.load(std::memory_order_acquire);
+    return t - h;
+  }
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  // 生产者调用
+  template <class ...Args>
+  bool try_emplace(Args&& ...args);
+  bool try_push(const value_type& value) {
+    return try_emplace(value);
+  }
+  bool try_push(value_type&& value) {
+    return try_emplace(yastl::move(value));
+  }
+  size_type push_n(const_pointer first, size_type n);
+
+  // 消费者调用
+  bool try_pop(value_type& out);
+  size_type pop_n(pointer out, size_type n);
+};
+
+template <class T>
+template <class ...Args>
+bool spsc_queue<T>::try_emplace(Args&& ...args) {
+  const size_type t = tail_.load(std::memory_order_relaxed);
+  if (t - head_cache_ > mask_) {
+    head_cache_ = head_.load(std::memory_order_acquire);
+    if (t - head_cache_ > mask_) {
+      return false;
+    }
+  }
+  data_allocator::construct(buf_ + (t & mask_), yastl::forward<Args>(args)...);
+  tail_.store(t + 1, std::memory_order_release);
+  return true;
+}
+
+template <class T>
+typename spsc_queue<T>::size_type spsc_queue<T>::push_n(const_pointer first, size_type n) {
+  const size_type t = tail_.load(std::memory_order_relaxed);
+  if (mask_ + 1 - (t - head_cache_) < n) {
+    head_cache_ = head_.load(std::memory_order_acquire);
+  }
+  n = yastl::min(n, mask_ + 1 - (t - head_cache_));
+  if (n == 0) {
+    return 0;
+  }
+  // 最多分两段拷贝
+  const size_type pos = t & mask_;
+  const size_type len1 = yastl::min(n, mask_ + 1 - pos);
+  yastl::uninitialized_copy(first, first + len1, buf_ + pos);
+  try {
+    yastl::uninitialized_copy(first + len1, first + n, buf_);
+  } catch (...) {
+    data_allocator::destroy(buf_ + pos, buf_ + pos + len1);
+    throw;
+  }
+  tail_.store(t + n, std::memory_order_release);
+  return n;
+}
+
+template <class T>
+bool spsc_queue<T>::try_pop(value_type& out) {
+  const size_type h = head_.load(std::memory_order_relaxed);
+  if (h == tail_cache_) {
+    tail_cache_ = tail_.load(std::memory_order_acquire);
+    if (h == tail_cache_) {
+      return false;
+    }
+  }
+  pointer p = buf_ + (h & mask_);
+  out = yastl::move(*p);
+  data_allocator::destroy(p);
+  head_.store(h + 1, std::memory_order_release);
+  return true;
+}
+
+template <class T>
+typename spsc_queue<T>::size_type spsc_queue<T>::pop_n(pointer out, size_type n) {
+  const size_type h = head_.load(std::memory_order_relaxed);
+  if (tail_cache_ - h < n) {
+    tail_cache_ = tail_.load(std::memory_order_acquire);
+  }
+  n = yastl::min(n, tail_cache_ - h);
+  if (n == 0) {
+    return 0;
+  }
+  const size_type pos = h & mask_;
+  const size_type len1 = yastl::min(n, mask_ + 1 - pos);
+  out = yastl::move(buf_ + pos, buf_ + pos + len1, out);
+  yastl::move(buf_, buf_ + (n - len1), out);
+  data_allocator::destroy(buf_ + pos, buf_ + pos + len1);
+  data_allocator::destroy(buf_, buf_ + (n - len1));
+  head_.store(h + n, std::memory_order_release);
+  return n;
+}
+
+/*****************************************************************************************/
+// mpmc_queue
+// 每个槽位带一个序号：序号等于入队位置时槽位可写，等于入队位置 + 1 时槽位可读，
+// 出队后序号加上容量，留给下一轮的生产者
+/*****************************************************************************************/
+template <class T>
+class mpmc_queue {
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+private:
+  struct cell {
+    std::atomic<size_type> seq;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+    pointer value() noexcept {
+      return reinterpret_cast<pointer>(&storage);
+    }
+  };
+  typedef yastl::allocator<cell> cell_allocator;
+
+  // 只读数据
+  cell* buf_;
+  size_type mask_;
+  char pad0_[YASTL_CACHE_LINE_SIZE];
+
+  std::atomic<size_type> enqueue_pos_;
+  char pad1_[YASTL_CACHE_LINE_SIZE];
+
+  std::atomic<size_type> dequeue_pos_;
+  char pad2_[YASTL_CACHE_LINE_SIZE];
+
+public:
+  explicit mpmc_queue(size_type capacity)
+    : buf_(nullptr), mask_(concurrent_queue_round_up(capacity) - 1), enqueue_pos_(0), dequeue_pos_(0) {
+    buf_ = cell_allocator::allocate(mask_ + 1);
+    for (size_type i = 0; i <= mask_; ++i) {
+      ::new (static_cast<void*>(&buf_[i].seq)) std::atomic<size_type>(i);
+    }
+  }
+
+  mpmc_queue(const mpmc_queue&) = delete;
+  mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+  ~mpmc_queue() {
+    const size_type t = enqueue_pos_.load(std::memory_order_acquire);
+    for (size_type h = dequeue_pos_.load(std::memory_order_relaxed); h != t; ++h) {
+      yastl::destroy(buf_[h & mask_].value());
+    }
+    cell_allocator::deallocate(buf_, mask_ + 1);
+  }
+
+  size_type capacity() const noexcept {
+    return mask_ + 1;
+  }
+  // 其他线程同时操作时只是一个近似值
+  size_type size() const noexcept {
+    const size_type h = dequeue_pos_.load(std::memory_order_acquire);
+    const size_type t = enqueue_pos_.load(std::memory_order_acquire);
+    return t > h ? t - h : 0;
+  }
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  // 占住位置之后不能再抛出异常，所以先在槽位之外构造好元素，再移动进去
+  template <class ...Args>
+  bool try_emplace(Args&& ...args) {
+    value_type tmp(yastl::forward<Args>(args)...);
+    return try_push(yastl::move(tmp));
+  }
+  bool try_push(const value_type& value) {
+    value_type tmp(value);
+    return try_push(yastl::move(tmp));
+  }
+  bool try_push(value_type&& value);
+  bool try_pop(value_type& out);
+
+  size_type push_n(const_pointer first, size_type n);
+  size_type pop_n(pointer out, size_type n);
+
+private:
+  // 从 pos 开始最多 n 个连续槽位中，序号等于 pos + i + offset 的个数
+  size_type ready_count(size_type pos, size_type n, size_type offset) const noexcept {
+    size_type k = 0;
+    while (k < n && buf_[(pos + k) & mask_].seq.load(std::memory_order_acquire) == pos + k + offset) {
+      ++k;
+    }
+    return k;
+  }
+  // 槽位 pos 的序号落后于 pos + offset，说明队列已满 / 已空
+  bool lagging(size_type pos, size_type offset) const noexcept {
+    const size_type seq = buf_[pos & mask_].seq.load(std::memory_order_acquire);
+    return static_cast<difference_type>(seq - (pos + offset)) < 0;
+  }
+};
+
+template <class T>
+bool mpmc_queue<T>::try_push(value_type&& value) {
+  static_assert(std::is_nothrow_move_constructible<T>::value,
+                "mpmc_queue<T> requires T to be nothrow move constructible");
+  size_type pos = enqueue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    cell& c = buf_[pos & mask_];
+    const size_type seq = c.seq.load(std::memory_order_acquire);
+    const difference_type diff = static_cast<difference_type>(seq - pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell& c = buf_[pos & mask_];
+  yastl::construct(c.value(), yastl::move(value));
+  c.seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <class T>
+bool mpmc_queue<T>::try_pop(value_type& out) {
+  size_type pos = dequeue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    cell& c = buf_[pos & mask_];
+    const size_type seq = c.seq.load(std::memory_order_acquire);
+    const difference_type diff = static_cast<difference_type>(seq - (pos + 1));
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell& c = buf_[pos & mask_];
+  out = yastl::move(*c.value());
+  yastl::destroy(c.value());
+  c.seq.store(pos + mask_ + 1, std::memory_order_release);
+  return true;
+}
+
+// 批量入队：先确认连续 k 个槽位都可写，再用一次 CAS 占住这些位置
+template <class T>
+typename mpmc_queue<T>::size_type mpmc_queue<T>::push_n(const_pointer first, size_type n) {
+  static_assert(std::is_nothrow_copy_constructible<T>::value,
+                "mpmc_queue<T>::push_n requires T to be nothrow copy constructible");
+  if (n == 0) {
+    return 0;
+  }
+  n = yastl::min(n, mask_ + 1);
+  size_type pos = enqueue_pos_.load(std::memory_order_relaxed);
+  size_type k = 0;
+  for (;;) {
+    k = ready_count(pos, n, 0);
+    if (k == 0) {
+      if (lagging(pos, 0)) {
+        return 0;
+      }
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    } else if (enqueue_pos_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  for (size_type i = 0; i < k; ++i) {
+    cell& c = buf_[(pos + i) & mask_];
+    yastl::construct(c.value(), first[i]);
+    c.seq.store(pos + i + 1, std::memory_order_release);
+  }
+  return k;
+}
+
+// 批量出队：先确认连续 k 个槽位都可读，再用一次 CAS 取走这些位置
+template <class T>
+typename mpmc_queue<T>::size_type mpmc_queue<T>::pop_n(pointer out, size_type n) {
+  if (n == 0) {
+    return 0;
+  }
+  n = yastl::min(n, mask_ + 1);
+  size_type pos = dequeue_pos_.load(std::memory_order_relaxed);
+  size_type k = 0;
+  for (;;) {
+    k = ready_count(pos, n, 1);
+    if (k == 0) {
+      if (lagging(pos, 1)) {
+        return 0;
+      }
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    } else if (dequeue_pos_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  for (size_type i = 0; i < k; ++i) {
+    cell& c = buf_[(pos + i) & mask_];
+    out[i] = yastl::move(*c.value());
+    yastl::destroy(c.value());
+    c.seq.store(pos + i + mask_ + 1, std::memory_order_release);
+  }
+  return k;
+}
+
+/*****************************************************************************************/
+// blocking_queue
+// 包装 spsc_queue 或 mpmc_queue，队列满 / 空时在 atomic_waiter 上等待而不是自旋
+/*****************************************************************************************/
+template <class Queue>
+class blocking_queue {
+public:
+  typedef Queue queue_type;
+  typedef typename Queue::value_type value_type;
+  typedef typename Queue::size_type size_type;
+
+private:
+  queue_type q_;
+  atomic_waiter not_empty_;
+  atomic_waiter not_full_;
+
+public:
+  explicit blocking_queue(size_type capacity) : q_(capacity) {}
+
+  blocking_queue(const blocking_queue&) = delete;
+  blocking_queue& operator=(const blocking_queue&) = delete;
+
+  size_type capacity() const noexcept {
+    return q_.capacity();
+  }
+  size_type size() const noexcept {
+    return q_.size();
+  }
+  bool empty() const noexcept {
+    return q_.empty();
+  }
+
+  // 非阻塞的版本，成功时同样会唤醒对方
+  bool try_push(const value_type& value) {
+    return after_push(q_.try_push(value));
+  }
+  bool try_push(value_type&& value) {
+    return after_push(q_.try_push(yastl::move(value)));
+  }
+  bool try_pop(value_type& out) {
+    return after_pop(q_.try_pop(out));
+  }
+
+  // 阻塞的版本
+  void push(const value_type& value) {
+    while (!try_push(value)) {
+      const uint32_t epoch = not_full_.prepare_wait();
+      if (try_push(value)) {
+        not_full_.cancel_wait();
+        return;
+      }
+      not_full_.wait(epoch);
+    }
+  }
+  void push(value_type&& value) {
+    while (!try_push(yastl::move(value))) {
+      const uint32_t epoch = not_full_.prepare_wait();
+      if (try_push(yastl::move(value))) {
+        not_full_.cancel_wait();
+        return;
+      }
+      not_full_.wait(epoch);
+    }
+  }
+  void pop(value_type& out) {
+    while (!try_pop(out)) {
+      const uint32_t epoch = not_empty_.prepare_wait();
+      if (try_pop(out)) {
+        not_empty_.cancel_wait();
+        return;
+      }
+      not_empty_.wait(epoch);
+    }
+  }
+
+  // 批量版本，至少处理一个元素才返回
+  size_type push_n(const value_type* first, size_type n) {
+    size_type k = 0;
+    while (n != 0 && (k = q_.push_n(first, n)) == 0) {
+      const uint32_t epoch = not_full_.prepare_wait();
+      if ((k = q_.push_n(first, n)) != 0) {
+        not_full_.cancel_wait();
+        break;
+      }
+      not_full_.wait(epoch);
+    }
+    if (k != 0) {
+      not_empty_.notify_all();
+    }
+    return k;
+  }
+  size_type pop_n(value_type* out, size_type n) {
+    size_type k = 0;
+    while (n != 0 && (k = q_.pop_n(out, n)) == 0) {
+      const uint32_t epoch = not_empty_.prepare_wait();
+      if ((k = q_.pop_n(out, n)) != 0) {
+        not_empty_.cancel_wait();
+        break;
+      }
+      not_empty_.wait(epoch);
+    }
+    if (k != 0) {
+      not_full_.notify_all();
+    }
+    return k;
+  }
+
+private:
+  bool after_push(bool ok) noexcept {
+    if (ok) {
+      not_empty_.notify_one();
+    }
+    return ok;
+  }
+  bool after_pop(bool ok) noexcept {
+    if (ok) {
+      not_full_.notify_one();
+    }
+    return ok;
+  }
+};
+
+} // namespace yastl
+#endif // _INCLUDE_CONCURRENT_QUEUE_H_
@@ -0,0 +1,653 @@
+﻿#ifndef _INCLUDE_CONCURRENT_SKIPLIST_H_
+#define _INCLUDE_CONCURRENT_SKIPLIST_H_
+
+// 这个头文件包含了一个模板类 concurrent_skiplist 与它的节点内存池 skiplist_arena，以及两个别名 concurrent_map、concurrent_set
+// concurrent_skiplist : 多线程的有序跳表，插入、删除、查找都是无锁的
+// concurrent_map      : 映射，键值不允许重复
+// concurrent_set      : 集合，键值不允许重复
+
+// notes:
+//
+// 每一层的 next 指针最低位是删除标记（Fraser / Herlihy-Shavit 无锁跳表）：删除先从高到低标记节点每一层的 next，
+// 标记第 0 层的那一刻节点被删除，之后查找路过时把它从各层摘掉；插入在第 0 层 CAS 成功的那一刻完成，再逐层向上链接
+// 节点从 skiplist_arena 中分配，删除的节点只是从链表中摘掉，内存和元素都保留到 clear 或者析构，
+// 所以并发的查找和迭代器永远不会访问到已经释放的节点，不需要引用计数或者延迟回收
+// 迭代器是弱一致的：不会失效，按键值顺序访问，能看到遍历开始前插入且没有被删除的元素，遍历过程中的插入和删除可能看到也可能看不到
+// size 是一个近似值；clear、swap、析构不能与其他操作并发
+// emplace 要先构造元素才能得到键值，键值已存在时这个节点的内存要到 clear 才能重新使用，已知键值时用 try_emplace / insert
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <new>
+#include <cstdint>
+#include <type_traits>
+
+#include "functional.h"
+#include "iterator.h"
+#include "util.h"
+#include "concurrent_queue.h"
+
+namespace yastl {
+
+// 跳表的最大层数，每一层的节点数约为下一层的 1/4
+constexpr static size_t kSkiplistMaxHeight = 16;
+// 内存池每次向系统申请的块大小
+constexpr static size_t kSkiplistBlockSize = 64 * 1024;
+
+/*****************************************************************************************/
+// skiplist_arena
+// 节点内存池，由多个各自带锁的分片组成，分配时随机挑一个抢得到锁的分片，在它当前的块里顺序切出内存
+// 内存只在 release 或者析构时一起释放，for_each_block 按分配顺序访问每个块中已经分配的内存
+/*****************************************************************************************/
+class skiplist_arena {
+private:
+  struct block {
+    block* next;     // 同一个分片中上一个申请的块
+    size_t used;     // 已经分配的字节数
+    size_t capacity; // data 的字节数
+    alignas(std::max_align_t) char data[1];
+  };
+
+  // 分片，每个占据单独的缓存行
+  struct shard {
+    std::mutex lock;
+    block* blocks;
+    char pad[YASTL_CACHE_LINE_SIZE];
+  };
+
+  shard* shards_;
+  size_t count_;
+
+public:
+  explicit skiplist_arena(size_t shards = 0) : shards_(nullptr), count_(shards) {
+    if (count_ == 0) {
+      count_ = static_cast<size_t>(std::thread::hardware_concurrency());
+    }
+    if (count_ == 0) {
+      count_ = 1;
+    }
+    shards_ = new shard[count_];
+    for (size_t i = 0; i < count_; ++i) {
+      shards_[i].blocks = nullptr;
+    }
+  }
+
+  skiplist_arena(const skiplist_arena&) = delete;
+  skiplist_arena& operator=(const skiplist_arena&) = delete;
+
+  ~skiplist_arena() {
+    release();
+    delete[] shards_;
+  }
+
+  // 分配 n 个字节，n 必须是 align 的倍数，align 不能超过 std::max_align_t 的对齐
+  void* allocate(size_t n, size_t align) {
+    shard& s = lock_any();
+    block* b = s.blocks;
+    size_t offset = b == nullptr ? 0 : (b->used + align - 1) / align * align;
+    if (b == nullptr || offset + n > b->capacity) {
+      const size_t capacity = n > kSkiplistBlockSize ? n : kSkiplistBlockSize;
+      void* mem = ::operator new(sizeof(block) + capacity, std::nothrow);
+      if (mem == nullptr) {
+        s.lock.unlock();
+        throw std::bad_alloc();
+      }
+      b = static_cast<block*>(mem);
+      b->next = s.blocks;
+      b->used = 0;
+      b->capacity = capacity;
+      s.blocks = b;
+      offset = 0;
+    }
+    b->used = offset + n;
+    void* result = b->data + offset;
+    s.lock.unlock();
+    return result;
+  }
+
+  // 对每个块调用 f(first, last)，[first, last) 为块中已经分配的内存，不能与 allocate 并发
+  template <class Function>
+  void for_each_block(Function f) const {
+    for (size_t i = 0; i < count_; ++i) {
+      for (block* b = shards_[i].blocks; b != nullptr; b = b->next) {
+        f(b->data, b->data + b->used);
+      }
+    }
+  }
+
+  // 释放所有的块，不能与 allocate 并发
+  void release() noexcept {
+    for (size_t i = 0; i < count_; ++i) {
+      block* b = shards_[i].blocks;
+      while (b != nullptr) {
+        block* next = b->next;
+        ::operator delete(b);
+        b = next;
+      }
+      shards_[i].blocks = nullptr;
+    }
+  }
+
+  void swap(skiplist_arena& rhs) noexcept {
+    yastl::swap(shards_, rhs.shards_);
+    yastl::swap(count_, rhs.count_);
+  }
+
+private:
+  shard& lock_any() {
+    for (;;) {
+      shard& s = shards_[concurrent_random() % count_];
+      if (s.lock.try_lock()) {
+        return s;
+      }
+    }
+  }
+};
+
+/*****************************************************************************************/
+// concurrent_skiplist 的节点与迭代器
+/*****************************************************************************************/
+
+// 节点，next 数组的实际长度为 height，节点按 height 切出不同的大小
+template <class Value>
+struct skiplist_node {
+  typename std::aligned_storage<sizeof(Value), alignof(Value)>::type storage; // 元素
+  uint32_t height;    // 层数
+  bool constructed;   // 元素是否已经构造，构造失败和插入失败的节点为 false
+  std::atomic<uintptr_t> next[1];  // 各层的后继，最低位为删除标记
+
+  Value& value() noexcept {
+    return *reinterpret_cast<Value*>(&storage);
+  }
+
+  std::atomic<uintptr_t>* link(size_t level) noexcept {
+    return next + level;
+  }
+
+  // 第 0 层被标记时节点已被删除
+  bool deleted() const noexcept {
+    return (next[0].load(std::memory_order_acquire) & 1) != 0;
+  }
+
+  static skiplist_node* ptr(uintptr_t link) noexcept {
+    return reinterpret_cast<skiplist_node*>(link & ~static_cast<uintptr_t>(1));
+  }
+
+  // 在第 0 层向后找到第一个没有被删除的节点
+  static skiplist_node* next_alive(skiplist_node* x) noexcept {
+    while (x != nullptr && x->deleted()) {
+      x = ptr(x->next[0].load(std::memory_order_acquire));
+    }
+    return x;
+  }
+
+  // 层数为 h 的节点的大小
+  static size_t size(size_t h) noexcept {
+    const size_t n = sizeof(skiplist_node) + (h - 1) * sizeof(std::atomic<uintptr_t>);
+    return (n + alignof(skiplist_node) - 1) / alignof(skiplist_node) * alignof(skiplist_node);
+  }
+};
+
+// 弱一致的前向迭代器，只在第 0 层上移动，跳过已被删除的节点
+template <class Value, class Ref, class Ptr>
+struct skiplist_iterator : public yastl::iterator<yastl::forward_iterator_tag, Value> {
+  typedef skiplist_node<Value> node_type;
+  typedef Ref reference;
+  typedef Ptr pointer;
+  typedef skiplist_iterator<Value, Value&, Value*> iterator;
+  typedef skiplist_iterator self;
+
+  node_type* node;
+
+  skiplist_iterator() : node(nullptr) {}
+  explicit skiplist_iterator(node_type* x) : node(x) {}
+  skiplist_iterator(const iterator& rhs) : node(rhs.node) {}
+  skiplist_iterator& operator=(const skiplist_iterator&) = default;
+
+  reference operator*() const {
+    return node->value();
+  }
+  pointer operator->() const {
+    return &(operator*());
+  }
+
+  self& operator++() {
+    node = node_type::next_alive(node_type::ptr(node->next[0].load(std::memory_order_acquire)));
+    return *this;
+  }
+  self operator++(int) {
+    self tmp(*this);
+    ++*this;
+    return tmp;
+  }
+
+  bool operator==(const self& rhs) const {
+    return node == rhs.node;
+  }
+  bool operator!=(const self& rhs) const {
+    return node != rhs.node;
+  }
+};
+
+/*****************************************************************************************/
+// concurrent_skiplist
+// 参数一代表键值类型，参数二代表元素类型，参数三代表从元素取出键值的方式，参数四代表键值的比较方式
+/*****************************************************************************************/
+template <class Key, class Value, class KeyOfValue, class Compare = yastl::less<Key>>
+class concurrent_skiplist {
+public:
+  // concurrent_skiplist 的嵌套型别定义
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef Compare key_compare;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  // 元素就是键值时（集合）不允许通过迭代器修改元素
+  typedef typename std::conditional<std::is_same<Key, Value>::value, const Value&, Value&>::type reference;
+  typedef typename std::conditional<std::is_same<Key, Value>::value, const Value*, Value*>::type pointer;
+  typedef const Value& const_reference;
+  typedef const Value* const_pointer;
+
+  typedef skiplist_iterator<Value, reference, pointer> iterator;
+  typedef skiplist_iterator<Value, const Value&, const Value*> const_iterator;
+
+private:
+  typedef skiplist_node<Value> node_type;
+
+  node_type* head_;                // 头节点，有最大的层数，不保存元素
+  skiplist_arena arena_;           // 节点内存池
+  std::atomic<size_type> size_;    // 元素个数
+  key_compare comp_;               // 键值比较的准则
+
+public:
+  // 构造、析构函数
+
+  explicit concurrent_skiplist(const Compare& comp = Compare())
+    : head_(nullptr), size_(0), comp_(comp) {
+    head_ = static_cast<node_type*>(::operator new(node_type::size(kSkiplistMaxHeight)));
+    head_->height = static_cast<uint32_t>(kSkiplistMaxHeight);
+    head_->constructed = false;
+    for (size_t level = 0; level < kSkiplistMaxHeight; ++level) {
+      new (head_->link(level)) std::atomic<uintptr_t>(0);
+    }
+  }
+
+  concurrent_skiplist(const concurrent_skiplist&) = delete;
+  concurrent_skiplist& operator=(const concurrent_skiplist&) = delete;
+
+  ~concurrent_skiplist() {
+    destroy_all();
+    ::operator delete(head_);
+  }
+
+  // 迭代器相关操作
+  iterator begin() noexcept {
+    return iterator(first_alive());
+  }
+  const_iterator begin() const noexcept {
+    return const_iterator(first_alive());
+  }
+  iterator end() noexcept {
+    return iterator();
+  }
+  const_iterator end() const noexcept {
+    return const_iterator();
+  }
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+  const_iterator cend() const noexcept {
+    return end();
+  }
+
+  // 容量相关操作
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+  size_type size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  // 修改容器相关操作
+
+  // 先构造元素再插入，键值已存在时销毁构造的元素
+  template <class ...Args>
+  pair<iterator, bool> emplace(Args&& ...args) {
+    node_type* x = create_node(yastl::forward<Args>(args)...);
+    return insert_node(x);
+  }
+
+  pair<iterator, bool> insert(const value_type& value) {
+    return try_emplace_key(KeyOfValue()(value), value);
+  }
+  pair<iterator, bool> insert(value_type&& value) {
+    return try_emplace_key(KeyOfValue()(value), yastl::move(value));
+  }
+
+  // key 不存在时才构造节点，节点的值由 key 和 mapped_type(args...) 构造，只用于映射
+  template <class K, class ...Args>
+  pair<iterator, bool> try_emplace(K&& key, Args&& ...args) {
+    typedef typename value_type::second_type mapped_type;
+    node_type* x = lower_bound_node(key, false);
+    if (x != nullptr && !comp_(key, key_of(x))) {
+      return yastl::make_pair(iterator(x), false);
+    }
+    return insert_node(create_node(yastl::forward<K>(key), mapped_type(yastl::forward<Args>(args)...)));
+  }
+
+  // 删除键值为 key 的元素，返回删除的个数
+  size_type erase(const key_type& key);
+
+  // 清空容器，不能与其他操作并发
+  void clear() {
+    destroy_all();
+    arena_.release();
+    for (size_t level = 0; level < kSkiplistMaxHeight; ++level) {
+      head_->link(level)->store(0, std::memory_order_relaxed);
+    }
+    size_.store(0, std::memory_order_relaxed);
+  }
+
+  // 不能与其他操作并发
+  void swap(concurrent_skiplist& rhs) noexcept {
+    if (this != &rhs) {
+      yastl::swap(head_, rhs.head_);
+      arena_.swap(rhs.arena_);
+      const size_type n = size_.load(std::memory_order_relaxed);
+      size_.store(rhs.size_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      rhs.size_.store(n, std::memory_order_relaxed);
+      yastl::swap(comp_, rhs.comp_);
+    }
+  }
+
+  // 查找相关操作
+
+  iterator find(const key_type& key) {
+    return iterator(find_node(key));
+  }
+  const_iterator find(const key_type& key) const {
+    return const_iterator(find_node(key));
+  }
+
+  size_type count(const key_type& key) const {
+    return find_node(key) != nullptr ? 1 : 0;
+  }
+  bool contains(const key_type& key) const {
+    return find_node(key) != nullptr;
+  }
+
+  // 第一个键值不小于 key 的元素
+  iterator lower_bound(const key_type& key) {
+    return iterator(lower_bound_node(key, false));
+  }
+  const_iterator lower_bound(const key_type& key) const {
+    return const_iterator(lower_bound_node(key, false));
+  }
+
+  // 第一个键值大于 key 的元素
+  iterator upper_bound(const key_type& key) {
+    return iterator(lower_bound_node(key, true));
+  }
+  const_iterator upper_bound(const key_type& key) const {
+    return const_iterator(lower_bound_node(key, true));
+  }
+
+  pair<iterator, iterator> equal_range(const key_type& key) {
+    return yastl::make_pair(lower_bound(key), upper_bound(key));
+  }
+  pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+    return yastl::make_pair(lower_bound(key), upper_bound(key));
+  }
+
+  key_compare key_comp() const {
+    return comp_;
+  }
+
+private:
+  // helper functions
+
+  const key_type& key_of(node_type* x) const {
+    return KeyOfValue()(x->value());
+  }
+
+  node_type* first_alive() const noexcept {
+    return node_type::next_alive(node_type::ptr(head_->link(0)->load(std::memory_order_acquire)));
+  }
+
+  node_type* find_node(const key_type& key) const {
+    node_type* x = lower_bound_node(key, false);
+    return x != nullptr && !comp_(key, key_of(x)) ? x : nullptr;
+  }
+
+  // 按 1/4 的概率逐层增高
+  static size_t random_height() noexcept {
+    size_t height = 1;
+    for (uint64_t r = concurrent_random(); height < kSkiplistMaxHeight && (r & 3) == 0; r >>= 2) {
+      ++height;
+    }
+    return height;
+  }
+
+  template <class ...Args>
+  node_type* create_node(Args&& ...args);
+  void destroy_all() noexcept;
+
+  template <class K>
+  pair<iterator, bool> try_emplace_key(const key_type& key, K&& value);
+  pair<iterator, bool> insert_node(node_type* x);
+
+  node_type* lower_bound_node(const key_type& key, bool upper) const;
+  bool find_position(const key_type& key, node_type** preds, node_type** succs);
+};
+
+/*****************************************************************************************/
+
+// 从内存池中切出一个随机层数的节点并构造元素，构造失败的节点留在内存池中，标记为未构造
+template <class Key, class Value, class KeyOfValue, class Compare>
+template <class ...Args>
+typename concurrent_skiplist<Key, Value, KeyOfValue, Compare>::node_type*
+concurrent_skiplist<Key, Value, KeyOfValue, Compare>::create_node(Args&& ...args) {
+  const size_t height = random_height();
+  auto x = static_cast<node_type*>(arena_.allocate(node_type::size(height), alignof(node_type)));
+  x->height = static_cast<uint32_t>(height);
+  x->constructed = false;
+  for (size_t level = 0; level < height; ++level) {
+    new (x->link(level)) std::atomic<uintptr_t>(0);
+  }
+  ::new (static_cast<void*>(&x->storage)) value_type(yastl::forward<Args>(args)...);
+  x->constructed = true;
+  return x;
+}
+
+// 按分配顺序遍历内存池中的每个节点，析构其中的元素，包括已经被删除的节点
+template <class Key, class Value, class KeyOfValue, class Compare>
+void concurrent_skiplist<Key, Value, KeyOfValue, Compare>::destroy_all() noexcept {
+  arena_.for_each_block([](char* first, char* last) {
+    while (first < last) {
+      auto x = reinterpret_cast<node_type*>(first);
+      if (x->constructed) {
+        x->value().~value_type();
+      }
+      first += node_type::size(x->height);
+    }
+  });
+}
+
+template <class Key, class Value, class KeyOfValue, class Compare>
+template <class K>
+pair<typename concurrent_skiplist<Key, Value, KeyOfValue, Compare>::iterator, bool>
+concurrent_skiplist<Key, Value, KeyOfValue, Compare>::try_emplace_key(const key_type& key, K&& value) {
+  node_type* x = lower_bound_node(key, false);
+  if (x != nullptr && !comp_(key, key_of(x))) {
+    return yastl::make_pair(iterator(x), false);
+  }
+  return insert_node(create_node(yastl::forward<K>(value)));
+}
+
+// 找到 key 在每一层的前驱 preds 与后继 succs，后继是该层第一个键值不小于 key 的节点
+// 路过已被标记的节点时把它从这一层摘掉，摘除失败说明前驱也变了，从头重新查找
+// 返回第 0 层的后继的键值是否等于 key
+template <class Key, class Value, class KeyOfValue, class Compare>
+bool concurrent_skiplist<Key, Value, KeyOfValue, Compare>::
+find_position(const key_type& key, node_type** preds, node_type** succs) {
+retry:
+  node_type* pred = head_;
+  for (size_t level = kSkiplistMaxHeight; level-- > 0;) {
+    node_type* cur = node_type::ptr(pred->link(level)->load(std::memory_order_acquire));
+    while (cur != nullptr) {
+      uintptr_t succ = cur->link(level)->load(std::memory_order_acquire);
+      while (succ & 1) { // cur 在这一层已被标记，摘掉它
+        uintptr_t expected = reinterpret_cast<uintptr_t>(cur);
+        if (!pred->link(level)->compare_exchange_strong(expected, succ & ~static_cast<uintptr_t>(1),
+                                                        std::memory_order_acq_rel,
+                                                        std::memory_order_acquire)) {
+          goto retry;
+        }
+        cur = node_type::ptr(succ);
+        if (cur == nullptr) {
+          break;
+        }
+        succ = cur->link(level)->load(std::memory_order_acquire);
+      }
+      if (cur == nullptr || !comp_(key_of(cur), key)) {
+        break;
+      }
+      pred = cur;
+      cur = node_type::ptr(succ);
+    }
+    preds[level] = pred;
+    succs[level] = cur;
+  }
+  return succs[0] != nullptr && !comp_(key, key_of(succs[0]));
+}
+
+// 插入一个已经构造好的节点，键值已存在时销毁节点中的元素，返回已有的元素
+// 第 0 层链接成功即插入成功，然后逐层向上链接；节点在链接过程中被删除时停止
+template <class Key, class Value, class KeyOfValue, class Compare>
+pair<typename concurrent_skiplist<Key, Value, KeyOfValue, Compare>::iterator, bool>
+concurrent_skiplist<Key, Value, KeyOfValue, Compare>::insert_node(node_type* x) {
+  node_type* preds[kSkiplistMaxHeight];
+  node_type* succs[kSkiplistMaxHeight];
+  const key_type& key = key_of(x);
+  const size_t height = x->height;
+  for (;;) {
+    if (find_position(key, preds, succs)) {
+      x->value().~value_type();
+      x->constructed = false;
+      return yastl::make_pair(iterator(succs[0]), false);
+    }
+    for (size_t level = 0; level < height; ++level) {
+      x->link(level)->store(reinterpret_cast<uintptr_t>(succs[level]), std::memory_order_relaxed);
+    }
+    uintptr_t expected = reinterpret_cast<uintptr_t>(succs[0]);
+    if (preds[0]->link(0)->compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(x),
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  size_.fetch_add(1, std::memory_order_relaxed);
+  for (size_t level = 1; level < height; ++level) {
+    for (;;) {
+      uintptr_t next = x->link(level)->load(std::memory_order_acquire);
+      if (next & 1) { // 已经被删除
+        return yastl::make_pair(iterator(x), true);
+      }
+      const uintptr_t succ = reinterpret_cast<uintptr_t>(succs[level]);
+      if (next != succ && !x->link(level)->compare_exchange_strong(next, succ, std::memory_order_acq_rel)) {
+        continue;
+      }
+      uintptr_t expected = succ;
+      if (preds[level]->link(level)->compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(x),
+                                                             std::memory_order_release,
+                                                             std::memory_order_relaxed)) {
+        break;
+      }
+      find_position(key, preds, succs); // 前驱或后继变了，重新查找这一层的位置
+      if (succs[0] != x) { // 已经被删除并摘掉
+        return yastl::make_pair(iterator(x), true);
+      }
+    }
+  }
+  return yastl::make_pair(iterator(x), true);
+}
+
+// 先从高到低标记除第 0 层以外的各层，标记第 0 层成功的线程完成删除，再查找一次把节点从各层摘掉
+template <class Key, class Value, class KeyOfValue, class Compare>
+typename concurrent_skiplist<Key, Value, KeyOfValue, Compare>::size_type
+concurrent_skiplist<Key, Value, KeyOfValue, Compare>::erase(const key_type& key) {
+  node_type* preds[kSkiplistMaxHeight];
+  node_type* succs[kSkiplistMaxHeight];
+  for (;;) {
+    if (!find_position(key, preds, succs)) {
+      return 0;
+    }
+    node_type* x = succs[0];
+    for (size_t level = x->height - 1; level > 0; --level) {
+      uintptr_t next = x->link(level)->load(std::memory_order_acquire);
+      while (!(next & 1) &&
+             !x->link(level)->compare_exchange_weak(next, next | 1, std::memory_order_acq_rel)) {
+      }
+    }
+    uintptr_t next = x->link(0)->load(std::memory_order_acquire);
+    while (!(next & 1)) {
+      if (x->link(0)->compare_exchange_weak(next, next | 1, std::memory_order_acq_rel)) {
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        find_position(key, preds, succs);
+        return 1;
+      }
+    }
+    // 被别的线程抢先删除，重新查找
+  }
+}
+
+// 只读的查找，不摘除节点：每一层只停在读到时没有被标记的节点上，返回第 0 层第一个键值不小于（upper 时大于）key 的节点
+template <class Key, class Value, class KeyOfValue, class Compare>
+typename concurrent_skiplist<Key, Value, KeyOfValue, Compare>::node_type*
+concurrent_skiplist<Key, Value, KeyOfValue, Compare>::lower_bound_node(const key_type& key, bool upper) const {
+  node_type* pred = head_;
+  node_type* cur = nullptr;
+  for (size_t level = kSkiplistMaxHeight; level-- > 0;) {
+    cur = node_type::ptr(pred->link(level)->load(std::memory_order_acquire));
+    while (cur != nullptr) {
+      uintptr_t succ = cur->link(level)->load(std::memory_order_acquire);
+      while (succ & 1) { // 跳过被标记的节点
+        cur = node_type::ptr(succ);
+        if (cur == nullptr) {
+          break;
+        }
+        succ = cur->link(level)->load(std::memory_order_acquire);
+      }
+      if (cur == nullptr) {
+        break;
+      }
+      const bool before = upper ? !comp_(key, key_of(cur)) : comp_(key_of(cur), key);
+      if (!before) {
+        break;
+      }
+      pred = cur;
+      cur = node_type::ptr(succ);
+    }
+  }
+  return cur;
+}
+
+// 重载 yastl 的 swap
+template <class Key, class Value, class KeyOfValue, class Compare>
+void swap(concurrent_skiplist<Key, Value, KeyOfValue, Compare>& lhs,
+          concurrent_skiplist<Key, Value, KeyOfValue, Compare>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+// 映射，键值不允许重复
+template <class Key, class T, class Compare = yastl::less<Key>>
+using concurrent_map = concurrent_skiplist<Key, yastl::pair<const Key, T>, yastl::selectfirst<yastl::pair<const Key, T>>, Compare>;
+
+// 集合，键值不允许重复
+template <class Key, class Compare = yastl::less<Key>>
+using concurrent_set = concurrent_skiplist<Key, Key, yastl::identity<Key>, Compare>;
+
+} // namespace yastl
+#endif // _INCLUDE_CONCURRENT_SKIPLIST_H_
@@ -42,6 +42,9 @@ void destroy_one(Ty* pointer, std::false_type) {
   }
 }
 
+template <class Ty>
+void destroy(Ty* pointer);
+
 // 一堆迭代器 析构函数不重要 true type
 template <class ForwardIter>
 void destroy_cat(ForwardIter , ForwardIter , std::true_type) {}
@@ -14,6 +14,9 @@
 //   * push_front
 //   * push_back
 //   * insert
+//   * append
+//   * prepend
+//   * emplace_back_n
 
 #include <initializer_list>
 
@@ -29,18 +32,23 @@ namespace yastl {
 #define DEQUE_MAP_INIT_SIZE 8
 #endif
 
-// 每个buffer的size，取决于泛型大小
-template <class T>
+// deque 最多缓存的空闲缓冲区个数，弹出元素时腾空的缓冲区先放进缓存，之后需要新缓冲区时优先复用
+#ifndef DEQUE_SPARE_BUFFER_SIZE
+#define DEQUE_SPARE_BUFFER_SIZE 2
+#endif
+
+// 每个buffer的size，BufSize 不为 0 时由使用者指定，否则取决于泛型大小
+template <class T, size_t BufSize = 0>
 struct deque_buf_size {
-  static constexpr size_t value = sizeof(T) < 256 ? 4096 / sizeof(T) : 16;
+  static constexpr size_t value = BufSize != 0 ? BufSize : (sizeof(T) < 256 ? 4096 / sizeof(T) : 16);
 };
 
 // deque 的迭代器设计
 // 一个deque中有begin和end是这种iter
-template <class T, class Ref, class Ptr>
+template <class T, class Ref, class Ptr, size_t BufSize = 0>
 struct deque_iterator : public iterator<random_access_iterator_tag, T> {
-  typedef deque_iterator<T, T&, T*> iterator;
-  typedef deque_iterator<T, const T&, const T*> const_iterator;
+  typedef deque_iterator<T, T&, T*, BufSize> iterator;
+  typedef deque_iterator<T, const T&, const T*, BufSize> const_iterator;
   typedef deque_iterator self;
 
   typedef T value_type;
@@ -52,7 +60,7 @@ struct deque_iterator : public iterator<random_access_iterator_tag, T> {
   typedef T** map_pointer;
 
   // 一个缓冲区的大小
-  static const size_type buffer_size = deque_buf_size<T>::value;
+  static const size_type buffer_size = deque_buf_size<T, BufSize>::value;
 
   // 迭代器所含成员数据
   value_pointer cur;    // 指向所在缓冲区的有效当前元素
@@ -189,9 +197,39 @@ struct deque_iterator : public iterator<random_access_iterator_tag, T> {
   }
 };
 
+// deque 的迭代器是分段迭代器，每个缓冲区是一段，copy、move、fill、find、for_each、equal 等算法逐个缓冲区处理
+template <class T, class Ref, class Ptr, size_t BufSize>
+struct segmented_iterator_traits<deque_iterator<T, Ref, Ptr, BufSize>> {
+  typedef m_true_type is_segmented_iterator;
+  typedef deque_iterator<T, Ref, Ptr, BufSize> iterator;
+  typedef typename iterator::map_pointer segment_iterator;
+  typedef Ptr local_iterator;
+
+  static segment_iterator segment(const iterator& it) {
+    return it.node;
+  }
+  static local_iterator local(const iterator& it) {
+    return it.cur;
+  }
+  static local_iterator begin(segment_iterator seg) {
+    return *seg;
+  }
+  static local_iterator end(segment_iterator seg) {
+    return *seg + iterator::buffer_size;
+  }
+  // 位于缓冲区尾部的位置属于下一个缓冲区，与 operator++ 的约定一致
+  static iterator compose(segment_iterator seg, local_iterator local) {
+    if (local == end(seg)) {
+      ++seg;
+      local = begin(seg);
+    }
+    return iterator(const_cast<T*>(local), seg);
+  }
+};
+
 // 模板类 deque
-// 模板参数代表数据类型
-template <class T>
+// 参数一代表数据类型，参数二代表每个缓冲区的元素个数，缺省为 0，表示由 deque_buf_size 根据类型大小决定
+template <class T, size_t BufSize = 0>
 class deque {
 public:
   // deque 的型别定义
@@ -209,8 +247,8 @@ public:
   typedef pointer* map_pointer;
   typedef const_pointer* const_map_pointer;
 
-  typedef deque_iterator<T, T&, T*> iterator;
-  typedef deque_iterator<T, const T&, const T*> const_iterator;
+  typedef deque_iterator<T, T&, T*, BufSize> iterator;
+  typedef deque_iterator<T, const T&, const T*, BufSize> const_iterator;
   typedef yastl::reverse_iterator<iterator> reverse_iterator;
   typedef yastl::reverse_iterator<const_iterator> const_reverse_iterator;
 
@@ -219,7 +257,7 @@ public:
   }
 
   // 每个buffer的size
-  static const size_type buffer_size = deque_buf_size<T>::value;
+  static const size_type buffer_size = deque_buf_size<T, BufSize>::value;
 
 private:
   // 用以下四个数据来表现一个 deque
@@ -228,6 +266,10 @@ private:
   map_pointer map_;       // 指向一块 map，map 中的每个元素都是一个指针，指向一个缓冲区
   size_type map_size_;  // map 内指针的数目
 
+  // 空闲缓冲区的缓存，作为队列使用时 pop_front 腾出的缓冲区可以直接给 push_back 复用
+  pointer spare_[DEQUE_SPARE_BUFFER_SIZE];
+  size_type spare_size_ = 0;
+
 public:
   // 构造、复制、移动、析构函数
   // 初始化一个空的
@@ -280,6 +322,7 @@ public:
       map_allocator::deallocate(map_, map_size_);
       map_ = nullptr;
     }
+    release_spare();
   }
 
 public:
@@ -417,6 +460,24 @@ public:
   void pop_front();
   void pop_back();
 
+  // 批量操作，只检查一次容量，按缓冲区分段拷贝，可平凡拷贝的类型会走 memmove
+
+  // 把 [first, first + n) 拷贝到尾部
+  void append(const_pointer first, size_type n);
+  // 把 [first, first + n) 拷贝到头部，保持原来的顺序
+  void prepend(const_pointer first, size_type n);
+  // 在尾部就地构建 n 个元素，每个元素都用 args 构造
+  template <class ...Args>
+  void emplace_back_n(size_type n, Args&& ...args);
+  // 把头部最多 n 个元素移动到 out 所指的区间并弹出，返回实际弹出的个数
+  size_type pop_front_n(size_type n, pointer out);
+  // 直接弹出头部最多 n 个元素，返回实际弹出的个数
+  size_type pop_front_n(size_type n);
+  // 把头部最多 n 个元素按缓冲区分段交给 f(pointer first, size_type len) 原地处理，每段处理完就弹出，
+  // 返回实际弹出的个数；f 抛出异常时，正在处理的那一段留在容器中
+  template <class Function>
+  size_type consume_front(size_type n, Function f);
+
   // insert
 
   iterator insert(iterator position, const value_type& value);
@@ -445,6 +506,11 @@ private:
   void create_buffer(map_pointer nstart, map_pointer nfinish);
   void destroy_buffer(map_pointer nstart, map_pointer nfinish);
 
+  // 单个缓冲区的获取与归还，优先使用空闲缓存
+  pointer allocate_buffer();
+  void deallocate_buffer(pointer buffer) noexcept;
+  void release_spare() noexcept;
+
   // initialize
   void map_init(size_type nelem);
   void fill_init(size_type n, const value_type& value);
@@ -470,19 +536,22 @@ private:
   void insert_dispatch(iterator, IIter, IIter, input_iterator_tag);
   template <class FIter>
   void insert_dispatch(iterator, FIter, FIter, forward_iterator_tag);
+  iterator copy_to_buffers(iterator pos, const_pointer first, size_type n, std::true_type);
+  iterator copy_to_buffers(iterator pos, const_pointer first, size_type n, std::false_type);
 
   // reallocate
   void require_capacity(size_type n, bool front);
   void reallocate_map_at_front(size_type need);
   void reallocate_map_at_back(size_type need);
+  void recenter_map(map_pointer new_start);
 
 };
 
 /*****************************************************************************************/
 
 // 复制赋值运算符
-template <class T>
-deque<T>& deque<T>::operator=(const deque& rhs) {
+template <class T, size_t BufSize>
+deque<T, BufSize>& deque<T, BufSize>::operator=(const deque& rhs) {
   if (this != &rhs) {
     const auto len = size();
     if (len >= rhs.size()) {
@@ -497,8 +566,8 @@ deque<T>& deque<T>::operator=(const deque& rhs) {
 }
 
 // 移动赋值运算符
-template <class T>
-deque<T>& deque<T>::operator=(deque&& rhs) {
+template <class T, size_t BufSize>
+deque<T, BufSize>& deque<T, BufSize>::operator=(deque&& rhs) {
   clear();
   begin_ = yastl::move(rhs.begin_);
   end_ = yastl::move(rhs.end_);
@@ -510,8 +579,8 @@ deque<T>& deque<T>::operator=(deque&& rhs) {
 }
 
 // 重置容器大小
-template <class T>
-void deque<T>::resize(size_type new_size, const value_type& value) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::resize(size_type new_size, const value_type& value) {
   const auto len = size();
   if (new_size < len) { // 少则插入，多则删除
     erase(begin_ + new_size, end_);
@@ -521,8 +590,8 @@ void deque<T>::resize(size_type new_size, const value_type& value) {
 }
 
 // 减小容器容量，把之前出队的“废弃”空间释放,最后就剩有效空间没有释放
-template <class T>
-void deque<T>::shrink_to_fit() noexcept {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::shrink_to_fit() noexcept {
   // 至少会留下头部缓冲区
   // 释放头部的废弃空间
   for (auto cur = map_; cur < begin_.node; ++cur) {
@@ -534,12 +603,13 @@ void deque<T>::shrink_to_fit() noexcept {
     data_allocator::deallocate(*cur, buffer_size);
     *cur = nullptr;
   }
+  release_spare(); // 释放缓存的空闲缓冲区
 }
 
 // 在头部就地构建元素
-template <class T>
+template <class T, size_t BufSize>
 template <class ...Args>
-void deque<T>::emplace_front(Args&& ...args) {
+void deque<T, BufSize>::emplace_front(Args&& ...args) {
   if (begin_.cur != begin_.first) {
     data_allocator::construct(begin_.cur - 1, yastl::forward<Args>(args)...);
     --begin_.cur;
@@ -558,9 +628,9 @@ void deque<T>::emplace_front(Args&& ...args) {
 }
 
 // 在尾部就地构建元素
-template <class T>
+template <class T, size_t BufSize>
 template <class ...Args>
-void deque<T>::emplace_back(Args&& ...args) {
+void deque<T, BufSize>::emplace_back(Args&& ...args) {
   if (end_.cur != end_.last - 1) { // 空间还够
     data_allocator::construct(end_.cur, yastl::forward<Args>(args)...);
     ++end_.cur;
@@ -572,9 +642,9 @@ void deque<T>::emplace_back(Args&& ...args) {
 }
 
 // 在 pos 位置就地构建元素
-template <class T>
+template <class T, size_t BufSize>
 template <class ...Args>
-typename deque<T>::iterator deque<T>::emplace(iterator pos, Args&& ...args) {
+typename deque<T, BufSize>::iterator deque<T, BufSize>::emplace(iterator pos, Args&& ...args) {
   if (pos.cur == begin_.cur) {
     emplace_front(yastl::forward<Args>(args)...);
     return begin_;
@@ -586,8 +656,8 @@ typename deque<T>::iterator deque<T>::emplace(iterator pos, Args&& ...args) {
 }
 
 // 在头部插入元素
-template <class T>
-void deque<T>::push_front(const value_type& value) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::push_front(const value_type& value) {
   if (begin_.cur != begin_.first) {
     data_allocator::construct(begin_.cur - 1, value);
     --begin_.cur;
@@ -604,8 +674,8 @@ void deque<T>::push_front(const value_type& value) {
 }
 
 // 在尾部插入元素
-template <class T>
-void deque<T>::push_back(const value_type& value) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::push_back(const value_type& value) {
   if (end_.cur != end_.last - 1) {
     data_allocator::construct(end_.cur, value);
     ++end_.cur;
@@ -617,8 +687,8 @@ void deque<T>::push_back(const value_type& value) {
 }
 
 // 弹出头部元素
-template <class T>
-void deque<T>::pop_front() {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::pop_front() {
   YASTL_DEBUG(!empty());
   if (begin_.cur != begin_.last - 1) {
     data_allocator::destroy(begin_.cur);
@@ -631,8 +701,8 @@ void deque<T>::pop_front() {
 }
 
 // 弹出尾部元素
-template <class T>
-void deque<T>::pop_back() {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::pop_back() {
   YASTL_DEBUG(!empty());
   if (end_.cur != end_.first) {
     --end_.cur;
@@ -644,9 +714,136 @@ void deque<T>::pop_back() {
   }
 }
 
+// 批量追加到尾部，先一次性准备好缓冲区，再逐个缓冲区拷贝
+template <class T, size_t BufSize>
+void deque<T, BufSize>::append(const_pointer first, size_type n) {
+  if (n == 0) {
+    return;
+  }
+  require_capacity(n, false);
+  try {
+    end_ = copy_to_buffers(end_, first, n, std::is_trivially_copy_assignable<T>{});
+  } catch (...) {
+    destroy_buffer(end_.node + 1, (end_ + n).node);
+    throw;
+  }
+}
+
+// 批量插入到头部，从新的头部开始逐个缓冲区拷贝
+template <class T, size_t BufSize>
+void deque<T, BufSize>::prepend(const_pointer first, size_type n) {
+  if (n == 0) {
+    return;
+  }
+  require_capacity(n, true);
+  const auto new_begin = begin_ - n;
+  try {
+    copy_to_buffers(new_begin, first, n, std::is_trivially_copy_assignable<T>{});
+  } catch (...) {
+    destroy_buffer(new_begin.node, begin_.node - 1);
+    throw;
+  }
+  begin_ = new_begin;
+}
+
+// 在尾部就地构建 n 个元素
+template <class T, size_t BufSize>
+template <class ...Args>
+void deque<T, BufSize>::emplace_back_n(size_type n, Args&& ...args) {
+  if (n == 0) {
+    return;
+  }
+  require_capacity(n, false);
+  auto cur = end_;
+  try {
+    for (size_type i = 0; i < n; ++i, ++cur) {
+      data_allocator::construct(cur.cur, args...);
+    }
+  } catch (...) {
+    yastl::destroy(end_, cur);
+    destroy_buffer(end_.node + 1, (end_ + n).node);
+    throw;
+  }
+  end_ = cur;
+}
+
+// 批量弹出并移动到 out，移动由 yastl::move 逐个缓冲区完成
+template <class T, size_t BufSize>
+typename deque<T, BufSize>::size_type deque<T, BufSize>::pop_front_n(size_type n, pointer out) {
+  n = yastl::min(n, size());
+  yastl::move(begin_, begin_ + n, out);
+  return pop_front_n(n);
+}
+
+// 批量弹出，逐个缓冲区析构，腾空的缓冲区与 pop_front 一样先放进缓存
+template <class T, size_t BufSize>
+typename deque<T, BufSize>::size_type deque<T, BufSize>::pop_front_n(size_type n) {
+  n = yastl::min(n, size());
+  if (n == 0) {
+    return 0;
+  }
+  const auto new_begin = begin_ + n;
+  if (begin_.node == new_begin.node) {
+    data_allocator::destroy(begin_.cur, new_begin.cur);
+  } else {
+    data_allocator::destroy(begin_.cur, begin_.last);
+    for (auto node = begin_.node + 1; node < new_begin.node; ++node) {
+      data_allocator::destroy(*node, *node + buffer_size);
+    }
+    data_allocator::destroy(new_begin.first, new_begin.cur);
+    destroy_buffer(begin_.node, new_begin.node - 1);
+  }
+  begin_ = new_begin;
+  return n;
+}
+
+// 逐个缓冲区把头部的元素交给 f，处理完一段弹出一段
+template <class T, size_t BufSize>
+template <class Function>
+typename deque<T, BufSize>::size_type deque<T, BufSize>::consume_front(size_type n, Function f) {
+  n = yastl::min(n, size());
+  for (size_type left = n; left > 0;) {
+    const size_type len = yastl::min(left, static_cast<size_type>(begin_.last - begin_.cur));
+    f(begin_.cur, len);
+    pop_front_n(len);
+    left -= len;
+  }
+  return n;
+}
+
+// copy_to_buffers 函数，把 [first, first + n) 构造到从 pos 开始、已经分配好的缓冲区中，返回构造结束的位置
+// 平凡类型逐个缓冲区整段拷贝；其他类型逐个构造，失败时析构已经构造的元素并重新抛出异常
+template <class T, size_t BufSize>
+typename deque<T, BufSize>::iterator
+deque<T, BufSize>::copy_to_buffers(iterator pos, const_pointer first, size_type n, std::true_type) {
+  for (size_type left = n; left > 0;) {
+    const size_type len = yastl::min(left, static_cast<size_type>(pos.last - pos.cur));
+    yastl::uninitialized_copy(first, first + len, pos.cur);
+    first += len;
+    left -= len;
+    pos += len;
+  }
+  return pos;
+}
+
+template <class T, size_t BufSize>
+typename deque<T, BufSize>::iterator
+deque<T, BufSize>::copy_to_buffers(iterator pos, const_pointer first, size_type n, std::false_type) {
+  auto cur = pos;
+  try {
+    for (; n > 0; --n, ++first, ++cur) {
+      data_allocator::construct(cur.cur, *first);
+    }
+  } catch (...) {
+    yastl::destroy(pos, cur);
+    throw;
+  }
+  return cur;
+}
+
 // 在 position 处插入元素，拷贝构造
-template <class T>
-typename deque<T>::iterator deque<T>::insert(iterator position, const value_type& value) {
+template <class T, size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::insert(iterator position, const value_type& value) {
   if (position.cur == begin_.cur) {
     push_front(value);
     return begin_;
@@ -661,8 +858,8 @@ typename deque<T>::iterator deque<T>::insert(iterator position, const value_type
 }
 
 // 在 position 处插入元素，右值构造
-template <class T>
-typename deque<T>::iterator deque<T>::insert(iterator position, value_type&& value) {
+template <class T, size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::insert(iterator position, value_type&& value) {
   if (position.cur == begin_.cur) {
     emplace_front(yastl::move(value));
     return begin_;
@@ -677,8 +874,8 @@ typename deque<T>::iterator deque<T>::insert(iterator position, value_type&& val
 }
 
 // 在 position 位置插入 n 个元素
-template <class T>
-void deque<T>::insert(iterator position, size_type n, const value_type& value) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::insert(iterator position, size_type n, const value_type& value) {
   if (position.cur == begin_.cur) {
     require_capacity(n, true);
     auto new_begin = begin_ - n;
@@ -695,8 +892,8 @@ void deque<T>::insert(iterator position, size_type n, const value_type& value) {
 }
 
 // 删除 position 处的元素
-template <class T>
-typename deque<T>::iterator deque<T>::erase(iterator position) {
+template <class T, size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::erase(iterator position) {
   auto next = position;
   ++next;
   const size_type elems_before = position - begin_;
@@ -711,8 +908,8 @@ typename deque<T>::iterator deque<T>::erase(iterator position) {
 }
 
 // 删除[first, last)上的元素
-template <class T>
-typename deque<T>::iterator deque<T>::erase(iterator first, iterator last) {
+template <class T, size_t BufSize>
+typename deque<T, BufSize>::iterator deque<T, BufSize>::erase(iterator first, iterator last) {
   if (first == begin_ && last == end_) {
     clear();
     return end_;
@@ -735,8 +932,8 @@ typename deque<T>::iterator deque<T>::erase(iterator first, iterator last) {
 }
 
 // 清空 deque,释放废弃空间，以及调用有效空间的析构函数
-template <class T>
-void deque<T>::clear() {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::clear() {
   // clear 会保留头部的缓冲区
   for (map_pointer cur = begin_.node + 1; cur < end_.node; ++cur) { // 对于map中除了begin和end的每个node
     data_allocator::destroy(*cur, *cur + buffer_size);
@@ -756,8 +953,8 @@ void deque<T>::clear() {
 }
 
 // 交换两个 deque
-template <class T>
-void deque<T>::swap(deque& rhs) noexcept {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::swap(deque& rhs) noexcept {
   if (this != &rhs) {
     yastl::swap(begin_, rhs.begin_);
     yastl::swap(end_, rhs.end_);
@@ -769,8 +966,8 @@ void deque<T>::swap(deque& rhs) noexcept {
 /*****************************************************************************************/
 // helper function
 // 分配map指针区域内存以及初始化置空（不分配缓冲区）
-template <class T>
-typename deque<T>::map_pointer deque<T>::create_map(size_type size) {
+template <class T, size_t BufSize>
+typename deque<T, BufSize>::map_pointer deque<T, BufSize>::create_map(size_type size) {
   map_pointer mp = nullptr;
   mp = map_allocator::allocate(size);
   for (size_type i = 0; i < size; ++i) {
@@ -780,35 +977,65 @@ typename deque<T>::map_pointer deque<T>::create_map(size_type size) {
 }
 
 // create_buffer 函数, 分配缓冲区[nstart, nfinish]这段map指针所对应的缓冲区
-template <class T>
-void deque<T>::create_buffer(map_pointer nstart, map_pointer nfinish) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::create_buffer(map_pointer nstart, map_pointer nfinish) {
   map_pointer cur;
   try {
     for (cur = nstart; cur <= nfinish; ++cur) {
-      *cur = data_allocator::allocate(buffer_size);
+      *cur = allocate_buffer();
     }
   } catch (...) {
     while (cur != nstart) {
       --cur;
-      data_allocator::deallocate(*cur, buffer_size);
+      deallocate_buffer(*cur);
       *cur = nullptr;
     }
     throw;
   }
 }
 
-// destroy_buffer 函数，销毁map所指的buffer
-template <class T>
-void deque<T>::destroy_buffer(map_pointer nstart, map_pointer nfinish) {
+// destroy_buffer 函数，销毁map所指的buffer，缓存未满时先留作备用
+template <class T, size_t BufSize>
+void deque<T, BufSize>::destroy_buffer(map_pointer nstart, map_pointer nfinish) {
   for (map_pointer n = nstart; n <= nfinish; ++n) {
-    data_allocator::deallocate(*n, buffer_size);
+    deallocate_buffer(*n);
     *n = nullptr;
   }
 }
 
+// allocate_buffer 函数，有缓存的空闲缓冲区就直接取出，否则向分配器申请
+template <class T, size_t BufSize>
+typename deque<T, BufSize>::pointer deque<T, BufSize>::allocate_buffer() {
+  if (spare_size_ != 0) {
+    return spare_[--spare_size_];
+  }
+  return data_allocator::allocate(buffer_size);
+}
+
+// deallocate_buffer 函数，缓存未满则放入缓存，否则归还给分配器
+template <class T, size_t BufSize>
+void deque<T, BufSize>::deallocate_buffer(pointer buffer) noexcept {
+  if (buffer == nullptr) {
+    return;
+  }
+  if (spare_size_ < DEQUE_SPARE_BUFFER_SIZE) {
+    spare_[spare_size_++] = buffer;
+  } else {
+    data_allocator::deallocate(buffer, buffer_size);
+  }
+}
+
+// release_spare 函数，释放所有缓存的空闲缓冲区
+template <class T, size_t BufSize>
+void deque<T, BufSize>::release_spare() noexcept {
+  while (spare_size_ != 0) {
+    data_allocator::deallocate(spare_[--spare_size_], buffer_size);
+  }
+}
+
 // map_init 函数
-template <class T>
-void deque<T>::map_init(size_type nElem) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::map_init(size_type nElem) {
   const size_type nNode = nElem / buffer_size + 1;  // 需要分配的缓冲区个数
   map_size_ = yastl::max(static_cast<size_type>(DEQUE_MAP_INIT_SIZE), nNode + 2);
   try {
@@ -837,8 +1064,8 @@ void deque<T>::map_init(size_type nElem) {
 }
 
 // fill_init 函数
-template <class T>
-void deque<T>::fill_init(size_type n, const value_type& value) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::fill_init(size_type n, const value_type& value) {
   map_init(n);
   if (n != 0) {
     for (auto cur = begin_.node; cur < end_.node; ++cur) {
@@ -849,9 +1076,9 @@ void deque<T>::fill_init(size_type n, const value_type& value) {
 }
 
 // copy_init 函数， 把[first, last)内容拷贝构造到一个新deque中
-template <class T>
+template <class T, size_t BufSize>
 template <class IIter>
-void deque<T>::copy_init(IIter first, IIter last, input_iterator_tag) {
+void deque<T, BufSize>::copy_init(IIter first, IIter last, input_iterator_tag) {
   const size_type n = yastl::distance(first, last);
   map_init(n); // 初始化map
   for (; first != last; ++first) {
@@ -859,9 +1086,9 @@ void deque<T>::copy_init(IIter first, IIter last, input_iterator_tag) {
   } 
 }
 
-template <class T>
+template <class T, size_t BufSize>
 template <class FIter>
-void deque<T>::copy_init(FIter first, FIter last, forward_iterator_tag) {
+void deque<T, BufSize>::copy_init(FIter first, FIter last, forward_iterator_tag) {
   const size_type n = yastl::distance(first, last);
   map_init(n);
   for (auto cur = begin_.node; cur < end_.node; ++cur) {
@@ -874,8 +1101,8 @@ void deque<T>::copy_init(FIter first, FIter last, forward_iterator_tag) {
 }
 
 // fill_assign 函数,让当前deque大小变为n，并且全部填充上value
-template <class T>
-void deque<T>::fill_assign(size_type n, const value_type& value) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::fill_assign(size_type n, const value_type& value) {
   if (n > size()) {
     yastl::fill(begin(), end(), value); // 先把目前的给填充上
     insert(end(), n - size(), value); // 额外插入
@@ -886,9 +1113,9 @@ void deque<T>::fill_assign(size_type n, const value_type& value) {
 }
 
 // copy_assign 函数
-template <class T>
+template <class T, size_t BufSize>
 template <class IIter>
-void deque<T>::copy_assign(IIter first, IIter last, input_iterator_tag) {
+void deque<T, BufSize>::copy_assign(IIter first, IIter last, input_iterator_tag) {
   auto first1 = begin();
   auto last1 = end();
   for (; first != last && first1 != last1; ++first, ++first1) {
@@ -901,9 +1128,9 @@ void deque<T>::copy_assign(IIter first, IIter last, input_iterator_tag) {
   }
 }
 
-template <class T>
+template <class T, size_t BufSize>
 template <class FIter>
-void deque<T>::copy_assign(FIter first, FIter last, forward_iterator_tag) {  
+void deque<T, BufSize>::copy_assign(FIter first, FIter last, forward_iterator_tag) {  
   const size_type len1 = size();
   const size_type len2 = yastl::distance(first, last);
   if (len1 < len2) { // 需要额外插入
@@ -917,9 +1144,9 @@ void deque<T>::copy_assign(FIter first, FIter last, forward_iterator_tag) {
 }
 
 // insert_aux 函数
-template <class T>
+template <class T, size_t BufSize>
 template <class... Args>
-typename deque<T>::iterator deque<T>::insert_aux(iterator position, Args&& ...args) {
+typename deque<T, BufSize>::iterator deque<T, BufSize>::insert_aux(iterator position, Args&& ...args) {
   const size_type elems_before = position - begin_;
   value_type value_copy = value_type(yastl::forward<Args>(args)...);
   if (elems_before < (size() / 2)) { // 在前半段插入
@@ -946,8 +1173,8 @@ typename deque<T>::iterator deque<T>::insert_aux(iterator position, Args&& ...ar
 }
 
 // fill_insert 函数
-template <class T>
-void deque<T>::fill_insert(iterator position, size_type n, const value_type& value) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::fill_insert(iterator position, size_type n, const value_type& value) {
   const size_type elems_before = position - begin_;
   const size_type len = size();
   auto value_copy = value;
@@ -1004,9 +1231,9 @@ void deque<T>::fill_insert(iterator position, size_type n, const value_type& val
 }
 
 // copy_insert
-template <class T>
+template <class T, size_t BufSize>
 template <class FIter>
-void deque<T>::copy_insert(iterator position, FIter first, FIter last, size_type n) {
+void deque<T, BufSize>::copy_insert(iterator position, FIter first, FIter last, size_type n) {
   const size_type elems_before = position - begin_;
   auto len = size();
   if (elems_before < (len / 2)) { // 挪前面
@@ -1068,9 +1295,9 @@ void deque<T>::copy_insert(iterator position, FIter first, FIter last, size_type
 }
 
 // insert_dispatch 函数
-template <class T>
+template <class T, size_t BufSize>
 template <class IIter>
-void deque<T>::insert_dispatch(iterator position, IIter first, IIter last, input_iterator_tag) {
+void deque<T, BufSize>::insert_dispatch(iterator position, IIter first, IIter last, input_iterator_tag) {
   if (last <= first) {
     return;
   }
@@ -1088,9 +1315,9 @@ void deque<T>::insert_dispatch(iterator position, IIter first, IIter last, input
   }
 }
 
-template <class T>
+template <class T, size_t BufSize>
 template <class FIter>
-void deque<T>::
+void deque<T, BufSize>::
 insert_dispatch(iterator position, FIter first, FIter last, forward_iterator_tag)
 {
   if (last <= first) {
@@ -1127,17 +1354,17 @@ insert_dispatch(iterator position, FIter first, FIter last, forward_iterator_tag
 }
 
 // require_capacity 函数, 分配n个空间出来并创建对应map和buffer
-template <class T>
-void deque<T>::require_capacity(size_type n, bool front) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::require_capacity(size_type n, bool front) {
   if (front && (static_cast<size_type>(begin_.cur - begin_.first) < n)) { // 在前面分配
-    const size_type need_buffer = (n - (begin_.cur - begin_.first)) / buffer_size + 1;
+    const size_type need_buffer = (n - (begin_.cur - begin_.first) + buffer_size - 1) / buffer_size;
     if (need_buffer > static_cast<size_type>(begin_.node - map_)) { // 需要的node数不够了
       reallocate_map_at_front(need_buffer);
       return;
     }
     create_buffer(begin_.node - need_buffer, begin_.node - 1);
   } else if (!front && (static_cast<size_type>(end_.last - end_.cur - 1) < n)) { // 在后面分配
-    const size_type need_buffer = (n - (end_.last - end_.cur - 1)) / buffer_size + 1;
+    const size_type need_buffer = (n - (end_.last - end_.cur - 1) + buffer_size - 1) / buffer_size;
     if (need_buffer > static_cast<size_type>((map_ + map_size_) - end_.node - 1)) {
       reallocate_map_at_back(need_buffer);
       return;
@@ -1147,8 +1374,16 @@ void deque<T>::require_capacity(size_type n, bool front) {
 }
 
 // reallocate_map_at_front 函数, node数不够了在前面分配node
-template <class T>
-void deque<T>::reallocate_map_at_front(size_type need_buffer) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::reallocate_map_at_front(size_type need_buffer) {
+  const size_type old_used = end_.node - begin_.node + 1;
+  if (map_size_ > 2 * (old_used + need_buffer)) {
+    // map 足够大，只是有效节点偏到了尾部（例如作为队列使用时），把它们挪回中央即可，不必重新分配
+    auto new_start = map_ + (map_size_ - old_used - need_buffer) / 2 + need_buffer;
+    recenter_map(new_start);
+    create_buffer(new_start - need_buffer, new_start - 1);
+    return;
+  }
   const size_type new_map_size = yastl::max(map_size_ << 1, map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
   map_pointer new_map = create_map(new_map_size);
   const size_type old_buffer = end_.node - begin_.node + 1;
@@ -1172,8 +1407,16 @@ void deque<T>::reallocate_map_at_front(size_type need_buffer) {
 }
 
 // reallocate_map_at_back 函数, node数不够了，在后面分配node
-template <class T>
-void deque<T>::reallocate_map_at_back(size_type need_buffer) {
+template <class T, size_t BufSize>
+void deque<T, BufSize>::reallocate_map_at_back(size_type need_buffer) {
+  const size_type old_used = end_.node - begin_.node + 1;
+  if (map_size_ > 2 * (old_used + need_buffer)) {
+    // map 足够大，只是有效节点偏到了头部（例如作为队列使用时），把它们挪回中央即可，不必重新分配
+    auto new_start = map_ + (map_size_ - old_used - need_buffer) / 2;
+    recenter_map(new_start);
+    create_buffer(new_start + old_used, new_start + old_used + need_buffer - 1);
+    return;
+  }
   const size_type new_map_size = yastl::max(map_size_ << 1, map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
   map_pointer new_map = create_map(new_map_size);
   const size_type old_buffer = end_.node - begin_.node + 1;
@@ -1196,42 +1439,63 @@ void deque<T>::reallocate_map_at_back(size_type need_buffer) {
   end_ = iterator(*(mid - 1) + (end_.cur - end_.first), mid - 1);
 }
 
+// recenter_map 函数，把 [begin_.node, end_.node] 的节点整体挪到以 new_start 开头的位置
+template <class T, size_t BufSize>
+void deque<T, BufSize>::recenter_map(map_pointer new_start) {
+  const map_pointer old_start = begin_.node;
+  const map_pointer old_finish = end_.node + 1;
+  const map_pointer new_finish = new_start + (old_finish - old_start);
+  if (new_start < old_start) {
+    yastl::copy(old_start, old_finish, new_start);
+  } else {
+    yastl::copy_backward(old_start, old_finish, new_finish);
+  }
+  // 被腾出来的旧节点置空
+  for (auto cur = old_start; cur < old_finish; ++cur) {
+    if (cur < new_start || cur >= new_finish) {
+      *cur = nullptr;
+    }
+  }
+  begin_ = iterator(*new_start + (begin_.cur - begin_.first), new_start);
+  end_ = iterator(*(new_finish - 1) + (end_.cur - end_.first), new_finish - 1);
+}
+
 // 重载比较操作符
-template <class T>
-bool operator==(const deque<T>& lhs, const deque<T>& rhs) {
+template <class T, size_t BufSize>
+bool operator==(const deque<T, BufSize>& lhs, const deque<T, BufSize>& rhs) {
   return lhs.size() == rhs.size() && 
     yastl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <class T>
-bool operator<(const deque<T>& lhs, const deque<T>& rhs) {
+template <class T, size_t BufSize>
+bool operator<(const deque<T, BufSize>& lhs, const deque<T, BufSize>& rhs) {
   return yastl::lexicographical_compare(
     lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <class T>
-bool operator!=(const deque<T>& lhs, const deque<T>& rhs) {
+template <class T, size_t BufSize>
+bool operator!=(const deque<T, BufSize>& lhs, const deque<T, BufSize>& rhs) {
   return !(lhs == rhs);
 }
 
-template <class T>
-bool operator>(const deque<T>& lhs, const deque<T>& rhs) {
+template <class T, size_t BufSize>
+bool operator>(const deque<T, BufSize>& lhs, const deque<T, BufSize>& rhs) {
   return rhs < lhs;
 }
 
-template <class T>
-bool operator<=(const deque<T>& lhs, const deque<T>& rhs) {
+template <class T, size_t BufSize>
+bool operator<=(const deque<T, BufSize>& lhs, const deque<T, BufSize>& rhs) {
   return !(rhs < lhs);
 }
 
-template <class T>
-bool operator>=(const deque<T>& lhs, const deque<T>& rhs) {
+template <class T, size_t BufSize>
+bool operator>=(const deque<T, BufSize>& lhs, const deque<T, BufSize>& rhs) {
   return !(lhs < rhs);
 }
 
 // 重载 yastl 的 swap
-template <class T>
-void swap(deque<T>& lhs, deque<T>& rhs) {
+template <class T, size_t BufSize>
+void swap(deque<T, BufSize>& lhs, deque<T, BufSize>& rhs) {
   lhs.swap(rhs);
 }
 
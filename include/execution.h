@@ -0,0 +1,782 @@
+﻿#ifndef _INCLUDE_EXECUTION_H_
+#define _INCLUDE_EXECUTION_H_
+
+// 这个头文件包含了执行策略 yastl::execution::seq / par / par_unseq，以及带执行策略的算法重载
+// 目前支持 sort、stable_sort、nth_element、partial_sort、for_each、transform、reduce、count_if、find_if、copy、
+// merge、multiway_merge
+
+// notes:
+//
+// 策略为 par / par_unseq 且所有迭代器都是随机访问迭代器时，算法在 thread_pool::default_pool() 上并行执行，
+// 否则（包括策略为 seq）退化为 algo.h 中的串行版本，par_unseq 目前与 par 相同
+// 元素个数少于 2 * YASTL_PARALLEL_GRAIN 时不拆分任务，直接串行执行
+// 并行执行时函数对象会在多个线程中同时调用，调用者需要保证它们可以并发执行，reduce 的 op 需要满足结合律
+
+#include <cmath>
+
+#include "algo.h"
+#include "functional.h"
+#include "memory.h"
+#include "multiway_merge.h"
+#include "vector.h"
+#include "thread_pool.h"
+
+namespace yastl {
+
+// 每个任务至少处理的元素个数
+#ifndef YASTL_PARALLEL_GRAIN
+#define YASTL_PARALLEL_GRAIN 8192
+#endif
+
+namespace execution {
+
+struct sequenced_policy {};
+struct parallel_policy {};
+struct parallel_unsequenced_policy {};
+
+constexpr sequenced_policy seq{};
+constexpr parallel_policy par{};
+constexpr parallel_unsequenced_policy par_unseq{};
+
+} // namespace execution
+
+// is_execution_policy
+template <class T>
+struct is_execution_policy : m_false_type {};
+
+template <>
+struct is_execution_policy<execution::sequenced_policy> : m_true_type {};
+
+template <>
+struct is_execution_policy<execution::parallel_policy> : m_true_type {};
+
+template <>
+struct is_execution_policy<execution::parallel_unsequenced_policy> : m_true_type {};
+
+// 第一个参数是执行策略时才参与重载
+template <class ExecutionPolicy, class R>
+using enable_if_execution_policy =
+  typename std::enable_if<is_execution_policy<typename std::decay<ExecutionPolicy>::type>::value, R>::type;
+
+// 所有迭代器都是随机访问迭代器
+template <class... Iters>
+struct all_random_access_iterator : m_true_type {};
+
+template <class Iter, class... Rest>
+struct all_random_access_iterator<Iter, Rest...>
+  : m_bool_constant<is_random_access_iterator<Iter>::value && all_random_access_iterator<Rest...>::value> {};
+
+// 是否使用并行版本，用来做标签分派
+template <class ExecutionPolicy, class... Iters>
+struct parallel_dispatch
+  : m_bool_constant<!std::is_same<typename std::decay<ExecutionPolicy>::type, execution::sequenced_policy>::value &&
+                    all_random_access_iterator<Iters...>::value> {};
+
+/*****************************************************************************************/
+// 并行执行的辅助函数
+/*****************************************************************************************/
+
+// 把 n 个元素分成多少块
+template <class Size>
+Size parallel_chunk_count(Size n) {
+  const Size grain = static_cast<Size>(YASTL_PARALLEL_GRAIN);
+  const Size limit = static_cast<Size>(thread_pool::default_pool().size() * 4);
+  Size chunks = n / grain;
+  if (chunks > limit) {
+    chunks = limit;
+  }
+  return chunks < 1 ? 1 : chunks;
+}
+
+// 把 [0, n) 均匀分成 chunks 块，对第 i 块 [b, e) 调用 body(i, b, e)，最后一块在当前线程执行
+template <class Size, class Body>
+void parallel_run_chunks(Size n, Size chunks, Body body) {
+  if (chunks <= 1) {
+    body(Size(0), Size(0), n);
+    return;
+  }
+  task_group group(thread_pool::default_pool());
+  const Size step = n / chunks;
+  const Size rem = n % chunks;
+  Size b = 0;
+  for (Size i = 0; i < chunks; ++i) {
+    const Size e = b + step + (i < rem ? 1 : 0);
+    if (i + 1 < chunks) {
+      group.run([body, i, b, e]() { body(i, b, e); });
+    } else {
+      body(i, b, e);
+    }
+    b = e;
+  }
+  group.wait();
+}
+
+// 归并路径：在 a[0, n) 与 b[0, m) 归并的结果中，前 d 个元素有多少个来自 a，相等的元素 a 在前
+template <class Iter1, class Iter2, class Distance, class Compared>
+Distance merge_path_split(Iter1 a, Distance n, Iter2 b, Distance m, Distance d, Compared comp) {
+  Distance lo = d > m ? d - m : 0;
+  Distance hi = d < n ? d : n;
+  while (lo < hi) {
+    const Distance i = lo + (hi - lo) / 2;
+    const Distance j = d - i;
+    if (j > 0 && i < n && !comp(*(b + (j - 1)), *(a + i))) {
+      lo = i + 1;
+    } else {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+template <class Iter, class OutIter>
+void merge_assign(OutIter out, Iter in, m_true_type) {
+  *out = yastl::move(*in);
+}
+
+template <class Iter, class OutIter>
+void merge_assign(OutIter out, Iter in, m_false_type) {
+  *out = *in;
+}
+
+// 计算归并结果中 [d0, d1) 这一段，Move 为 m_true_type 时移动元素
+template <class Iter1, class Iter2, class OutIter, class Distance, class Compared, class Move>
+void merge_path_chunk(Iter1 a, Distance n, Iter2 b, Distance m, OutIter out,
+                      Distance d0, Distance d1, Compared comp, Move move_tag) {
+  Distance i = merge_path_split(a, n, b, m, d0, comp);
+  Distance j = d0 - i;
+  const Distance i1 = merge_path_split(a, n, b, m, d1, comp);
+  const Distance j1 = d1 - i1;
+  out += d0;
+  while (i < i1 && j < j1) {
+    if (comp(*(b + j), *(a + i))) {
+      merge_assign(out, b + j, move_tag);
+      ++j;
+    } else {
+      merge_assign(out, a + i, move_tag);
+      ++i;
+    }
+    ++out;
+  }
+  for (; i < i1; ++i, ++out) {
+    merge_assign(out, a + i, move_tag);
+  }
+  for (; j < j1; ++j, ++out) {
+    merge_assign(out, b + j, move_tag);
+  }
+}
+
+// 并行归并：按输出位置切块，每块用归并路径找到两段输入的起点
+template <class Iter1, class Iter2, class OutIter, class Compared, class Move>
+void parallel_merge_impl(Iter1 a, Iter1 a_last, Iter2 b, Iter2 b_last, OutIter out, Compared comp, Move move_tag) {
+  typedef typename iterator_traits<Iter1>::difference_type Distance;
+  const Distance n = a_last - a;
+  const Distance m = static_cast<Distance>(b_last - b);
+  const Distance total = n + m;
+  const Distance chunks = parallel_chunk_count(total);
+  const Distance step = total / chunks;
+  parallel_run_chunks(chunks, chunks, [=](Distance k, Distance, Distance) {
+    const Distance d0 = k * step;
+    const Distance d1 = k + 1 == chunks ? total : d0 + step;
+    merge_path_chunk(a, n, b, m, out, d0, d1, comp, move_tag);
+  });
+}
+
+/*****************************************************************************************/
+// for_each
+/*****************************************************************************************/
+template <class InputIter, class Function>
+void for_each_dispatch(InputIter first, InputIter last, Function f, m_false_type) {
+  yastl::for_each(first, last, f);
+}
+
+template <class RandomIter, class Function>
+void for_each_dispatch(RandomIter first, RandomIter last, Function f, m_true_type) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const Distance n = last - first;
+  parallel_run_chunks(n, parallel_chunk_count(n), [first, &f](Distance, Distance b, Distance e) {
+    for (RandomIter it = first + b, end = first + e; it != end; ++it) {
+      f(*it);
+    }
+  });
+}
+
+template <class ExecutionPolicy, class InputIter, class Function>
+enable_if_execution_policy<ExecutionPolicy, void>
+for_each(ExecutionPolicy&&, InputIter first, InputIter last, Function f) {
+  for_each_dispatch(first, last, f, parallel_dispatch<ExecutionPolicy, InputIter>());
+}
+
+/*****************************************************************************************/
+// transform
+/*****************************************************************************************/
+template <class InputIter, class OutputIter, class UnaryOperation>
+OutputIter transform_dispatch(InputIter first, InputIter last, OutputIter result, UnaryOperation unary_op,
+                              m_false_type) {
+  return yastl::transform(first, last, result, unary_op);
+}
+
+template <class RandomIter, class OutputIter, class UnaryOperation>
+OutputIter transform_dispatch(RandomIter first, RandomIter last, OutputIter result, UnaryOperation unary_op,
+                              m_true_type) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const Distance n = last - first;
+  parallel_run_chunks(n, parallel_chunk_count(n), [first, result, &unary_op](Distance, Distance b, Distance e) {
+    yastl::transform(first + b, first + e, result + b, unary_op);
+  });
+  return result + n;
+}
+
+template <class ExecutionPolicy, class InputIter, class OutputIter, class UnaryOperation>
+enable_if_execution_policy<ExecutionPolicy, OutputIter>
+transform(ExecutionPolicy&&, InputIter first, InputIter last, OutputIter result, UnaryOperation unary_op) {
+  return transform_dispatch(first, last, result, unary_op,
+                            parallel_dispatch<ExecutionPolicy, InputIter, OutputIter>());
+}
+
+template <class InputIter1, class InputIter2, class OutputIter, class BinaryOperation>
+OutputIter transform_dispatch(InputIter1 first1, InputIter1 last1, InputIter2 first2, OutputIter result,
+                              BinaryOperation binary_op, m_false_type) {
+  return yastl::transform(first1, last1, first2, result, binary_op);
+}
+
+template <class RandomIter1, class RandomIter2, class OutputIter, class BinaryOperation>
+OutputIter transform_dispatch(RandomIter1 first1, RandomIter1 last1, RandomIter2 first2, OutputIter result,
+                              BinaryOperation binary_op, m_true_type) {
+  typedef typename iterator_traits<RandomIter1>::difference_type Distance;
+  const Distance n = last1 - first1;
+  parallel_run_chunks(n, parallel_chunk_count(n), [=, &binary_op](Distance, Distance b, Distance e) {
+    yastl::transform(first1 + b, first1 + e, first2 + b, result + b, binary_op);
+  });
+  return result + n;
+}
+
+template <class ExecutionPolicy, class InputIter1, class InputIter2, class OutputIter, class BinaryOperation>
+enable_if_execution_policy<ExecutionPolicy, OutputIter>
+transform(ExecutionPolicy&&, InputIter1 first1, InputIter1 last1, InputIter2 first2, OutputIter result,
+          BinaryOperation binary_op) {
+  return transform_dispatch(first1, last1, first2, result, binary_op,
+                            parallel_dispatch<ExecutionPolicy, InputIter1, InputIter2, OutputIter>());
+}
+
+/*****************************************************************************************/
+// reduce
+// 以 op 把 [first, last) 与 init 归约为一个值，op 需要满足结合律和交换律，缺省使用 plus
+/*****************************************************************************************/
+template <class InputIter, class T, class BinaryOp>
+T reduce(InputIter first, InputIter last, T init, BinaryOp op) {
+  for (; first != last; ++first) {
+    init = op(init, *first);
+  }
+  return init;
+}
+
+template <class InputIter, class T>
+T reduce(InputIter first, InputIter last, T init) {
+  return yastl::reduce(first, last, init, yastl::plus<T>());
+}
+
+template <class InputIter>
+typename iterator_traits<InputIter>::value_type reduce(InputIter first, InputIter last) {
+  typedef typename iterator_traits<InputIter>::value_type T;
+  return yastl::reduce(first, last, T(), yastl::plus<T>());
+}
+
+template <class InputIter, class T, class BinaryOp>
+T reduce_dispatch(InputIter first, InputIter last, T init, BinaryOp op, m_false_type) {
+  return yastl::reduce(first, last, init, op);
+}
+
+// 每块先各自归约，再把各块的结果依次归约到 init 上
+template <class RandomIter, class T, class BinaryOp>
+T reduce_dispatch(RandomIter first, RandomIter last, T init, BinaryOp op, m_true_type) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const Distance n = last - first;
+  const Distance chunks = parallel_chunk_count(n);
+  if (chunks <= 1) {
+    return yastl::reduce(first, last, init, op);
+  }
+  yastl::vector<T> partial(static_cast<size_t>(chunks), init);
+  parallel_run_chunks(n, chunks, [first, &op, &partial](Distance i, Distance b, Distance e) {
+    T acc = *(first + b);
+    for (RandomIter it = first + b + 1, end = first + e; it != end; ++it) {
+      acc = op(acc, *it);
+    }
+    partial[static_cast<size_t>(i)] = yastl::move(acc);
+  });
+  for (size_t i = 0; i < partial.size(); ++i) {
+    init = op(init, partial[i]);
+  }
+  return init;
+}
+
+template <class ExecutionPolicy, class InputIter, class T, class BinaryOp>
+enable_if_execution_policy<ExecutionPolicy, T>
+reduce(ExecutionPolicy&&, InputIter first, InputIter last, T init, BinaryOp op) {
+  return reduce_dispatch(first, last, init, op, parallel_dispatch<ExecutionPolicy, InputIter>());
+}
+
+template <class ExecutionPolicy, class InputIter, class T>
+enable_if_execution_policy<ExecutionPolicy, T>
+reduce(ExecutionPolicy&&, InputIter first, InputIter last, T init) {
+  return reduce_dispatch(first, last, init, yastl::plus<T>(), parallel_dispatch<ExecutionPolicy, InputIter>());
+}
+
+template <class ExecutionPolicy, class InputIter>
+enable_if_execution_policy<ExecutionPolicy, typename iterator_traits<InputIter>::value_type>
+reduce(ExecutionPolicy&&, InputIter first, InputIter last) {
+  typedef typename iterator_traits<InputIter>::value_type T;
+  return reduce_dispatch(first, last, T(), yastl::plus<T>(), parallel_dispatch<ExecutionPolicy, InputIter>());
+}
+
+/*****************************************************************************************/
+// count_if
+/*****************************************************************************************/
+template <class InputIter, class UnaryPredicate>
+size_t count_if_dispatch(InputIter first, InputIter last, UnaryPredicate unary_pred, m_false_type) {
+  return yastl::count_if(first, last, unary_pred);
+}
+
+template <class RandomIter, class UnaryPredicate>
+size_t count_if_dispatch(RandomIter first, RandomIter last, UnaryPredicate unary_pred, m_true_type) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const Distance n = last - first;
+  std::atomic<size_t> total(0);
+  parallel_run_chunks(n, parallel_chunk_count(n), [first, &unary_pred, &total](Distance, Distance b, Distance e) {
+    total.fetch_add(yastl::count_if(first + b, first + e, unary_pred), std::memory_order_relaxed);
+  });
+  return total.load();
+}
+
+template <class ExecutionPolicy, class InputIter, class UnaryPredicate>
+enable_if_execution_policy<ExecutionPolicy, size_t>
+count_if(ExecutionPolicy&&, InputIter first, InputIter last, UnaryPredicate unary_pred) {
+  return count_if_dispatch(first, last, unary_pred, parallel_dispatch<ExecutionPolicy, InputIter>());
+}
+
+/*****************************************************************************************/
+// find_if
+// 各块记录已找到的最小下标，位置更靠后的块发现有更靠前的结果后提前结束
+/*****************************************************************************************/
+template <class InputIter, class UnaryPredicate>
+InputIter find_if_dispatch(InputIter first, InputIter last, UnaryPredicate unary_pred, m_false_type) {
+  return yastl::find_if(first, last, unary_pred);
+}
+
+template <class RandomIter, class UnaryPredicate>
+RandomIter find_if_dispatch(RandomIter first, RandomIter last, UnaryPredicate unary_pred, m_true_type) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const Distance n = last - first;
+  std::atomic<Distance> found(n);
+  parallel_run_chunks(n, parallel_chunk_count(n), [first, &unary_pred, &found](Distance, Distance b, Distance e) {
+    for (Distance i = b; i < e; ++i) {
+      if (found.load(std::memory_order_relaxed) < i) {
+        return;
+      }
+      if (unary_pred(*(first + i))) {
+        Distance cur = found.load(std::memory_order_relaxed);
+        while (i < cur && !found.compare_exchange_weak(cur, i, std::memory_order_relaxed)) {
+        }
+        return;
+      }
+    }
+  });
+  return first + found.load();
+}
+
+template <class ExecutionPolicy, class InputIter, class UnaryPredicate>
+enable_if_execution_policy<ExecutionPolicy, InputIter>
+find_if(ExecutionPolicy&&, InputIter first, InputIter last, UnaryPredicate unary_pred) {
+  return find_if_dispatch(first, last, unary_pred, parallel_dispatch<ExecutionPolicy, InputIter>());
+}
+
+/*****************************************************************************************/
+// copy
+/*****************************************************************************************/
+template <class InputIter, class OutputIter>
+OutputIter copy_dispatch(InputIter first, InputIter last, OutputIter result, m_false_type) {
+  return yastl::copy(first, last, result);
+}
+
+template <class RandomIter, class OutputIter>
+OutputIter copy_dispatch(RandomIter first, RandomIter last, OutputIter result, m_true_type) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const Distance n = last - first;
+  parallel_run_chunks(n, parallel_chunk_count(n), [first, result](Distance, Distance b, Distance e) {
+    yastl::copy(first + b, first + e, result + b);
+  });
+  return result + n;
+}
+
+template <class ExecutionPolicy, class InputIter, class OutputIter>
+enable_if_execution_policy<ExecutionPolicy, OutputIter>
+copy(ExecutionPolicy&&, InputIter first, InputIter last, OutputIter result) {
+  return copy_dispatch(first, last, result, parallel_dispatch<ExecutionPolicy, InputIter, OutputIter>());
+}
+
+/*****************************************************************************************/
+// merge
+/*****************************************************************************************/
+template <class InputIter1, class InputIter2, class OutputIter, class Compared>
+OutputIter merge_dispatch(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+                          OutputIter result, Compared comp, m_false_type) {
+  return yastl::merge(first1, last1, first2, last2, result, comp);
+}
+
+template <class RandomIter1, class RandomIter2, class OutputIter, class Compared>
+OutputIter merge_dispatch(RandomIter1 first1, RandomIter1 last1, RandomIter2 first2, RandomIter2 last2,
+                          OutputIter result, Compared comp, m_true_type) {
+  parallel_merge_impl(first1, last1, first2, last2, result, comp, m_false_type());
+  return result + ((last1 - first1) + (last2 - first2));
+}
+
+template <class ExecutionPolicy, class InputIter1, class InputIter2, class OutputIter, class Compared>
+enable_if_execution_policy<ExecutionPolicy, OutputIter>
+merge(ExecutionPolicy&&, InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+      OutputIter result, Compared comp) {
+  return merge_dispatch(first1, last1, first2, last2, result, comp,
+                        parallel_dispatch<ExecutionPolicy, InputIter1, InputIter2, OutputIter>());
+}
+
+template <class ExecutionPolicy, class InputIter1, class InputIter2, class OutputIter>
+enable_if_execution_policy<ExecutionPolicy, OutputIter>
+merge(ExecutionPolicy&&, InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+      OutputIter result) {
+  return merge_dispatch(first1, last1, first2, last2, result,
+                        yastl::less<typename iterator_traits<InputIter1>::value_type>(),
+                        parallel_dispatch<ExecutionPolicy, InputIter1, InputIter2, OutputIter>());
+}
+
+/*****************************************************************************************/
+// multiway_merge
+// 并行版本按输出位置均匀切块，先并行求出每个切分点在各路序列中的位置，再各块独立做 k 路归并
+/*****************************************************************************************/
+template <class SeqIter, class OutputIter, class Compared>
+OutputIter multiway_merge_dispatch(SeqIter seqs_first, SeqIter seqs_last, OutputIter result,
+                                   Compared comp, m_false_type) {
+  return yastl::multiway_merge(seqs_first, seqs_last, result, comp);
+}
+
+template <class SeqIter, class OutputIter, class Compared>
+OutputIter multiway_merge_dispatch(SeqIter seqs_first, SeqIter seqs_last, OutputIter result,
+                                   Compared comp, m_true_type) {
+  typedef typename iterator_traits<SeqIter>::value_type::first_type RandomIter;
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  const size_t k = static_cast<size_t>(seqs_last - seqs_first);
+  Distance total = 0;
+  for (size_t i = 0; i < k; ++i) {
+    total += seqs_first[i].second - seqs_first[i].first;
+  }
+  const Distance chunks = parallel_chunk_count(total);
+  if (k < 2 || chunks < 2) {
+    return yastl::multiway_merge(seqs_first, seqs_last, result, comp);
+  }
+  const Distance step = total / chunks;
+  // splits[c * k + i] 为第 c 个切分点在序列 i 中的位置，第 0 个与第 chunks 个是各序列的首尾
+  yastl::vector<Distance> splits(static_cast<size_t>(chunks + 1) * k, 0);
+  for (size_t i = 0; i < k; ++i) {
+    splits[static_cast<size_t>(chunks) * k + i] = seqs_first[i].second - seqs_first[i].first;
+  }
+  Distance* split = splits.begin();
+  parallel_run_chunks(chunks - 1, chunks - 1, [=](Distance c, Distance, Distance) {
+    yastl::multiway_merge_split(seqs_first, seqs_last, (c + 1) * step, split + (c + 1) * k, comp);
+  });
+  parallel_run_chunks(chunks, chunks, [=](Distance c, Distance, Distance) {
+    yastl::vector<yastl::pair<RandomIter, RandomIter>> parts(k);
+    for (size_t i = 0; i < k; ++i) {
+      parts[i].first = seqs_first[i].first + split[c * k + i];
+      parts[i].second = seqs_first[i].first + split[(c + 1) * k + i];
+    }
+    yastl::multiway_merge(parts.begin(), parts.end(), result + c * step, comp);
+  });
+  return result + total;
+}
+
+template <class ExecutionPolicy, class SeqIter, class OutputIter, class Compared>
+enable_if_execution_policy<ExecutionPolicy, OutputIter>
+multiway_merge(ExecutionPolicy&&, SeqIter seqs_first, SeqIter seqs_last, OutputIter result, Compared comp) {
+  typedef typename iterator_traits<SeqIter>::value_type::first_type RandomIter;
+  return multiway_merge_dispatch(seqs_first, seqs_last, result, comp,
+                                 parallel_dispatch<ExecutionPolicy, SeqIter, RandomIter, OutputIter>());
+}
+
+template <class ExecutionPolicy, class SeqIter, class OutputIter>
+enable_if_execution_policy<ExecutionPolicy, OutputIter>
+multiway_merge(ExecutionPolicy&&, SeqIter seqs_first, SeqIter seqs_last, OutputIter result) {
+  typedef typename iterator_traits<SeqIter>::value_type::first_type RandomIter;
+  return multiway_merge_dispatch(seqs_first, seqs_last, result,
+                                 yastl::less<typename iterator_traits<RandomIter>::value_type>(),
+                                 parallel_dispatch<ExecutionPolicy, SeqIter, RandomIter, OutputIter>());
+}
+
+/*****************************************************************************************/
+// sort / stable_sort
+// 并行版本先把区间分成 2 的幂次段并行排序，再借助临时缓冲区逐轮两两并行归并
+// 归并路径对相等元素总是先取前一段的，所以各段用 stable_sort 排序时整体也是稳定的
+/*****************************************************************************************/
+template <class RandomIter, class Compared>
+void sort_dispatch(RandomIter first, RandomIter last, Compared comp, m_false_type) {
+  yastl::sort(first, last, comp);
+}
+
+template <class RandomIter, class Compared>
+void stable_sort_dispatch(RandomIter first, RandomIter last, Compared comp, m_false_type) {
+  yastl::stable_sort(first, last, comp);
+}
+
+// 串行排序一段，Stable 为 m_true_type 时使用 stable_sort
+template <class RandomIter, class Compared>
+void parallel_sort_run(RandomIter first, RandomIter last, Compared comp, m_false_type) {
+  yastl::sort(first, last, comp);
+}
+
+template <class RandomIter, class Compared>
+void parallel_sort_run(RandomIter first, RandomIter last, Compared comp, m_true_type) {
+  yastl::stable_sort(first, last, comp);
+}
+
+// 把 src 中相邻的两段（每段 width 个元素）归并到 dst 的相同位置
+template <class SrcIter, class DstIter, class Distance, class Compared>
+void parallel_merge_round(SrcIter src, DstIter dst, Distance n, Distance width, Compared comp) {
+  task_group group(thread_pool::default_pool());
+  for (Distance lo = 0; lo < n; lo += 2 * width) {
+    const Distance mid = yastl::min(lo + width, n);
+    const Distance hi = yastl::min(lo + 2 * width, n);
+    const Distance len1 = mid - lo;
+    const Distance len2 = hi - mid;
+    const Distance total = hi - lo;
+    const Distance chunks = parallel_chunk_count(total);
+    const Distance step = total / chunks;
+    for (Distance k = 0; k < chunks; ++k) {
+      const Distance d0 = k * step;
+      const Distance d1 = k + 1 == chunks ? total : d0 + step;
+      group.run([=]() {
+        merge_path_chunk(src + lo, len1, src + mid, len2, dst + lo, d0, d1, comp, m_true_type());
+      });
+    }
+  }
+  group.wait();
+}
+
+template <class RandomIter, class Compared, class Stable>
+void parallel_merge_sort(RandomIter first, RandomIter last, Compared comp, Stable stable) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  typedef typename iterator_traits<RandomIter>::value_type T;
+  const Distance n = last - first;
+  Distance runs = 1;
+  while (runs * 2 <= parallel_chunk_count(n)) {
+    runs *= 2;
+  }
+  if (runs < 2) {
+    parallel_sort_run(first, last, comp, stable);
+    return;
+  }
+  // 各段并行排序
+  const Distance width = (n + runs - 1) / runs;
+  parallel_run_chunks(runs, runs, [=](Distance i, Distance, Distance) {
+    const Distance lo = yastl::min(i * width, n);
+    const Distance hi = yastl::min(lo + width, n);
+    parallel_sort_run(first + lo, first + hi, comp, stable);
+  });
+  temporary_buffer<RandomIter, T> buf(first, last);
+  if (buf.size() < n) {
+    // 申请不到足够的缓冲区，逐轮两两原地归并
+    for (Distance w = width; w < n; w *= 2) {
+      parallel_run_chunks((n + 2 * w - 1) / (2 * w), (n + 2 * w - 1) / (2 * w), [=](Distance i, Distance, Distance) {
+        const Distance lo = i * 2 * w;
+        yastl::inplace_merge(first + lo, first + yastl::min(lo + w, n), first + yastl::min(lo + 2 * w, n), comp);
+      });
+    }
+    return;
+  }
+  // 在原区间与缓冲区之间来回归并
+  bool in_buffer = false;
+  for (Distance w = width; w < n; w *= 2) {
+    if (in_buffer) {
+      parallel_merge_round(buf.begin(), first, n, w, comp);
+    } else {
+      parallel_merge_round(first, buf.begin(), n, w, comp);
+    }
+    in_buffer = !in_buffer;
+  }
+  if (in_buffer) {
+    T* src = buf.begin();
+    parallel_run_chunks(n, parallel_chunk_count(n), [src, first](Distance, Distance b, Distance e) {
+      yastl::move(src + b, src + e, first + b);
+    });
+  }
+}
+
+template <class RandomIter, class Compared>
+void sort_dispatch(RandomIter first, RandomIter last, Compared comp, m_true_type) {
+  parallel_merge_sort(first, last, comp, m_false_type());
+}
+
+template <class RandomIter, class Compared>
+void stable_sort_dispatch(RandomIter first, RandomIter last, Compared comp, m_true_type) {
+  parallel_merge_sort(first, last, comp, m_true_type());
+}
+
+template <class ExecutionPolicy, class RandomIter, class Compared>
+enable_if_execution_policy<ExecutionPolicy, void>
+sort(ExecutionPolicy&&, RandomIter first, RandomIter last, Compared comp) {
+  sort_dispatch(first, last, comp, parallel_dispatch<ExecutionPolicy, RandomIter>());
+}
+
+template <class ExecutionPolicy, class RandomIter>
+enable_if_execution_policy<ExecutionPolicy, void>
+sort(ExecutionPolicy&&, RandomIter first, RandomIter last) {
+  sort_dispatch(first, last, yastl::less<typename iterator_traits<RandomIter>::value_type>(),
+                parallel_dispatch<ExecutionPolicy, RandomIter>());
+}
+
+template <class ExecutionPolicy, class RandomIter, class Compared>
+enable_if_execution_policy<ExecutionPolicy, void>
+stable_sort(ExecutionPolicy&&, RandomIter first, RandomIter last, Compared comp) {
+  stable_sort_dispatch(first, last, comp, parallel_dispatch<ExecutionPolicy, RandomIter>());
+}
+
+template <class ExecutionPolicy, class RandomIter>
+enable_if_execution_policy<ExecutionPolicy, void>
+stable_sort(ExecutionPolicy&&, RandomIter first, RandomIter last) {
+  stable_sort_dispatch(first, last, yastl::less<typename iterator_traits<RandomIter>::value_type>(),
+                       parallel_dispatch<ExecutionPolicy, RandomIter>());
+}
+
+/*****************************************************************************************/
+// nth_element / partial_sort
+// 并行版本从区间中等距抽样并排序，取样本中排在 nth 前后的两个元素 lo、hi 作为枢轴，
+// 并行地把区间分成 < lo、[lo, hi]、> hi 三段：各块先计数，再按前缀和把元素移入缓冲区，最后移回原区间
+// nth 几乎总是落在很小的中间一段，区间小到不值得并行时改用串行的 nth_element
+// partial_sort 先并行 nth_element，再并行排序前 N 个元素
+/*****************************************************************************************/
+constexpr static size_t kParallelSelectSample = 4096;  // 每轮的样本大小
+
+template <class RandomIter, class Compared>
+void nth_element_dispatch(RandomIter first, RandomIter nth, RandomIter last, Compared comp, m_false_type) {
+  yastl::nth_element(first, nth, last, comp);
+}
+
+template <class RandomIter, class Compared>
+void nth_element_dispatch(RandomIter first, RandomIter nth, RandomIter last, Compared comp, m_true_type) {
+  typedef typename iterator_traits<RandomIter>::difference_type Distance;
+  typedef typename iterator_traits<RandomIter>::value_type T;
+  if (nth == last || parallel_chunk_count(last - first) < 2) {
+    yastl::nth_element(first, nth, last, comp);
+    return;
+  }
+  temporary_buffer<RandomIter, T> buf(first, last);
+  T* const tmp = buf.begin();
+  Distance n = last - first;
+  Distance chunks = parallel_chunk_count(n);
+  while (chunks >= 2 && buf.size() >= n) {
+    // 抽样并选出两个枢轴
+    const Distance m = yastl::min(n, static_cast<Distance>(kParallelSelectSample));
+    const Distance spread = static_cast<Distance>(2 * std::sqrt(static_cast<double>(m)));
+    yastl::vector<T> sample;
+    sample.reserve(static_cast<size_t>(m));
+    for (Distance i = 0; i < m; ++i) {
+      sample.push_back(*(first + (n / m) * i));
+    }
+    yastl::sort(sample.begin(), sample.end(), comp);
+    const Distance rank = static_cast<Distance>(static_cast<double>(nth - first) / n * m);
+    const T lo = sample[static_cast<size_t>(yastl::max(rank - spread, static_cast<Distance>(0)))];
+    const T hi = sample[static_cast<size_t>(yastl::min(rank + spread, m - 1))];
+
+    // 各块统计三段的元素个数，再求出各块在每一段中的起始位置
+    yastl::vector<Distance> offset(static_cast<size_t>(3 * chunks), 0);
+    Distance* const off = offset.begin();
+    parallel_run_chunks(n, chunks, [=](Distance c, Distance b, Distance e) {
+      Distance low = 0;
+      Distance mid = 0;
+      for (RandomIter i = first + b; i != first + e; ++i) {
+        if (comp(*i, lo)) {
+          ++low;
+        } else if (!comp(hi, *i)) {
+          ++mid;
+        }
+      }
+      off[3 * c] = low;
+      off[3 * c + 1] = mid;
+      off[3 * c + 2] = (e - b) - low - mid;
+    });
+    Distance total[3] = {0, 0, 0};
+    for (Distance c = 0; c < chunks; ++c) {
+      for (int part = 0; part < 3; ++part) {
+        const Distance cnt = off[3 * c + part];
+        off[3 * c + part] = total[part];
+        total[part] += cnt;
+      }
+    }
+    const Distance base[3] = {0, total[0], total[0] + total[1]};
+    parallel_run_chunks(n, chunks, [=](Distance c, Distance b, Distance e) {
+      T* out[3] = {tmp + base[0] + off[3 * c], tmp + base[1] + off[3 * c + 1], tmp + base[2] + off[3 * c + 2]};
+      for (RandomIter i = first + b; i != first + e; ++i) {
+        const int part = comp(*i, lo) ? 0 : (comp(hi, *i) ? 2 : 1);
+        *out[part]++ = yastl::move(*i);
+      }
+    });
+    parallel_run_chunks(n, chunks, [=](Distance, Distance b, Distance e) {
+      yastl::move(tmp + b, tmp + e, first + b);
+    });
+
+    // 继续处理包含 nth 的一段
+    const Distance k = nth - first;
+    if (k < base[1]) {
+      last = first + base[1];
+    } else if (k < base[2]) {
+      if (!comp(lo, hi)) { // 中间一段的元素都相等
+        return;
+      }
+      last = first + base[2];
+      first += base[1];
+    } else {
+      first += base[2];
+    }
+    if (last - first == n) { // 没有缩小
+      break;
+    }
+    n = last - first;
+    chunks = parallel_chunk_count(n);
+  }
+  yastl::nth_element(first, nth, last, comp);
+}
+
+template <class ExecutionPolicy, class RandomIter, class Compared>
+enable_if_execution_policy<ExecutionPolicy, void>
+nth_element(ExecutionPolicy&&, RandomIter first, RandomIter nth, RandomIter last, Compared comp) {
+  nth_element_dispatch(first, nth, last, comp, parallel_dispatch<ExecutionPolicy, RandomIter>());
+}
+
+template <class ExecutionPolicy, class RandomIter>
+enable_if_execution_policy<ExecutionPolicy, void>
+nth_element(ExecutionPolicy&&, RandomIter first, RandomIter nth, RandomIter last) {
+  nth_element_dispatch(first, nth, last, yastl::less<typename iterator_traits<RandomIter>::value_type>(),
+                       parallel_dispatch<ExecutionPolicy, RandomIter>());
+}
+
+template <class RandomIter, class Compared>
+void partial_sort_dispatch(RandomIter first, RandomIter middle, RandomIter last, Compared comp, m_false_type) {
+  yastl::partial_sort(first, middle, last, comp);
+}
+
+template <class RandomIter, class Compared>
+void partial_sort_dispatch(RandomIter first, RandomIter middle, RandomIter last, Compared comp, m_true_type) {
+  nth_element_dispatch(first, middle, last, comp, m_true_type());
+  sort_dispatch(first, middle, comp, m_true_type());
+}
+
+template <class ExecutionPolicy, class RandomIter, class Compared>
+enable_if_execution_policy<ExecutionPolicy, void>
+partial_sort(ExecutionPolicy&&, RandomIter first, RandomIter middle, RandomIter last, Compared comp) {
+  partial_sort_dispatch(first, middle, last, comp, parallel_dispatch<ExecutionPolicy, RandomIter>());
+}
+
+template <class ExecutionPolicy, class RandomIter>
+enable_if_execution_policy<ExecutionPolicy, void>
+partial_sort(ExecutionPolicy&&, RandomIter first, RandomIter middle, RandomIter last) {
+  partial_sort_dispatch(first, middle, last, yastl::less<typename iterator_traits<RandomIter>::value_type>(),
+                        parallel_dispatch<ExecutionPolicy, RandomIter>());
+}
+
+} // namespace yastl
+#endif // _INCLUDE_EXECUTION_H_
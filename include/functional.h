@@ -269,21 +269,21 @@ inline size_t bitwise_hash(const unsigned char* first, size_t count)
 
 template <>
 struct hash<float> {
-  size_t operator()(const float& val) { 
+  size_t operator()(const float& val) const noexcept {
     return val == 0.0f ? 0 : bitwise_hash((const unsigned char*)&val, sizeof(float));
   }
 };
 
 template <>
 struct hash<double> {
-  size_t operator()(const double& val) {
+  size_t operator()(const double& val) const noexcept {
     return val == 0.0f ? 0 : bitwise_hash((const unsigned char*)&val, sizeof(double));
   }
 };
 
 template <>
 struct hash<long double> {
-  size_t operator()(const long double& val) {
+  size_t operator()(const long double& val) const noexcept {
     return val == 0.0f ? 0 : bitwise_hash((const unsigned char*)&val, sizeof(long double));
   }
 };
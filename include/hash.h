@@ -0,0 +1,304 @@
+﻿#ifndef _INCLUDE_HASH_H_
+#define _INCLUDE_HASH_H_
+
+// 这个头文件包含了字节序列与整数的哈希函数 hash_bytes、hash_mix，组合多个哈希值的 hash_combine，
+// 对整数做充分混合的 mixed_hash，带随机种子的 seeded_hash，
+// 以及 std::basic_string / std::basic_string_view 的 yastl::hash 特化
+
+// notes:
+//
+// hash_bytes 是 wyhash 风格的 64 位哈希，核心是 64 x 64 -> 128 位乘法再把高低两半异或（hash_mum）：
+//   不超过 16 字节时读两次可能重叠的 4 / 8 字节，只做两次乘法
+//   不超过 kHashLongThreshold 字节时每轮用三路互不依赖的乘法吸收 48 字节
+//   更长的输入按 xxh3 的方式把 64 字节的条带累加到 8 个累加器上（simd.h 中的 simd_hash_stripes），
+//   每 kHashBlockStripes 个条带扰乱一次累加器，最后折叠成 64 位，剩下不足一个条带的部分再按上面的方式吸收
+// 结果只在同一平台上稳定，不要写入文件或在机器之间传递
+// yastl::hash<int> 等整数哈希仍然返回原值：hashtable 的桶数是质数，取余已经能把连续的键值分散开，
+// 键值的分布有规律并且低位相同（如都是 8 的倍数的地址）或者自己实现 2 的幂次个桶的表时，使用 mixed_hash
+// 键值来自不可信的输入时使用 seeded_hash：每个对象构造时取一个随机种子，不知道种子就无法构造落在同一个桶中的键值，
+// hashtable 发现某个桶的链表过长时会调用它的 reseed 换一个种子并重新分配所有节点
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#include "functional.h"
+#include "simd.h"
+
+namespace yastl {
+
+// wyhash 的常数
+constexpr static uint64_t kHashSecret0 = 0xa0761d6478bd642full;
+constexpr static uint64_t kHashSecret1 = 0xe7037ed1a0b428dbull;
+constexpr static uint64_t kHashSecret2 = 0x8ebc6af09c88c6e3ull;
+constexpr static uint64_t kHashSecret3 = 0x589965cc75374cc3ull;
+
+constexpr static size_t kHashLongThreshold = 256;  // 超过这个长度使用条带累加
+constexpr static size_t kHashBlockStripes = 16;    // 每 16 个条带（1 KB）扰乱一次累加器
+
+// 条带累加的密钥：第 s 个条带使用 [s, s + 8)，扰乱使用 [16, 24)，折叠使用 [11, 19)
+constexpr static uint64_t kHashStripeSecret[kHashBlockStripes + 8] = {
+  0x2cb0f69f4abea221ull, 0x9417034723148989ull, 0xdd555950609dfe03ull,
+  0xdbafb150deb12800ull, 0x7e789b2e6c442cb6ull, 0xf41e5636c7e4f8c4ull,
+  0x0959d150f8fba7e4ull, 0xa97316f13cdb9eeaull, 0x74cd8258f9520068ull,
+  0x55c74a62e116868bull, 0xd2f4c799a2023cbdull, 0xdf98cb79a37b51b9ull,
+  0x396f5885524f3905ull, 0xaf1d56386ca3b276ull, 0xa9ffbe6b5104e85aull,
+  0x6bd0c51b9fd533b3ull, 0x980ce91c50ab4b56ull, 0x28ac395780fe62c5ull,
+  0x768912e3a6bcedc7ull, 0x50b3e8c9332c7c88ull, 0xce3bbfe520bd47daull,
+  0xcba6c8e8e0bb7c4full, 0xbf194db8434a346dull, 0x7d8f2a7b60416d7full,
+};
+
+/*****************************************************************************************/
+// 基本运算
+/*****************************************************************************************/
+
+// 计算 a * b 的 128 位乘积，低 64 位写回 a，高 64 位写回 b
+inline void hash_mum128(uint64_t& a, uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+  __extension__ typedef unsigned __int128 uint128;
+  const uint128 r = static_cast<uint128>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+#else
+  const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+  const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  const uint64_t t = rl + (rm0 << 32);
+  uint64_t carry = t < rl ? 1 : 0;
+  const uint64_t lo = t + (rm1 << 32);
+  carry += lo < t ? 1 : 0;
+  a = lo;
+  b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+// 128 位乘积的高低两半异或
+inline uint64_t hash_mum(uint64_t a, uint64_t b) noexcept {
+  hash_mum128(a, b);
+  return a ^ b;
+}
+
+// 整数混合：每一位输入都会影响输出的所有位，用于整数键值
+inline uint64_t hash_mix(uint64_t x) noexcept {
+  return hash_mum(x ^ kHashSecret0, kHashSecret1);
+}
+
+inline uint64_t hash_read8(const unsigned char* p) noexcept {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t hash_read4(const unsigned char* p) noexcept {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// 把 stripes 个 64 字节的条带累加后折叠为 64 位
+inline uint64_t hash_stripes(const unsigned char* p, size_t stripes, uint64_t seed) noexcept {
+  uint64_t acc[8];
+  for (size_t i = 0; i < 8; ++i) {
+    acc[i] = kHashStripeSecret[i] ^ seed;
+  }
+  while (stripes != 0) {
+    const size_t n = stripes < kHashBlockStripes ? stripes : kHashBlockStripes;
+    simd_hash_stripes<uint64_t>(acc, p, n, kHashStripeSecret);
+    p += n * 64;
+    stripes -= n;
+    if (n == kHashBlockStripes) {
+      for (size_t i = 0; i < 8; ++i) {
+        acc[i] = (acc[i] ^ (acc[i] >> 47) ^ kHashStripeSecret[kHashBlockStripes + i]) * 0x9e3779b1u;
+      }
+    }
+  }
+  uint64_t result = seed;
+  for (size_t i = 0; i < 4; ++i) {
+    result += hash_mum(acc[2 * i] ^ kHashStripeSecret[11 + 2 * i], acc[2 * i + 1] ^ kHashStripeSecret[12 + 2 * i]);
+  }
+  return result;
+}
+
+/*****************************************************************************************/
+// hash_bytes
+// 计算 [key, key + len) 的 64 位哈希值，seed 不同时得到互不相关的哈希函数
+/*****************************************************************************************/
+inline uint64_t hash_bytes(const void* key, size_t len, uint64_t seed = 0) noexcept {
+  const unsigned char* p = static_cast<const unsigned char*>(key);
+  seed ^= hash_mum(seed ^ kHashSecret0, kHashSecret1);
+  uint64_t a;
+  uint64_t b;
+  if (len <= 16) {
+    if (len >= 4) {
+      const size_t mid = (len >> 3) << 2;  // 长度不小于 8 时读取的第二个位置
+      a = (hash_read4(p) << 32) | hash_read4(p + mid);
+      b = (hash_read4(p + len - 4) << 32) | hash_read4(p + len - 4 - mid);
+    } else if (len > 0) {
+      a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+      b = 0;
+    } else {
+      a = 0;
+      b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (len > kHashLongThreshold) {
+      seed = hash_stripes(p, len / 64, seed);
+      p += len / 64 * 64;
+      i = len % 64;
+    }
+    if (i > 48) {
+      uint64_t see1 = seed;
+      uint64_t see2 = seed;
+      do {
+        seed = hash_mum(hash_read8(p) ^ kHashSecret1, hash_read8(p + 8) ^ seed);
+        see1 = hash_mum(hash_read8(p + 16) ^ kHashSecret2, hash_read8(p + 24) ^ see1);
+        see2 = hash_mum(hash_read8(p + 32) ^ kHashSecret3, hash_read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = hash_mum(hash_read8(p) ^ kHashSecret1, hash_read8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    // 最后 16 个字节可能与已经吸收过的部分重叠，总长度大于 16，不会越界
+    a = hash_read8(p + i - 16);
+    b = hash_read8(p + i - 8);
+  }
+  a ^= kHashSecret1;
+  b ^= seed;
+  hash_mum128(a, b);
+  return hash_mum(a ^ kHashSecret0 ^ len, b ^ kHashSecret1);
+}
+
+/*****************************************************************************************/
+// hash_combine
+// 把 value 的哈希值组合进 seed，结果与组合的顺序有关
+/*****************************************************************************************/
+template <class T>
+inline void hash_combine(size_t& seed, const T& value) {
+  const uint64_t h = static_cast<uint64_t>(yastl::hash<T>()(value));
+  seed = static_cast<size_t>(hash_mum(static_cast<uint64_t>(seed) ^ kHashSecret0, h ^ kHashSecret1));
+}
+
+/*****************************************************************************************/
+// mixed_hash
+// 对 Hash 的结果再做一次 hash_mix
+/*****************************************************************************************/
+template <class Key, class Hash = yastl::hash<Key>>
+struct mixed_hash {
+  Hash hf;
+
+  mixed_hash(const Hash& h = Hash()) : hf(h) {}
+
+  size_t operator()(const Key& key) const {
+    return static_cast<size_t>(hash_mix(static_cast<uint64_t>(hf(key))));
+  }
+};
+
+/*****************************************************************************************/
+// seeded_hash
+// 带种子的哈希函数，种子默认从 hash_random_seed 取得
+// 整数、枚举与指针直接按值混合，字符串用 hash_bytes 并以种子作为它的 seed，其他类型混合 yastl::hash 的结果
+/*****************************************************************************************/
+
+// 进程的初始熵：random_device 不可用时退化为时钟与栈地址
+inline uint64_t hash_initial_entropy() noexcept {
+  uint64_t entropy = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  entropy ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&entropy));
+  try {
+    std::random_device rd;
+    entropy ^= (static_cast<uint64_t>(rd()) << 32) ^ rd();
+  } catch (...) {
+  }
+  return entropy;
+}
+
+// 每次调用返回一个新的随机种子，可以在多个线程中同时调用
+inline uint64_t hash_random_seed() noexcept {
+  static std::atomic<uint64_t> state(hash_initial_entropy());
+  return hash_mix(state.fetch_add(kHashSecret2, std::memory_order_relaxed));
+}
+
+template <class T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, uint64_t>::type
+hash_seeded(T value, uint64_t seed) noexcept {
+  const uint64_t h = hash_mum(static_cast<uint64_t>(value) ^ seed, kHashSecret1);
+  return hash_mum(h ^ seed, kHashSecret2);
+}
+
+template <class T>
+inline uint64_t hash_seeded(T* p, uint64_t seed) noexcept {
+  return hash_seeded(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p)), seed);
+}
+
+template <class CharT, class Traits, class Alloc>
+inline uint64_t hash_seeded(const std::basic_string<CharT, Traits, Alloc>& s, uint64_t seed) noexcept {
+  return hash_bytes(s.data(), s.size() * sizeof(CharT), seed);
+}
+
+#if __cplusplus >= 201703L
+template <class CharT, class Traits>
+inline uint64_t hash_seeded(std::basic_string_view<CharT, Traits> s, uint64_t seed) noexcept {
+  return hash_bytes(s.data(), s.size() * sizeof(CharT), seed);
+}
+#endif
+
+template <class T>
+inline typename std::enable_if<!std::is_integral<T>::value && !std::is_enum<T>::value, uint64_t>::type
+hash_seeded(const T& value, uint64_t seed) {
+  return hash_seeded(static_cast<uint64_t>(yastl::hash<T>()(value)), seed);
+}
+
+template <class Key>
+class seeded_hash {
+private:
+  uint64_t seed_;
+
+public:
+  seeded_hash() : seed_(hash_random_seed()) {}
+  explicit seeded_hash(uint64_t seed) : seed_(seed) {}
+
+  size_t operator()(const Key& key) const {
+    return static_cast<size_t>(hash_seeded(key, seed_));
+  }
+
+  uint64_t seed() const noexcept {
+    return seed_;
+  }
+
+  // 换一个种子，之前计算的哈希值全部失效
+  void reseed(uint64_t seed) noexcept {
+    seed_ = seed;
+  }
+};
+
+/*****************************************************************************************/
+// 字符串的哈希函数
+/*****************************************************************************************/
+template <class CharT, class Traits, class Alloc>
+struct hash<std::basic_string<CharT, Traits, Alloc>> {
+  size_t operator()(const std::basic_string<CharT, Traits, Alloc>& s) const noexcept {
+    return static_cast<size_t>(hash_bytes(s.data(), s.size() * sizeof(CharT)));
+  }
+};
+
+#if __cplusplus >= 201703L
+template <class CharT, class Traits>
+struct hash<std::basic_string_view<CharT, Traits>> {
+  size_t operator()(std::basic_string_view<CharT, Traits> s) const noexcept {
+    return static_cast<size_t>(hash_bytes(s.data(), s.size() * sizeof(CharT)));
+  }
+};
+#endif
+
+} // namespace yastl
+#endif // _INCLUDE_HASH_H_
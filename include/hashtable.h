@@ -4,10 +4,19 @@
 // 这个头文件包含了一个模板类 hashtable
 // hashtable : 哈希表，使用开链法处理冲突
 
+// notes:
+//
+// Hash 有成员函数 reseed(uint64_t)（如 hash.h 中的 seeded_hash）时，插入新节点后若所在桶的链表长度超过
+// kHtChainLimit * max(1, max_load_factor)，就给 Hash 换一个随机种子并把所有节点重新分配到桶中，
+// 用来抵御精心构造的、哈希值落在同一个桶中的键值；元素个数每翻一倍最多重新分配一次，重复键值形成的长链不会反复触发
+// bucket_count 为 0 时（各 unordered 容器的默认构造）不分配桶，所有空表共用一个只有一条空链表的静态桶 ht_empty_bucket，
+// 查找照常取余、遍历这个空链表，不需要特判；第一次插入时才分配真正的桶
+
 #include <initializer_list>
 
 #include "algo.h"
 #include "functional.h"
+#include "hash.h"
 #include "memory.h"
 #include "vector.h"
 #include "util.h"
@@ -448,6 +457,25 @@ static constexpr size_t ht_prime_list[] = {
 
 #endif
 
+// 链表长度的上限，超过时给可以换种子的 Hash 换种子
+constexpr static size_t kHtChainLimit = 32;
+
+// 所有还没有分配桶的 hashtable 共用的桶，只有一条空链表，不会被写入
+template <class T>
+struct ht_empty_bucket {
+  static hashtable_node<T>* bucket[1];
+};
+
+template <class T>
+hashtable_node<T>* ht_empty_bucket<T>::bucket[1] = {nullptr};
+
+// Hash 是否有成员函数 reseed(uint64_t)
+template <class Hash, class = void>
+struct ht_reseedable : m_false_type {};
+
+template <class Hash>
+struct ht_reseedable<Hash, decltype(std::declval<Hash&>().reseed(uint64_t()), void())> : m_true_type {};
+
 // 找出最接近并 >=n 的那个质数
 inline size_t ht_next_prime(size_t n) {
   const size_t* first = ht_prime_list;
@@ -475,7 +503,7 @@ public:
 
   typedef hashtable_node<T> node_type;
   typedef node_type* node_ptr;
-  typedef yastl::vector<node_ptr> bucket_type; // 桶的类别 vector，元素为指向 hashnode 的指针
+  typedef yastl::allocator<node_ptr> bucket_allocator; // 桶的数组，元素为指向 hashnode 的指针
 
   typedef yastl::allocator<T> allocator_type;
   typedef yastl::allocator<T> data_allocator;
@@ -499,12 +527,13 @@ public:
 
 private:
   // 用以下六个参数来表现 hashtable
-  bucket_type buckets_; // 桶的 vector
+  node_ptr* buckets_; // 桶的数组，没有分配时指向 ht_empty_bucket
   size_type bucket_size_; // 桶的数量
   size_type size_; // 元素个数
   float mlf_; // max load factor 最大负载系数
   hasher hash_; // 哈希函数
   key_equal equal_; // 键值相等的比较函数
+  size_type reseed_size_; // 上一次换种子时的元素个数
 
 private:
   bool is_equal(const key_type& key1, const key_type& key2) {
@@ -515,6 +544,11 @@ private:
     return equal_(key1, key2);
   }
 
+  // 是否还在使用共享的空桶
+  bool empty_bucket() const noexcept {
+    return buckets_ == ht_empty_bucket<T>::bucket;
+  }
+
   // change const iterator 把 node 强制转换为指向 hashtable 的 const 指针
   const_iterator M_cit(node_ptr node) const noexcept {
     return const_iterator(node, const_cast<hashtable*>(this));
@@ -544,30 +578,31 @@ public:
 
   // 构造函数
   explicit hashtable(size_type bucket_count, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
-    : size_(0), mlf_(1.0f), hash_(hash), equal_(equal) {
+    : size_(0), mlf_(1.0f), hash_(hash), equal_(equal), reseed_size_(0) {
     init(bucket_count);
   }
 
   // 调用迭代器构造
   template <class Iter, typename std::enable_if<yastl::is_input_iterator<Iter>::value, int>::type = 0>
     hashtable(Iter first, Iter last, size_type bucket_count, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
-    : size_(yastl::distance(first, last)), mlf_(1.0f), hash_(hash), equal_(equal) {
+    : size_(yastl::distance(first, last)), mlf_(1.0f), hash_(hash), equal_(equal), reseed_size_(0) {
     init(yastl::max(bucket_count, static_cast<size_type>(yastl::distance(first, last))));
   }
 
   // 拷贝构造
-  hashtable(const hashtable& rhs) : hash_(rhs.hash_), equal_(rhs.equal_) {
+  hashtable(const hashtable& rhs) : hash_(rhs.hash_), equal_(rhs.equal_), reseed_size_(rhs.reseed_size_) {
     copy_init(rhs);
   }
 
   // 移动构造
-  hashtable(hashtable&& rhs) noexcept : bucket_size_(rhs.bucket_size_), 
+  hashtable(hashtable&& rhs) noexcept : buckets_(rhs.buckets_),
+    bucket_size_(rhs.bucket_size_), 
     size_(rhs.size_),
     mlf_(rhs.mlf_),
     hash_(rhs.hash_),
-    equal_(rhs.equal_) {
-    buckets_ = yastl::move(rhs.buckets_);
-    rhs.bucket_size_ = 0;
+    equal_(rhs.equal_),
+    reseed_size_(rhs.reseed_size_) {
+    rhs.reset_bucket();
     rhs.size_ = 0;
     rhs.mlf_ = 0.0f;
   }
@@ -577,6 +612,7 @@ public:
 
   ~hashtable() {
     clear();
+    deallocate_bucket();
   }
 
   // 迭代器相关操作
@@ -633,6 +669,10 @@ public:
     return emplace_unique(yastl::forward<Args>(args)...).first;
   }
 
+  // 先按 key 查找，key 不存在时才申请节点，用 key 与 args 构造 value，key 已存在时 args 不会被使用
+  template <class K, class ...Args>
+  pair<iterator, bool> try_emplace_unique(K&& key, Args&& ...args);
+
   // insert
   // 不需要重新 hash 的方式
   iterator insert_multi_noresize(const value_type& value);
@@ -652,9 +692,8 @@ public:
     return insert_unique_noresize(value);
   }
 
-  pair<iterator, bool> insert_unique(value_type&& value) {
-    return emplace_unique(yastl::move(value));
-  }
+  // 先查找再申请节点，重复的 value 不会被移动
+  pair<iterator, bool> insert_unique(value_type&& value);
 
   // [note]: 同 emplace_hint
   iterator insert_multi_use_hint(const_iterator /*hint*/, const value_type& value) {
@@ -669,7 +708,7 @@ public:
     return insert_unique(value).first;
   }
   iterator insert_unique_use_hint(const_iterator /*hint*/, value_type&& value) {
-    return emplace_unique(yastl::move(value));
+    return insert_unique(yastl::move(value)).first;
   }
 
   // 插入[first, last) 内的元素到 hashtable 中，允许重复
@@ -795,6 +834,18 @@ private:
   void init(size_type n);
   void copy_init(const hashtable& ht);
 
+  // bucket
+  static node_ptr* allocate_bucket(size_type n);
+  void deallocate_bucket() noexcept {
+    if (!empty_bucket()) {
+      bucket_allocator::deallocate(buckets_, bucket_size_);
+    }
+  }
+  void reset_bucket() noexcept {
+    buckets_ = ht_empty_bucket<T>::bucket;
+    bucket_size_ = 1;
+  }
+
   // node
   template <class ...Args>
   node_ptr create_node(Args&& ...args);
@@ -818,8 +869,18 @@ private:
 
   // insert node
   pair<iterator, bool> insert_node_unique(node_ptr np);
+  iterator insert_new_node_unique(node_ptr np, size_type code);
   iterator insert_node_multi(node_ptr np);
 
+  // 链表长度检查，长度超过上限时换种子并重新分配节点
+  void check_chain(size_type length) {
+    if (length > kHtChainLimit && (float)length > (float)kHtChainLimit * max_load_factor()) {
+      reseed(ht_reseedable<Hash>());
+    }
+  }
+  void reseed(m_true_type);
+  void reseed(m_false_type) {}
+
   // bucket operator
   void replace_bucket(size_type bucket_count);
   void erase_bucket(size_type n, node_ptr first, node_ptr last);
@@ -860,9 +921,7 @@ typename hashtable<T, Hash, KeyEqual>::iterator
 hashtable<T, Hash, KeyEqual>::emplace_multi(Args&& ...args) {
   auto np = create_node(yastl::forward<Args>(args)...);
   try {
-    if ((float)(size_ + 1) > (float)bucket_size_ * max_load_factor()) { // 元素个数超过负载数
-      rehash(size_ + 1);
-    }
+    rehash_if_need(1); // 元素个数超过负载数
   } catch (...) {
     destroy_node(np);
     throw;
@@ -878,9 +937,7 @@ pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
 hashtable<T, Hash, KeyEqual>::emplace_unique(Args&& ...args) {
   auto np = create_node(yastl::forward<Args>(args)...);
   try {
-    if ((float)(size_ + 1) > (float)bucket_size_ * max_load_factor()) {
-      rehash(size_ + 1);
-    }
+    rehash_if_need(1);
   } catch (...) {
     destroy_node(np);
     throw;
@@ -888,13 +945,52 @@ hashtable<T, Hash, KeyEqual>::emplace_unique(Args&& ...args) {
   return insert_node_unique(np);
 }
 
+// 先用 key 查找，不存在时才构造节点，节点的值由 key 和 mapped_type(args...) 构造
+// key 的哈希值只计算一次，重复的 key 不会申请和释放节点
+template <class T, class Hash, class KeyEqual>
+template <class K, class ...Args>
+pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
+hashtable<T, Hash, KeyEqual>::try_emplace_unique(K&& key, Args&& ...args) {
+  typedef typename value_traits::mapped_type mapped_type;
+  const size_type code = hash_(key);
+  size_type length = 0;
+  for (node_ptr cur = buckets_[code % bucket_size_]; cur; cur = cur->next, ++length) {
+    if (is_equal(value_traits::get_key(cur->value), key)) {
+      return yastl::make_pair(iterator(cur, this), false);
+    }
+  }
+  auto np = create_node(yastl::forward<K>(key), mapped_type(yastl::forward<Args>(args)...));
+  auto it = insert_new_node_unique(np, code);
+  check_chain(length + 1);
+  return yastl::make_pair(it, true);
+}
+
+// 插入右值，先查找再申请节点
+template <class T, class Hash, class KeyEqual>
+pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
+hashtable<T, Hash, KeyEqual>::insert_unique(value_type&& value) {
+  const size_type code = hash_(value_traits::get_key(value));
+  size_type length = 0;
+  for (node_ptr cur = buckets_[code % bucket_size_]; cur; cur = cur->next, ++length) {
+    if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(value))) {
+      return yastl::make_pair(iterator(cur, this), false);
+    }
+  }
+  auto np = create_node(yastl::move(value));
+  auto it = insert_new_node_unique(np, code);
+  check_chain(length + 1);
+  return yastl::make_pair(it, true);
+}
+
 // 在不需要重建表格的情况下插入新节点，键值不允许重复，返回已有的迭代器或者插入的迭代器以及状态的 pair
 template <class T, class Hash, class KeyEqual>
 pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
 hashtable<T, Hash, KeyEqual>::insert_unique_noresize(const value_type& value) {
+  YASTL_DEBUG(!empty_bucket());
   const auto n = hash(value_traits::get_key(value));
   auto first = buckets_[n];
-  for (auto cur = first; cur; cur = cur->next) {
+  size_type length = 0;
+  for (auto cur = first; cur; cur = cur->next, ++length) {
     if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(value))) {
       return yastl::make_pair(iterator(cur, this), false); // 如果已经存在，直接返回，并且状态标记为 false
     }
@@ -904,6 +1000,7 @@ hashtable<T, Hash, KeyEqual>::insert_unique_noresize(const value_type& value) {
   tmp->next = first; // 插入头部
   buckets_[n] = tmp;
   ++size_;
+  check_chain(length + 1);
   return yastl::make_pair(iterator(tmp, this), true); // 不存在，插入，状态返回 true
 }
 
@@ -911,10 +1008,12 @@ hashtable<T, Hash, KeyEqual>::insert_unique_noresize(const value_type& value) {
 template <class T, class Hash, class KeyEqual>
 typename hashtable<T, Hash, KeyEqual>::iterator
 hashtable<T, Hash, KeyEqual>::insert_multi_noresize(const value_type& value) {
+  YASTL_DEBUG(!empty_bucket());
   const auto n = hash(value_traits::get_key(value));
   auto first = buckets_[n];
   auto tmp = create_node(value);
-  for (auto cur = first; cur; cur = cur->next) {
+  size_type length = 0;
+  for (auto cur = first; cur; cur = cur->next, ++length) {
     // 如果链表中存在相同键值的节点就马上插入，然后返回
     if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(value))) {
       tmp->next = cur->next; // 存在相同键值，插在它后面
@@ -927,6 +1026,7 @@ hashtable<T, Hash, KeyEqual>::insert_multi_noresize(const value_type& value) {
   tmp->next = first;
   buckets_[n] = tmp;
   ++size_;
+  check_chain(length + 1);
   return iterator(tmp, this);
 }
 
@@ -991,8 +1091,9 @@ typename hashtable<T, Hash, KeyEqual>::size_type
 hashtable<T, Hash, KeyEqual>::erase_multi(const key_type& key) {
   auto p = equal_range_multi(key);
   if (p.first.node != nullptr) {
+    const size_type n = yastl::distance(p.first, p.second); // 先计数，删除之后 p 已经失效
     erase(p.first, p.second);
-    return yastl::distance(p.first, p.second);
+    return n;
   }
   return 0;
 }
@@ -1196,12 +1297,13 @@ hashtable<T, Hash, KeyEqual>::equal_range_unique(const key_type& key) const {
 template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::swap(hashtable& rhs) noexcept {
   if (this != &rhs) {
-    buckets_.swap(rhs.buckets_);
+    yastl::swap(buckets_, rhs.buckets_);
     yastl::swap(bucket_size_, rhs.bucket_size_);
     yastl::swap(size_, rhs.size_);
     yastl::swap(mlf_, rhs.mlf_);
     yastl::swap(hash_, rhs.hash_);
     yastl::swap(equal_, rhs.equal_);
+    yastl::swap(reseed_size_, rhs.reseed_size_);
   }
 }
 
@@ -1209,47 +1311,62 @@ void hashtable<T, Hash, KeyEqual>::swap(hashtable& rhs) noexcept {
 // helper function
 
 // init 函数
+// n 为 0 时不分配桶，使用共享的空桶
 template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::init(size_type n) {
-  const auto bucket_nums = next_size(n); // 找到一个 >= n 的质数
-  try {
-    buckets_.reserve(bucket_nums); // 分配空间
-    buckets_.assign(bucket_nums, nullptr);
-  } catch (...) {
-    bucket_size_ = 0;
-    size_ = 0;
-    throw;
+  if (n == 0) {
+    reset_bucket();
+    return;
   }
-  bucket_size_ = buckets_.size();
+  const auto bucket_nums = next_size(n); // 找到一个 >= n 的质数
+  buckets_ = allocate_bucket(bucket_nums);
+  bucket_size_ = bucket_nums;
 }
 
-// copy_init 函数
+// copy_init 函数，复制空表时不分配桶
 template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::copy_init(const hashtable& ht) {
-  bucket_size_ = 0;
-  buckets_.reserve(ht.bucket_size_);
-  buckets_.assign(ht.bucket_size_, nullptr);
+  size_ = 0;
+  mlf_ = ht.mlf_;
+  if (ht.size_ == 0) {
+    reset_bucket();
+    return;
+  }
+  buckets_ = allocate_bucket(ht.bucket_size_);
+  bucket_size_ = ht.bucket_size_;
   try {
     for (size_type i = 0; i < ht.bucket_size_; ++i) {
       node_ptr cur = ht.buckets_[i];
       if (cur) { // 如果某 bucket 存在链表
         auto copy = create_node(cur->value);
         buckets_[i] = copy;
+        ++size_;
         for (auto next = cur->next; next; cur = next, next = cur->next) { // 遍历并复制链表
           copy->next = create_node(next->value);
           copy = copy->next;
+          ++size_;
         }
         copy->next = nullptr; // 最后的空指针
       }
     }
-    bucket_size_ = ht.bucket_size_;
-    mlf_ = ht.mlf_;
-    size_ = ht.size_;
   } catch (...) {
     clear();
+    deallocate_bucket();
+    throw;
   }
 }
 
+// allocate_bucket 函数，分配 n 个桶并置为空链表
+template <class T, class Hash, class KeyEqual>
+typename hashtable<T, Hash, KeyEqual>::node_ptr*
+hashtable<T, Hash, KeyEqual>::allocate_bucket(size_type n) {
+  node_ptr* bucket = bucket_allocator::allocate(n);
+  for (size_type i = 0; i < n; ++i) {
+    bucket[i] = nullptr;
+  }
+  return bucket;
+}
+
 // create_node 函数
 template <class T, class Hash, class KeyEqual>
 template <class ...Args>
@@ -1266,6 +1383,24 @@ hashtable<T, Hash, KeyEqual>::create_node(Args&& ...args) {
   return tmp;
 }
 
+// insert_new_node_unique 函数，插入一个已知不重复的新节点，code 为它的键值的哈希值
+// 需要时先重建表格，重建失败时释放节点
+template <class T, class Hash, class KeyEqual>
+typename hashtable<T, Hash, KeyEqual>::iterator
+hashtable<T, Hash, KeyEqual>::insert_new_node_unique(node_ptr np, size_type code) {
+  try {
+    rehash_if_need(1);
+  } catch (...) {
+    destroy_node(np);
+    throw;
+  }
+  const size_type n = code % bucket_size_;
+  np->next = buckets_[n];
+  buckets_[n] = np;
+  ++size_;
+  return iterator(np, this);
+}
+
 // destroy_node 函数， 调用析构函数并且释放节点内存
 template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::destroy_node(node_ptr node) {
@@ -1294,10 +1429,10 @@ hashtable<T, Hash, KeyEqual>::hash(const key_type& key) const {
   return hash_(key) % bucket_size_;
 }
 
-// rehash_if_need 函数, 增加大小为 n，计算是否需要重新排布 hashtable
+// rehash_if_need 函数, 增加大小为 n，计算是否需要重新排布 hashtable，还在使用共享的空桶时一定分配
 template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::rehash_if_need(size_type n) {
-  if (static_cast<float>(size_ + n) > (float)bucket_size_ * max_load_factor()) {
+  if (empty_bucket() || static_cast<float>(size_ + n) > (float)bucket_size_ * max_load_factor()) {
     rehash(size_ + n);
   }
 }
@@ -1355,7 +1490,8 @@ hashtable<T, Hash, KeyEqual>::insert_node_multi(node_ptr np) {
     ++size_;
     return iterator(np, this);
   }
-  for (; cur; cur = cur->next) {
+  size_type length = 0;
+  for (; cur; cur = cur->next, ++length) {
     if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(np->value))) { // 相等插在后面
       np->next = cur->next;
       cur->next = np;
@@ -1366,6 +1502,7 @@ hashtable<T, Hash, KeyEqual>::insert_node_multi(node_ptr np) {
   np->next = buckets_[n]; // 插在头部
   buckets_[n] = np;
   ++size_;
+  check_chain(length + 1);
   return iterator(np, this);
 }
 
@@ -1380,7 +1517,8 @@ hashtable<T, Hash, KeyEqual>::insert_node_unique(node_ptr np) {
     ++size_;
     return yastl::make_pair(iterator(np, this), true);
   }
-  for (; cur; cur = cur->next) { // 遍历，已经存在的话返回失败
+  size_type length = 0;
+  for (; cur; cur = cur->next, ++length) { // 遍历，已经存在的话返回失败
     if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(np->value))) {
       return yastl::make_pair(iterator(cur, this), false);
     }
@@ -1388,37 +1526,50 @@ hashtable<T, Hash, KeyEqual>::insert_node_unique(node_ptr np) {
   np->next = buckets_[n]; // 插入头部 返回成功
   buckets_[n] = np;
   ++size_;
+  check_chain(length + 1);
   return yastl::make_pair(iterator(np, this), true);
 }
 
 // replace_bucket 函数，把现有的 bucket size 调整为 bucket_count
+// 节点直接移到新的 bucket 中，不重新申请，键值相等的节点仍然相邻
 template <class T, class Hash, class KeyEqual>
 void hashtable<T, Hash, KeyEqual>::replace_bucket(size_type bucket_count) {
-  bucket_type bucket(bucket_count); // 新建一个 bucket_count 的 vector
-  if (size_ != 0) { // 需要调整，若为空则直接换节省效率
-    for (size_type i = 0; i < bucket_size_; ++i) { // 对于每一个 bucket
-      for (auto first = buckets_[i]; first; first = first->next) { // 遍历每一条 old hashnode
-        auto tmp = create_node(first->value); // 复制 old hashnode
-        const auto n = hash(value_traits::get_key(first->value), bucket_count); // 重新计算在新的 bucket 中的索引
-        auto f = bucket[n]; // 新 bucket 的首个 hashnode
-        bool is_inserted = false;
-        for (auto cur = f; cur; cur = cur->next) { // 遍历 new bucket 的 hashnode
-          if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(first->value))) {
-            tmp->next = cur->next; // 如果 new bucket 的某个 node 值和 old 的键值相等
-            cur->next = tmp; // 把 tmp 节点插入到 cur 后面，保证相同值在一块
-            is_inserted = true;
-            break;
-          }
-        }
-        if (!is_inserted) {
-          tmp->next = f; // 把 tmp 插入到 new bucket 的头部
-          bucket[n] = tmp;
+  node_ptr* bucket = allocate_bucket(bucket_count); // 新建 bucket_count 个桶
+  for (size_type i = 0; i < bucket_size_; ++i) { // 对于每一个 bucket
+    node_ptr first = buckets_[i];
+    while (first) { // 遍历每一条 old hashnode
+      node_ptr next = first->next;
+      const auto n = hash(value_traits::get_key(first->value), bucket_count); // 重新计算在新的 bucket 中的索引
+      auto cur = bucket[n];
+      for (; cur; cur = cur->next) { // 遍历 new bucket 的 hashnode
+        if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(first->value))) {
+          break;
         }
       }
+      if (cur) { // 新 bucket 中有相等的键值，插在它后面，保证相同值在一块
+        first->next = cur->next;
+        cur->next = first;
+      } else { // 插到新 bucket 的头部
+        first->next = bucket[n];
+        bucket[n] = first;
+      }
+      first = next;
     }
   }
-  buckets_.swap(bucket); // 交换，出了函数会自动析构 bucket
-  bucket_size_ = buckets_.size();
+  deallocate_bucket();
+  buckets_ = bucket;
+  bucket_size_ = bucket_count;
+}
+
+// reseed 函数，给 Hash 换一个随机种子，在桶数不变的情况下重新分配所有节点
+template <class T, class Hash, class KeyEqual>
+void hashtable<T, Hash, KeyEqual>::reseed(m_true_type) {
+  if (size_ < 2 * reseed_size_) { // 元素个数翻倍之前不再换种子
+    return;
+  }
+  reseed_size_ = size_;
+  hash_.reseed(hash_random_seed());
+  replace_bucket(bucket_size_);
 }
 
 // erase_bucket 函数
@@ -0,0 +1,218 @@
+﻿#ifndef _INCLUDE_INTERVAL_MAP_H_
+#define _INCLUDE_INTERVAL_MAP_H_
+
+// 这个头文件包含一个模板类 interval_map
+// interval_map : 区间树，键值是一个半开区间 [first, second)，元素按区间的左端点、右端点排序，键值允许重复
+
+// notes:
+//
+// 每个节点保存以它为根的子树中最大的右端点，由 rb_tree 的子树信息维护策略在插入、删除和旋转时更新
+// find_containing 和 find_overlapping 跳过最大右端点不够大的子树，以及左端点已经太大的节点和它的右子树，
+// 时间复杂度为 O(log n + k)，k 为结果个数，结果按区间的顺序输出
+
+#include "rb_tree.h"
+
+namespace yastl {
+
+// 区间的比较方式，先比较左端点，再比较右端点
+template <class Key, class Compare>
+struct interval_compare {
+  Compare comp;
+
+  bool operator()(const yastl::pair<Key, Key>& lhs, const yastl::pair<Key, Key>& rhs) const {
+    return comp(lhs.first, rhs.first) || (!comp(rhs.first, lhs.first) && comp(lhs.second, rhs.second));
+  }
+};
+
+// interval_map 的子树信息维护策略，节点保存子树中最大的右端点
+template <class Value, class Key, class Compare>
+struct interval_augment : public rb_tree_augment_base<Value, Key> {
+  typedef rb_tree_augment_base<Value, Key> base;
+  typedef typename base::base_ptr base_ptr;
+
+  void update(base_ptr x) const {
+    Compare comp;
+    const Key* high = &base::value(x).first.second;
+    if (x->left != nullptr && comp(*high, base::data(x->left))) {
+      high = &base::data(x->left);
+    }
+    if (x->right != nullptr && comp(*high, base::data(x->right))) {
+      high = &base::data(x->right);
+    }
+    base::data(x) = *high;
+  }
+};
+
+// 模板类 interval_map，键值允许重复
+// 参数一代表区间端点的类型，参数二代表实值类型，参数三代表端点的比较方式，缺省使用 yastl::less
+template <class Key, class T, class Compare = yastl::less<Key>>
+class interval_map {
+public:
+  // interval_map 的嵌套型别定义
+  typedef yastl::pair<Key, Key> key_type; // 区间 [first, second)
+  typedef Key point_type; // 区间端点的类型
+  typedef T mapped_type;
+  typedef yastl::pair<const key_type, T> value_type;
+  typedef interval_compare<Key, Compare> key_compare;
+  typedef Compare point_compare;
+
+private:
+  typedef interval_augment<value_type, Key, Compare> augment_type;
+  typedef yastl::rb_tree<value_type, key_compare, augment_type> base_type;
+  typedef typename base_type::base_ptr base_ptr;
+  base_type tree_;
+
+public:
+  typedef typename base_type::iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::reverse_iterator reverse_iterator;
+  typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  interval_map() = default;
+
+  template <class InputIterator>
+  interval_map(InputIterator first, InputIterator last) {
+    tree_.insert_multi(first, last);
+  }
+
+  interval_map(std::initializer_list<value_type> ilist) {
+    tree_.insert_multi(ilist.begin(), ilist.end());
+  }
+
+  // 迭代器相关
+  iterator begin() noexcept {
+    return tree_.begin();
+  }
+  const_iterator begin() const noexcept {
+    return tree_.begin();
+  }
+  iterator end() noexcept {
+    return tree_.end();
+  }
+  const_iterator end() const noexcept {
+    return tree_.end();
+  }
+  reverse_iterator rbegin() noexcept {
+    return tree_.rbegin();
+  }
+  const_reverse_iterator rbegin() const noexcept {
+    return tree_.rbegin();
+  }
+  reverse_iterator rend() noexcept {
+    return tree_.rend();
+  }
+  const_reverse_iterator rend() const noexcept {
+    return tree_.rend();
+  }
+
+  // 容量相关
+  bool empty() const noexcept {
+    return tree_.empty();
+  }
+  size_type size() const noexcept {
+    return tree_.size();
+  }
+
+  // 插入删除相关
+
+  iterator insert(const value_type& value) {
+    return tree_.insert_multi(value);
+  }
+  iterator insert(const point_type& first, const point_type& last, const mapped_type& value) {
+    return tree_.emplace_multi(key_type(first, last), value);
+  }
+
+  iterator erase(iterator position) {
+    return tree_.erase(position);
+  }
+  size_type erase(const key_type& key) {
+    return tree_.erase_multi(key);
+  }
+  void erase(iterator first, iterator last) {
+    tree_.erase(first, last);
+  }
+
+  void clear() {
+    tree_.clear();
+  }
+
+  // 查找相关
+
+  iterator find(const key_type& key) {
+    return tree_.find(key);
+  }
+  const_iterator find(const key_type& key) const {
+    return tree_.find(key);
+  }
+  size_type count(const key_type& key) const {
+    return tree_.count_multi(key);
+  }
+
+  // 把所有包含 point 的区间的迭代器按顺序写入 result，返回一个迭代器指向输出结果的尾部
+  template <class OutputIter>
+  OutputIter find_containing(const point_type& point, OutputIter result) const {
+    return search(tree_.root_node(), point, nullptr, result);
+  }
+
+  // 把所有与 [first, last) 相交的区间的迭代器按顺序写入 result，返回一个迭代器指向输出结果的尾部
+  template <class OutputIter>
+  OutputIter find_overlapping(const point_type& first, const point_type& last, OutputIter result) const {
+    return search(tree_.root_node(), first, &last, result);
+  }
+
+  key_compare key_comp() const {
+    return tree_.key_comp();
+  }
+
+  void swap(interval_map& rhs) noexcept {
+    tree_.swap(rhs.tree_);
+  }
+
+public:
+  friend bool operator==(const interval_map& lhs, const interval_map& rhs) {
+    return lhs.size() == rhs.size() && yastl::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+  friend bool operator!=(const interval_map& lhs, const interval_map& rhs) {
+    return !(lhs == rhs);
+  }
+
+private:
+  template <class OutputIter>
+  OutputIter search(base_ptr x, const point_type& low, const point_type* high, OutputIter result) const;
+};
+
+/*****************************************************************************************/
+
+// 在子树 x 中查找，high 为空指针时查找包含 low 的区间，否则查找与 [low, *high) 相交的区间
+// 两种情况下区间 [a, b) 都要满足 low < b；包含 low 还要 a <= low，相交还要 a < *high
+template <class Key, class T, class Compare>
+template <class OutputIter>
+OutputIter interval_map<Key, T, Compare>::
+search(base_ptr x, const point_type& low, const point_type* high, OutputIter result) const {
+  Compare comp;
+  // 子树中最大的右端点 <= low 时整棵子树都不满足
+  while (x != nullptr && comp(low, augment_type::data(x))) {
+    result = search(x->left, low, high, result);
+    const key_type& key = augment_type::value(x).first;
+    if (high != nullptr ? !comp(key.first, *high) : comp(low, key.first)) { // x 与右子树的左端点都太大
+      break;
+    }
+    if (comp(low, key.second)) {
+      *result = const_iterator(x);
+      ++result;
+    }
+    x = x->right;
+  }
+  return result;
+}
+
+// 重载 yastl 的 swap
+template <class Key, class T, class Compare>
+void swap(interval_map<Key, T, Compare>& lhs, interval_map<Key, T, Compare>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+} // namespace yastl
+#endif // _INCLUDE_INTERVAL_MAP_H_
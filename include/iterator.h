@@ -133,6 +133,20 @@ struct is_iterator : // 条件是迭代器输入输出的tag至少有一个为
   public m_bool_constant<is_input_iterator<Iterator>::value || is_output_iterator<Iterator>::value>
 {};
 
+// 分段迭代器的萃取：deque 这类容器的元素存放在若干段连续的内存中，算法可以逐段处理，段内直接使用指针
+// 特化版本把 is_segmented_iterator 定义为 m_true_type，并提供：
+//   segment_iterator / local_iterator : 段的迭代器与段内的迭代器
+//   segment(it) / local(it)           : 迭代器所在的段与段内的位置
+//   begin(seg) / end(seg)             : 一段的首尾
+//   compose(seg, local)               : 由段与段内的位置合成迭代器，local 为 end(seg) 时合成下一段的开头
+template <class Iterator>
+struct segmented_iterator_traits {
+  typedef m_false_type is_segmented_iterator;
+};
+
+template <class Iterator>
+struct is_segmented_iterator : public segmented_iterator_traits<Iterator>::is_segmented_iterator {};
+
 // 萃取某个迭代器的 category
 template <class Iterator>
 typename iterator_traits<Iterator>::iterator_category iterator_category(const Iterator&) {
@@ -177,21 +177,12 @@ public:
     return it->second;
   }
 
+  // key 不存在时插入一个值初始化的实值，只查找一次
   mapped_type& operator[](const key_type& key) {
-    iterator it = lower_bound(key);
-    // 没找到，到头了 || 没找到，it->first < key，区间内不存在这个值
-    if (it == end() || key_comp()(key, it->first)) {
-      it = emplace_hint(it, key, T{}); // 插一个空值在这个位置
-    }
-    return it->second;
+    return tree_.try_emplace_unique(key).first->second;
   }
   mapped_type& operator[](key_type&& key) {
-    iterator it = lower_bound(key);
-    // 没找到，到头了 || 没找到，it->first < key，区间内不存在这个值
-    if (it == end() || key_comp()(key, it->first)) {
-      it = emplace_hint(it, yastl::move(key), T{});
-    }
-    return it->second;
+    return tree_.try_emplace_unique(yastl::move(key)).first->second;
   }
 
   // 插入删除相关
@@ -225,6 +216,51 @@ public:
     tree_.insert_unique(first, last);
   }
 
+  // try_emplace / insert_or_assign
+  // 先按 key 查找插入点，key 不存在时才申请节点并用 args 构造实值，key 已存在时不会申请节点，args 也不会被移动
+  template <class ...Args>
+  pair<iterator, bool> try_emplace(const key_type& key, Args&& ...args) {
+    return tree_.try_emplace_unique(key, yastl::forward<Args>(args)...);
+  }
+  template <class ...Args>
+  pair<iterator, bool> try_emplace(key_type&& key, Args&& ...args) {
+    return tree_.try_emplace_unique(yastl::move(key), yastl::forward<Args>(args)...);
+  }
+  template <class ...Args>
+  iterator try_emplace(iterator /*hint*/, const key_type& key, Args&& ...args) {
+    return tree_.try_emplace_unique(key, yastl::forward<Args>(args)...).first;
+  }
+  template <class ...Args>
+  iterator try_emplace(iterator /*hint*/, key_type&& key, Args&& ...args) {
+    return tree_.try_emplace_unique(yastl::move(key), yastl::forward<Args>(args)...).first;
+  }
+
+  // key 已存在时把 obj 赋值给它的实值，否则插入，返回值的 bool 表示是否插入了新元素
+  template <class M>
+  pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj) {
+    auto res = tree_.try_emplace_unique(key, yastl::forward<M>(obj));
+    if (!res.second) {
+      res.first->second = yastl::forward<M>(obj);
+    }
+    return res;
+  }
+  template <class M>
+  pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj) {
+    auto res = tree_.try_emplace_unique(yastl::move(key), yastl::forward<M>(obj));
+    if (!res.second) {
+      res.first->second = yastl::forward<M>(obj);
+    }
+    return res;
+  }
+  template <class M>
+  iterator insert_or_assign(iterator /*hint*/, const key_type& key, M&& obj) {
+    return insert_or_assign(key, yastl::forward<M>(obj)).first;
+  }
+  template <class M>
+  iterator insert_or_assign(iterator /*hint*/, key_type&& key, M&& obj) {
+    return insert_or_assign(yastl::move(key), yastl::forward<M>(obj)).first;
+  }
+
   void erase(iterator position) {
     tree_.erase(position);
   }
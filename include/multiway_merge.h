@@ -0,0 +1,221 @@
+﻿#ifndef _INCLUDE_MULTIWAY_MERGE_H_
+#define _INCLUDE_MULTIWAY_MERGE_H_
+
+// 这个头文件包含 k 路归并 multiway_merge、它使用的败者树 loser_tree，以及按输出位置切分各路的 multiway_merge_split
+// 带执行策略的并行版本在 execution.h 中
+
+// notes:
+//
+// 输入是一个由 yastl::pair<RandomIter, RandomIter> 组成的区间，每个 pair 是一段有序序列 [first, second)
+// 败者树每输出一个元素只需沿叶子到根比较 log k 次，总共 O(n log k) 次比较、n 次复制，
+// 两两归并则需要 log k 轮，每轮复制全部元素
+// 归并是稳定的：相等的元素按所在序列的先后输出，同一序列内保持原来的顺序
+
+#include "algo.h"
+#include "functional.h"
+#include "vector.h"
+
+namespace yastl {
+
+/*****************************************************************************************/
+// loser_tree
+// 叶子是各路序列当前的元素，内部结点记录比赛的败者，loser_[0] 记录最终的胜者
+// 叶子数补齐为 2 的幂次，补上的叶子与已经取完的序列一样，比任何元素都大
+/*****************************************************************************************/
+template <class RandomIter, class Compared>
+class loser_tree {
+private:
+  // 结点记录一路序列的当前位置，内部结点是败者，根之上的 losers_[0] 是胜者
+  struct node {
+    RandomIter cur;
+    size_t source;  // 序列的序号
+    bool done;      // 序列是否已经取完，补上的叶子也记为取完
+  };
+
+  yastl::vector<node> losers_;
+  yastl::vector<RandomIter> last_;
+  size_t leaves_;  // 叶子个数
+  Compared comp_;
+
+public:
+  template <class SeqIter>
+  loser_tree(SeqIter seqs_first, SeqIter seqs_last, Compared comp);
+
+  // 所有序列都已取完
+  bool empty() const {
+    return losers_.front().done;
+  }
+
+  // 胜者所在的序列与它的当前元素
+  size_t top_index() const {
+    return losers_.front().source;
+  }
+
+  RandomIter top() const {
+    return losers_.front().cur;
+  }
+
+  // 胜者所在的序列前进一个元素，并从它的叶子到根重新比赛
+  void pop();
+
+private:
+  // x 的当前元素是否排在 y 之前，元素相等时序号小的在前
+  // 先只比较 x < y，不成立时绝大多数情况下 y < x，第二次比较的分支很好预测
+  bool beats(const node& x, const node& y) const {
+    if (x.done) {
+      return false;
+    }
+    if (y.done) {
+      return true;
+    }
+    return comp_(*x.cur, *y.cur) || (!comp_(*y.cur, *x.cur) && x.source < y.source);
+  }
+};
+
+template <class RandomIter, class Compared>
+template <class SeqIter>
+loser_tree<RandomIter, Compared>::loser_tree(SeqIter seqs_first, SeqIter seqs_last, Compared comp)
+  : leaves_(1), comp_(comp) {
+  yastl::vector<node> leaf;
+  for (; seqs_first != seqs_last; ++seqs_first) {
+    leaf.push_back(node{seqs_first->first, leaf.size(), seqs_first->first == seqs_first->second});
+    last_.push_back(seqs_first->second);
+  }
+  while (leaves_ < leaf.size()) {
+    leaves_ *= 2;
+  }
+  while (leaf.size() < leaves_) {
+    leaf.push_back(node{RandomIter(), leaf.size(), true});
+  }
+  // 自底向上比赛，winner[i] 为以 i 为根的子树的胜者，叶子 i 的编号为 leaves_ + i
+  yastl::vector<size_t> winner(2 * leaves_);
+  for (size_t i = 0; i < leaves_; ++i) {
+    winner[leaves_ + i] = i;
+  }
+  losers_.assign(leaves_, leaf[0]);
+  for (size_t pos = leaves_ - 1; pos > 0; --pos) {
+    const size_t l = winner[2 * pos];
+    const size_t r = winner[2 * pos + 1];
+    if (beats(leaf[l], leaf[r])) {
+      winner[pos] = l;
+      losers_[pos] = leaf[r];
+    } else {
+      winner[pos] = r;
+      losers_[pos] = leaf[l];
+    }
+  }
+  losers_[0] = leaf[winner[1]];
+}
+
+template <class RandomIter, class Compared>
+void loser_tree<RandomIter, Compared>::pop() {
+  node* tree = losers_.begin();
+  node w = tree[0];
+  ++w.cur;
+  w.done = w.cur == last_.begin()[w.source];
+  for (size_t pos = (leaves_ + w.source) / 2; pos > 0; pos /= 2) {
+    if (beats(tree[pos], w)) {
+      yastl::swap(tree[pos], w);
+    }
+  }
+  tree[0] = w;
+}
+
+/*****************************************************************************************/
+// multiway_merge
+// 把 [seqs_first, seqs_last) 中的各段有序序列归并到 result，返回一个迭代器指向输出结果的尾部
+/*****************************************************************************************/
+template <class SeqIter, class OutputIter, class Compared>
+OutputIter multiway_merge(SeqIter seqs_first, SeqIter seqs_last, OutputIter result, Compared comp) {
+  typedef typename iterator_traits<SeqIter>::value_type::first_type RandomIter;
+  const auto k = seqs_last - seqs_first;
+  if (k == 0) {
+    return result;
+  }
+  if (k == 1) {
+    return yastl::copy(seqs_first->first, seqs_first->second, result);
+  }
+  if (k == 2) {
+    SeqIter second = seqs_first;
+    ++second;
+    return yastl::merge(seqs_first->first, seqs_first->second, second->first, second->second, result, comp);
+  }
+  loser_tree<RandomIter, Compared> tree(seqs_first, seqs_last, comp);
+  for (; !tree.empty(); ++result) {
+    *result = *tree.top();
+    tree.pop();
+  }
+  return result;
+}
+
+template <class SeqIter, class OutputIter>
+OutputIter multiway_merge(SeqIter seqs_first, SeqIter seqs_last, OutputIter result) {
+  typedef typename iterator_traits<SeqIter>::value_type::first_type RandomIter;
+  return yastl::multiway_merge(seqs_first, seqs_last, result,
+                               yastl::less<typename iterator_traits<RandomIter>::value_type>());
+}
+
+/*****************************************************************************************/
+// multiway_merge_split
+// 求归并结果的前 rank 个元素在各段序列中各占多少个，结果依次写入 splits
+// 每轮取剩余候选范围最大的序列的中间元素 p，统计各序列中排在 p 之前的元素个数，据此缩小所有序列的候选范围
+// 比较 k * log n 轮，每轮 k 次二分查找
+/*****************************************************************************************/
+template <class SeqIter, class Distance, class OutputIter, class Compared>
+void multiway_merge_split(SeqIter seqs_first, SeqIter seqs_last, Distance rank,
+                          OutputIter splits, Compared comp) {
+  typedef typename iterator_traits<SeqIter>::value_type::first_type RandomIter;
+  const size_t k = static_cast<size_t>(seqs_last - seqs_first);
+  yastl::vector<RandomIter> first(k);
+  yastl::vector<Distance> lo(k, 0);
+  yastl::vector<Distance> hi(k, 0);
+  for (size_t i = 0; i < k; ++i) {
+    first[i] = seqs_first[i].first;
+    hi[i] = static_cast<Distance>(seqs_first[i].second - seqs_first[i].first);
+  }
+  yastl::vector<Distance> below(k, 0);
+  for (;;) {
+    size_t pick = k;
+    for (size_t i = 0; i < k; ++i) {
+      if (hi[i] > lo[i] && (pick == k || hi[i] - lo[i] > hi[pick] - lo[pick])) {
+        pick = i;
+      }
+    }
+    if (pick == k) { // 所有序列的候选范围都已经缩成一个点
+      break;
+    }
+    const Distance mid = lo[pick] + (hi[pick] - lo[pick]) / 2;
+    const auto& pivot = *(first[pick] + mid);
+    // 排在 pivot 之前的元素：序号较小的序列中 <= pivot 的，序号较大的序列中 < pivot 的
+    Distance total = 0;
+    for (size_t i = 0; i < k; ++i) {
+      if (i == pick) {
+        below[i] = mid;
+      } else if (i < pick) {
+        below[i] = static_cast<Distance>(
+          yastl::upper_bound(first[i] + lo[i], first[i] + hi[i], pivot, comp) - first[i]);
+      } else {
+        below[i] = static_cast<Distance>(
+          yastl::lower_bound(first[i] + lo[i], first[i] + hi[i], pivot, comp) - first[i]);
+      }
+      total += below[i];
+    }
+    // 计数被限制在候选范围内，真正的切分位置始终落在 [lo, hi] 中
+    if (total < rank) { // pivot 以及排在它之前的元素都在前 rank 个中
+      for (size_t i = 0; i < k; ++i) {
+        lo[i] = below[i];
+      }
+      lo[pick] = mid + 1;
+    } else {
+      for (size_t i = 0; i < k; ++i) {
+        hi[i] = below[i];
+      }
+    }
+  }
+  for (size_t i = 0; i < k; ++i, ++splits) {
+    *splits = lo[i];
+  }
+}
+
+} // namespace yastl
+#endif // _INCLUDE_MULTIWAY_MERGE_H_
@@ -0,0 +1,483 @@
+﻿#ifndef _INCLUDE_PERSISTENT_MAP_H_
+#define _INCLUDE_PERSISTENT_MAP_H_
+
+// 这个头文件包含一个模板类 persistent_map
+// persistent_map : 持久化（不可变）映射，键值不允许重复，修改操作返回一个新版本，新旧版本共享没有改动的子树
+
+// notes:
+//
+// 底层是路径复制的 AVL 树：insert、set、erase 只复制从根到修改位置的 O(log n) 个节点，其余子树由新旧版本共享；
+// 函数式的红黑树删除需要处理的情况太多，AVL 的平衡只看左右子树的高度，复制路径时重新平衡更简单，复杂度相同
+// 节点带有原子引用计数，复制一个 persistent_map 只是增加根节点的计数，最后一个引用消失时才释放节点
+// 已经生成的版本不会再被修改，多个线程可以不加锁地同时读取、复制同一个版本；
+// 但对同一个 persistent_map 变量的赋值与其他线程对它的读取仍需要同步（比如用互斥量保护“当前版本”这个变量）
+// 迭代器不持有引用计数，只在它所属的版本存活期间有效
+
+#include <atomic>
+#include <initializer_list>
+#include <type_traits>
+
+#include "algobase.h"
+#include "allocator.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "iterator.h"
+#include "util.h"
+
+namespace yastl {
+
+// 树的最大高度，高度为 64 的 AVL 树至少有 Fib(66) - 1（约 2.7e13）个节点，实际不可能达到
+constexpr static size_t kPersistentMapMaxHeight = 64;
+
+// persistent_map 的节点
+template <class Value>
+struct persistent_map_node {
+  std::atomic<size_t> refs;      // 引用计数
+  persistent_map_node* left;
+  persistent_map_node* right;
+  size_t height;                 // 以该节点为根的子树的高度
+  Value value;
+
+  template <class ...Args>
+  persistent_map_node(persistent_map_node* l, persistent_map_node* r, Args&& ...args)
+    : refs(1), left(l), right(r), height(1), value(yastl::forward<Args>(args)...) {}
+};
+
+// persistent_map 的迭代器，中序遍历，用一个栈保存从根到当前节点路径上还没有访问的祖先
+template <class Value>
+struct persistent_map_iterator : public yastl::iterator<yastl::forward_iterator_tag, Value> {
+  typedef persistent_map_node<Value> node_type;
+  typedef const Value& reference;
+  typedef const Value* pointer;
+  typedef persistent_map_iterator self;
+
+  const node_type* stack[kPersistentMapMaxHeight];
+  size_t depth; // 栈顶为当前节点，depth 为 0 时是尾后迭代器
+
+  persistent_map_iterator() : depth(0) {}
+
+  reference operator*() const {
+    return stack[depth - 1]->value;
+  }
+  pointer operator->() const {
+    return &(operator*());
+  }
+
+  self& operator++() {
+    const node_type* x = stack[--depth]->right;
+    push_left(x);
+    return *this;
+  }
+  self operator++(int) {
+    self tmp(*this);
+    ++*this;
+    return tmp;
+  }
+
+  bool operator==(const self& rhs) const {
+    return depth == rhs.depth && (depth == 0 || stack[depth - 1] == rhs.stack[depth - 1]);
+  }
+  bool operator!=(const self& rhs) const {
+    return !(*this == rhs);
+  }
+
+  // 把 x 和它的左链依次压栈
+  void push_left(const node_type* x) {
+    for (; x != nullptr; x = x->left) {
+      YASTL_DEBUG(depth < kPersistentMapMaxHeight);
+      stack[depth++] = x;
+    }
+  }
+};
+
+// 模板类 persistent_map，键值不允许重复
+// 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 yastl::less
+template <class Key, class T, class Compare = yastl::less<Key>>
+class persistent_map {
+public:
+  // persistent_map 的嵌套型别定义
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef yastl::pair<const Key, T> value_type;
+  typedef Compare key_compare;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  typedef const value_type& reference;
+  typedef const value_type& const_reference;
+  typedef persistent_map_iterator<value_type> iterator;
+  typedef persistent_map_iterator<value_type> const_iterator;
+
+private:
+  typedef persistent_map_node<value_type> node_type;
+  typedef node_type* node_ptr;
+  typedef yastl::allocator<node_type> node_allocator;
+
+  // 离开作用域时释放持有的一个引用
+  struct node_holder {
+    node_ptr node;
+    explicit node_holder(node_ptr x) : node(x) {}
+    ~node_holder() {
+      release(node);
+    }
+    node_ptr dismiss() noexcept {
+      node_ptr x = node;
+      node = nullptr;
+      return x;
+    }
+  };
+
+  node_ptr root_;
+  size_type size_;
+  key_compare comp_;
+
+public:
+  // 构造、复制、析构函数
+
+  persistent_map() : root_(nullptr), size_(0), comp_() {}
+  explicit persistent_map(const Compare& comp) : root_(nullptr), size_(0), comp_(comp) {}
+
+  template <class Iter, typename std::enable_if<yastl::is_input_iterator<Iter>::value, int>::type = 0>
+  persistent_map(Iter first, Iter last) : root_(nullptr), size_(0), comp_() {
+    for (; first != last; ++first) {
+      *this = insert(*first);
+    }
+  }
+
+  persistent_map(std::initializer_list<value_type> ilist)
+    : persistent_map(ilist.begin(), ilist.end()) {}
+
+  persistent_map(const persistent_map& rhs) noexcept
+    : root_(acquire(rhs.root_)), size_(rhs.size_), comp_(rhs.comp_) {}
+
+  persistent_map(persistent_map&& rhs) noexcept
+    : root_(rhs.root_), size_(rhs.size_), comp_(rhs.comp_) {
+    rhs.root_ = nullptr;
+    rhs.size_ = 0;
+  }
+
+  persistent_map& operator=(const persistent_map& rhs) noexcept {
+    persistent_map tmp(rhs);
+    swap(tmp);
+    return *this;
+  }
+  persistent_map& operator=(persistent_map&& rhs) noexcept {
+    persistent_map tmp(yastl::move(rhs));
+    swap(tmp);
+    return *this;
+  }
+
+  ~persistent_map() {
+    release(root_);
+  }
+
+  // 迭代器相关
+  const_iterator begin() const noexcept {
+    const_iterator it;
+    it.push_left(root_);
+    return it;
+  }
+  const_iterator end() const noexcept {
+    return const_iterator();
+  }
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+  const_iterator cend() const noexcept {
+    return end();
+  }
+
+  // 容量相关
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+  size_type size() const noexcept {
+    return size_;
+  }
+
+  // 访问元素相关
+  const mapped_type& at(const key_type& key) const {
+    const node_type* x = find_node(key);
+    THROW_OUT_OF_RANGE_IF(x == nullptr, "persistent_map<Key, T> no such element exists");
+    return x->value.second;
+  }
+
+  // 产生新版本的操作，原版本保持不变
+
+  // key 不存在时插入 value，否则返回与原版本相同的映射
+  persistent_map insert(const value_type& value) const {
+    bool inserted = false;
+    node_ptr root = insert_at(root_, value.first, false, inserted, value);
+    return inserted ? persistent_map(root, size_ + 1, comp_) : modified(root);
+  }
+
+  // key 不存在时插入，存在时覆盖实值
+  persistent_map set(const key_type& key, const mapped_type& value) const {
+    bool inserted = false;
+    node_ptr root = insert_at(root_, key, true, inserted, key, value);
+    return persistent_map(root, inserted ? size_ + 1 : size_, comp_);
+  }
+
+  // 删除 key，key 不存在时返回与原版本相同的映射
+  persistent_map erase(const key_type& key) const {
+    bool erased = false;
+    node_ptr root = erase_at(root_, key, erased);
+    return erased ? persistent_map(root, size_ - 1, comp_) : *this;
+  }
+
+  // 查找相关
+
+  const_iterator find(const key_type& key) const {
+    const_iterator it = lower_bound(key);
+    return it == end() || comp_(key, it->first) ? end() : it;
+  }
+  size_type count(const key_type& key) const {
+    return find_node(key) != nullptr ? 1 : 0;
+  }
+  bool contains(const key_type& key) const {
+    return find_node(key) != nullptr;
+  }
+
+  // 键值不小于 key 的第一个位置
+  const_iterator lower_bound(const key_type& key) const {
+    const_iterator it;
+    for (const node_type* x = root_; x != nullptr;) {
+      if (comp_(x->value.first, key)) {
+        x = x->right;
+      } else {
+        it.stack[it.depth++] = x;
+        x = x->left;
+      }
+    }
+    return it;
+  }
+
+  // 键值大于 key 的第一个位置
+  const_iterator upper_bound(const key_type& key) const {
+    const_iterator it;
+    for (const node_type* x = root_; x != nullptr;) {
+      if (comp_(key, x->value.first)) {
+        it.stack[it.depth++] = x;
+        x = x->left;
+      } else {
+        x = x->right;
+      }
+    }
+    return it;
+  }
+
+  key_compare key_comp() const {
+    return comp_;
+  }
+
+  void swap(persistent_map& rhs) noexcept {
+    yastl::swap(root_, rhs.root_);
+    yastl::swap(size_, rhs.size_);
+    yastl::swap(comp_, rhs.comp_);
+  }
+
+public:
+  friend bool operator==(const persistent_map& lhs, const persistent_map& rhs) {
+    return lhs.size_ == rhs.size_ && (lhs.root_ == rhs.root_ || yastl::equal(lhs.begin(), lhs.end(), rhs.begin()));
+  }
+  friend bool operator!=(const persistent_map& lhs, const persistent_map& rhs) {
+    return !(lhs == rhs);
+  }
+
+private:
+  // 接管 root 的一个引用
+  persistent_map(node_ptr root, size_type n, const Compare& comp) noexcept
+    : root_(root), size_(n), comp_(comp) {}
+
+  // insert 没有插入时 insert_at 返回空指针
+  persistent_map modified(node_ptr root) const {
+    return root == nullptr ? *this : persistent_map(root, size_, comp_);
+  }
+
+  // helper functions
+
+  static node_ptr acquire(node_ptr x) noexcept {
+    if (x != nullptr) {
+      x->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return x;
+  }
+
+  static void release(node_ptr x) noexcept {
+    while (x != nullptr && x->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      release(x->left);
+      node_ptr right = x->right;
+      node_allocator::destroy(x);
+      node_allocator::deallocate(x);
+      x = right;
+    }
+  }
+
+  static size_t height(node_ptr x) noexcept {
+    return x == nullptr ? 0 : x->height;
+  }
+
+  static void update_height(node_ptr x) noexcept {
+    x->height = yastl::max(height(x->left), height(x->right)) + 1;
+  }
+
+  // 节点构造成功后才增加子节点的引用计数，所以构造失败不会泄漏
+  template <class ...Args>
+  static node_ptr create_node(node_ptr left, node_ptr right, Args&& ...args) {
+    node_ptr x = node_allocator::allocate(1);
+    try {
+      node_allocator::construct(x, left, right, yastl::forward<Args>(args)...);
+    } catch (...) {
+      node_allocator::deallocate(x);
+      throw;
+    }
+    acquire(left);
+    acquire(right);
+    update_height(x);
+    return x;
+  }
+
+  const node_type* find_node(const key_type& key) const {
+    const node_type* x = root_;
+    while (x != nullptr) {
+      if (comp_(key, x->value.first)) {
+        x = x->left;
+      } else if (comp_(x->value.first, key)) {
+        x = x->right;
+      } else {
+        return x;
+      }
+    }
+    return nullptr;
+  }
+
+  template <class ...Args>
+  node_ptr insert_at(node_ptr x, const key_type& key, bool assign, bool& inserted, Args&& ...args) const;
+  node_ptr erase_at(node_ptr x, const key_type& key, bool& erased) const;
+  node_ptr erase_min(node_ptr x, node_ptr& min) const;
+  static node_ptr balance(node_ptr x);
+};
+
+/*****************************************************************************************/
+
+// 在子树 x 中插入键值为 key 的元素，返回新子树的根（持有一个引用），子树没有变化时返回空指针
+template <class Key, class T, class Compare>
+template <class ...Args>
+typename persistent_map<Key, T, Compare>::node_ptr
+persistent_map<Key, T, Compare>::
+insert_at(node_ptr x, const key_type& key, bool assign, bool& inserted, Args&& ...args) const {
+  if (x == nullptr) {
+    inserted = true;
+    return create_node(nullptr, nullptr, yastl::forward<Args>(args)...);
+  }
+  if (comp_(key, x->value.first)) {
+    node_holder left(insert_at(x->left, key, assign, inserted, yastl::forward<Args>(args)...));
+    return left.node == nullptr ? nullptr : balance(create_node(left.node, x->right, x->value));
+  }
+  if (comp_(x->value.first, key)) {
+    node_holder right(insert_at(x->right, key, assign, inserted, yastl::forward<Args>(args)...));
+    return right.node == nullptr ? nullptr : balance(create_node(x->left, right.node, x->value));
+  }
+  return assign ? create_node(x->left, x->right, yastl::forward<Args>(args)...) : nullptr;
+}
+
+// 在子树 x 中删除 key，erased 为 true 时返回新子树的根（持有一个引用，可能为空）
+template <class Key, class T, class Compare>
+typename persistent_map<Key, T, Compare>::node_ptr
+persistent_map<Key, T, Compare>::erase_at(node_ptr x, const key_type& key, bool& erased) const {
+  if (x == nullptr) {
+    return nullptr;
+  }
+  if (comp_(key, x->value.first)) {
+    node_holder left(erase_at(x->left, key, erased));
+    return erased ? balance(create_node(left.node, x->right, x->value)) : nullptr;
+  }
+  if (comp_(x->value.first, key)) {
+    node_holder right(erase_at(x->right, key, erased));
+    return erased ? balance(create_node(x->left, right.node, x->value)) : nullptr;
+  }
+  erased = true;
+  if (x->left == nullptr) {
+    return acquire(x->right);
+  }
+  if (x->right == nullptr) {
+    return acquire(x->left);
+  }
+  // 用右子树中最小的元素代替 x
+  node_ptr min = nullptr;
+  node_holder right(erase_min(x->right, min));
+  return balance(create_node(x->left, right.node, min->value));
+}
+
+// 删除子树 x 中最小的节点，由 min 返回，返回新子树的根（持有一个引用）
+template <class Key, class T, class Compare>
+typename persistent_map<Key, T, Compare>::node_ptr
+persistent_map<Key, T, Compare>::erase_min(node_ptr x, node_ptr& min) const {
+  if (x->left == nullptr) {
+    min = x;
+    return acquire(x->right);
+  }
+  node_holder left(erase_min(x->left, min));
+  return balance(create_node(left.node, x->right, x->value));
+}
+
+// x 是刚复制出来的节点，只有调用者持有它，可以直接修改；它的子节点可能被其他版本共享，旋转时要复制
+// 成功时返回新子树的根，失败时释放 x
+template <class Key, class T, class Compare>
+typename persistent_map<Key, T, Compare>::node_ptr
+persistent_map<Key, T, Compare>::balance(node_ptr x) {
+  node_holder hold(x);
+  const size_t lh = height(x->left);
+  const size_t rh = height(x->right);
+  if (lh > rh + 1) {
+    node_ptr l = x->left;
+    if (height(l->left) >= height(l->right)) { // 右旋：l 成为根，l 的右子树成为 x 的左子树
+      node_ptr root = create_node(l->left, x, l->value);
+      x->left = acquire(l->right);
+      release(l);
+      update_height(x);
+      update_height(root);
+      return root; // hold 释放的是调用者的引用，root 仍持有 x
+    }
+    // 先左旋再右旋：l 的右子节点 lr 成为根
+    node_ptr lr = l->right;
+    node_holder nl(create_node(l->left, lr->left, l->value));
+    node_ptr root = create_node(nl.node, x, lr->value);
+    x->left = acquire(lr->right);
+    release(l);
+    update_height(x);
+    update_height(root);
+    return root;
+  }
+  if (rh > lh + 1) {
+    node_ptr r = x->right;
+    if (height(r->right) >= height(r->left)) { // 左旋
+      node_ptr root = create_node(x, r->right, r->value);
+      x->right = acquire(r->left);
+      release(r);
+      update_height(x);
+      update_height(root);
+      return root;
+    }
+    // 先右旋再左旋
+    node_ptr rl = r->left;
+    node_holder nr(create_node(rl->right, r->right, r->value));
+    node_ptr root = create_node(x, nr.node, rl->value);
+    x->right = acquire(rl->left);
+    release(r);
+    update_height(x);
+    update_height(root);
+    return root;
+  }
+  update_height(x);
+  return hold.dismiss();
+}
+
+// 重载 yastl 的 swap
+template <class Key, class T, class Compare>
+void swap(persistent_map<Key, T, Compare>& lhs, persistent_map<Key, T, Compare>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+} // namespace yastl
+#endif // _INCLUDE_PERSISTENT_MAP_H_
@@ -0,0 +1,628 @@
+﻿#ifndef _INCLUDE_PERSISTENT_VECTOR_H_
+#define _INCLUDE_PERSISTENT_VECTOR_H_
+
+// 这个头文件包含一个模板类 persistent_vector
+// persistent_vector : 持久化（不可变）向量，修改操作返回一个新版本，新旧版本共享没有改动的节点
+
+// notes:
+//
+// 底层是分支因子为 32 的基数平衡树（radix balanced tree），元素按下标的二进制每 5 位一层存放在叶子中，
+// 随机访问、set 只经过 O(log32 n) 层；最后一个不满的叶子单独作为尾部保存，push_back、pop_back 大多只复制尾部
+// 没有实现 RRB 树的拼接与切片，所以树中的叶子除尾部外总是满的，下标计算只需要移位
+// 节点带有原子引用计数，复制一个 persistent_vector 只是增加根节点和尾部的计数，最后一个引用消失时才释放节点
+// 已经生成的版本不会再被修改，多个线程可以不加锁地同时读取、复制同一个版本；
+// 对同一个 persistent_vector 变量的赋值与其他线程对它的读取仍需要同步
+// 迭代器不持有引用计数，只在它所属的版本存活期间有效
+
+#include <atomic>
+#include <initializer_list>
+#include <type_traits>
+
+#include "algobase.h"
+#include "allocator.h"
+#include "exceptdef.h"
+#include "iterator.h"
+#include "util.h"
+
+namespace yastl {
+
+// 每层下标的位数与每个节点的子节点数
+constexpr static size_t kPvectorBits = 5;
+constexpr static size_t kPvectorWidth = static_cast<size_t>(1) << kPvectorBits;
+constexpr static size_t kPvectorMask = kPvectorWidth - 1;
+
+// 节点的公共部分，内部节点与叶子由所在的层数区分
+struct pvector_node_base {
+  std::atomic<size_t> refs; // 引用计数
+
+  pvector_node_base() : refs(1) {}
+};
+
+// 内部节点，未使用的子节点为空指针
+struct pvector_branch : public pvector_node_base {
+  pvector_node_base* child[kPvectorWidth];
+
+  pvector_branch() : pvector_node_base(), child() {}
+};
+
+// 叶子，前 count 个元素已经构造
+template <class T>
+struct pvector_leaf : public pvector_node_base {
+  size_t count;
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type data[kPvectorWidth];
+
+  pvector_leaf() : pvector_node_base(), count(0) {}
+
+  T* elements() noexcept {
+    return reinterpret_cast<T*>(data);
+  }
+  const T* elements() const noexcept {
+    return reinterpret_cast<const T*>(data);
+  }
+};
+
+template <class T>
+class persistent_vector;
+
+// persistent_vector 的迭代器，缓存当前叶子的元素指针，只有跨过叶子时才从根向下查找
+template <class T>
+struct pvector_iterator : public yastl::iterator<yastl::random_access_iterator_tag, T> {
+  typedef const T& reference;
+  typedef const T* pointer;
+  typedef ptrdiff_t difference_type;
+  typedef pvector_iterator self;
+
+  const persistent_vector<T>* vec;
+  const T* leaf;  // 下标 index 所在叶子的第一个元素
+  size_t index;
+
+  pvector_iterator() : vec(nullptr), leaf(nullptr), index(0) {}
+  pvector_iterator(const persistent_vector<T>* v, size_t i)
+    : vec(v), leaf(i < v->size() ? v->leaf_for(i) : nullptr), index(i) {}
+
+  reference operator*() const {
+    return leaf[index & kPvectorMask];
+  }
+  pointer operator->() const {
+    return &(operator*());
+  }
+  reference operator[](difference_type n) const {
+    return *(*this + n);
+  }
+
+  self& operator++() {
+    ++index;
+    if ((index & kPvectorMask) == 0) {
+      leaf = index < vec->size() ? vec->leaf_for(index) : nullptr;
+    }
+    return *this;
+  }
+  self operator++(int) {
+    self tmp(*this);
+    ++*this;
+    return tmp;
+  }
+  self& operator--() {
+    --index;
+    if ((index & kPvectorMask) == kPvectorMask || leaf == nullptr) {
+      leaf = vec->leaf_for(index);
+    }
+    return *this;
+  }
+  self operator--(int) {
+    self tmp(*this);
+    --*this;
+    return tmp;
+  }
+
+  self& operator+=(difference_type n) {
+    const size_t i = index + n;
+    if ((i >> kPvectorBits) != (index >> kPvectorBits) || leaf == nullptr) {
+      leaf = i < vec->size() ? vec->leaf_for(i) : nullptr;
+    }
+    index = i;
+    return *this;
+  }
+  self operator+(difference_type n) const {
+    self tmp(*this);
+    return tmp += n;
+  }
+  self& operator-=(difference_type n) {
+    return *this += -n;
+  }
+  self operator-(difference_type n) const {
+    self tmp(*this);
+    return tmp += -n;
+  }
+  difference_type operator-(const self& rhs) const {
+    return static_cast<difference_type>(index) - static_cast<difference_type>(rhs.index);
+  }
+
+  bool operator==(const self& rhs) const {
+    return index == rhs.index;
+  }
+  bool operator!=(const self& rhs) const {
+    return index != rhs.index;
+  }
+  bool operator<(const self& rhs) const {
+    return index < rhs.index;
+  }
+  bool operator>(const self& rhs) const {
+    return rhs < *this;
+  }
+  bool operator<=(const self& rhs) const {
+    return !(rhs < *this);
+  }
+  bool operator>=(const self& rhs) const {
+    return !(*this < rhs);
+  }
+};
+
+// 模板类 persistent_vector
+// 模板参数 T 代表元素类型
+template <class T>
+class persistent_vector {
+  friend struct pvector_iterator<T>;
+
+public:
+  // persistent_vector 的嵌套型别定义
+  typedef T value_type;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef const T& reference;
+  typedef const T& const_reference;
+  typedef const T* pointer;
+  typedef const T* const_pointer;
+
+  typedef pvector_iterator<T> iterator;
+  typedef pvector_iterator<T> const_iterator;
+  typedef yastl::reverse_iterator<const_iterator> reverse_iterator;
+  typedef yastl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+private:
+  typedef pvector_node_base node_type;
+  typedef pvector_branch branch_type;
+  typedef pvector_leaf<T> leaf_type;
+  typedef yastl::allocator<branch_type> branch_allocator;
+  typedef yastl::allocator<leaf_type> leaf_allocator;
+
+  branch_type* root_;  // 除尾部以外的元素，元素不超过一个叶子时为空
+  leaf_type* tail_;    // 最后一个叶子，为空时容器为空
+  size_type size_;
+  size_type shift_;    // 根节点所在层的下标位移，叶子的上一层为 kPvectorBits
+
+public:
+  // 构造、复制、析构函数
+
+  persistent_vector() noexcept : root_(nullptr), tail_(nullptr), size_(0), shift_(kPvectorBits) {}
+
+  persistent_vector(size_type n, const value_type& value) : persistent_vector() {
+    for (; n > 0; --n) {
+      append(value);
+    }
+  }
+
+  template <class Iter, typename std::enable_if<yastl::is_input_iterator<Iter>::value, int>::type = 0>
+  persistent_vector(Iter first, Iter last) : persistent_vector() {
+    for (; first != last; ++first) {
+      append(*first);
+    }
+  }
+
+  persistent_vector(std::initializer_list<value_type> ilist)
+    : persistent_vector(ilist.begin(), ilist.end()) {}
+
+  persistent_vector(const persistent_vector& rhs) noexcept
+    : root_(acquire(rhs.root_)), tail_(acquire(rhs.tail_)), size_(rhs.size_), shift_(rhs.shift_) {}
+
+  persistent_vector(persistent_vector&& rhs) noexcept
+    : root_(rhs.root_), tail_(rhs.tail_), size_(rhs.size_), shift_(rhs.shift_) {
+    rhs.root_ = nullptr;
+    rhs.tail_ = nullptr;
+    rhs.size_ = 0;
+    rhs.shift_ = kPvectorBits;
+  }
+
+  persistent_vector& operator=(const persistent_vector& rhs) noexcept {
+    persistent_vector tmp(rhs);
+    swap(tmp);
+    return *this;
+  }
+  persistent_vector& operator=(persistent_vector&& rhs) noexcept {
+    persistent_vector tmp(yastl::move(rhs));
+    swap(tmp);
+    return *this;
+  }
+
+  ~persistent_vector() {
+    release(root_, shift_);
+    release(tail_, 0);
+  }
+
+  // 迭代器相关
+  const_iterator begin() const noexcept {
+    return const_iterator(this, 0);
+  }
+  const_iterator end() const noexcept {
+    return const_iterator(this, size_);
+  }
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+  const_iterator cend() const noexcept {
+    return end();
+  }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  // 容量相关
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+  size_type size() const noexcept {
+    return size_;
+  }
+
+  // 访问元素相关
+  const_reference operator[](size_type n) const {
+    YASTL_DEBUG(n < size_);
+    return leaf_for(n)[n & kPvectorMask];
+  }
+  const_reference at(size_type n) const {
+    THROW_OUT_OF_RANGE_IF(!(n < size_), "persistent_vector<T>::at() subscript out of range");
+    return (*this)[n];
+  }
+  const_reference front() const {
+    YASTL_DEBUG(!empty());
+    return (*this)[0];
+  }
+  const_reference back() const {
+    YASTL_DEBUG(!empty());
+    return tail_->elements()[tail_->count - 1];
+  }
+
+  // 产生新版本的操作，原版本保持不变
+
+  // 在尾部添加 value
+  persistent_vector push_back(const value_type& value) const {
+    persistent_vector result(*this);
+    result.append(value);
+    return result;
+  }
+
+  // 删除最后一个元素
+  persistent_vector pop_back() const;
+
+  // 把下标为 n 的元素替换为 value
+  persistent_vector set(size_type n, const value_type& value) const;
+
+  void swap(persistent_vector& rhs) noexcept {
+    yastl::swap(root_, rhs.root_);
+    yastl::swap(tail_, rhs.tail_);
+    yastl::swap(size_, rhs.size_);
+    yastl::swap(shift_, rhs.shift_);
+  }
+
+public:
+  friend bool operator==(const persistent_vector& lhs, const persistent_vector& rhs) {
+    return lhs.size_ == rhs.size_ && yastl::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+  friend bool operator!=(const persistent_vector& lhs, const persistent_vector& rhs) {
+    return !(lhs == rhs);
+  }
+
+private:
+  // helper functions
+
+  // 尾部第一个元素的下标
+  size_type tail_offset() const noexcept {
+    return size_ < kPvectorWidth ? 0 : ((size_ - 1) >> kPvectorBits) << kPvectorBits;
+  }
+
+  // 下标 n 所在的叶子
+  leaf_type* leaf_node_for(size_type n) const noexcept {
+    if (n >= tail_offset()) {
+      return tail_;
+    }
+    node_type* x = root_;
+    for (size_type level = shift_; level > 0; level -= kPvectorBits) {
+      x = static_cast<branch_type*>(x)->child[(n >> level) & kPvectorMask];
+    }
+    return static_cast<leaf_type*>(x);
+  }
+
+  // 下标 n 所在叶子的第一个元素
+  const T* leaf_for(size_type n) const noexcept {
+    return leaf_node_for(n)->elements();
+  }
+
+  template <class Node>
+  static Node* acquire(Node* x) noexcept {
+    if (x != nullptr) {
+      x->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return x;
+  }
+
+  // 释放层数为 level 的节点 x 的一个引用，level 为 0 时 x 是叶子
+  static void release(node_type* x, size_type level) noexcept;
+
+  static branch_type* create_branch() {
+    branch_type* x = branch_allocator::allocate(1);
+    branch_allocator::construct(x);
+    return x;
+  }
+  static branch_type* copy_branch(const branch_type* src) {
+    branch_type* x = create_branch();
+    for (size_type i = 0; i < kPvectorWidth; ++i) {
+      x->child[i] = acquire(src->child[i]);
+    }
+    return x;
+  }
+  static leaf_type* copy_leaf(const leaf_type* src, size_type count);
+
+  void append(const value_type& value);
+  node_type* push_tail(const branch_type* parent, size_type level, leaf_type* tail) const;
+  static node_type* new_path(size_type level, leaf_type* tail);
+  node_type* pop_tail(const branch_type* x, size_type level) const;
+  static node_type* set_in(const node_type* x, size_type level, size_type n, const value_type& value);
+};
+
+/*****************************************************************************************/
+
+template <class T>
+void persistent_vector<T>::release(node_type* x, size_type level) noexcept {
+  if (x == nullptr || x->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  if (level == 0) {
+    leaf_type* leaf = static_cast<leaf_type*>(x);
+    yastl::destroy(leaf->elements(), leaf->elements() + leaf->count);
+    leaf_allocator::destroy(leaf);
+    leaf_allocator::deallocate(leaf);
+    return;
+  }
+  branch_type* branch = static_cast<branch_type*>(x);
+  for (size_type i = 0; i < kPvectorWidth; ++i) {
+    release(branch->child[i], level - kPvectorBits);
+  }
+  branch_allocator::destroy(branch);
+  branch_allocator::deallocate(branch);
+}
+
+// 复制 src 的前 count 个元素到一个新叶子
+template <class T>
+typename persistent_vector<T>::leaf_type*
+persistent_vector<T>::copy_leaf(const leaf_type* src, size_type count) {
+  leaf_type* x = leaf_allocator::allocate(1);
+  leaf_allocator::construct(x);
+  try {
+    for (; x->count < count; ++x->count) {
+      yastl::construct(x->elements() + x->count, src->elements()[x->count]);
+    }
+  } catch (...) {
+    release(x, 0);
+    throw;
+  }
+  return x;
+}
+
+// 在当前版本的尾部添加 value：尾部只被当前版本持有时直接构造，否则复制一份尾部；
+// 尾部已满时先把它挂进树中，再开始一个新的尾部
+template <class T>
+void persistent_vector<T>::append(const value_type& value) {
+  if (tail_ != nullptr && tail_->count == kPvectorWidth) {
+    leaf_type* tail = tail_;
+    branch_type* root;
+    size_type shift = shift_;
+    if (root_ == nullptr) {
+      root = create_branch();
+      root->child[0] = acquire(tail);
+    } else if ((size_ >> kPvectorBits) > (static_cast<size_type>(1) << shift_)) {
+      // 根已满，树增高一层
+      root = create_branch();
+      root->child[0] = acquire(root_);
+      try {
+        root->child[1] = new_path(shift_, tail);
+      } catch (...) {
+        release(root, shift_ + kPvectorBits);
+        throw;
+      }
+      shift += kPvectorBits;
+    } else {
+      root = static_cast<branch_type*>(push_tail(root_, shift_, tail));
+    }
+    leaf_type* fresh = nullptr;
+    try {
+      fresh = leaf_allocator::allocate(1);
+      leaf_allocator::construct(fresh);
+      yastl::construct(fresh->elements(), value);
+    } catch (...) {
+      if (fresh != nullptr) {
+        release(fresh, 0);
+      }
+      release(root, shift);
+      throw;
+    }
+    fresh->count = 1;
+    release(root_, shift_);
+    release(tail_, 0);
+    root_ = root;
+    tail_ = fresh;
+    shift_ = shift;
+    ++size_;
+    return;
+  }
+  if (tail_ == nullptr) {
+    tail_ = leaf_allocator::allocate(1);
+    leaf_allocator::construct(tail_);
+  } else if (tail_->refs.load(std::memory_order_acquire) != 1) {
+    leaf_type* tail = copy_leaf(tail_, tail_->count);
+    release(tail_, 0);
+    tail_ = tail;
+  }
+  yastl::construct(tail_->elements() + tail_->count, value);
+  ++tail_->count;
+  ++size_;
+}
+
+// 复制从 parent 到新叶子位置的路径，把满的尾部 tail 挂到树的最右侧，返回新的节点
+template <class T>
+typename persistent_vector<T>::node_type*
+persistent_vector<T>::push_tail(const branch_type* parent, size_type level, leaf_type* tail) const {
+  const size_type i = ((size_ - 1) >> level) & kPvectorMask;
+  branch_type* x = copy_branch(parent);
+  try {
+    node_type* child;
+    if (level == kPvectorBits) {
+      child = acquire(tail);
+    } else if (parent->child[i] != nullptr) {
+      child = push_tail(static_cast<const branch_type*>(parent->child[i]), level - kPvectorBits, tail);
+    } else {
+      child = new_path(level - kPvectorBits, tail);
+    }
+    release(x->child[i], level - kPvectorBits);
+    x->child[i] = child;
+  } catch (...) {
+    release(x, level);
+    throw;
+  }
+  return x;
+}
+
+// 一条只有最左侧子节点的路径，最底层是叶子 tail
+template <class T>
+typename persistent_vector<T>::node_type*
+persistent_vector<T>::new_path(size_type level, leaf_type* tail) {
+  if (level == 0) {
+    return acquire(tail);
+  }
+  branch_type* x = create_branch();
+  try {
+    x->child[0] = new_path(level - kPvectorBits, tail);
+  } catch (...) {
+    release(x, level);
+    throw;
+  }
+  return x;
+}
+
+// 复制去掉最右侧叶子以后的路径，路径变空时返回空指针
+template <class T>
+typename persistent_vector<T>::node_type*
+persistent_vector<T>::pop_tail(const branch_type* x, size_type level) const {
+  const size_type i = ((size_ - 2) >> level) & kPvectorMask;
+  node_type* child = nullptr;
+  if (level > kPvectorBits) {
+    child = pop_tail(static_cast<const branch_type*>(x->child[i]), level - kPvectorBits);
+    if (child == nullptr && i == 0) {
+      return nullptr;
+    }
+  } else if (i == 0) {
+    return nullptr;
+  }
+  branch_type* result;
+  try {
+    result = copy_branch(x);
+  } catch (...) {
+    release(child, level - kPvectorBits);
+    throw;
+  }
+  release(result->child[i], level - kPvectorBits);
+  result->child[i] = child;
+  return result;
+}
+
+template <class T>
+persistent_vector<T> persistent_vector<T>::pop_back() const {
+  YASTL_DEBUG(!empty());
+  persistent_vector result;
+  if (tail_->count > 1) {
+    result.tail_ = copy_leaf(tail_, tail_->count - 1);
+    result.root_ = acquire(root_);
+    result.shift_ = shift_;
+    result.size_ = size_ - 1;
+    return result;
+  }
+  if (size_ == 1) {
+    return result;
+  }
+  // 尾部只剩一个元素，树中最后一个叶子成为新的尾部
+  result.tail_ = acquire(leaf_node_for(size_ - 2));
+  result.size_ = size_ - 1;
+  branch_type* root = static_cast<branch_type*>(pop_tail(root_, shift_));
+  size_type shift = shift_;
+  if (root != nullptr && shift > kPvectorBits && root->child[1] == nullptr) {
+    // 根只剩一个子节点，树降低一层
+    branch_type* child = static_cast<branch_type*>(acquire(root->child[0]));
+    release(root, shift);
+    root = child;
+    shift -= kPvectorBits;
+  }
+  result.root_ = root;
+  result.shift_ = root == nullptr ? kPvectorBits : shift;
+  return result;
+}
+
+// 复制从 x 到下标 n 所在叶子的路径，并替换该元素
+template <class T>
+typename persistent_vector<T>::node_type*
+persistent_vector<T>::set_in(const node_type* x, size_type level, size_type n, const value_type& value) {
+  if (level == 0) {
+    const leaf_type* src = static_cast<const leaf_type*>(x);
+    leaf_type* leaf = leaf_allocator::allocate(1);
+    leaf_allocator::construct(leaf);
+    try {
+      for (; leaf->count < src->count; ++leaf->count) {
+        yastl::construct(leaf->elements() + leaf->count,
+                         leaf->count == (n & kPvectorMask) ? value : src->elements()[leaf->count]);
+      }
+    } catch (...) {
+      release(leaf, 0);
+      throw;
+    }
+    return leaf;
+  }
+  const branch_type* src = static_cast<const branch_type*>(x);
+  const size_type i = (n >> level) & kPvectorMask;
+  node_type* child = set_in(src->child[i], level - kPvectorBits, n, value);
+  branch_type* result;
+  try {
+    result = copy_branch(src);
+  } catch (...) {
+    release(child, level - kPvectorBits);
+    throw;
+  }
+  release(result->child[i], level - kPvectorBits);
+  result->child[i] = child;
+  return result;
+}
+
+template <class T>
+persistent_vector<T> persistent_vector<T>::set(size_type n, const value_type& value) const {
+  THROW_OUT_OF_RANGE_IF(!(n < size_), "persistent_vector<T>::set() subscript out of range");
+  persistent_vector result(*this);
+  if (n >= tail_offset()) {
+    leaf_type* tail = static_cast<leaf_type*>(set_in(tail_, 0, n, value));
+    release(result.tail_, 0);
+    result.tail_ = tail;
+  } else {
+    branch_type* root = static_cast<branch_type*>(set_in(root_, shift_, n, value));
+    release(result.root_, shift_);
+    result.root_ = root;
+  }
+  return result;
+}
+
+// 重载 yastl 的 swap
+template <class T>
+void swap(persistent_vector<T>& lhs, persistent_vector<T>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+} // namespace yastl
+#endif // _INCLUDE_PERSISTENT_VECTOR_H_
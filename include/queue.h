@@ -6,6 +6,7 @@
 // priority_queue : 优先队列
 
 #include "deque.h"
+#include "ring_buffer.h"
 #include "vector.h"
 #include "functional.h"
 #include "heap_algo.h"
@@ -102,6 +103,14 @@ public:
     c_.emplace_back(yastl::move(value));
   }
 
+  // 底层容器为固定容量的 ring_buffer 时使用，已满则返回 false
+  bool try_push(const value_type& value) {
+    return c_.try_push_back(value);
+  }
+  bool try_push(value_type&& value) {
+    return c_.try_push_back(yastl::move(value));
+  }
+
   void pop() {
     c_.pop_front();
   }
@@ -0,0 +1,345 @@
+﻿#ifndef _INCLUDE_RADIX_ALGO_H_
+#define _INCLUDE_RADIX_ALGO_H_
+
+// 这个头文件包含基数排序 radix_sort 和 radix_sort_by_key
+
+// notes:
+//
+// radix_sort_by_key 使用 LSD（从低字节到高字节）基数排序，是稳定的，键可以是
+//   * 有符号 / 无符号整数：有符号数翻转符号位
+//   * float / double：负数按位取反，非负数翻转符号位，使编码后的无符号数与浮点数顺序一致（-0.0 排在 0.0 之前，NaN 按位排在两端）
+//   * 由以上类型组成的 pair，先按 first 再按 second
+// 大区间先按最高字节做 MSD 分桶，桶足够小时再对低位字节做 LSD，避免每一趟都在整个区间上随机写
+// LSD 一次遍历统计所有字节的直方图，所有元素某个字节都相同时跳过这一趟
+// 来回分配使用 temporary_buffer 申请的缓冲区，申请失败时退化为 sort（此时不保证稳定）
+//
+// radix_sort 对 std::string 使用 MSD（从高字节到低字节）的原地 American flag sort，小区间改用插入排序
+
+#include <cstring>
+#include <cstdint>
+#include <string>
+
+#include "algo.h"
+#include "memory.h"
+#include "vector.h"
+#include "util.h"
+
+namespace yastl {
+
+// 小于这个大小时改用插入排序
+constexpr static size_t kRadixInsertionThreshold = 32;
+// MSD 分出的桶不超过这个大小时改用 LSD
+constexpr static size_t kRadixLsdThreshold = 1 << 16;
+
+/*****************************************************************************************/
+// radix_key_traits
+// 把键映射为按字节比较的无符号数，byte(k, i) 取出第 i 个字节，i 为 0 时是最低的字节
+/*****************************************************************************************/
+template <class K, class Enable = void>
+struct radix_key_traits;
+
+// 整数
+template <class K>
+struct radix_key_traits<K, typename std::enable_if<std::is_integral<K>::value &&
+                                                   !std::is_same<K, bool>::value>::type> {
+  typedef typename std::make_unsigned<K>::type unsigned_type;
+  static constexpr size_t bytes = sizeof(K);
+
+  static unsigned_type encode(K k) noexcept {
+    return std::is_signed<K>::value
+      ? static_cast<unsigned_type>(static_cast<unsigned_type>(k) ^ (unsigned_type(1) << (bytes * 8 - 1)))
+      : static_cast<unsigned_type>(k);
+  }
+  static unsigned byte(K k, size_t i) noexcept {
+    return static_cast<unsigned>((encode(k) >> (i * 8)) & 0xff);
+  }
+};
+
+// 浮点数
+template <class K, class U>
+struct radix_float_traits {
+  typedef U unsigned_type;
+  static constexpr size_t bytes = sizeof(K);
+
+  static unsigned_type encode(K k) noexcept {
+    unsigned_type u;
+    std::memcpy(&u, &k, sizeof(k));
+    const unsigned_type sign = unsigned_type(1) << (bytes * 8 - 1);
+    return (u & sign) ? static_cast<unsigned_type>(~u) : static_cast<unsigned_type>(u | sign);
+  }
+  static unsigned byte(K k, size_t i) noexcept {
+    return static_cast<unsigned>((encode(k) >> (i * 8)) & 0xff);
+  }
+};
+
+template <>
+struct radix_key_traits<float> : radix_float_traits<float, uint32_t> {};
+
+template <>
+struct radix_key_traits<double> : radix_float_traits<double, uint64_t> {};
+
+// pair：second 是低位，first 是高位
+template <class A, class B>
+struct radix_key_traits<yastl::pair<A, B>> {
+  typedef radix_key_traits<typename std::remove_cv<A>::type> first_traits;
+  typedef radix_key_traits<typename std::remove_cv<B>::type> second_traits;
+  static constexpr size_t bytes = first_traits::bytes + second_traits::bytes;
+
+  static unsigned byte(const yastl::pair<A, B>& k, size_t i) noexcept {
+    return i < second_traits::bytes ? second_traits::byte(k.second, i)
+                                    : first_traits::byte(k.first, i - second_traits::bytes);
+  }
+};
+
+// 默认的取键函数，键就是元素本身
+template <class T>
+struct radix_identity_key {
+  const T& operator()(const T& x) const noexcept {
+    return x;
+  }
+};
+
+/*****************************************************************************************/
+// radix_sort_by_key
+/*****************************************************************************************/
+
+// 按编码后的键比较两个元素，用于小区间的插入排序和缓冲区申请失败时的退化
+template <class KeyFunc, class Key>
+struct radix_key_less {
+  typedef radix_key_traits<Key> traits;
+  KeyFunc& key;
+
+  explicit radix_key_less(KeyFunc& k) : key(k) {}
+
+  template <class T>
+  bool operator()(const T& a, const T& b) const {
+    const Key ka = key(a);
+    const Key kb = key(b);
+    for (size_t i = traits::bytes; i-- > 0; ) {
+      const unsigned x = traits::byte(ka, i);
+      const unsigned y = traits::byte(kb, i);
+      if (x != y) {
+        return x < y;
+      }
+    }
+    return false;
+  }
+};
+
+// 按第 pass 个字节把 src 中的 n 个元素分配到 dst，offset 为各个桶的起始位置
+template <class SrcIter, class DstIter, class KeyFunc, class Traits>
+void radix_scatter(SrcIter src, size_t n, DstIter dst, KeyFunc& key, size_t pass, size_t* offset, Traits) {
+  for (size_t i = 0; i < n; ++i, ++src) {
+    const unsigned b = Traits::byte(key(*src), pass);
+    *(dst + offset[b]++) = yastl::move(*src);
+  }
+}
+
+// LSD：按低 hi 个字节排序，数据在 first 或 buf 中（in_buffer），结果放回 first
+template <class RandomIter, class T, class KeyFunc, class Traits>
+void radix_lsd(RandomIter first, T* buf, size_t n, size_t hi, bool in_buffer, KeyFunc& key, Traits) {
+  typedef typename std::decay<decltype(key(*first))>::type key_type;
+  // 一次遍历统计每个字节的直方图
+  size_t count[Traits::bytes][256];
+  yastl::fill_n(&count[0][0], hi * 256, size_t(0));
+  if (in_buffer) {
+    for (size_t i = 0; i < n; ++i) {
+      const key_type k = key(buf[i]);
+      for (size_t p = 0; p < hi; ++p) {
+        ++count[p][Traits::byte(k, p)];
+      }
+    }
+  } else {
+    for (RandomIter it = first; it != first + n; ++it) {
+      const key_type k = key(*it);
+      for (size_t p = 0; p < hi; ++p) {
+        ++count[p][Traits::byte(k, p)];
+      }
+    }
+  }
+  // 所有元素这个字节都相同时跳过这一趟
+  const key_type k0 = in_buffer ? key(buf[0]) : key(*first);
+  size_t offset[256];
+  for (size_t p = 0; p < hi; ++p) {
+    if (count[p][Traits::byte(k0, p)] == n) {
+      continue;
+    }
+    size_t sum = 0;
+    for (size_t b = 0; b < 256; ++b) {
+      offset[b] = sum;
+      sum += count[p][b];
+    }
+    if (in_buffer) {
+      radix_scatter(buf, n, first, key, p, offset, Traits());
+    } else {
+      radix_scatter(first, n, buf, key, p, offset, Traits());
+    }
+    in_buffer = !in_buffer;
+  }
+  if (in_buffer) {
+    yastl::move(buf, buf + n, first);
+  }
+}
+
+// MSD：按第 hi - 1 个字节分桶，桶足够小时改用 LSD 处理剩下的低位字节，使来回分配都发生在缓存中
+template <class RandomIter, class T, class KeyFunc, class Traits>
+void radix_msd(RandomIter first, T* buf, size_t n, size_t hi, bool in_buffer, KeyFunc& key, Traits) {
+  typedef typename std::decay<decltype(key(*first))>::type key_type;
+  while (true) {
+    if (n < kRadixInsertionThreshold) {
+      if (in_buffer) {
+        yastl::move(buf, buf + n, first);
+      }
+      yastl::pdq_insertion_sort(first, first + n, radix_key_less<KeyFunc, key_type>(key));
+      return;
+    }
+    if (n <= kRadixLsdThreshold || hi == 1) {
+      yastl::radix_lsd(first, buf, n, hi, in_buffer, key, Traits());
+      return;
+    }
+    const size_t p = hi - 1;
+    size_t count[256] = {0};
+    if (in_buffer) {
+      for (size_t i = 0; i < n; ++i) {
+        ++count[Traits::byte(key(buf[i]), p)];
+      }
+    } else {
+      for (RandomIter it = first; it != first + n; ++it) {
+        ++count[Traits::byte(key(*it), p)];
+      }
+    }
+    // 最高的字节都相同，直接看下一个字节
+    const unsigned b0 = Traits::byte(in_buffer ? key(buf[0]) : key(*first), p);
+    if (count[b0] == n) {
+      hi = p;
+      continue;
+    }
+    size_t start[257];
+    size_t offset[256];
+    start[0] = 0;
+    for (size_t b = 0; b < 256; ++b) {
+      offset[b] = start[b];
+      start[b + 1] = start[b] + count[b];
+    }
+    if (in_buffer) {
+      radix_scatter(buf, n, first, key, p, offset, Traits());
+    } else {
+      radix_scatter(first, n, buf, key, p, offset, Traits());
+    }
+    for (size_t b = 0; b < 256; ++b) {
+      if (count[b] != 0) {
+        yastl::radix_msd(first + start[b], buf + start[b], count[b], p, !in_buffer, key, Traits());
+      }
+    }
+    return;
+  }
+}
+
+template <class RandomIter, class KeyFunc>
+void radix_sort_by_key(RandomIter first, RandomIter last, KeyFunc key) {
+  typedef typename iterator_traits<RandomIter>::value_type T;
+  typedef typename std::decay<decltype(key(*first))>::type key_type;
+  typedef radix_key_traits<key_type> traits;
+
+  const size_t n = static_cast<size_t>(last - first);
+  if (n < kRadixInsertionThreshold) {
+    yastl::pdq_insertion_sort(first, last, radix_key_less<KeyFunc, key_type>(key));
+    return;
+  }
+  temporary_buffer<RandomIter, T> buf(first, last);
+  if (buf.size() < static_cast<ptrdiff_t>(n)) {
+    yastl::sort(first, last, radix_key_less<KeyFunc, key_type>(key));
+    return;
+  }
+  yastl::radix_msd(first, buf.begin(), n, traits::bytes, false, key, traits());
+}
+
+/*****************************************************************************************/
+// radix_sort
+/*****************************************************************************************/
+
+// 字符串在 depth 处的字符，0 表示已经结束，其他字符加一
+inline unsigned radix_char_at(const std::string& s, size_t depth) noexcept {
+  return depth < s.size() ? static_cast<unsigned>(static_cast<unsigned char>(s[depth])) + 1 : 0;
+}
+
+// 前 depth 个字符都相同的字符串的插入排序
+template <class RandomIter>
+void radix_string_insertion_sort(RandomIter first, RandomIter last, size_t depth) {
+  yastl::pdq_insertion_sort(first, last, [depth](const std::string& a, const std::string& b) {
+    return a.compare(depth, std::string::npos, b, depth, std::string::npos) < 0;
+  });
+}
+
+// MSD 的 American flag sort：统计 depth 处的字符，原地把元素交换到各自的桶，再对每个桶递归
+template <class RandomIter>
+void radix_sort_strings(RandomIter first, RandomIter last, size_t depth) {
+  while (true) {
+    const size_t n = static_cast<size_t>(last - first);
+    if (n < kRadixInsertionThreshold) {
+      yastl::radix_string_insertion_sort(first, last, depth);
+      return;
+    }
+
+    size_t count[257] = {0};
+    for (RandomIter it = first; it != last; ++it) {
+      ++count[radix_char_at(*it, depth)];
+    }
+    // 所有字符串这一位都相同，直接看下一位
+    const unsigned c0 = radix_char_at(*first, depth);
+    if (count[c0] == n) {
+      if (c0 == 0) {
+        return;
+      }
+      ++depth;
+      continue;
+    }
+
+    size_t start[257];
+    size_t next[257];
+    size_t sum = 0;
+    for (size_t b = 0; b < 257; ++b) {
+      start[b] = next[b] = sum;
+      sum += count[b];
+    }
+    for (size_t b = 0; b < 257; ++b) {
+      const size_t end = start[b] + count[b];
+      while (next[b] < end) {
+        const unsigned c = radix_char_at(*(first + next[b]), depth);
+        if (c == b) {
+          ++next[b];
+        } else {
+          yastl::iter_swap(first + next[b], first + next[c]++);
+        }
+      }
+    }
+    // 桶 0 中的字符串已经结束，全部相等
+    for (size_t b = 1; b < 257; ++b) {
+      if (count[b] > 1) {
+        yastl::radix_sort_strings(first + start[b], first + (start[b] + count[b]), depth + 1);
+      }
+    }
+    return;
+  }
+}
+
+template <class RandomIter>
+void radix_sort_dispatch(RandomIter first, RandomIter last, m_true_type) {
+  yastl::radix_sort_strings(first, last, 0);
+}
+
+template <class RandomIter>
+void radix_sort_dispatch(RandomIter first, RandomIter last, m_false_type) {
+  typedef typename iterator_traits<RandomIter>::value_type T;
+  yastl::radix_sort_by_key(first, last, radix_identity_key<T>());
+}
+
+// 对整数、浮点数、它们组成的 pair 以及 std::string 进行排序
+template <class RandomIter>
+void radix_sort(RandomIter first, RandomIter last) {
+  typedef typename iterator_traits<RandomIter>::value_type T;
+  yastl::radix_sort_dispatch(first, last, m_bool_constant<std::is_same<T, std::string>::value>());
+}
+
+} // namespace yastl
+#endif // _INCLUDE_RADIX_ALGO_H_
@@ -4,9 +4,20 @@
 // 这个头文件包含一个模板类 rb_tree
 // rb_tree : 红黑树
 
+// notes:
+//
+// 节点的颜色存放在父节点指针的最低位：节点至少按指针大小对齐，地址的最低位恒为 0，
+// 节点因此只有三个指针大小，64 位下 map<int, int> 的节点从 40 字节减为 32 字节
+// 父节点和颜色只能通过 parent() / set_parent() / color() / set_color() 访问，根节点存放在 header_ 的父节点中
+//
+// 第三个模板参数 Augment 是子树信息的维护策略，默认的 rb_tree_no_augment 不维护任何信息
+// 增强的节点在 rb_tree_node 之后额外保存一个 Data，旋转、插入、删除时按自底向上的顺序调用 Augment::update 重新计算，
+// interval_map.h 与 aggregate_map.h 中的容器都建立在它之上
+
 #include <initializer_list>
 
 #include <cassert>
+#include <cstdint>
 
 #include "functional.h"
 #include "iterator.h"
@@ -26,6 +37,7 @@ static constexpr rb_tree_color_type rb_tree_black = true;
 
 template <class T> struct rb_tree_node_base;
 template <class T> struct rb_tree_node;
+template <class T> struct rb_tree_no_augment;
 
 template <class T> struct rb_tree_iterator;
 template <class T> struct rb_tree_const_iterator;
@@ -112,10 +124,26 @@ struct rb_tree_node_base {
   typedef rb_tree_node_base<T>* base_ptr; // 只有连接关系的指针
   typedef rb_tree_node<T>* node_ptr; // 继承自base_ptr的指针，包含value
 
-  base_ptr parent;  // 父节点
+  uintptr_t parent_color;  // 父节点指针，最低位为节点颜色
   base_ptr left;    // 左子节点
   base_ptr right;   // 右子节点
-  color_type color;   // 节点颜色
+
+  base_ptr parent() const noexcept {
+    return reinterpret_cast<base_ptr>(parent_color & ~static_cast<uintptr_t>(1));
+  }
+  color_type color() const noexcept {
+    return static_cast<color_type>(parent_color & 1);
+  }
+
+  void set_parent(base_ptr p) noexcept { // 保留原来的颜色
+    parent_color = reinterpret_cast<uintptr_t>(p) | (parent_color & 1);
+  }
+  void set_color(color_type c) noexcept {
+    parent_color = (parent_color & ~static_cast<uintptr_t>(1)) | static_cast<uintptr_t>(c);
+  }
+  void set_parent_color(base_ptr p, color_type c) noexcept {
+    parent_color = reinterpret_cast<uintptr_t>(p) | static_cast<uintptr_t>(c);
+  }
 
   base_ptr get_base_ptr() { // 返回关系指针的地址
     return &*this;
@@ -146,6 +174,51 @@ struct rb_tree_node : public rb_tree_node_base<T> {
   }
 };
 
+// 增强的节点，额外保存子树信息 data
+template <class T, class Data>
+struct rb_tree_augmented_node : public rb_tree_node<T> {
+  Data data;  // 子树信息
+};
+
+// rb tree 子树信息的维护策略
+// node_type 为树使用的节点类型，必须以 rb_tree_node<T> 为基类
+// construct / destroy 构造、析构节点中的额外数据，construct 不能抛出异常；copy 在复制节点时复制额外数据
+// update(x) 在 x 的值或者子树结构改变之后，由 x 的值与左右子节点的信息重新计算 x 的信息
+template <class T>
+struct rb_tree_no_augment {
+  typedef rb_tree_node<T> node_type;
+  typedef rb_tree_node_base<T>* base_ptr;
+
+  void construct(node_type*) const noexcept {}
+  void destroy(node_type*) const noexcept {}
+  void copy(base_ptr, base_ptr) const noexcept {}
+  void update(base_ptr) const noexcept {}
+};
+
+// 在节点中保存一个 Data 的策略的基类，派生类只需要提供 update
+template <class T, class Data>
+struct rb_tree_augment_base {
+  typedef rb_tree_augmented_node<T, Data> node_type;
+  typedef rb_tree_node_base<T>* base_ptr;
+
+  static Data& data(base_ptr x) noexcept {
+    return static_cast<node_type*>(x)->data;
+  }
+  static const T& value(base_ptr x) noexcept {
+    return static_cast<node_type*>(x)->value;
+  }
+
+  void construct(node_type* p) const noexcept {
+    yastl::allocator<Data>::construct(yastl::address_of(p->data));
+  }
+  void destroy(node_type* p) const noexcept {
+    yastl::allocator<Data>::destroy(yastl::address_of(p->data));
+  }
+  void copy(base_ptr to, base_ptr from) const {
+    data(to) = data(from);
+  }
+};
+
 // rb tree traits
 
 template <class T>
@@ -180,10 +253,10 @@ struct rb_tree_iterator_base :public yastl::iterator<yastl::bidirectional_iterat
     if (node->right != nullptr) { 
       node = rb_tree_min(node->right); // 取右边最小的那个
     } else {  // 如果没有右子节点
-      auto p = node->parent;
+      auto p = node->parent();
       while (p->right == node) { // 一直向上遍历，直到父节点的右孩子不是前一个节点，这个父节点就是我们要的
         node = p;
-        p = node->parent;
+        p = node->parent();
       }
 
       if (node->right != p) { // 不是“寻找根节点的下一节点，而根节点没有右子节点”的特殊情况
@@ -196,15 +269,15 @@ struct rb_tree_iterator_base :public yastl::iterator<yastl::bidirectional_iterat
 
   // 使迭代器后退
   void dec() {
-    if (node->parent->parent == node && rb_tree_is_red(node)) { // 如果 node 为 header
+    if (node->parent()->parent() == node && rb_tree_is_red(node)) { // 如果 node 为 header
       node = node->right;  // 指向整棵树的 max 节点
     } else if (node->left != nullptr) {
       node = rb_tree_max(node->left);
     } else {  // 非 header 节点，也无左子节点
-      auto p = node->parent;
+      auto p = node->parent();
       while (node == p->left) {
         node = p;
-        p = node->parent;
+        p = node->parent();
       }
       node = p;
     }
@@ -248,6 +321,7 @@ struct rb_tree_iterator : public rb_tree_iterator_base<T> {
   rb_tree_iterator(const const_iterator& rhs) {
     node = rhs.node;
   }
+  self& operator=(const self&) = default;
 
   // 重载操作符
   reference operator*() const {
@@ -310,6 +384,7 @@ struct rb_tree_const_iterator : public rb_tree_iterator_base<T> {
   rb_tree_const_iterator(const const_iterator& rhs) {
     node = rhs.node;
   }
+  self& operator=(const self&) = default;
 
   // 重载操作符
   reference operator*() const {
@@ -361,24 +436,36 @@ NodePtr rb_tree_max(NodePtr x) noexcept {
 // 返回该节点是不是左孩子
 template <class NodePtr>
 bool rb_tree_is_lchild(NodePtr node) noexcept {
-  return node == node->parent->left;
+  return node == node->parent()->left;
 }
 // 返回该节点是不是右孩子
 template <class NodePtr>
 bool rb_tree_is_red(NodePtr node) noexcept {
-  return node->color == rb_tree_red;
+  return node->color() == rb_tree_red;
 }
 // 染黑node节点
 template <class NodePtr>
-void rb_tree_set_black(NodePtr& node) noexcept {
-  node->color = rb_tree_black;
+void rb_tree_set_black(NodePtr node) noexcept {
+  node->set_color(rb_tree_black);
 }
 // 染红node节点
 template <class NodePtr>
-void rb_tree_set_red(NodePtr& node) noexcept {
-  node->color = rb_tree_red;
+void rb_tree_set_red(NodePtr node) noexcept {
+  node->set_color(rb_tree_red);
 }
 
+// 从 x 开始沿父节点向上，依次更新子树信息直到根节点
+template <class NodePtr, class Augment>
+void rb_tree_update_path(NodePtr x, NodePtr header, const Augment& aug) {
+  for (; x != header; x = x->parent()) {
+    aug.update(x);
+  }
+}
+
+// 不维护子树信息时什么也不做
+template <class NodePtr, class T>
+void rb_tree_update_path(NodePtr, NodePtr, const rb_tree_no_augment<T>&) noexcept {}
+
 // 返回node的下一个节点，中序遍历的后一个节点
 template <class NodePtr>
 NodePtr rb_tree_next(NodePtr node) noexcept {
@@ -386,9 +473,9 @@ NodePtr rb_tree_next(NodePtr node) noexcept {
     return rb_tree_min(node->right);
   }
   while (!rb_tree_is_lchild(node)) { // 没右孩子了，向上找爹 向上溯源直到node为左孩子
-    node = node->parent;
+    node = node->parent();
   }
-  return node->parent;
+  return node->parent();
 }
 
 /*---------------------------------------*\
@@ -400,26 +487,29 @@ NodePtr rb_tree_next(NodePtr node) noexcept {
 |      / \                   / \          |
 |     b   c                 a   b         |
 \*---------------------------------------*/
-// 左旋，并不染色，参数一为左旋点，参数二为根节点，传值为引用，当涉及根节点变动时需要操作
-template <class NodePtr>
-void rb_tree_rotate_left(NodePtr x, NodePtr& root) noexcept {
+// 左旋，并不染色，参数一为左旋点，参数二为 header，根节点存放在 header 的父节点中，当涉及根节点变动时需要操作
+template <class NodePtr, class Augment>
+void rb_tree_rotate_left(NodePtr x, NodePtr header, const Augment& aug) {
   auto y = x->right;  // y 为 x 的右子节点
   x->right = y->left;
   if (y->left != nullptr) { // y的左孩子如果是空节点则省略赋值parent这步
-    y->left->parent = x;
+    y->left->set_parent(x);
   }
-  y->parent = x->parent;
+  y->set_parent(x->parent());
 
-  if (x == root) { // 如果 x 为根节点，让 y 顶替 x 成为根节点
-    root = y;
+  if (x == header->parent()) { // 如果 x 为根节点，让 y 顶替 x 成为根节点
+    header->set_parent(y);
   } else if (rb_tree_is_lchild(x)) { // 如果 x 是左子节点
-    x->parent->left = y;
+    x->parent()->left = y;
   } else { // 如果 x 是右子节点
-    x->parent->right = y;
+    x->parent()->right = y;
   }
   // 调整 x 与 y 的关系
   y->left = x;
-  x->parent = y;
+  x->set_parent(y);
+  // x 成为 y 的子节点，先更新 x 再更新 y
+  aug.update(x);
+  aug.update(y);
 }
 
 /*----------------------------------------*\
@@ -431,29 +521,32 @@ void rb_tree_rotate_left(NodePtr x, NodePtr& root) noexcept {
 |    / \                           / \     |
 |   b   c                         c   a    |
 \*----------------------------------------*/
-// 右旋，参数一为右旋点，参数二为根节点,x调整前是哪个节点调增后就是哪个节点
-template <class NodePtr>
-void rb_tree_rotate_right(NodePtr x, NodePtr& root) noexcept {
+// 右旋，参数一为右旋点，参数二为 header,x调整前是哪个节点调增后就是哪个节点
+template <class NodePtr, class Augment>
+void rb_tree_rotate_right(NodePtr x, NodePtr header, const Augment& aug) {
   auto y = x->left;
   x->left = y->right;
   if (y->right) { // 如果y有右孩子，要更新他的parent信息
-    y->right->parent = x;
+    y->right->set_parent(x);
   }
-  y->parent = x->parent;
+  y->set_parent(x->parent());
   // 下面三个判断用于更新x节点的父亲的信息
-  if (x == root) { // 如果 x 为根节点，让 y 顶替 x 成为根节点
-    root = y;
+  if (x == header->parent()) { // 如果 x 为根节点，让 y 顶替 x 成为根节点
+    header->set_parent(y);
   } else if (rb_tree_is_lchild(x)) { // 如果 x 是右子节点
-    x->parent->left = y;
+    x->parent()->left = y;
   } else { // 如果 x 是左子节点
-    x->parent->right = y;
+    x->parent()->right = y;
   }
   // 调整 x 与 y 的关系
   y->right = x;                      
-  x->parent = y;
+  x->set_parent(y);
+  aug.update(x);
+  aug.update(y);
 }
 
-// 插入节点后使 rb tree 重新平衡，参数一为新增节点，参数二为根节点
+// 插入节点后使 rb tree 重新平衡，参数一为新增节点，参数二为 header，参数三为子树信息的维护策略
+// 调用前新增节点到根节点路径上的子树信息已经更新，旋转时只需要更新参与旋转的两个节点
 //
 // case 1: 新增节点位于根节点，令新增节点为黑
 // case 2: 新增节点的父节点为黑，没有破坏平衡，直接返回
@@ -466,58 +559,59 @@ void rb_tree_rotate_right(NodePtr x, NodePtr& root) noexcept {
 //
 // 参考博客: http://blog.csdn.net/v_JULY_v/article/details/6105630
 //          http://blog.csdn.net/v_JULY_v/article/details/6109153
-template <class NodePtr>
-void rb_tree_insert_rebalance(NodePtr x, NodePtr& root) noexcept {
+template <class NodePtr, class Augment>
+void rb_tree_insert_rebalance(NodePtr x, NodePtr header, const Augment& aug) {
   rb_tree_set_red(x);  // 新增节点为红色
-  while (x != root && rb_tree_is_red(x->parent)) { // 因为插入节点为红色，所以要直到父亲为黑色
-    if (rb_tree_is_lchild(x->parent)) { // 如果父节点是左子节点
-      auto uncle = x->parent->parent->right;
+  while (x != header->parent() && rb_tree_is_red(x->parent())) { // 因为插入节点为红色，所以要直到父亲为黑色
+    if (rb_tree_is_lchild(x->parent())) { // 如果父节点是左子节点
+      auto uncle = x->parent()->parent()->right;
       if (uncle != nullptr && rb_tree_is_red(uncle)) { // case 3: 父节点和叔叔节点都为红
-        rb_tree_set_black(x->parent); // 父亲设为黑
+        rb_tree_set_black(x->parent()); // 父亲设为黑
         rb_tree_set_black(uncle); // 叔叔设为黑
-        x = x->parent->parent;
+        x = x->parent()->parent();
         rb_tree_set_red(x); // 爷爷设为红，继续看爷爷的颜色状态
       } else { // 无叔叔节点或叔叔节点为黑，需要旋转
         if (!rb_tree_is_lchild(x)) { // case 4: 当前节点 x 为右子节点  内测插入
-          x = x->parent;
-          rb_tree_rotate_left(x, root); // 上移并且左旋
+          x = x->parent();
+          rb_tree_rotate_left(x, header, aug); // 上移并且左旋
         }
         // 都转换成 case 5： 当前节点为左子节点
-        rb_tree_set_black(x->parent); // 插入节点变黑
-        rb_tree_set_red(x->parent->parent); // 爷爷变红
-        rb_tree_rotate_right(x->parent->parent, root); // 对爷爷右旋
+        rb_tree_set_black(x->parent()); // 插入节点变黑
+        rb_tree_set_red(x->parent()->parent()); // 爷爷变红
+        rb_tree_rotate_right(x->parent()->parent(), header, aug); // 对爷爷右旋
         break;
       }
     } else { // 如果父节点是右子节点，对称处理
-      auto uncle = x->parent->parent->left;
+      auto uncle = x->parent()->parent()->left;
       if (uncle != nullptr && rb_tree_is_red(uncle)) { // case 3: 父节点和叔叔节点都为红
-        rb_tree_set_black(x->parent);
+        rb_tree_set_black(x->parent());
         rb_tree_set_black(uncle);
-        x = x->parent->parent;
+        x = x->parent()->parent();
         rb_tree_set_red(x);
         // 此时祖父节点为红，可能会破坏红黑树的性质，令当前节点为祖父节点，继续处理
       } else { // 无叔叔节点或叔叔节点为黑
         if (rb_tree_is_lchild(x)) { // case 4: 当前节点 x 为左子节点
-          x = x->parent;
-          rb_tree_rotate_right(x, root);
+          x = x->parent();
+          rb_tree_rotate_right(x, header, aug);
         }
         // 都转换成 case 5： 当前节点为左子节点
-        rb_tree_set_black(x->parent);
-        rb_tree_set_red(x->parent->parent);
-        rb_tree_rotate_left(x->parent->parent, root);
+        rb_tree_set_black(x->parent());
+        rb_tree_set_red(x->parent()->parent());
+        rb_tree_rotate_left(x->parent()->parent(), header, aug);
         break;
       }
     }
   }
-  rb_tree_set_black(root);  // 根节点永远为黑，若为红则强行覆盖
+  rb_tree_set_black(header->parent());  // 根节点永远为黑，若为红则强行覆盖
 }
 
-// 删除节点后使 rb tree 重新平衡，参数 z 为要删除的节点，参数 root 为根节点，参数 leftmost 为最小节点，参数 rightmost 为最大节点
+// 删除节点后使 rb tree 重新平衡，参数 z 为要删除的节点，参数 header 的父节点为根节点，左右子节点为最小节点和最大节点，
+// 参数 aug 为子树信息的维护策略
 // 返回删除的节点指针, 这个节点会从红黑树的结构中移出去，遍历不到
 // 参考博客: http://blog.csdn.net/v_JULY_v/article/details/6105630
 //          http://blog.csdn.net/v_JULY_v/article/details/6109153
-template <class NodePtr>
-NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, NodePtr& rightmost) {
+template <class NodePtr, class Augment>
+NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr header, const Augment& aug) {
   // y 是可能的替换节点，指向最终要删除的节点
   auto y = (z->left == nullptr || z->right == nullptr) ? z : rb_tree_next(z); // 如果z是叶子或者只有一个子节点就选z，否则选择z后继节点
   // x 是 y 的一个独子节点或 NIL 节点，用于在 y 节点被删除后替代 y 的位置
@@ -538,30 +632,32 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
   |        f (x)|
   \*-----------*/
   if (y != z) { // 用 y 顶替 z 的位置，用 x 顶替 y 的位置，最后用 y 指向 z
-    z->left->parent = y;
+    z->left->set_parent(y);
     y->left = z->left;
     // 如果 y 不是 z 的右子节点，那么 z 的右子节点一定有左孩子
     if (y != z->right) { // x 替换 y 的位置
-      xp = y->parent;
+      xp = y->parent();
       if (x != nullptr) {
-        x->parent = y->parent;
+        x->set_parent(y->parent());
       }
-      y->parent->left = x;
+      y->parent()->left = x;
       y->right = z->right; // y 替换 z 位置操作
-      z->right->parent = y;
+      z->right->set_parent(y);
     } else { // y 是 z 的右子节点
       xp = y;
     }
     // 连接 y 与 z 的父节点 
-    if (root == z) { // 特殊情况 z 本身就是根节点
-      root = y; 
+    if (header->parent() == z) { // 特殊情况 z 本身就是根节点
+      header->set_parent(y);
     } else if (rb_tree_is_lchild(z)) { // z 是左节点
-      z->parent->left = y;
+      z->parent()->left = y;
     } else { // z 是右节点
-      z->parent->right = y;
+      z->parent()->right = y;
     }
-    y->parent = z->parent; // 到此为止，y 所处的位置和 z 的位置一模一样
-    yastl::swap(y->color, z->color); // 交换彼此颜色，y 拥有了和 z 一样的颜色
+    y->set_parent(z->parent()); // 到此为止，y 所处的位置和 z 的位置一模一样
+    const auto color = y->color(); // 交换彼此颜色，y 拥有了和 z 一样的颜色
+    y->set_color(z->color());
+    z->set_color(color);
     y = z; // y 指向准备删除节点 z
   } else { // y == z 说明 z 至多只有一个孩子
     /*-------------*\
@@ -571,28 +667,30 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
     |      /        |
     |     a (x)     |
     \*-------------*/
-    xp = y->parent;
+    xp = y->parent();
     if (x) {
-      x->parent = y->parent;
+      x->set_parent(y->parent());
     }
 
     // 连接 x 与 z 的父节点
-    if (root == z) {
-      root = x;
+    if (header->parent() == z) {
+      header->set_parent(x);
     } else if (rb_tree_is_lchild(z)) {
-      z->parent->left = x;
+      z->parent()->left = x;
     } else {
-      z->parent->right = x;
+      z->parent()->right = x;
     }
 
     // 此时 z 有可能是最左节点或最右节点，更新数据
-    if (leftmost == z) {
-      leftmost = x == nullptr ? xp : rb_tree_min(x);
+    if (header->left == z) {
+      header->left = x == nullptr ? xp : rb_tree_min(x);
     }
-    if (rightmost == z) {
-      rightmost = x == nullptr ? xp : rb_tree_max(x);
+    if (header->right == z) {
+      header->right = x == nullptr ? xp : rb_tree_max(x);
     }
   }
+  // xp 以上的节点失去了一个后代，先更新这条路径，之后的旋转只需要更新参与旋转的节点
+  rb_tree_update_path(xp, header, aug);
   // rb tree delete fix up 代码部分
   // 此时，y 指向要删除的节点，x 为替代节点，从 x 节点开始调整。
   // 如果删除的节点为红色，树的性质没有被破坏，否则按照以下情况调整（x 为左子节点为例）：
@@ -603,13 +701,13 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
   // case 4: 兄弟节点为黑色，右子节点为红色，令兄弟节点为父节点的颜色，父节点为黑色，兄弟节点的右子节点
   //         为黑色，以父节点为支点左（右）旋，树的性质调整完成，算法结束
   if (!rb_tree_is_red(y)) { // 红色无需调整，黑色进入循环
-    while (x != root && (x == nullptr || !rb_tree_is_red(x))) { // x 为黑色时，调整，否则直接将 x 变为黑色即可
+    while (x != header->parent() && (x == nullptr || !rb_tree_is_red(x))) { // x 为黑色时，调整，否则直接将 x 变为黑色即可
       if (x == xp->left) { // 如果 x 为左子节点
         auto brother = xp->right;
         if (rb_tree_is_red(brother)) { // case 1  兄红
           rb_tree_set_black(brother);
           rb_tree_set_red(xp);
-          rb_tree_rotate_left(xp, root);
+          rb_tree_rotate_left(xp, header, aug);
           brother = xp->right;
         }
         // case 1 转为为了 case 2、3、4 中的一种
@@ -617,23 +715,23 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
             (brother->right == nullptr || !rb_tree_is_red(brother->right))) { // case 2 兄黑双黑侄
           rb_tree_set_red(brother);
           x = xp;
-          xp = xp->parent;
+          xp = xp->parent();
         } else { 
           if (brother->right == nullptr || !rb_tree_is_red(brother->right)) { // case 3 兄黑右黑侄
             if (brother->left != nullptr) {
               rb_tree_set_black(brother->left);
             }
             rb_tree_set_red(brother);
-            rb_tree_rotate_right(brother, root);
+            rb_tree_rotate_right(brother, header, aug);
             brother = xp->right;
           }
           // 转为 case 4 兄黑右红侄（左旋父，祖染父色，父叔黑）
-          brother->color = xp->color;
+          brother->set_color(xp->color());
           rb_tree_set_black(xp);
           if (brother->right != nullptr) {
             rb_tree_set_black(brother->right);
           }
-          rb_tree_rotate_left(xp, root);
+          rb_tree_rotate_left(xp, header, aug);
           break;
         }
       } else { // x 为右子节点，对称处理
@@ -641,30 +739,30 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
         if (rb_tree_is_red(brother)) { // case 1
           rb_tree_set_black(brother);
           rb_tree_set_red(xp);
-          rb_tree_rotate_right(xp, root);
+          rb_tree_rotate_right(xp, header, aug);
           brother = xp->left;
         }
         if ((brother->left == nullptr || !rb_tree_is_red(brother->left)) &&
             (brother->right == nullptr || !rb_tree_is_red(brother->right))) { // case 2
           rb_tree_set_red(brother);
           x = xp;
-          xp = xp->parent;
+          xp = xp->parent();
         } else {
           if (brother->left == nullptr || !rb_tree_is_red(brother->left)) { // case 3
             if (brother->right != nullptr) {
               rb_tree_set_black(brother->right);
             }
             rb_tree_set_red(brother);
-            rb_tree_rotate_left(brother, root);
+            rb_tree_rotate_left(brother, header, aug);
             brother = xp->left;
           }
           // 转为 case 4
-          brother->color = xp->color;
+          brother->set_color(xp->color());
           rb_tree_set_black(xp);
           if (brother->left != nullptr) {
             rb_tree_set_black(brother->left);
           }
-          rb_tree_rotate_right(xp, root);
+          rb_tree_rotate_right(xp, header, aug);
           break;
         }
       }
@@ -677,8 +775,8 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
 }
 
 // 模板类 rb_tree
-// 参数一代表数据类型，参数二代表键值比较类型
-template <class T, class Compare>
+// 参数一代表数据类型，参数二代表键值比较类型，参数三代表子树信息的维护策略
+template <class T, class Compare, class Augment = rb_tree_no_augment<T>>
 class rb_tree {
 public:
   // rb_tree 的嵌套型别定义 
@@ -688,8 +786,8 @@ public:
 
   typedef typename tree_traits::base_type base_type;
   typedef typename tree_traits::base_ptr base_ptr;
-  typedef typename tree_traits::node_type node_type;
-  typedef typename tree_traits::node_ptr node_ptr;
+  typedef typename Augment::node_type node_type;
+  typedef node_type* node_ptr;
   typedef typename tree_traits::key_type key_type;
   typedef typename tree_traits::mapped_type mapped_type;
   typedef typename tree_traits::value_type value_type;
@@ -727,7 +825,7 @@ private:
 
 private:
   // 以下三个函数用于取得根节点，最小节点和最大节点
-  base_ptr& root() const { return header_->parent; }
+  base_ptr root() const { return header_->parent(); }
   base_ptr& leftmost() const { return header_->left; }
   base_ptr& rightmost() const { return header_->right; }
 
@@ -745,6 +843,7 @@ public:
 
   ~rb_tree() {
     clear();
+    base_allocator::deallocate(header_);
   }
 
 public:
@@ -819,6 +918,10 @@ public:
   template <class ...Args>
   iterator emplace_unique_use_hint(iterator hint, Args&& ...args);
 
+  // 先按 key 查找插入点，key 不存在时才申请节点，用 key 与 args 构造 value，key 已存在时 args 不会被使用
+  template <class K, class ...Args>
+  yastl::pair<iterator, bool> try_emplace_unique(K&& key, Args&& ...args);
+
   // insert
 
   iterator insert_multi(const value_type& value);
@@ -844,9 +947,7 @@ public:
   }
 
   yastl::pair<iterator, bool> insert_unique(const value_type& value);
-  yastl::pair<iterator, bool> insert_unique(value_type&& value) {
-    return emplace_unique(yastl::move(value));
-  }
+  yastl::pair<iterator, bool> insert_unique(value_type&& value);
 
   iterator insert_unique(iterator hint, const value_type& value) {
     return emplace_unique_use_hint(hint, value);
@@ -914,13 +1015,25 @@ public:
 
   void swap(rb_tree& rhs) noexcept;
 
+  // 子树信息相关操作
+
+  // 根节点，空树时为 nullptr，供增强的容器在树上查找
+  base_ptr root_node() const noexcept {
+    return root();
+  }
+
+  // 修改了 pos 的值之后，重新计算 pos 到根节点路径上的子树信息
+  void update_path(iterator pos) {
+    rb_tree_update_path(pos.node, header_, Augment());
+  }
+
 private:
 
   // node related
   template <class ...Args>
   node_ptr create_node(Args&&... args);
   node_ptr clone_node(base_ptr x);
-  void destroy_node(node_ptr p);
+  void destroy_node(base_ptr x);
 
   // init / reset
   void rb_tree_init();
@@ -947,11 +1060,11 @@ private:
 /*****************************************************************************************/
 
 // 复制构造函数
-template <class T, class Compare>
-rb_tree<T, Compare>::rb_tree(const rb_tree& rhs) {
+template <class T, class Compare, class Augment>
+rb_tree<T, Compare, Augment>::rb_tree(const rb_tree& rhs) {
   rb_tree_init();
   if (rhs.node_count_ != 0) {
-    root() = copy_from(rhs.root(), header_);
+    header_->set_parent(copy_from(rhs.root(), header_));
     leftmost() = rb_tree_min(root());
     rightmost() = rb_tree_max(root());
   }
@@ -960,19 +1073,19 @@ rb_tree<T, Compare>::rb_tree(const rb_tree& rhs) {
 }
 
 // 移动构造函数
-template <class T, class Compare>
-rb_tree<T, Compare>::rb_tree(rb_tree&& rhs) noexcept
+template <class T, class Compare, class Augment>
+rb_tree<T, Compare, Augment>::rb_tree(rb_tree&& rhs) noexcept
   : header_(yastl::move(rhs.header_)), node_count_(rhs.node_count_), key_comp_(rhs.key_comp_) {
   rhs.reset(); // 移动构造给成员置空，防止double free
 }
 
 // 复制赋值操作符
-template <class T, class Compare>
-rb_tree<T, Compare>& rb_tree<T, Compare>::operator=(const rb_tree& rhs) {
+template <class T, class Compare, class Augment>
+rb_tree<T, Compare, Augment>& rb_tree<T, Compare, Augment>::operator=(const rb_tree& rhs) {
   if (this != &rhs) {
     clear(); // 释放当前的内存
     if (rhs.node_count_ != 0) { // 复制 rhs 的内容
-      root() = copy_from(rhs.root(), header_);
+      header_->set_parent(copy_from(rhs.root(), header_));
       leftmost() = rb_tree_min(root());
       rightmost() = rb_tree_max(root());
     }
@@ -983,20 +1096,23 @@ rb_tree<T, Compare>& rb_tree<T, Compare>::operator=(const rb_tree& rhs) {
 }
 
 // 移动赋值操作符
-template <class T, class Compare>
-rb_tree<T, Compare>& rb_tree<T, Compare>::operator=(rb_tree&& rhs) {
-  clear();
-  header_ = yastl::move(rhs.header_);
-  node_count_ = rhs.node_count_;
-  key_comp_ = rhs.key_comp_;
-  rhs.reset(); // 置空 rhs 的成员，防止double free
+template <class T, class Compare, class Augment>
+rb_tree<T, Compare, Augment>& rb_tree<T, Compare, Augment>::operator=(rb_tree&& rhs) {
+  if (this != &rhs) {
+    clear();
+    base_allocator::deallocate(header_);
+    header_ = yastl::move(rhs.header_);
+    node_count_ = rhs.node_count_;
+    key_comp_ = rhs.key_comp_;
+    rhs.reset(); // 置空 rhs 的成员，防止double free
+  }
   return *this;
 }
 
 // 就地插入元素，键值允许重复
-template <class T, class Compare>
+template <class T, class Compare, class Augment>
 template <class ...Args>
-typename rb_tree<T, Compare>::iterator rb_tree<T, Compare>::emplace_multi(Args&& ...args) {
+typename rb_tree<T, Compare, Augment>::iterator rb_tree<T, Compare, Augment>::emplace_multi(Args&& ...args) {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
   node_ptr np = create_node(yastl::forward<Args>(args)...);
   auto res = get_insert_multi_pos(value_traits::get_key(np->value));
@@ -1004,10 +1120,10 @@ typename rb_tree<T, Compare>::iterator rb_tree<T, Compare>::emplace_multi(Args&&
 }
 
 // 就地插入元素，键值不允许重复 返回值<父节点，是否插入成功>
-template <class T, class Compare>
+template <class T, class Compare, class Augment>
 template <class ...Args>
-yastl::pair<typename rb_tree<T, Compare>::iterator, bool> 
-rb_tree<T, Compare>::emplace_unique(Args&& ...args) {
+yastl::pair<typename rb_tree<T, Compare, Augment>::iterator, bool> 
+rb_tree<T, Compare, Augment>::emplace_unique(Args&& ...args) {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
   node_ptr np = create_node(yastl::forward<Args>(args)...);
   auto res = get_insert_unique_pos(value_traits::get_key(np->value));
@@ -1019,10 +1135,10 @@ rb_tree<T, Compare>::emplace_unique(Args&& ...args) {
 }
 
 // 就地插入元素，键值允许重复，当 hint 位置与插入位置接近时，插入操作的时间复杂度可以降低
-template <class T, class Compare>
+template <class T, class Compare, class Augment>
 template <class ...Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::emplace_multi_use_hint(iterator hint, Args&& ...args) {
+typename rb_tree<T, Compare, Augment>::iterator
+rb_tree<T, Compare, Augment>::emplace_multi_use_hint(iterator hint, Args&& ...args) {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
   node_ptr np = create_node(yastl::forward<Args>(args)...);
   if (node_count_ == 0) { // 空树，直接插入作为根节点
@@ -1048,10 +1164,10 @@ rb_tree<T, Compare>::emplace_multi_use_hint(iterator hint, Args&& ...args) {
 }
 
 // 就地插入元素，键值不允许重复，当 hint 位置与插入位置接近时，插入操作的时间复杂度可以降低
-template<class T, class Compare>
+template <class T, class Compare, class Augment>
 template<class ...Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::emplace_unique_use_hint(iterator hint, Args&& ...args) {
+typename rb_tree<T, Compare, Augment>::iterator
+rb_tree<T, Compare, Augment>::emplace_unique_use_hint(iterator hint, Args&& ...args) {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
   node_ptr np = create_node(yastl::forward<Args>(args)...);
   if (node_count_ == 0) {
@@ -1065,7 +1181,7 @@ rb_tree<T, Compare>::emplace_unique_use_hint(iterator hint, Args&& ...args) {
       auto pos = get_insert_unique_pos(key);
       if (!pos.second) { // 在pos.first.first插入key失败会，有重复的值
         destroy_node(np);
-        return pos.first.first; // 返回插入key失败的父节点
+        return pos.first.first; // 返回与 key 重复的节点
       }
       return insert_node_at(pos.first.first, np, pos.first.second); // 可以插入
     }
@@ -1084,18 +1200,32 @@ rb_tree<T, Compare>::emplace_unique_use_hint(iterator hint, Args&& ...args) {
   return insert_unique_use_hint(hint, key, np); // 位于 hint 处插入
 }
 
+// 先找插入点再申请节点，键值不允许重复，节点的值由 key 和 mapped_type(args...) 构造
+template <class T, class Compare, class Augment>
+template <class K, class ...Args>
+yastl::pair<typename rb_tree<T, Compare, Augment>::iterator, bool>
+rb_tree<T, Compare, Augment>::try_emplace_unique(K&& key, Args&& ...args) {
+  THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
+  auto res = get_insert_unique_pos(key);
+  if (!res.second) {
+    return yastl::make_pair(iterator(res.first.first), false);
+  }
+  node_ptr np = create_node(yastl::forward<K>(key), mapped_type(yastl::forward<Args>(args)...));
+  return yastl::make_pair(insert_node_at(res.first.first, np, res.first.second), true);
+}
+
 // 插入元素，节点键值允许重复
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator rb_tree<T, Compare>::insert_multi(const value_type& value) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::iterator rb_tree<T, Compare, Augment>::insert_multi(const value_type& value) {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
   auto res = get_insert_multi_pos(value_traits::get_key(value)); // 找到插入位置
   return insert_value_at(res.first, value, res.second); // 在res.first位置插入value，res.second决定是否是左节点
 }
 
 // 插入新值，节点键值不允许重复，返回一个 pair，若插入成功，pair 的第二参数为 true，否则为 false
-template <class T, class Compare>
-yastl::pair<typename rb_tree<T, Compare>::iterator, bool>
-rb_tree<T, Compare>::insert_unique(const value_type& value) {
+template <class T, class Compare, class Augment>
+yastl::pair<typename rb_tree<T, Compare, Augment>::iterator, bool>
+rb_tree<T, Compare, Augment>::insert_unique(const value_type& value) {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
   auto res = get_insert_unique_pos(value_traits::get_key(value));
   if (res.second) { // 插入成功
@@ -1104,24 +1234,37 @@ rb_tree<T, Compare>::insert_unique(const value_type& value) {
   return yastl::make_pair(res.first.first, false);
 }
 
+// 插入右值，先找插入点再申请节点，重复的 value 不会被移动
+template <class T, class Compare, class Augment>
+yastl::pair<typename rb_tree<T, Compare, Augment>::iterator, bool>
+rb_tree<T, Compare, Augment>::insert_unique(value_type&& value) {
+  THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
+  auto res = get_insert_unique_pos(value_traits::get_key(value));
+  if (res.second) {
+    node_ptr np = create_node(yastl::move(value));
+    return yastl::make_pair(insert_node_at(res.first.first, np, res.first.second), true);
+  }
+  return yastl::make_pair(iterator(res.first.first), false);
+}
+
 // 删除 hint 位置的节点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::erase(iterator hint) {
-  auto node = hint.node->get_node_ptr();
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::iterator
+rb_tree<T, Compare, Augment>::erase(iterator hint) {
+  auto node = hint.node;
   iterator next(node);
   ++next;
   
-  rb_tree_erase_rebalance(node, root(), leftmost(), rightmost()); // 让 node 移除树连接关系并且调整红黑树
+  rb_tree_erase_rebalance(node, header_, Augment()); // 让 node 移除树连接关系并且调整红黑树
   destroy_node(node); // 销毁 node
   --node_count_;
   return next; // 返回node的后继节点
 }
 
 // 删除键值等于 key 的元素，返回删除的个数
-template <class T, class Compare>
-typename rb_tree<T, Compare>::size_type
-rb_tree<T, Compare>::erase_multi(const key_type& key) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::size_type
+rb_tree<T, Compare, Augment>::erase_multi(const key_type& key) {
   auto p = equal_range_multi(key);
   size_type n = yastl::distance(p.first, p.second);
   erase(p.first, p.second);
@@ -1129,9 +1272,9 @@ rb_tree<T, Compare>::erase_multi(const key_type& key) {
 }
 
 // 删除键值等于 key 的元素一个，返回删除的个数
-template <class T, class Compare>
-typename rb_tree<T, Compare>::size_type
-rb_tree<T, Compare>::erase_unique(const key_type& key) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::size_type
+rb_tree<T, Compare, Augment>::erase_unique(const key_type& key) {
   auto it = find(key);
   if (it != end()) {
     erase(it);
@@ -1141,8 +1284,8 @@ rb_tree<T, Compare>::erase_unique(const key_type& key) {
 }
 
 // 删除[first, last)区间内的元素
-template <class T, class Compare>
-void rb_tree<T, Compare>::erase(iterator first, iterator last) {
+template <class T, class Compare, class Augment>
+void rb_tree<T, Compare, Augment>::erase(iterator first, iterator last) {
   if (first == begin() && last == end()) {
     clear();
   } else {
@@ -1153,20 +1296,20 @@ void rb_tree<T, Compare>::erase(iterator first, iterator last) {
 }
 
 // 清空 rb tree
-template <class T, class Compare>
-void rb_tree<T, Compare>::clear() {
+template <class T, class Compare, class Augment>
+void rb_tree<T, Compare, Augment>::clear() {
   if (node_count_ != 0) {
     erase_since(root());
     leftmost() = header_;
-    root() = nullptr;
+    header_->set_parent(nullptr);
     rightmost() = header_;
     node_count_ = 0;
   }
 }
 
 // 查找键值为 k 的节点，返回指向它的迭代器
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator rb_tree<T, Compare>::find(const key_type& key) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::iterator rb_tree<T, Compare, Augment>::find(const key_type& key) {
   auto y = header_;  // 最后一个 >=key 的节点
   auto x = root();
   while (x != nullptr) { // 向下搜索，若没找到 x 为 nullptr，y 为 end()，若找到 y 为 key 的迭代器
@@ -1184,8 +1327,8 @@ typename rb_tree<T, Compare>::iterator rb_tree<T, Compare>::find(const key_type&
 }
 
 // const 入参版本
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator rb_tree<T, Compare>::find(const key_type& key) const {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::const_iterator rb_tree<T, Compare, Augment>::find(const key_type& key) const {
   auto y = header_;  // 最后一个不小于 key 的节点
   auto x = root();
   while (x != nullptr) {
@@ -1201,9 +1344,9 @@ typename rb_tree<T, Compare>::const_iterator rb_tree<T, Compare>::find(const key
 }
 
 // 键值 >=key 的第一个位置, 找不到返回header_，也就是end()
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::lower_bound(const key_type& key) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::iterator
+rb_tree<T, Compare, Augment>::lower_bound(const key_type& key) {
   auto y = header_;
   auto x = root();
   while (x != nullptr) {
@@ -1218,9 +1361,9 @@ rb_tree<T, Compare>::lower_bound(const key_type& key) {
   return iterator(y);
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::lower_bound(const key_type& key) const {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::const_iterator
+rb_tree<T, Compare, Augment>::lower_bound(const key_type& key) const {
   auto y = header_;
   auto x = root();
   while (x != nullptr) {
@@ -1235,9 +1378,9 @@ rb_tree<T, Compare>::lower_bound(const key_type& key) const {
 }
 
 // 键值 >key 的第一个位置
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::upper_bound(const key_type& key) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::iterator
+rb_tree<T, Compare, Augment>::upper_bound(const key_type& key) {
   auto y = header_;
   auto x = root();
   while (x != nullptr) {
@@ -1251,9 +1394,9 @@ rb_tree<T, Compare>::upper_bound(const key_type& key) {
   return iterator(y);
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::upper_bound(const key_type& key) const {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::const_iterator
+rb_tree<T, Compare, Augment>::upper_bound(const key_type& key) const {
   auto y = header_;
   auto x = root();
   while (x != nullptr) {
@@ -1268,8 +1411,8 @@ rb_tree<T, Compare>::upper_bound(const key_type& key) const {
 }
 
 // 交换 rb tree
-template <class T, class Compare>
-void rb_tree<T, Compare>::swap(rb_tree& rhs) noexcept {
+template <class T, class Compare, class Augment>
+void rb_tree<T, Compare, Augment>::swap(rb_tree& rhs) noexcept {
   if (this != &rhs) {
     yastl::swap(header_, rhs.header_);
     yastl::swap(node_count_, rhs.node_count_);
@@ -1281,63 +1424,66 @@ void rb_tree<T, Compare>::swap(rb_tree& rhs) noexcept {
 // helper function
 
 // 创建一个结点
-template <class T, class Compare>
+template <class T, class Compare, class Augment>
 template <class ...Args>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::create_node(Args&&... args) {
+typename rb_tree<T, Compare, Augment>::node_ptr
+rb_tree<T, Compare, Augment>::create_node(Args&&... args) {
   auto tmp = node_allocator::allocate(1);
   try {
     data_allocator::construct(yastl::address_of(tmp->value), yastl::forward<Args>(args)...);
     tmp->left = nullptr;
     tmp->right = nullptr;
-    tmp->parent = nullptr;
+    tmp->set_parent_color(nullptr, rb_tree_red);
   } catch (...) {
     node_allocator::deallocate(tmp);
     throw;
   }
+  Augment().construct(tmp);
   return tmp;
 }
 
 // 复制一个结点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::clone_node(base_ptr x) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::node_ptr
+rb_tree<T, Compare, Augment>::clone_node(base_ptr x) {
   node_ptr tmp = create_node(x->get_node_ptr()->value);
-  tmp->color = x->color;
+  tmp->set_color(x->color());
+  Augment().copy(tmp, x);
   tmp->left = nullptr;
   tmp->right = nullptr;
   return tmp;
 }
 
 // 销毁一个结点
-template <class T, class Compare>
-void rb_tree<T, Compare>::destroy_node(node_ptr p) {
+template <class T, class Compare, class Augment>
+void rb_tree<T, Compare, Augment>::destroy_node(base_ptr x) {
+  node_ptr p = static_cast<node_ptr>(x);
+  Augment().destroy(p);
   data_allocator::destroy(&p->value);
   node_allocator::deallocate(p);
 }
 
 // 初始化容器
-template <class T, class Compare>
-void rb_tree<T, Compare>::rb_tree_init() {
+template <class T, class Compare, class Augment>
+void rb_tree<T, Compare, Augment>::rb_tree_init() {
   header_ = base_allocator::allocate(1);
-  header_->color = rb_tree_red;  // header_ 节点颜色为红，与 root 区分
-  root() = nullptr;
+  header_->set_parent_color(nullptr, rb_tree_red);  // header_ 节点颜色为红，与 root 区分
   leftmost() = header_;
   rightmost() = header_;
   node_count_ = 0;
 }
 
 // reset 函数
-template <class T, class Compare>
-void rb_tree<T, Compare>::reset() {
+template <class T, class Compare, class Augment>
+void rb_tree<T, Compare, Augment>::reset() {
   header_ = nullptr;
   node_count_ = 0;
 }
 
 // get_insert_multi_pos 函数, 找到插入的位置返回值 <位置，是否插在左边>
-template <class T, class Compare>
-yastl::pair<typename rb_tree<T, Compare>::base_ptr, bool>
-rb_tree<T, Compare>::get_insert_multi_pos(const key_type& key) {
+template <class T, class Compare, class Augment>
+yastl::pair<typename rb_tree<T, Compare, Augment>::base_ptr, bool>
+rb_tree<T, Compare, Augment>::get_insert_multi_pos(const key_type& key) {
   auto x = root();
   auto y = header_;
   bool add_to_left = true;
@@ -1351,10 +1497,10 @@ rb_tree<T, Compare>::get_insert_multi_pos(const key_type& key) {
 
 // get_insert_unique_pos 函数, 如果key有重复就会不允许插入
 // 返回一个 pair，第一个值为一个 pair，包含插入点的父节点和一个 bool 表示是否在左边插入，
-// 第二个值为一个 bool，表示是否插入成功
-template <class T, class Compare>
-yastl::pair<yastl::pair<typename rb_tree<T, Compare>::base_ptr, bool>, bool>
-rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key) { 
+// 第二个值为一个 bool，表示是否插入成功，不成功时第一个值中的节点是与 key 重复的节点
+template <class T, class Compare, class Augment>
+yastl::pair<yastl::pair<typename rb_tree<T, Compare, Augment>::base_ptr, bool>, bool>
+rb_tree<T, Compare, Augment>::get_insert_unique_pos(const key_type& key) { 
   auto x = root();
   auto y = header_;
   bool add_to_left = true;  // 树为空时也在 header_ 左边插入
@@ -1374,20 +1520,20 @@ rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key) {
   if (key_comp_(value_traits::get_key(*j), key)) { // 表明新节点没有重复
     return yastl::make_pair(yastl::make_pair(y, add_to_left), true);
   }
-  // 进行至此，表示新节点与现有节点键值重复
-  return yastl::make_pair(yastl::make_pair(y, add_to_left), false);
+  // 进行至此，表示新节点与现有节点键值重复，j 就是重复的节点
+  return yastl::make_pair(yastl::make_pair(j.node, add_to_left), false);
 }
 
 // insert_value_at 函数
 // x 为插入点的父节点， value 为要插入的值，add_to_left 表示是否在左边插入
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::insert_value_at(base_ptr x, const value_type& value, bool add_to_left) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::iterator
+rb_tree<T, Compare, Augment>::insert_value_at(base_ptr x, const value_type& value, bool add_to_left) {
   node_ptr node = create_node(value);
-  node->parent = x;
+  node->set_parent(x);
   auto base_node = node->get_base_ptr();
   if (x == header_) { // 如果一个目前树为空
-    root() = base_node;
+    header_->set_parent(base_node);
     leftmost() = base_node;
     rightmost() = base_node;
   } else if (add_to_left) { // 插在x的左边
@@ -1401,20 +1547,21 @@ rb_tree<T, Compare>::insert_value_at(base_ptr x, const value_type& value, bool a
       rightmost() = base_node;
     }
   }
-  rb_tree_insert_rebalance(base_node, root()); // 进行插入后的平衡操作
+  rb_tree_update_path(base_node, header_, Augment()); // 新节点到根节点路径上的子树信息
+  rb_tree_insert_rebalance(base_node, header_, Augment()); // 进行插入后的平衡操作
   ++node_count_;
   return iterator(node);
 }
 
 // 在 x 节点处插入新的节点
 // x 为插入点的父节点， node 为要插入的节点，add_to_left 表示是否在左边插入
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::insert_node_at(base_ptr x, node_ptr node, bool add_to_left) {
-  node->parent = x;
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::iterator
+rb_tree<T, Compare, Augment>::insert_node_at(base_ptr x, node_ptr node, bool add_to_left) {
+  node->set_parent(x);
   auto base_node = node->get_base_ptr();
   if (x == header_) { // 空树，插入根节点
-    root() = base_node;
+    header_->set_parent(base_node);
     leftmost() = base_node;
     rightmost() = base_node;
   } else if (add_to_left) { // 插在x左边
@@ -1428,15 +1575,16 @@ rb_tree<T, Compare>::insert_node_at(base_ptr x, node_ptr node, bool add_to_left)
       rightmost() = base_node;
     }
   }
-  rb_tree_insert_rebalance(base_node, root()); // 插入后的调整操作
+  rb_tree_update_path(base_node, header_, Augment()); // 新节点到根节点路径上的子树信息
+  rb_tree_insert_rebalance(base_node, header_, Augment()); // 插入后的调整操作
   ++node_count_;
   return iterator(node);
 }
 
 // 插入元素，键值允许重复，使用 hint
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator 
-rb_tree<T, Compare>::insert_multi_use_hint(iterator hint, key_type key, node_ptr node) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::iterator 
+rb_tree<T, Compare, Augment>::insert_multi_use_hint(iterator hint, key_type key, node_ptr node) {
   // 在 hint 附近寻找可插入的位置
   auto np = hint.node;
   auto before = hint;
@@ -1455,9 +1603,9 @@ rb_tree<T, Compare>::insert_multi_use_hint(iterator hint, key_type key, node_ptr
 }
 
 // 插入元素，键值不允许重复，使用 hint
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator 
-rb_tree<T, Compare>::insert_unique_use_hint(iterator hint, key_type key, node_ptr node) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::iterator 
+rb_tree<T, Compare, Augment>::insert_unique_use_hint(iterator hint, key_type key, node_ptr node) {
   // 在 hint 附近寻找可插入的位置
   auto np = hint.node;
   auto before = hint;
@@ -1481,11 +1629,11 @@ rb_tree<T, Compare>::insert_unique_use_hint(iterator hint, key_type key, node_pt
 
 // copy_from 函数
 // 递归复制一颗树，节点从 x 开始，p 为 x 的父节点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::base_ptr
-rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p) {
+template <class T, class Compare, class Augment>
+typename rb_tree<T, Compare, Augment>::base_ptr
+rb_tree<T, Compare, Augment>::copy_from(base_ptr x, base_ptr p) {
   auto top = clone_node(x); // 复制 x 节点
-  top->parent = p;
+  top->set_parent(p);
   try {
     if (x->right) { // 复制 x 右侧的树
       top->right = copy_from(x->right, top);
@@ -1495,7 +1643,7 @@ rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p) {
     while (x != nullptr) {
       auto y = clone_node(x); // 复制 x' 节点
       p->left = y;
-      y->parent = p;
+      y->set_parent(p);
       if (x->right) { // 复制 x' 右侧节点
         y->right = copy_from(x->right, y);
       }
@@ -1511,50 +1659,50 @@ rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p) {
 
 // erase_since 函数
 // 从 x 节点开始删除该节点及其子树
-template <class T, class Compare>
-void rb_tree<T, Compare>::erase_since(base_ptr x) {
+template <class T, class Compare, class Augment>
+void rb_tree<T, Compare, Augment>::erase_since(base_ptr x) {
   while (x != nullptr) { // while 循环的意义在于一直向左遍历
     erase_since(x->right); // 销毁右侧
     auto y = x->left;
-    destroy_node(x->get_node_ptr()); // 销毁 x
+    destroy_node(x); // 销毁 x
     x = y; // 继续让 x 为 x 的左侧继续销毁
   }
 }
 
 // 重载比较操作符 中序遍历相等则相等
-template <class T, class Compare>
-bool operator==(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Augment>
+bool operator==(const rb_tree<T, Compare, Augment>& lhs, const rb_tree<T, Compare, Augment>& rhs) {
   return lhs.size() == rhs.size() && yastl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <class T, class Compare>
-bool operator<(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Augment>
+bool operator<(const rb_tree<T, Compare, Augment>& lhs, const rb_tree<T, Compare, Augment>& rhs) {
   return yastl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <class T, class Compare>
-bool operator!=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Augment>
+bool operator!=(const rb_tree<T, Compare, Augment>& lhs, const rb_tree<T, Compare, Augment>& rhs) {
   return !(lhs == rhs);
 }
 
-template <class T, class Compare>
-bool operator>(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Augment>
+bool operator>(const rb_tree<T, Compare, Augment>& lhs, const rb_tree<T, Compare, Augment>& rhs) {
   return rhs < lhs;
 }
 
-template <class T, class Compare>
-bool operator<=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Augment>
+bool operator<=(const rb_tree<T, Compare, Augment>& lhs, const rb_tree<T, Compare, Augment>& rhs) {
   return !(rhs < lhs);
 }
 
-template <class T, class Compare>
-bool operator>=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Augment>
+bool operator>=(const rb_tree<T, Compare, Augment>& lhs, const rb_tree<T, Compare, Augment>& rhs) {
   return !(lhs < rhs);
 }
 
 // 重载 yastl 的 swap
-template <class T, class Compare>
-void swap(rb_tree<T, Compare>& lhs, rb_tree<T, Compare>& rhs) noexcept {
+template <class T, class Compare, class Augment>
+void swap(rb_tree<T, Compare, Augment>& lhs, rb_tree<T, Compare, Augment>& rhs) noexcept {
   lhs.swap(rhs);
 }
 } // namespace yastl
@@ -0,0 +1,702 @@
+﻿#ifndef _INCLUDE_RING_BUFFER_H_
+#define _INCLUDE_RING_BUFFER_H_
+
+// 这个头文件包含了一个模板类 ring_buffer
+// ring_buffer : 环形缓冲区，元素存放在一块连续的、容量为 2 的幂次的内存中，首尾相接
+
+// notes:
+//
+// ring_buffer 可以作为 queue 和 stack 的底层容器，头尾的增删都是 O(1) 且不需要管理缓冲区节点
+// 默认是可增长的：容量用完后扩充为原来的两倍
+// 调用 set_bounded(true) 之后变为固定容量：容量用完后 push_back / emplace_back 抛出 length_error，
+// try_push_back 返回 false，append 只放入能放下的部分
+//
+// 异常保证：
+// yastl::ring_buffer<T> 满足基本异常保证，并对以下函数做强异常安全保证：
+//   * emplace_front
+//   * emplace_back
+//   * push_front
+//   * push_back
+
+#include <initializer_list>
+
+#include "iterator.h"
+#include "memory.h"
+#include "util.h"
+#include "exceptdef.h"
+
+namespace yastl {
+
+// ring_buffer 第一次分配时的容量
+#ifndef RING_BUFFER_INIT_SIZE
+#define RING_BUFFER_INIT_SIZE 16
+#endif
+
+// ring_buffer 的迭代器设计
+// pos 是未取模的逻辑位置，解引用时再与 mask 相与，所以迭代器之间可以直接比较和相减
+template <class T, class Ref, class Ptr>
+struct ring_buffer_iterator : public iterator<random_access_iterator_tag, T> {
+  typedef ring_buffer_iterator<T, T&, T*> iterator;
+  typedef ring_buffer_iterator<T, const T&, const T*> const_iterator;
+  typedef ring_buffer_iterator self;
+
+  typedef T value_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef T* value_pointer;
+
+  // 迭代器所含成员数据
+  value_pointer buf;  // 缓冲区的首地址
+  size_type mask;     // 容量 - 1
+  size_type pos;      // 逻辑位置，等于 head + 下标
+
+  // 构造、复制函数
+  ring_buffer_iterator() noexcept : buf(nullptr), mask(0), pos(0) {}
+
+  ring_buffer_iterator(value_pointer b, size_type m, size_type p) : buf(b), mask(m), pos(p) {}
+
+  ring_buffer_iterator(const iterator& rhs) : buf(rhs.buf), mask(rhs.mask), pos(rhs.pos) {}
+
+  self& operator=(const self& rhs) = default;
+
+  reference operator*() const {
+    return buf[pos & mask];
+  }
+  pointer operator->() const {
+    return buf + (pos & mask);
+  }
+
+  difference_type operator-(const self& x) const {
+    return static_cast<difference_type>(pos) - static_cast<difference_type>(x.pos);
+  }
+
+  self& operator++() {
+    ++pos;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++pos;
+    return tmp;
+  }
+  self& operator--() {
+    --pos;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --pos;
+    return tmp;
+  }
+
+  self& operator+=(difference_type n) {
+    pos += n;
+    return *this;
+  }
+  self operator+(difference_type n) const {
+    self tmp = *this;
+    return tmp += n;
+  }
+  self& operator-=(difference_type n) {
+    pos -= n;
+    return *this;
+  }
+  self operator-(difference_type n) const {
+    self tmp = *this;
+    return tmp -= n;
+  }
+
+  reference operator[](difference_type n) const {
+    return buf[(pos + n) & mask];
+  }
+
+  // 重载比较操作符
+  bool operator==(const self& rhs) const {
+    return pos == rhs.pos;
+  }
+  bool operator!=(const self& rhs) const {
+    return pos != rhs.pos;
+  }
+  bool operator<(const self& rhs) const {
+    return pos < rhs.pos;
+  }
+  bool operator>(const self& rhs) const {
+    return rhs < *this;
+  }
+  bool operator<=(const self& rhs) const {
+    return !(rhs < *this);
+  }
+  bool operator>=(const self& rhs) const {
+    return !(*this < rhs);
+  }
+};
+
+// 模板类 ring_buffer
+// 模板参数代表数据类型
+template <class T>
+class ring_buffer {
+public:
+  // ring_buffer 的型别定义
+  typedef yastl::allocator<T> allocator_type;
+  typedef yastl::allocator<T> data_allocator;
+
+  typedef typename allocator_type::value_type value_type;
+  typedef typename allocator_type::pointer pointer;
+  typedef typename allocator_type::const_pointer const_pointer;
+  typedef typename allocator_type::reference reference;
+  typedef typename allocator_type::const_reference const_reference;
+  typedef typename allocator_type::size_type size_type;
+  typedef typename allocator_type::difference_type difference_type;
+
+  typedef ring_buffer_iterator<T, T&, T*> iterator;
+  typedef ring_buffer_iterator<T, const T&, const T*> const_iterator;
+  typedef yastl::reverse_iterator<iterator> reverse_iterator;
+  typedef yastl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  // 一段连续的元素：首地址和元素个数
+  typedef yastl::pair<pointer, size_type> span_type;
+  typedef yastl::pair<const_pointer, size_type> const_span_type;
+
+  allocator_type get_allocator() {
+    return allocator_type();
+  }
+
+private:
+  // 用以下数据来表现一个 ring_buffer
+  pointer buf_;      // 缓冲区的首地址
+  size_type cap_;    // 缓冲区的容量，为 0 或 2 的幂次
+  size_type head_;   // 第一个元素在缓冲区中的位置
+  size_type size_;   // 元素个数
+  bool bounded_;     // 是否为固定容量
+
+public:
+  // 构造、复制、移动、析构函数
+  ring_buffer() noexcept : buf_(nullptr), cap_(0), head_(0), size_(0), bounded_(false) {}
+
+  explicit ring_buffer(size_type n) : ring_buffer() {
+    fill_init(n, value_type());
+  }
+
+  ring_buffer(size_type n, const value_type& value) : ring_buffer() {
+    fill_init(n, value);
+  }
+
+  template <class IIter, typename std::enable_if<yastl::is_input_iterator<IIter>::value, int>::type = 0>
+  ring_buffer(IIter first, IIter last) : ring_buffer() {
+    range_init(first, last);
+  }
+
+  ring_buffer(std::initializer_list<value_type> ilist) : ring_buffer() {
+    range_init(ilist.begin(), ilist.end());
+  }
+
+  // 拷贝构造，容量与是否固定容量也一并复制
+  ring_buffer(const ring_buffer& rhs) : ring_buffer() {
+    reserve(rhs.cap_);
+    range_init(rhs.begin(), rhs.end());
+    bounded_ = rhs.bounded_;
+  }
+
+  ring_buffer(ring_buffer&& rhs) noexcept
+    : buf_(rhs.buf_), cap_(rhs.cap_), head_(rhs.head_), size_(rhs.size_), bounded_(rhs.bounded_) {
+    rhs.buf_ = nullptr;
+    rhs.cap_ = 0;
+    rhs.head_ = 0;
+    rhs.size_ = 0;
+  }
+
+  ring_buffer& operator=(const ring_buffer& rhs) {
+    if (this != &rhs) {
+      ring_buffer tmp(rhs);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  ring_buffer& operator=(ring_buffer&& rhs) noexcept {
+    if (this != &rhs) {
+      destroy_and_recover();
+      swap(rhs);
+    }
+    return *this;
+  }
+
+  ring_buffer& operator=(std::initializer_list<value_type> ilist) {
+    ring_buffer tmp(ilist);
+    swap(tmp);
+    return *this;
+  }
+
+  ~ring_buffer() {
+    destroy_and_recover();
+  }
+
+public:
+  // 迭代器相关操作
+
+  iterator begin() noexcept {
+    return iterator(buf_, mask(), head_);
+  }
+  const_iterator begin() const noexcept {
+    return iterator(buf_, mask(), head_);
+  }
+  iterator end() noexcept {
+    return iterator(buf_, mask(), head_ + size_);
+  }
+  const_iterator end() const noexcept {
+    return iterator(buf_, mask(), head_ + size_);
+  }
+
+  reverse_iterator rbegin() noexcept {
+    return reverse_iterator(end());
+  }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept {
+    return reverse_iterator(begin());
+  }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+  const_iterator cend() const noexcept {
+    return end();
+  }
+  const_reverse_iterator crbegin() const noexcept {
+    return rbegin();
+  }
+  const_reverse_iterator crend() const noexcept {
+    return rend();
+  }
+
+  // 容量相关操作
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+  bool full() const noexcept {
+    return size_ == cap_;
+  }
+  size_type size() const noexcept {
+    return size_;
+  }
+  size_type max_size() const noexcept {
+    return static_cast<size_type>(-1) / sizeof(T);
+  }
+  size_type capacity() const noexcept {
+    return cap_;
+  }
+  // 容量扩充到不小于 n 的 2 的幂次，固定容量模式下也可以调用
+  void reserve(size_type n);
+  void shrink_to_fit();
+
+  // 固定容量模式
+  bool bounded() const noexcept {
+    return bounded_;
+  }
+  void set_bounded(bool b) noexcept {
+    bounded_ = b;
+  }
+
+  // 访问元素相关操作
+  reference operator[](size_type n) {
+    YASTL_DEBUG(n < size());
+    return *slot(n);
+  }
+  const_reference operator[](size_type n) const {
+    YASTL_DEBUG(n < size());
+    return *slot(n);
+  }
+
+  reference at(size_type n) {
+    THROW_OUT_OF_RANGE_IF(!(n < size()), "ring_buffer<T>::at() subscript out of range");
+    return (*this)[n];
+  }
+  const_reference at(size_type n) const {
+    THROW_OUT_OF_RANGE_IF(!(n < size()), "ring_buffer<T>::at() subscript out of range");
+    return (*this)[n];
+  }
+
+  reference front() {
+    YASTL_DEBUG(!empty());
+    return *slot(0);
+  }
+  const_reference front() const {
+    YASTL_DEBUG(!empty());
+    return *slot(0);
+  }
+  reference back() {
+    YASTL_DEBUG(!empty());
+    return *slot(size_ - 1);
+  }
+  const_reference back() const {
+    YASTL_DEBUG(!empty());
+    return *slot(size_ - 1);
+  }
+
+  // 元素在缓冲区中最多分成两段连续的内存，first_span 是从头部开始的一段，second_span 是绕回缓冲区开头的一段
+  span_type first_span() noexcept {
+    return span_type(buf_ + head_, first_span_size());
+  }
+  const_span_type first_span() const noexcept {
+    return const_span_type(buf_ + head_, first_span_size());
+  }
+  span_type second_span() noexcept {
+    return span_type(buf_, size_ - first_span_size());
+  }
+  const_span_type second_span() const noexcept {
+    return const_span_type(buf_, size_ - first_span_size());
+  }
+
+  // 修改容器相关操作
+
+  // emplace_front / emplace_back
+
+  template <class ...Args>
+  void emplace_front(Args&& ...args);
+  template <class ...Args>
+  void emplace_back(Args&& ...args);
+
+  // push_front / push_back
+
+  void push_front(const value_type& value) {
+    emplace_front(value);
+  }
+  void push_front(value_type&& value) {
+    emplace_front(yastl::move(value));
+  }
+  void push_back(const value_type& value) {
+    emplace_back(value);
+  }
+  void push_back(value_type&& value) {
+    emplace_back(yastl::move(value));
+  }
+
+  // 固定容量模式下已满则返回 false，不抛出异常
+  template <class ...Args>
+  bool try_emplace_back(Args&& ...args) {
+    if (bounded_ && full()) {
+      return false;
+    }
+    emplace_back(yastl::forward<Args>(args)...);
+    return true;
+  }
+  bool try_push_back(const value_type& value) {
+    return try_emplace_back(value);
+  }
+  bool try_push_back(value_type&& value) {
+    return try_emplace_back(yastl::move(value));
+  }
+
+  // pop_front / pop_back
+
+  void pop_front();
+  void pop_back();
+
+  // 批量操作
+
+  // 把 [first, first + n) 拷贝到尾部，返回实际放入的个数，固定容量模式下只放入能放下的部分
+  size_type append(const_pointer first, size_type n);
+  // 把头部最多 n 个元素移动到 out 所指的区间并弹出，返回实际弹出的个数
+  size_type pop_front_n(size_type n, pointer out);
+  // 直接弹出头部最多 n 个元素，通常在用 first_span / second_span 原地读取之后调用
+  size_type pop_front_n(size_type n);
+
+  // resize / clear
+
+  void resize(size_type new_size) {
+    resize(new_size, value_type());
+  }
+  void resize(size_type new_size, const value_type& value);
+
+  void clear() noexcept;
+
+  // swap
+
+  void swap(ring_buffer& rhs) noexcept;
+
+private:
+  // helper functions
+
+  size_type mask() const noexcept {
+    return cap_ == 0 ? 0 : cap_ - 1;
+  }
+  // 第 n 个元素的地址
+  pointer slot(size_type n) const noexcept {
+    return buf_ + ((head_ + n) & (cap_ - 1));
+  }
+  size_type first_span_size() const noexcept {
+    return cap_ - head_ < size_ ? cap_ - head_ : size_;
+  }
+
+  // initialize / destroy
+  void fill_init(size_type n, const value_type& value);
+  template <class IIter>
+  void range_init(IIter first, IIter last);
+  void destroy_and_recover() noexcept;
+
+  // reallocate
+  void require_capacity(size_type n);
+  void reallocate(size_type new_cap);
+};
+
+/*****************************************************************************************/
+
+template <class T>
+void ring_buffer<T>::reserve(size_type n) {
+  if (n > cap_) {
+    THROW_LENGTH_ERROR_IF(n > max_size(), "ring_buffer<T>'s size too big");
+    size_type new_cap = 1;
+    while (new_cap < n) {
+      new_cap <<= 1;
+    }
+    reallocate(new_cap);
+  }
+}
+
+// 缩小容量，固定容量模式下不做任何事
+template <class T>
+void ring_buffer<T>::shrink_to_fit() {
+  if (bounded_) {
+    return;
+  }
+  if (size_ == 0) {
+    destroy_and_recover();
+    return;
+  }
+  size_type new_cap = 1;
+  while (new_cap < size_) {
+    new_cap <<= 1;
+  }
+  if (new_cap < cap_) {
+    reallocate(new_cap);
+  }
+}
+
+// 在头部就地构建元素
+template <class T>
+template <class ...Args>
+void ring_buffer<T>::emplace_front(Args&& ...args) {
+  require_capacity(size_ + 1);
+  const size_type new_head = (head_ - 1) & (cap_ - 1);
+  data_allocator::construct(buf_ + new_head, yastl::forward<Args>(args)...);
+  head_ = new_head;
+  ++size_;
+}
+
+// 在尾部就地构建元素
+template <class T>
+template <class ...Args>
+void ring_buffer<T>::emplace_back(Args&& ...args) {
+  require_capacity(size_ + 1);
+  data_allocator::construct(slot(size_), yastl::forward<Args>(args)...);
+  ++size_;
+}
+
+// 弹出头部元素
+template <class T>
+void ring_buffer<T>::pop_front() {
+  YASTL_DEBUG(!empty());
+  data_allocator::destroy(buf_ + head_);
+  head_ = (head_ + 1) & (cap_ - 1);
+  --size_;
+}
+
+// 弹出尾部元素
+template <class T>
+void ring_buffer<T>::pop_back() {
+  YASTL_DEBUG(!empty());
+  data_allocator::destroy(slot(size_ - 1));
+  --size_;
+}
+
+// 批量追加，最多分两段拷贝，可平凡拷贝的类型会走 memmove
+template <class T>
+typename ring_buffer<T>::size_type ring_buffer<T>::append(const_pointer first, size_type n) {
+  if (bounded_) {
+    n = yastl::min(n, cap_ - size_);
+  } else {
+    require_capacity(size_ + n);
+  }
+  if (n == 0) {
+    return 0;
+  }
+  const size_type tail = (head_ + size_) & (cap_ - 1);
+  const size_type len1 = yastl::min(n, cap_ - tail);
+  yastl::uninitialized_copy(first, first + len1, buf_ + tail);
+  try {
+    yastl::uninitialized_copy(first + len1, first + n, buf_);
+  } catch (...) {
+    data_allocator::destroy(buf_ + tail, buf_ + tail + len1);
+    throw;
+  }
+  size_ += n;
+  return n;
+}
+
+// 批量弹出并移动到 out，最多分两段移动
+template <class T>
+typename ring_buffer<T>::size_type ring_buffer<T>::pop_front_n(size_type n, pointer out) {
+  n = yastl::min(n, size_);
+  const size_type len1 = yastl::min(n, cap_ - head_);
+  out = yastl::move(buf_ + head_, buf_ + head_ + len1, out);
+  yastl::move(buf_, buf_ + (n - len1), out);
+  return pop_front_n(n);
+}
+
+template <class T>
+typename ring_buffer<T>::size_type ring_buffer<T>::pop_front_n(size_type n) {
+  n = yastl::min(n, size_);
+  if (n == 0) {
+    return 0;
+  }
+  const size_type len1 = yastl::min(n, cap_ - head_);
+  data_allocator::destroy(buf_ + head_, buf_ + head_ + len1);
+  data_allocator::destroy(buf_, buf_ + (n - len1));
+  head_ = (head_ + n) & (cap_ - 1);
+  size_ -= n;
+  return n;
+}
+
+// 重置容器大小
+template <class T>
+void ring_buffer<T>::resize(size_type new_size, const value_type& value) {
+  if (new_size < size_) {
+    while (size_ > new_size) {
+      pop_back();
+    }
+  } else {
+    require_capacity(new_size);
+    while (size_ < new_size) {
+      emplace_back(value);
+    }
+  }
+}
+
+template <class T>
+void ring_buffer<T>::clear() noexcept {
+  pop_front_n(size_);
+  head_ = 0;
+}
+
+template <class T>
+void ring_buffer<T>::swap(ring_buffer& rhs) noexcept {
+  if (this != &rhs) {
+    yastl::swap(buf_, rhs.buf_);
+    yastl::swap(cap_, rhs.cap_);
+    yastl::swap(head_, rhs.head_);
+    yastl::swap(size_, rhs.size_);
+    yastl::swap(bounded_, rhs.bounded_);
+  }
+}
+
+/*****************************************************************************************/
+// helper function
+
+template <class T>
+void ring_buffer<T>::fill_init(size_type n, const value_type& value) {
+  try {
+    resize(n, value);
+  } catch (...) {
+    destroy_and_recover();
+    throw;
+  }
+}
+
+template <class T>
+template <class IIter>
+void ring_buffer<T>::range_init(IIter first, IIter last) {
+  try {
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  } catch (...) {
+    destroy_and_recover();
+    throw;
+  }
+}
+
+template <class T>
+void ring_buffer<T>::destroy_and_recover() noexcept {
+  clear();
+  data_allocator::deallocate(buf_, cap_);
+  buf_ = nullptr;
+  cap_ = 0;
+}
+
+// require_capacity 函数，保证能容纳 n 个元素，固定容量模式下放不下则抛出异常
+template <class T>
+void ring_buffer<T>::require_capacity(size_type n) {
+  if (n <= cap_) {
+    return;
+  }
+  THROW_LENGTH_ERROR_IF(bounded_, "ring_buffer<T> is full");
+  const size_type init = RING_BUFFER_INIT_SIZE;
+  reserve(yastl::max(n, cap_ == 0 ? init : cap_ * 2));
+}
+
+// reallocate 函数，把元素按逻辑顺序搬到新缓冲区的开头
+template <class T>
+void ring_buffer<T>::reallocate(size_type new_cap) {
+  pointer new_buf = data_allocator::allocate(new_cap);
+  const size_type len1 = first_span_size();
+  try {
+    auto mid = yastl::uninitialized_move(buf_ + head_, buf_ + head_ + len1, new_buf);
+    yastl::uninitialized_move(buf_, buf_ + (size_ - len1), mid);
+  } catch (...) {
+    data_allocator::deallocate(new_buf, new_cap);
+    throw;
+  }
+  data_allocator::destroy(buf_ + head_, buf_ + head_ + len1);
+  data_allocator::destroy(buf_, buf_ + (size_ - len1));
+  data_allocator::deallocate(buf_, cap_);
+  buf_ = new_buf;
+  cap_ = new_cap;
+  head_ = 0;
+}
+
+// 重载比较操作符
+template <class T>
+bool operator==(const ring_buffer<T>& lhs, const ring_buffer<T>& rhs) {
+  return lhs.size() == rhs.size() && yastl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T>
+bool operator<(const ring_buffer<T>& lhs, const ring_buffer<T>& rhs) {
+  return yastl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T>
+bool operator!=(const ring_buffer<T>& lhs, const ring_buffer<T>& rhs) {
+  return !(lhs == rhs);
+}
+
+template <class T>
+bool operator>(const ring_buffer<T>& lhs, const ring_buffer<T>& rhs) {
+  return rhs < lhs;
+}
+
+template <class T>
+bool operator<=(const ring_buffer<T>& lhs, const ring_buffer<T>& rhs) {
+  return !(rhs < lhs);
+}
+
+template <class T>
+bool operator>=(const ring_buffer<T>& lhs, const ring_buffer<T>& rhs) {
+  return !(lhs < rhs);
+}
+
+// 重载 yastl 的 swap
+template <class T>
+void swap(ring_buffer<T>& lhs, ring_buffer<T>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+} // namespace yastl
+#endif // _INCLUDE_RING_BUFFER_H_
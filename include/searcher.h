@@ -0,0 +1,272 @@
+﻿#ifndef _INCLUDE_SEARCHER_H_
+#define _INCLUDE_SEARCHER_H_
+
+// 这个头文件包含了三个搜索器 default_searcher、boyer_moore_horspool_searcher 和 boyer_moore_searcher
+// 搜索器保存要查找的模式串，用 search(first, last, searcher) 或 searcher(first, last) 在文本中查找
+
+// notes:
+//
+// 搜索器的 operator() 返回一对迭代器，指向第一处匹配的首尾，找不到时两个都是 last
+// boyer_moore_horspool_searcher 只使用坏字符表，预处理 O(m)，平均跳过接近 m 个字符
+// boyer_moore_searcher 再加上好后缀表，最坏情况也不会退化为 O(n * m)
+// 元素是单字节整数并且使用 yastl::equal_to 时坏字符表是 256 项的数组，否则是以 Hash / BinaryPredicate 为参数的 unordered_map
+
+#include "algo.h"
+#include "functional.h"
+#include "vector.h"
+#include "unordered_map.h"
+
+namespace yastl {
+
+/*****************************************************************************************/
+// default_searcher
+// 使用 search 逐个比较
+/*****************************************************************************************/
+template <class ForwardIter1, class BinaryPredicate = yastl::equal_to<typename iterator_traits<ForwardIter1>::value_type>>
+class default_searcher {
+private:
+  ForwardIter1 pat_first_;
+  ForwardIter1 pat_last_;
+  BinaryPredicate pred_;
+
+public:
+  default_searcher(ForwardIter1 pat_first, ForwardIter1 pat_last, BinaryPredicate pred = BinaryPredicate())
+    : pat_first_(pat_first), pat_last_(pat_last), pred_(pred) {}
+
+  template <class ForwardIter2>
+  yastl::pair<ForwardIter2, ForwardIter2> operator()(ForwardIter2 first, ForwardIter2 last) const {
+    ForwardIter2 result = yastl::search(first, last, pat_first_, pat_last_, pred_);
+    ForwardIter2 result_end = result;
+    if (result != last) {
+      yastl::advance(result_end, yastl::distance(pat_first_, pat_last_));
+    }
+    return yastl::pair<ForwardIter2, ForwardIter2>(result, result_end);
+  }
+};
+
+/*****************************************************************************************/
+// 坏字符表：字符 -> 跳过的距离，没有出现过的字符返回缺省值
+/*****************************************************************************************/
+template <class Key, class Value, class Hash, class BinaryPredicate, bool IsByte>
+class searcher_skip_table {
+private:
+  yastl::unordered_map<Key, Value, Hash, BinaryPredicate> table_;
+  Value default_;
+
+public:
+  searcher_skip_table(size_t n, Value default_value, Hash hf, BinaryPredicate pred)
+    : table_(n, hf, pred), default_(default_value) {}
+
+  void set(const Key& key, Value value) {
+    table_[key] = value;
+  }
+
+  Value get(const Key& key) const {
+    auto it = table_.find(key);
+    return it == table_.end() ? default_ : it->second;
+  }
+};
+
+// 单字节整数直接查数组
+template <class Key, class Value, class Hash, class BinaryPredicate>
+class searcher_skip_table<Key, Value, Hash, BinaryPredicate, true> {
+private:
+  Value table_[256];
+
+public:
+  searcher_skip_table(size_t, Value default_value, Hash, BinaryPredicate) {
+    for (size_t i = 0; i < 256; ++i) {
+      table_[i] = default_value;
+    }
+  }
+
+  void set(const Key& key, Value value) {
+    table_[static_cast<unsigned char>(key)] = value;
+  }
+
+  Value get(const Key& key) const {
+    return table_[static_cast<unsigned char>(key)];
+  }
+};
+
+template <class Key, class BinaryPredicate>
+struct searcher_use_array
+  : m_bool_constant<std::is_integral<Key>::value && sizeof(Key) == 1 &&
+                    std::is_same<BinaryPredicate, yastl::equal_to<Key>>::value> {};
+
+/*****************************************************************************************/
+// boyer_moore_horspool_searcher
+// 从模式串的末尾开始比较，失配时按文本窗口最后一个字符在模式串中最后出现的位置移动
+/*****************************************************************************************/
+template <class RandomIter1,
+          class Hash = yastl::hash<typename iterator_traits<RandomIter1>::value_type>,
+          class BinaryPredicate = yastl::equal_to<typename iterator_traits<RandomIter1>::value_type>>
+class boyer_moore_horspool_searcher {
+private:
+  typedef typename iterator_traits<RandomIter1>::value_type key_type;
+  typedef typename iterator_traits<RandomIter1>::difference_type difference_type;
+  typedef searcher_skip_table<key_type, difference_type, Hash, BinaryPredicate,
+                              searcher_use_array<key_type, BinaryPredicate>::value> skip_table;
+
+  RandomIter1 pat_first_;
+  RandomIter1 pat_last_;
+  BinaryPredicate pred_;
+  skip_table skip_;
+
+public:
+  boyer_moore_horspool_searcher(RandomIter1 pat_first, RandomIter1 pat_last,
+                                Hash hf = Hash(), BinaryPredicate pred = BinaryPredicate());
+
+  template <class RandomIter2>
+  yastl::pair<RandomIter2, RandomIter2> operator()(RandomIter2 first, RandomIter2 last) const;
+};
+
+template <class RandomIter1, class Hash, class BinaryPredicate>
+boyer_moore_horspool_searcher<RandomIter1, Hash, BinaryPredicate>::
+boyer_moore_horspool_searcher(RandomIter1 pat_first, RandomIter1 pat_last, Hash hf, BinaryPredicate pred)
+  : pat_first_(pat_first), pat_last_(pat_last), pred_(pred),
+    skip_(static_cast<size_t>(pat_last - pat_first), pat_last - pat_first, hf, pred) {
+  const difference_type m = pat_last - pat_first;
+  // 最后一个字符不参与，否则它的跳过距离为 0
+  for (difference_type i = 0; i + 1 < m; ++i) {
+    skip_.set(*(pat_first + i), m - 1 - i);
+  }
+}
+
+template <class RandomIter1, class Hash, class BinaryPredicate>
+template <class RandomIter2>
+yastl::pair<RandomIter2, RandomIter2>
+boyer_moore_horspool_searcher<RandomIter1, Hash, BinaryPredicate>::
+operator()(RandomIter2 first, RandomIter2 last) const {
+  typedef yastl::pair<RandomIter2, RandomIter2> result_type;
+  const difference_type m = pat_last_ - pat_first_;
+  if (m == 0) {
+    return result_type(first, first);
+  }
+  for (RandomIter2 cur = first; last - cur >= m; ) {
+    difference_type i = m - 1;
+    while (pred_(*(cur + i), *(pat_first_ + i))) {
+      if (i == 0) {
+        return result_type(cur, cur + m);
+      }
+      --i;
+    }
+    cur += skip_.get(*(cur + (m - 1)));
+  }
+  return result_type(last, last);
+}
+
+/*****************************************************************************************/
+// boyer_moore_searcher
+// 在 Horspool 的基础上增加好后缀表，失配时取坏字符规则与好后缀规则中较大的移动距离
+/*****************************************************************************************/
+template <class RandomIter1,
+          class Hash = yastl::hash<typename iterator_traits<RandomIter1>::value_type>,
+          class BinaryPredicate = yastl::equal_to<typename iterator_traits<RandomIter1>::value_type>>
+class boyer_moore_searcher {
+private:
+  typedef typename iterator_traits<RandomIter1>::value_type key_type;
+  typedef typename iterator_traits<RandomIter1>::difference_type difference_type;
+  typedef searcher_skip_table<key_type, difference_type, Hash, BinaryPredicate,
+                              searcher_use_array<key_type, BinaryPredicate>::value> skip_table;
+
+  RandomIter1 pat_first_;
+  RandomIter1 pat_last_;
+  BinaryPredicate pred_;
+  skip_table bad_char_;                     // 字符在模式串中最后出现的下标，没有出现为 -1
+  yastl::vector<difference_type> suffix_;   // 好后缀表：在下标 i 失配时的移动距离
+
+public:
+  boyer_moore_searcher(RandomIter1 pat_first, RandomIter1 pat_last,
+                       Hash hf = Hash(), BinaryPredicate pred = BinaryPredicate());
+
+  template <class RandomIter2>
+  yastl::pair<RandomIter2, RandomIter2> operator()(RandomIter2 first, RandomIter2 last) const;
+
+private:
+  void build_suffix_table();
+};
+
+template <class RandomIter1, class Hash, class BinaryPredicate>
+boyer_moore_searcher<RandomIter1, Hash, BinaryPredicate>::
+boyer_moore_searcher(RandomIter1 pat_first, RandomIter1 pat_last, Hash hf, BinaryPredicate pred)
+  : pat_first_(pat_first), pat_last_(pat_last), pred_(pred),
+    bad_char_(static_cast<size_t>(pat_last - pat_first), -1, hf, pred) {
+  const difference_type m = pat_last - pat_first;
+  for (difference_type i = 0; i < m; ++i) {
+    bad_char_.set(*(pat_first + i), i);
+  }
+  build_suffix_table();
+}
+
+// suff[i] 为以 i 结尾、同时也是模式串后缀的最长子串长度，再由它推出每个失配位置的移动距离
+template <class RandomIter1, class Hash, class BinaryPredicate>
+void boyer_moore_searcher<RandomIter1, Hash, BinaryPredicate>::build_suffix_table() {
+  const difference_type m = pat_last_ - pat_first_;
+  if (m == 0) {
+    return;
+  }
+  RandomIter1 p = pat_first_;
+  yastl::vector<difference_type> suff(static_cast<size_t>(m), 0);
+  suff[m - 1] = m;
+  difference_type g = m - 1;
+  difference_type f = m - 1;
+  for (difference_type i = m - 2; i >= 0; --i) {
+    if (i > g && suff[i + m - 1 - f] < i - g) {
+      suff[i] = suff[i + m - 1 - f];
+    } else {
+      if (i < g) {
+        g = i;
+      }
+      f = i;
+      while (g >= 0 && pred_(*(p + g), *(p + (g + m - 1 - f)))) {
+        --g;
+      }
+      suff[i] = f - g;
+    }
+  }
+
+  suffix_.assign(static_cast<size_t>(m), m);
+  // 模式串的某个前缀同时也是后缀
+  difference_type j = 0;
+  for (difference_type i = m - 1; i >= 0; --i) {
+    if (suff[i] == i + 1) {
+      for (; j < m - 1 - i; ++j) {
+        if (suffix_[j] == m) {
+          suffix_[j] = m - 1 - i;
+        }
+      }
+    }
+  }
+  // 好后缀在模式串中的其他位置再次出现
+  for (difference_type i = 0; i + 1 < m; ++i) {
+    suffix_[m - 1 - suff[i]] = m - 1 - i;
+  }
+}
+
+template <class RandomIter1, class Hash, class BinaryPredicate>
+template <class RandomIter2>
+yastl::pair<RandomIter2, RandomIter2>
+boyer_moore_searcher<RandomIter1, Hash, BinaryPredicate>::
+operator()(RandomIter2 first, RandomIter2 last) const {
+  typedef yastl::pair<RandomIter2, RandomIter2> result_type;
+  const difference_type m = pat_last_ - pat_first_;
+  if (m == 0) {
+    return result_type(first, first);
+  }
+  for (RandomIter2 cur = first; last - cur >= m; ) {
+    difference_type i = m - 1;
+    while (pred_(*(cur + i), *(pat_first_ + i))) {
+      if (i == 0) {
+        return result_type(cur, cur + m);
+      }
+      --i;
+    }
+    const difference_type bad = i - bad_char_.get(*(cur + i));
+    cur += yastl::max(suffix_[i], bad);
+  }
+  return result_type(last, last);
+}
+
+} // namespace yastl
+#endif // _INCLUDE_SEARCHER_H_
@@ -0,0 +1,736 @@
+﻿#ifndef _INCLUDE_SEGMENTED_VECTOR_H_
+#define _INCLUDE_SEGMENTED_VECTOR_H_
+
+// 这个头文件包含了一个模板类 segmented_vector
+// segmented_vector : 分段向量，元素存放在一个个固定大小的块(chunk)中，只支持在尾部增删
+
+// notes:
+//
+// 与 vector 不同，segmented_vector 扩容时只是追加新的块，不会搬移已有元素，
+// 所以元素的地址在它被 pop_back / clear 之前一直有效，push_back 是不搬移元素的 O(1) 操作
+// 与 deque 不同，块目录按几何级数分层：第 l 层有 2^l 个块指针，层表一旦分配就不再移动，
+// 因此不存在 map 的重新分配，也能让多个线程无锁地并发追加元素
+//
+// 并发约定：
+//   * concurrent_push_back / concurrent_emplace_back 之间可以并发调用，
+//     也可以与 operator[]、at 等只读访问并发调用
+//   * 其余修改容器的函数（push_back, pop_back, resize, clear, reserve, shrink_to_fit, swap 等）不是线程安全的
+//   * size() 统计的是已经预留出去的位置，一个线程只能确定自己追加的元素已经构造完成，
+//     读取其他线程追加的元素之前需要额外的同步（例如 join 线程，或者由追加者发布下标）
+//
+// 异常保证：
+// yastl::segmented_vector<T> 满足基本异常保证，并对以下函数做强异常安全保证：
+//   * emplace_back
+//   * push_back
+// concurrent_* 系列函数要求元素的构造不抛出异常，若块的分配失败（bad_alloc），已预留的位置将无法使用
+
+#include <atomic>
+#include <climits>
+#include <initializer_list>
+
+#include "iterator.h"
+#include "memory.h"
+#include "util.h"
+#include "exceptdef.h"
+
+namespace yastl {
+
+// 不大于 n 的最大的 2 的幂次
+constexpr size_t seg_floor_pow2(size_t n) {
+  return n < 2 ? 1 : 2 * seg_floor_pow2(n / 2);
+}
+
+// 编译期的 log2(n)，n 为 2 的幂次
+constexpr size_t seg_log2(size_t n) {
+  return n < 2 ? 0 : 1 + seg_log2(n / 2);
+}
+
+// 运行期的 floor(log2(n))，n 不能为 0
+inline size_t seg_floor_log2(size_t n) {
+#if defined(__GNUC__) || defined(__clang__)
+  return 63 - static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(n)));
+#else
+  size_t k = 0;
+  for (; n > 1; n >>= 1) {
+    ++k;
+  }
+  return k;
+#endif
+}
+
+// 每个块的默认元素个数，与 deque_buf_size 一样以 4096 字节为准，并向下取整为 2 的幂次，方便用移位代替除法
+template <class T>
+struct segmented_vector_chunk_size {
+  static constexpr size_t value = sizeof(T) < 256 ? seg_floor_pow2(4096 / sizeof(T)) : 16;
+};
+
+template <class T, size_t ChunkSize>
+class segmented_vector;
+
+// segmented_vector 的迭代器设计
+// 记录元素下标，同时缓存当前块的位置，在块内移动时不需要查目录
+template <class T, class Ref, class Ptr, size_t ChunkSize>
+struct segmented_vector_iterator : public iterator<random_access_iterator_tag, T> {
+  typedef segmented_vector_iterator<T, T&, T*, ChunkSize> iterator;
+  typedef segmented_vector_iterator<T, const T&, const T*, ChunkSize> const_iterator;
+  typedef segmented_vector_iterator self;
+  typedef segmented_vector<T, ChunkSize> container_type;
+
+  typedef T value_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef T* value_pointer;
+
+  // 迭代器所含成员数据
+  value_pointer cur;             // 指向当前元素，所在块还未分配时为空
+  value_pointer last;            // 指向当前块的尾部
+  size_type index;               // 当前元素的下标
+  const container_type* owner;   // 所属的容器
+
+  // 构造、复制函数
+  segmented_vector_iterator() noexcept : cur(nullptr), last(nullptr), index(0), owner(nullptr) {}
+
+  segmented_vector_iterator(const container_type* c, size_type n) : index(n), owner(c) {
+    locate();
+  }
+
+  segmented_vector_iterator(const iterator& rhs)
+    : cur(rhs.cur), last(rhs.last), index(rhs.index), owner(rhs.owner) {}
+
+  self& operator=(const self& rhs) = default;
+
+  // 根据 index 重新定位所在的块
+  void locate() {
+    value_pointer chunk = owner->chunk_at(index / ChunkSize);
+    if (chunk != nullptr) {
+      cur = chunk + index % ChunkSize;
+      last = chunk + ChunkSize;
+    } else {
+      cur = nullptr;
+      last = nullptr;
+    }
+  }
+
+  reference operator*() const {
+    return *cur;
+  }
+  pointer operator->() const {
+    return cur;
+  }
+
+  difference_type operator-(const self& x) const {
+    return static_cast<difference_type>(index) - static_cast<difference_type>(x.index);
+  }
+
+  self& operator++() {
+    ++index;
+    if (++cur == last) { // 到达块的尾部，换到下一个块
+      locate();
+    }
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  self& operator--() {
+    --index;
+    if (cur == nullptr || cur == last - ChunkSize) { // 在块的头部，换到上一个块
+      locate();
+    } else {
+      --cur;
+    }
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  self& operator+=(difference_type n) {
+    index += n;
+    if (cur != nullptr) {
+      const auto offset = n + (cur - (last - ChunkSize)); // 相对于块头部的偏移量
+      if (offset >= 0 && offset < static_cast<difference_type>(ChunkSize)) { // 仍在当前块
+        cur += n;
+        return *this;
+      }
+    }
+    locate();
+    return *this;
+  }
+  self operator+(difference_type n) const {
+    self tmp = *this;
+    return tmp += n;
+  }
+  self& operator-=(difference_type n) {
+    return *this += -n;
+  }
+  self operator-(difference_type n) const {
+    self tmp = *this;
+    return tmp -= n;
+  }
+
+  reference operator[](difference_type n) const {
+    return *(*this + n);
+  }
+
+  // 重载比较操作符
+  bool operator==(const self& rhs) const {
+    return index == rhs.index;
+  }
+  bool operator!=(const self& rhs) const {
+    return index != rhs.index;
+  }
+  bool operator<(const self& rhs) const {
+    return index < rhs.index;
+  }
+  bool operator>(const self& rhs) const {
+    return rhs < *this;
+  }
+  bool operator<=(const self& rhs) const {
+    return !(rhs < *this);
+  }
+  bool operator>=(const self& rhs) const {
+    return !(*this < rhs);
+  }
+};
+
+// 模板类 segmented_vector
+// 参数一代表数据类型，参数二代表每个块的元素个数，必须是 2 的幂次
+template <class T, size_t ChunkSize = segmented_vector_chunk_size<T>::value>
+class segmented_vector {
+  static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0,
+                "the ChunkSize of segmented_vector should be a power of 2");
+
+  template <class, class, class, size_t>
+  friend struct segmented_vector_iterator;
+
+public:
+  // segmented_vector 的型别定义
+  typedef yastl::allocator<T> allocator_type;
+  typedef yastl::allocator<T> data_allocator;
+
+  typedef typename allocator_type::value_type value_type;
+  typedef typename allocator_type::pointer pointer;
+  typedef typename allocator_type::const_pointer const_pointer;
+  typedef typename allocator_type::reference reference;
+  typedef typename allocator_type::const_reference const_reference;
+  typedef typename allocator_type::size_type size_type;
+  typedef typename allocator_type::difference_type difference_type;
+
+  typedef segmented_vector_iterator<T, T&, T*, ChunkSize> iterator;
+  typedef segmented_vector_iterator<T, const T&, const T*, ChunkSize> const_iterator;
+  typedef yastl::reverse_iterator<iterator> reverse_iterator;
+  typedef yastl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  allocator_type get_allocator() {
+    return allocator_type();
+  }
+
+  // 每个块的大小
+  static const size_type chunk_size = ChunkSize;
+
+private:
+  typedef std::atomic<pointer> chunk_slot;
+  typedef yastl::allocator<chunk_slot> slot_allocator;
+
+  static const size_type chunk_shift = seg_log2(ChunkSize);
+  static const size_type chunk_mask = ChunkSize - 1;
+  // 块下标 c 位于第 floor(log2(c + 1)) 层，层数足以覆盖整个 size_type 的下标范围
+  static const size_type level_count = sizeof(size_type) * CHAR_BIT - chunk_shift + 1;
+
+  // 用以下数据来表现一个 segmented_vector
+  std::atomic<size_type> size_;                // 已预留出去的元素个数
+  std::atomic<size_type> chunks_;              // 已分配的块的个数
+  std::atomic<chunk_slot*> levels_[level_count]; // 分层的块目录，第 l 层有 2^l 个块指针
+
+public:
+  // 构造、复制、移动、析构函数
+  segmented_vector() noexcept {
+    init_empty();
+  }
+
+  explicit segmented_vector(size_type n) {
+    init_empty();
+    fill_init(n, value_type());
+  }
+
+  segmented_vector(size_type n, const value_type& value) {
+    init_empty();
+    fill_init(n, value);
+  }
+
+  template <class IIter, typename std::enable_if<yastl::is_input_iterator<IIter>::value, int>::type = 0>
+  segmented_vector(IIter first, IIter last) {
+    init_empty();
+    range_init(first, last);
+  }
+
+  segmented_vector(std::initializer_list<value_type> ilist) {
+    init_empty();
+    range_init(ilist.begin(), ilist.end());
+  }
+
+  segmented_vector(const segmented_vector& rhs) {
+    init_empty();
+    range_init(rhs.begin(), rhs.end());
+  }
+
+  // 移动构造，直接接管块目录，元素地址不变
+  segmented_vector(segmented_vector&& rhs) noexcept {
+    init_empty();
+    swap(rhs);
+  }
+
+  segmented_vector& operator=(const segmented_vector& rhs) {
+    if (this != &rhs) {
+      segmented_vector tmp(rhs);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  segmented_vector& operator=(segmented_vector&& rhs) noexcept {
+    if (this != &rhs) {
+      destroy_and_release();
+      swap(rhs);
+    }
+    return *this;
+  }
+
+  segmented_vector& operator=(std::initializer_list<value_type> ilist) {
+    segmented_vector tmp(ilist);
+    swap(tmp);
+    return *this;
+  }
+
+  ~segmented_vector() {
+    destroy_and_release();
+  }
+
+public:
+  // 迭代器相关操作
+
+  iterator begin() noexcept {
+    return iterator(this, 0);
+  }
+  const_iterator begin() const noexcept {
+    return const_iterator(iterator(this, 0));
+  }
+  iterator end() noexcept {
+    return iterator(this, size());
+  }
+  const_iterator end() const noexcept {
+    return const_iterator(iterator(this, size()));
+  }
+
+  reverse_iterator rbegin() noexcept {
+    return reverse_iterator(end());
+  }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept {
+    return reverse_iterator(begin());
+  }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+  const_iterator cend() const noexcept {
+    return end();
+  }
+  const_reverse_iterator crbegin() const noexcept {
+    return rbegin();
+  }
+  const_reverse_iterator crend() const noexcept {
+    return rend();
+  }
+
+  // 容量相关操作
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+  size_type size() const noexcept {
+    return size_.load(std::memory_order_acquire);
+  }
+  size_type max_size() const noexcept {
+    return static_cast<size_type>(-1) / sizeof(T);
+  }
+  // 已分配的块所能容纳的元素个数
+  size_type capacity() const noexcept {
+    return chunks_.load(std::memory_order_relaxed) * ChunkSize;
+  }
+  void reserve(size_type n);
+  void shrink_to_fit() noexcept;
+
+  // 访问元素相关操作
+  reference operator[](size_type n) {
+    YASTL_DEBUG(n < size());
+    return *(chunk_at(n >> chunk_shift) + (n & chunk_mask));
+  }
+  const_reference operator[](size_type n) const {
+    YASTL_DEBUG(n < size());
+    return *(chunk_at(n >> chunk_shift) + (n & chunk_mask));
+  }
+
+  reference at(size_type n) {
+    THROW_OUT_OF_RANGE_IF(!(n < size()), "segmented_vector<T>::at() subscript out of range");
+    return (*this)[n];
+  }
+  const_reference at(size_type n) const {
+    THROW_OUT_OF_RANGE_IF(!(n < size()), "segmented_vector<T>::at() subscript out of range");
+    return (*this)[n];
+  }
+
+  reference front() {
+    YASTL_DEBUG(!empty());
+    return (*this)[0];
+  }
+  const_reference front() const {
+    YASTL_DEBUG(!empty());
+    return (*this)[0];
+  }
+  reference back() {
+    YASTL_DEBUG(!empty());
+    return (*this)[size() - 1];
+  }
+  const_reference back() const {
+    YASTL_DEBUG(!empty());
+    return (*this)[size() - 1];
+  }
+
+  // 修改容器相关操作
+
+  // emplace_back / push_back / pop_back
+
+  template <class ...Args>
+  void emplace_back(Args&& ...args);
+
+  void push_back(const value_type& value) {
+    emplace_back(value);
+  }
+  void push_back(value_type&& value) {
+    emplace_back(yastl::move(value));
+  }
+
+  void pop_back();
+
+  // 并发追加，返回指向新元素的迭代器
+
+  template <class ...Args>
+  iterator concurrent_emplace_back(Args&& ...args);
+
+  iterator concurrent_push_back(const value_type& value) {
+    return concurrent_emplace_back(value);
+  }
+  iterator concurrent_push_back(value_type&& value) {
+    return concurrent_emplace_back(yastl::move(value));
+  }
+
+  // resize / clear
+
+  void resize(size_type new_size) {
+    resize(new_size, value_type());
+  }
+  void resize(size_type new_size, const value_type& value);
+
+  // 析构所有元素，但保留已分配的块
+  void clear() noexcept;
+
+  // swap
+
+  void swap(segmented_vector& rhs) noexcept;
+
+private:
+  // helper functions
+
+  // 计算块下标 c 所在的层和层内位置
+  static void locate_chunk(size_type c, size_type& level, size_type& slot) {
+    level = seg_floor_log2(c + 1);
+    slot = c + 1 - (static_cast<size_type>(1) << level);
+  }
+
+  // 返回第 c 个块的地址，尚未分配则返回空
+  pointer chunk_at(size_type c) const noexcept;
+  // 返回第 c 个块的地址，尚未分配则无锁地分配
+  pointer require_chunk(size_type c);
+  // 释放下标不小于 first_chunk 的块
+  void release_chunks(size_type first_chunk) noexcept;
+  // 析构 [first, size) 的元素
+  void destroy_from(size_type first) noexcept;
+
+  // initialize / destroy
+  void init_empty() noexcept;
+  void fill_init(size_type n, const value_type& value);
+  template <class IIter>
+  void range_init(IIter first, IIter last);
+  void destroy_and_release() noexcept;
+};
+
+/*****************************************************************************************/
+
+// 预留 n 个元素的空间，只分配块，不构造元素
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::reserve(size_type n) {
+  const size_type need = (n + chunk_mask) >> chunk_shift;
+  for (size_type c = 0; c < need; ++c) {
+    require_chunk(c);
+  }
+}
+
+// 释放有效元素之后多余的块
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::shrink_to_fit() noexcept {
+  release_chunks((size() + chunk_mask) >> chunk_shift);
+}
+
+// 在尾部就地构建元素，构造成功之后才更新 size，满足强异常安全保证
+template <class T, size_t ChunkSize>
+template <class ...Args>
+void segmented_vector<T, ChunkSize>::emplace_back(Args&& ...args) {
+  const size_type n = size_.load(std::memory_order_relaxed);
+  pointer chunk = require_chunk(n >> chunk_shift);
+  data_allocator::construct(chunk + (n & chunk_mask), yastl::forward<Args>(args)...);
+  size_.store(n + 1, std::memory_order_release);
+}
+
+// 弹出尾部元素，所在的块保留下来供之后的追加复用
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::pop_back() {
+  YASTL_DEBUG(!empty());
+  const size_type n = size_.load(std::memory_order_relaxed) - 1;
+  data_allocator::destroy(chunk_at(n >> chunk_shift) + (n & chunk_mask));
+  size_.store(n, std::memory_order_release);
+}
+
+// 并发地在尾部构建元素：先原子地预留一个下标，再确保所在块存在，最后在该位置构造
+template <class T, size_t ChunkSize>
+template <class ...Args>
+typename segmented_vector<T, ChunkSize>::iterator
+segmented_vector<T, ChunkSize>::concurrent_emplace_back(Args&& ...args) {
+  static_assert(std::is_nothrow_constructible<T, Args&&...>::value,
+                "concurrent_emplace_back requires a nothrow constructor");
+  const size_type n = size_.fetch_add(1, std::memory_order_acq_rel);
+  pointer chunk = require_chunk(n >> chunk_shift);
+  data_allocator::construct(chunk + (n & chunk_mask), yastl::forward<Args>(args)...);
+  return iterator(this, n);
+}
+
+// 重置容器大小
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::resize(size_type new_size, const value_type& value) {
+  const size_type len = size();
+  if (new_size < len) {
+    destroy_from(new_size);
+    size_.store(new_size, std::memory_order_release);
+  } else {
+    reserve(new_size);
+    for (size_type i = len; i < new_size; ++i) {
+      emplace_back(value);
+    }
+  }
+}
+
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::clear() noexcept {
+  destroy_from(0);
+  size_.store(0, std::memory_order_release);
+}
+
+// 交换两个 segmented_vector，只交换块目录
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::swap(segmented_vector& rhs) noexcept {
+  if (this != &rhs) {
+    size_.store(rhs.size_.exchange(size_.load(std::memory_order_relaxed), std::memory_order_relaxed),
+                std::memory_order_relaxed);
+    chunks_.store(rhs.chunks_.exchange(chunks_.load(std::memory_order_relaxed), std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+    for (size_type l = 0; l < level_count; ++l) {
+      levels_[l].store(rhs.levels_[l].exchange(levels_[l].load(std::memory_order_relaxed),
+                                               std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    }
+  }
+}
+
+/*****************************************************************************************/
+// helper function
+
+template <class T, size_t ChunkSize>
+typename segmented_vector<T, ChunkSize>::pointer
+segmented_vector<T, ChunkSize>::chunk_at(size_type c) const noexcept {
+  size_type level, slot;
+  locate_chunk(c, level, slot);
+  chunk_slot* table = levels_[level].load(std::memory_order_acquire);
+  return table == nullptr ? nullptr : table[slot].load(std::memory_order_acquire);
+}
+
+// require_chunk 函数，层表和块都按需分配，用 CAS 发布，竞争失败的一方释放自己分配的内存
+template <class T, size_t ChunkSize>
+typename segmented_vector<T, ChunkSize>::pointer
+segmented_vector<T, ChunkSize>::require_chunk(size_type c) {
+  size_type level, slot;
+  locate_chunk(c, level, slot);
+  chunk_slot* table = levels_[level].load(std::memory_order_acquire);
+  if (table == nullptr) {
+    const size_type n = static_cast<size_type>(1) << level;
+    chunk_slot* fresh = slot_allocator::allocate(n);
+    for (size_type i = 0; i < n; ++i) {
+      yastl::construct(fresh + i, static_cast<pointer>(nullptr));
+    }
+    if (levels_[level].compare_exchange_strong(table, fresh, std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+      table = fresh;
+    } else { // 其他线程已经分配了这一层
+      slot_allocator::deallocate(fresh, n);
+    }
+  }
+  pointer chunk = table[slot].load(std::memory_order_acquire);
+  if (chunk == nullptr) {
+    pointer fresh = data_allocator::allocate(ChunkSize);
+    if (table[slot].compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+      chunk = fresh;
+      chunks_.fetch_add(1, std::memory_order_relaxed);
+    } else { // 其他线程已经分配了这个块
+      data_allocator::deallocate(fresh, ChunkSize);
+    }
+  }
+  return chunk;
+}
+
+// release_chunks 函数，释放块下标不小于 first_chunk 的块，以及不再需要的层表
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::release_chunks(size_type first_chunk) noexcept {
+  for (size_type l = 0; l < level_count; ++l) {
+    chunk_slot* table = levels_[l].load(std::memory_order_relaxed);
+    if (table == nullptr) {
+      continue;
+    }
+    const size_type n = static_cast<size_type>(1) << l;
+    const size_type level_first = n - 1; // 这一层第一个块的下标
+    for (size_type s = 0; s < n; ++s) {
+      if (level_first + s < first_chunk) {
+        continue;
+      }
+      pointer chunk = table[s].load(std::memory_order_relaxed);
+      if (chunk != nullptr) {
+        data_allocator::deallocate(chunk, ChunkSize);
+        table[s].store(nullptr, std::memory_order_relaxed);
+        chunks_.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+    if (level_first >= first_chunk) { // 整层都不再使用
+      slot_allocator::deallocate(table, n);
+      levels_[l].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+}
+
+// destroy_from 函数，逐块析构 [first, size) 上的元素
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::destroy_from(size_type first) noexcept {
+  const size_type last = size_.load(std::memory_order_relaxed);
+  while (first < last) {
+    const size_type chunk_end = ((first >> chunk_shift) + 1) << chunk_shift;
+    const size_type stop = chunk_end < last ? chunk_end : last;
+    pointer chunk = chunk_at(first >> chunk_shift);
+    data_allocator::destroy(chunk + (first & chunk_mask), chunk + (first & chunk_mask) + (stop - first));
+    first = stop;
+  }
+}
+
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::init_empty() noexcept {
+  size_.store(0, std::memory_order_relaxed);
+  chunks_.store(0, std::memory_order_relaxed);
+  for (size_type l = 0; l < level_count; ++l) {
+    levels_[l].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+// fill_init 函数，失败时释放已构造的元素和块
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::fill_init(size_type n, const value_type& value) {
+  try {
+    reserve(n);
+    for (size_type i = 0; i < n; ++i) {
+      emplace_back(value);
+    }
+  } catch (...) {
+    destroy_and_release();
+    throw;
+  }
+}
+
+// range_init 函数
+template <class T, size_t ChunkSize>
+template <class IIter>
+void segmented_vector<T, ChunkSize>::range_init(IIter first, IIter last) {
+  try {
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  } catch (...) {
+    destroy_and_release();
+    throw;
+  }
+}
+
+template <class T, size_t ChunkSize>
+void segmented_vector<T, ChunkSize>::destroy_and_release() noexcept {
+  destroy_from(0);
+  size_.store(0, std::memory_order_relaxed);
+  release_chunks(0);
+}
+
+// 重载比较操作符
+template <class T, size_t ChunkSize>
+bool operator==(const segmented_vector<T, ChunkSize>& lhs, const segmented_vector<T, ChunkSize>& rhs) {
+  return lhs.size() == rhs.size() && yastl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, size_t ChunkSize>
+bool operator<(const segmented_vector<T, ChunkSize>& lhs, const segmented_vector<T, ChunkSize>& rhs) {
+  return yastl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T, size_t ChunkSize>
+bool operator!=(const segmented_vector<T, ChunkSize>& lhs, const segmented_vector<T, ChunkSize>& rhs) {
+  return !(lhs == rhs);
+}
+
+template <class T, size_t ChunkSize>
+bool operator>(const segmented_vector<T, ChunkSize>& lhs, const segmented_vector<T, ChunkSize>& rhs) {
+  return rhs < lhs;
+}
+
+template <class T, size_t ChunkSize>
+bool operator<=(const segmented_vector<T, ChunkSize>& lhs, const segmented_vector<T, ChunkSize>& rhs) {
+  return !(rhs < lhs);
+}
+
+template <class T, size_t ChunkSize>
+bool operator>=(const segmented_vector<T, ChunkSize>& lhs, const segmented_vector<T, ChunkSize>& rhs) {
+  return !(lhs < rhs);
+}
+
+// 重载 yastl 的 swap
+template <class T, size_t ChunkSize>
+void swap(segmented_vector<T, ChunkSize>& lhs, segmented_vector<T, ChunkSize>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+} // namespace yastl
+#endif // _INCLUDE_SEGMENTED_VECTOR_H_
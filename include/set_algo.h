@@ -4,8 +4,16 @@
 // 这个头文件包含 set 的四种算法: union, intersection, difference, symmetric_difference
 // 所有函数都要求序列有序
 
+// notes:
+//
+// union、intersection、difference 与 algo.h 中的 includes 一样，在两个迭代器都是随机访问迭代器并且两个区间长度相差超过 kSetGallopRatio 倍时，
+// 改为遍历较短的区间，在较长的区间中用倍增查找（galloping）定位，比较次数从 O(n + m) 降为 O(m log(n / m))
+// 元素为 4 / 8 字节整数的指针区间求交集时，长度相近的部分使用 simd.h 中的分块比较内核，遇到重复元素时退回串行版本
+
 #include "algobase.h"
+#include "algo.h"
 #include "iterator.h"
+#include "simd.h"
 
 namespace yastl {
 
@@ -13,15 +21,17 @@ namespace yastl {
 // set_union
 // 计算 S1∪S2 的结果并保存到 result 中，返回一个迭代器指向输出结果的尾部
 /*****************************************************************************************/
-template <class InputIter1, class InputIter2, class OutputIter>
-OutputIter set_union(InputIter1 first1, InputIter1 last1,
-                     InputIter2 first2, InputIter2 last2, 
-                     OutputIter result) {
+// set_union_dispatch 的 input_iterator_tag 版本
+template <class InputIter1, class InputIter2, class OutputIter, class Compared>
+OutputIter set_union_dispatch(InputIter1 first1, InputIter1 last1,
+                              InputIter2 first2, InputIter2 last2,
+                              OutputIter result, Compared comp,
+                              input_iterator_tag, input_iterator_tag) {
   while (first1 != last1 && first2 != last2) { // 从小到大依次放
-    if (*first1 < *first2) {
+    if (comp(*first1, *first2)) {
       *result = *first1; // 放 集合1 的内容
       ++first1;
-    } else if (*first2 < *first1) {
+    } else if (comp(*first2, *first1)) {
       *result = *first2; // 放 集合2 的内容
       ++first2;
     } else {
@@ -35,41 +45,72 @@ OutputIter set_union(InputIter1 first1, InputIter1 last1,
   return yastl::copy(first2, last2, yastl::copy(first1, last1, result));
 }
 
+// set_union_dispatch 的 random_access_iterator_tag 版本
+template <class RandomIter1, class RandomIter2, class OutputIter, class Compared>
+OutputIter set_union_dispatch(RandomIter1 first1, RandomIter1 last1,
+                              RandomIter2 first2, RandomIter2 last2,
+                              OutputIter result, Compared comp,
+                              random_access_iterator_tag, random_access_iterator_tag) {
+  if (set_use_gallop(last1 - first1, last2 - first2)) {
+    // 集合1 较短：集合2 中小于 *first1 的部分整段放入
+    for (; first1 != last1; ++first1, ++result) {
+      RandomIter2 pos = yastl::gallop_lower_bound(first2, last2, *first1, comp);
+      result = yastl::copy(first2, pos, result);
+      first2 = pos;
+      if (first2 != last2 && !comp(*first1, *first2)) { // 元素相等，只放集合1 的
+        ++first2;
+      }
+      *result = *first1;
+    }
+  } else if (set_use_gallop(last2 - first2, last1 - first1)) {
+    // 集合2 较短：集合1 中小于 *first2 的部分整段放入
+    for (; first2 != last2; ++first2, ++result) {
+      RandomIter1 pos = yastl::gallop_lower_bound(first1, last1, *first2, comp);
+      result = yastl::copy(first1, pos, result);
+      first1 = pos;
+      if (first1 != last1 && !comp(*first2, *first1)) {
+        *result = *first1;
+        ++first1;
+      } else {
+        *result = *first2;
+      }
+    }
+  }
+  return yastl::set_union_dispatch(first1, last1, first2, last2, result, comp,
+                                   input_iterator_tag(), input_iterator_tag());
+}
+
+template <class InputIter1, class InputIter2, class OutputIter>
+OutputIter set_union(InputIter1 first1, InputIter1 last1,
+                     InputIter2 first2, InputIter2 last2, 
+                     OutputIter result) {
+  return yastl::set_union_dispatch(first1, last1, first2, last2, result, set_less(),
+                                   iterator_category(first1), iterator_category(first2));
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class InputIter1, class InputIter2, class OutputIter, class Compared>
 OutputIter set_union(InputIter1 first1, InputIter1 last1,
                      InputIter2 first2, InputIter2 last2, 
                      OutputIter result, Compared comp) {
-  while (first1 != last1 && first2 != last2) {
-    if (comp(*first1, *first2)) {
-      *result = *first1;
-      ++first1;
-    } else if (comp(*first2, *first1)) {
-      *result = *first2;
-      ++first2;
-    } else {
-      *result = *first1;
-      ++first1;
-      ++first2;
-    }
-    ++result;
-  }
-  // 将剩余元素拷贝到 result
-  return yastl::copy(first2, last2, yastl::copy(first1, last1, result));
+  return yastl::set_union_dispatch(first1, last1, first2, last2, result, comp,
+                                   iterator_category(first1), iterator_category(first2));
 }
 
 /*****************************************************************************************/
 // set_intersection
 // 计算 S1∩S2 的结果并保存到 result 中，返回一个迭代器指向输出结果的尾部
 /*****************************************************************************************/
-template <class InputIter1, class InputIter2, class OutputIter>
-OutputIter set_intersection(InputIter1 first1, InputIter1 last1,
-                            InputIter2 first2, InputIter2 last2, 
-                            OutputIter result) {
+// set_intersection_dispatch 的 input_iterator_tag 版本
+template <class InputIter1, class InputIter2, class OutputIter, class Compared>
+OutputIter set_intersection_dispatch(InputIter1 first1, InputIter1 last1,
+                                     InputIter2 first2, InputIter2 last2,
+                                     OutputIter result, Compared comp,
+                                     input_iterator_tag, input_iterator_tag) {
   while (first1 != last1 && first2 != last2) {
-    if (*first1 < *first2) {
+    if (comp(*first1, *first2)) {
       ++first1;
-    } else if (*first2 < *first1) {
+    } else if (comp(*first2, *first1)) {
       ++first2;
     } else { // 相等，丢出来放 result 里
       *result = *first1;
@@ -81,40 +122,102 @@ OutputIter set_intersection(InputIter1 first1, InputIter1 last1,
   return result;
 }
 
+// set_intersection_dispatch 的 random_access_iterator_tag 版本
+template <class RandomIter1, class RandomIter2, class OutputIter, class Compared>
+OutputIter set_intersection_dispatch(RandomIter1 first1, RandomIter1 last1,
+                                     RandomIter2 first2, RandomIter2 last2,
+                                     OutputIter result, Compared comp,
+                                     random_access_iterator_tag, random_access_iterator_tag) {
+  if (set_use_gallop(last1 - first1, last2 - first2)) {
+    for (; first1 != last1 && first2 != last2; ++first1) {
+      first2 = yastl::gallop_lower_bound(first2, last2, *first1, comp);
+      if (first2 != last2 && !comp(*first1, *first2)) {
+        *result = *first1;
+        ++result;
+        ++first2;
+      }
+    }
+    return result;
+  }
+  if (set_use_gallop(last2 - first2, last1 - first1)) {
+    for (; first1 != last1 && first2 != last2; ++first2) {
+      first1 = yastl::gallop_lower_bound(first1, last1, *first2, comp);
+      if (first1 != last1 && !comp(*first2, *first1)) {
+        *result = *first1;
+        ++result;
+        ++first1;
+      }
+    }
+    return result;
+  }
+  return yastl::set_intersection_dispatch(first1, last1, first2, last2, result, comp,
+                                          input_iterator_tag(), input_iterator_tag());
+}
+
+// 两个输入区间与输出区间都是指向同一种 4 / 8 字节整数的指针时可以使用 SIMD 内核
+template <class Iter1, class Iter2, class OutputIter>
+struct set_simd_intersection : m_false_type {};
+
+template <class U1, class U2, class T>
+struct set_simd_intersection<U1*, U2*, T*>
+  : m_bool_constant<simd_contiguous_pair<U1*, U2*>::value && simd_contiguous<U1*, T>::value &&
+                    !std::is_const<T>::value && std::is_integral<T>::value &&
+                    (sizeof(T) == 4 || sizeof(T) == 8)> {};
+
+template <class InputIter1, class InputIter2, class OutputIter>
+OutputIter set_intersection_cat(InputIter1 first1, InputIter1 last1,
+                                InputIter2 first2, InputIter2 last2,
+                                OutputIter result, m_false_type) {
+  return yastl::set_intersection_dispatch(first1, last1, first2, last2, result, set_less(),
+                                          iterator_category(first1), iterator_category(first2));
+}
+
+template <class U1, class U2, class T>
+T* set_intersection_cat(U1* first1, U1* last1, U2* first2, U2* last2, T* result, m_true_type) {
+  if (!set_use_gallop(last1 - first1, last2 - first2) && !set_use_gallop(last2 - first2, last1 - first1)) {
+    const T* stop1 = first1;
+    const T* stop2 = first2;
+    result = yastl::simd_set_intersection<T>(first1, last1, first2, last2, result, &stop1, &stop2);
+    first1 += stop1 - first1;
+    first2 += stop2 - first2;
+  }
+  return yastl::set_intersection_dispatch(first1, last1, first2, last2, result, set_less(),
+                                          random_access_iterator_tag(), random_access_iterator_tag());
+}
+
+template <class InputIter1, class InputIter2, class OutputIter>
+OutputIter set_intersection(InputIter1 first1, InputIter1 last1,
+                            InputIter2 first2, InputIter2 last2, 
+                            OutputIter result) {
+  return yastl::set_intersection_cat(first1, last1, first2, last2, result,
+                                     set_simd_intersection<InputIter1, InputIter2, OutputIter>());
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class InputIter1, class InputIter2, class OutputIter, class Compared>
 OutputIter set_intersection(InputIter1 first1, InputIter1 last1,
                             InputIter2 first2, InputIter2 last2,
                             OutputIter result, Compared comp) {
-  while (first1 != last1 && first2 != last2) {
-    if (comp(*first1, *first2)) {
-      ++first1;
-    } else if (comp(*first2, *first1)) {
-      ++first2;
-    } else { // 相等，丢出来放 result 里
-      *result = *first1;
-      ++first1;
-      ++first2;
-      ++result;
-    }
-  }
-  return result;
+  return yastl::set_intersection_dispatch(first1, last1, first2, last2, result, comp,
+                                          iterator_category(first1), iterator_category(first2));
 }
 
 /*****************************************************************************************/
 // set_difference
 // 计算 S1-S2 的结果并保存到 result 中，返回一个迭代器指向输出结果的尾部
 /*****************************************************************************************/
-template <class InputIter1, class InputIter2, class OutputIter>
-OutputIter set_difference(InputIter1 first1, InputIter1 last1,
-                          InputIter2 first2, InputIter2 last2,
-                          OutputIter result) {
+// set_difference_dispatch 的 input_iterator_tag 版本
+template <class InputIter1, class InputIter2, class OutputIter, class Compared>
+OutputIter set_difference_dispatch(InputIter1 first1, InputIter1 last1,
+                                   InputIter2 first2, InputIter2 last2,
+                                   OutputIter result, Compared comp,
+                                   input_iterator_tag, input_iterator_tag) {
   while (first1 != last1 && first2 != last2) {
-    if (*first1 < *first2) { // s1 有但是 s2 没有，放进 result 里
+    if (comp(*first1, *first2)) { // s1 有但是 s2 没有，放进 result 里
       *result = *first1;
       ++first1;
       ++result;
-    } else if (*first2 < *first1) { // s2 有但是 s1 没有，s2 继续看下一个
+    } else if (comp(*first2, *first1)) { // s2 有但是 s1 没有，s2 继续看下一个
       ++first2;
     } else { // 相等，继续看双方下一个
       ++first1;
@@ -124,24 +227,52 @@ OutputIter set_difference(InputIter1 first1, InputIter1 last1,
   return yastl::copy(first1, last1, result); // 把 s1 剩下的放入 result
 }
 
+// set_difference_dispatch 的 random_access_iterator_tag 版本
+template <class RandomIter1, class RandomIter2, class OutputIter, class Compared>
+OutputIter set_difference_dispatch(RandomIter1 first1, RandomIter1 last1,
+                                   RandomIter2 first2, RandomIter2 last2,
+                                   OutputIter result, Compared comp,
+                                   random_access_iterator_tag, random_access_iterator_tag) {
+  if (set_use_gallop(last1 - first1, last2 - first2)) {
+    for (; first1 != last1 && first2 != last2; ++first1) {
+      first2 = yastl::gallop_lower_bound(first2, last2, *first1, comp);
+      if (first2 != last2 && !comp(*first1, *first2)) { // s2 中有相同元素，抵消
+        ++first2;
+      } else {
+        *result = *first1;
+        ++result;
+      }
+    }
+  } else if (set_use_gallop(last2 - first2, last1 - first1)) {
+    for (; first1 != last1 && first2 != last2; ++first2) {
+      // s1 中小于 *first2 的部分整段放入
+      RandomIter1 pos = yastl::gallop_lower_bound(first1, last1, *first2, comp);
+      result = yastl::copy(first1, pos, result);
+      first1 = pos;
+      if (first1 != last1 && !comp(*first2, *first1)) {
+        ++first1;
+      }
+    }
+  }
+  return yastl::set_difference_dispatch(first1, last1, first2, last2, result, comp,
+                                        input_iterator_tag(), input_iterator_tag());
+}
+
+template <class InputIter1, class InputIter2, class OutputIter>
+OutputIter set_difference(InputIter1 first1, InputIter1 last1,
+                          InputIter2 first2, InputIter2 last2,
+                          OutputIter result) {
+  return yastl::set_difference_dispatch(first1, last1, first2, last2, result, set_less(),
+                                        iterator_category(first1), iterator_category(first2));
+}
+
 // 重载版本使用函数对象 comp 代替比较操作
 template <class InputIter1, class InputIter2, class OutputIter, class Compared>
 OutputIter set_difference(InputIter1 first1, InputIter1 last1,
-                          InputIter2 first2, InputIter2 last2, 
+                          InputIter2 first2, InputIter2 last2,
                           OutputIter result, Compared comp) {
-  while (first1 != last1 && first2 != last2) {
-    if (comp(*first1, *first2)) {
-      *result = *first1;
-      ++first1;
-      ++result;
-    } else if (comp(*first2, *first1)) {
-      ++first2;
-    } else {
-      ++first1;
-      ++first2;
-    }
-  }
-  return yastl::copy(first1, last1, result);
+  return yastl::set_difference_dispatch(first1, last1, first2, last2, result, comp,
+                                        iterator_category(first1), iterator_category(first2));
 }
 
 /*****************************************************************************************/
@@ -0,0 +1,533 @@
+﻿#ifndef _INCLUDE_SIMD_H_
+#define _INCLUDE_SIMD_H_
+
+// 这个头文件包含了连续区间上算术类型的 SIMD 内核：find、find_last、count、minmax、mismatch、search、set_intersection，
+// 以及 hash.h 中长字节序列哈希使用的 hash_stripes
+// algo.h / algobase.h 中的 find、count、min/max_element、minmax_element、equal、mismatch、
+// lexicographical_compare 在迭代器是指针、元素是算术类型时分派到这里，search 只用于单字节整数，
+// set_algo.h 中的 set_intersection 只用于 4 / 8 字节整数
+
+// notes:
+//
+// 内核用 GCC 的向量扩展写成，按向量宽度实例化为 SSE2（16 字节）、AVX2（32 字节）、AVX-512BW（64 字节）三个版本，
+// 每个版本是带 target 属性的函数，运行时用 CPUID 选择，编译时已经打开的指令集（如 -mavx2）不再检查
+// 掩码转换直接调用编译器内建函数而不是 <immintrin.h> 中的包装，否则 always_inline 的内核无法内联进带 target 的函数
+// 目前只在 x86-64 的 GCC 上启用，其他平台、编译器或定义了 YASTL_NO_SIMD 时 YASTL_HAS_SIMD 为 0，全部走串行版本
+// 浮点数的比较语义与串行版本一致：-0.0 == 0.0，NaN 与任何值都不相等，minmax 遇到 NaN 时返回 false 由调用者退化
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "type_traits.h"
+
+#if !defined(YASTL_NO_SIMD) && defined(__GNUC__) && !defined(__clang__) && \
+    defined(__x86_64__) && (__GNUC__ >= 6)
+#define YASTL_HAS_SIMD 1
+#else
+#define YASTL_HAS_SIMD 0
+#endif
+
+#if YASTL_HAS_SIMD
+#include <immintrin.h>  // 声明各指令集的内建函数
+#endif
+
+namespace yastl {
+
+// 能否使用 SIMD 内核：除 bool 与 long double 之外、大小为 1/2/4/8 字节的算术类型
+template <class T>
+struct simd_supported
+  : m_bool_constant<YASTL_HAS_SIMD && std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                    (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)> {};
+
+// 迭代器是指向 U 的指针，U 与 T（去掉 const）相同并且可以使用 SIMD
+template <class Iter, class T>
+struct simd_contiguous : m_false_type {};
+
+template <class U, class T>
+struct simd_contiguous<U*, T>
+  : m_bool_constant<std::is_same<typename std::remove_cv<U>::type, typename std::remove_cv<T>::type>::value &&
+                    simd_supported<typename std::remove_cv<U>::type>::value> {};
+
+// 两个迭代器都是指针，元素类型相同并且可以使用 SIMD
+template <class Iter1, class Iter2>
+struct simd_contiguous_pair : m_false_type {};
+
+template <class U1, class U2>
+struct simd_contiguous_pair<U1*, U2*> : simd_contiguous<U1*, U2> {};
+
+#if YASTL_HAS_SIMD
+
+/*****************************************************************************************/
+// 指令集选择
+/*****************************************************************************************/
+enum simd_isa_level {
+  simd_level_sse2 = 0,
+  simd_level_avx2 = 1,
+  simd_level_avx512 = 2
+};
+
+inline int simd_detect_level() noexcept {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+    return simd_level_avx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return simd_level_avx2;
+  }
+  return simd_level_sse2;
+}
+
+// 编译时已经打开的指令集直接使用，否则第一次调用时检测一次
+inline int simd_level() noexcept {
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+  return simd_level_avx512;
+#else
+  static const int level = simd_detect_level();
+  return level;
+#endif
+}
+
+/*****************************************************************************************/
+// 各指令集的向量宽度与掩码转换
+/*****************************************************************************************/
+typedef char simd_bytes16 __attribute__((vector_size(16)));
+typedef char simd_bytes32 __attribute__((vector_size(32)));
+typedef char simd_bytes64 __attribute__((vector_size(64)));
+typedef int simd_ints16 __attribute__((vector_size(16)));
+typedef int simd_ints32 __attribute__((vector_size(32)));
+typedef int simd_ints64 __attribute__((vector_size(64)));
+typedef long long simd_int64s64 __attribute__((vector_size(64)));
+
+// 把比较结果转换为每个字节一位的掩码，mul_u32 把每个 64 位元素的低 32 位相乘得到 64 位乘积写入 out
+// mul_u32 只会内联进带 target 属性的入口函数，内建函数返回宽向量时的 ABI 警告可以忽略
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+struct simd_sse2 {
+  static constexpr size_t width = 16;
+  template <class M>
+  __attribute__((always_inline)) static inline uint64_t movemask(const M& m) {
+    return static_cast<uint32_t>(__builtin_ia32_pmovmskb128(reinterpret_cast<simd_bytes16>(m)));
+  }
+  template <class V>
+  __attribute__((always_inline)) static inline void mul_u32(V& out, const V& a, const V& b) {
+    out = reinterpret_cast<V>(__builtin_ia32_pmuludq128(reinterpret_cast<simd_ints16>(a),
+                                                        reinterpret_cast<simd_ints16>(b)));
+  }
+};
+
+struct simd_avx2 {
+  static constexpr size_t width = 32;
+  template <class M>
+  __attribute__((always_inline)) static inline uint64_t movemask(const M& m) {
+    return static_cast<uint32_t>(__builtin_ia32_pmovmskb256(reinterpret_cast<simd_bytes32>(m)));
+  }
+  template <class V>
+  __attribute__((always_inline)) static inline void mul_u32(V& out, const V& a, const V& b) {
+    out = reinterpret_cast<V>(__builtin_ia32_pmuludq256(reinterpret_cast<simd_ints32>(a),
+                                                        reinterpret_cast<simd_ints32>(b)));
+  }
+};
+
+struct simd_avx512 {
+  static constexpr size_t width = 64;
+  template <class M>
+  __attribute__((always_inline)) static inline uint64_t movemask(const M& m) {
+    return __builtin_ia32_cvtb2mask512(reinterpret_cast<simd_bytes64>(m));
+  }
+  template <class V>
+  __attribute__((always_inline)) static inline void mul_u32(V& out, const V& a, const V& b) {
+    out = reinterpret_cast<V>(__builtin_ia32_pmuludq512_mask(reinterpret_cast<simd_ints64>(a),
+                                                             reinterpret_cast<simd_ints64>(b),
+                                                             simd_int64s64{}, static_cast<unsigned char>(-1)));
+  }
+};
+#pragma GCC diagnostic pop
+
+template <class T, size_t Width>
+struct simd_vector {
+  typedef T type __attribute__((vector_size(Width)));
+};
+
+// 向量通过引用传出，避免在没有打开 AVX 的上下文中按值传递宽向量
+template <class V>
+__attribute__((always_inline)) inline void simd_load(V& v, const void* p) {
+  __builtin_memcpy(&v, p, sizeof(V));
+}
+
+template <class V, class T>
+__attribute__((always_inline)) inline void simd_broadcast(V& v, T value) {
+  for (size_t i = 0; i < sizeof(V) / sizeof(T); ++i) {
+    v[i] = value;
+  }
+}
+
+/*****************************************************************************************/
+// 内核，只在带 target 属性的入口函数中实例化
+/*****************************************************************************************/
+
+// 第一个等于 value 的元素，没有则返回 last
+template <class Isa, class T>
+__attribute__((always_inline)) inline const T* simd_find_kernel(const T* first, const T* last, T value) {
+  typedef typename simd_vector<T, Isa::width>::type V;
+  const size_t lanes = Isa::width / sizeof(T);
+  V v;
+  simd_broadcast(v, value);
+  V x;
+  for (; static_cast<size_t>(last - first) >= lanes; first += lanes) {
+    simd_load(x, first);
+    const uint64_t mask = Isa::movemask(x == v);
+    if (mask != 0) {
+      return first + __builtin_ctzll(mask) / sizeof(T);
+    }
+  }
+  for (; first != last; ++first) {
+    if (*first == value) {
+      return first;
+    }
+  }
+  return last;
+}
+
+// 最后一个等于 value 的元素，没有则返回 last
+template <class Isa, class T>
+__attribute__((always_inline)) inline const T* simd_find_last_kernel(const T* first, const T* last, T value) {
+  typedef typename simd_vector<T, Isa::width>::type V;
+  const size_t lanes = Isa::width / sizeof(T);
+  V v;
+  simd_broadcast(v, value);
+  V x;
+  const T* cur = last;
+  for (; static_cast<size_t>(cur - first) >= lanes; cur -= lanes) {
+    simd_load(x, cur - lanes);
+    const uint64_t mask = Isa::movemask(x == v);
+    if (mask != 0) {
+      return cur - lanes + (63 - __builtin_clzll(mask)) / sizeof(T);
+    }
+  }
+  while (cur != first) {
+    if (*--cur == value) {
+      return cur;
+    }
+  }
+  return last;
+}
+
+// 等于 value 的元素个数
+template <class Isa, class T>
+__attribute__((always_inline)) inline size_t simd_count_kernel(const T* first, const T* last, T value) {
+  typedef typename simd_vector<T, Isa::width>::type V;
+  const size_t lanes = Isa::width / sizeof(T);
+  V v;
+  simd_broadcast(v, value);
+  V x;
+  size_t bits = 0;
+  for (; static_cast<size_t>(last - first) >= lanes; first += lanes) {
+    simd_load(x, first);
+    bits += __builtin_popcountll(Isa::movemask(x == v));
+  }
+  size_t n = bits / sizeof(T);
+  for (; first != last; ++first) {
+    n += *first == value ? 1 : 0;
+  }
+  return n;
+}
+
+// 非空区间的最小值与最大值，存在 NaN 时返回 false
+template <class Isa, class T>
+__attribute__((always_inline)) inline bool simd_minmax_kernel(const T* first, const T* last, T* min_out, T* max_out) {
+  typedef typename simd_vector<T, Isa::width>::type V;
+  const size_t lanes = Isa::width / sizeof(T);
+  T lo = *first;
+  T hi = *first;
+  bool nan = false;
+  if (static_cast<size_t>(last - first) >= lanes) {
+    V vlo;
+    simd_load(vlo, first);
+    V vhi = vlo;
+    auto bad = vlo != vlo;
+    for (first += lanes; static_cast<size_t>(last - first) >= lanes; first += lanes) {
+      V x;
+      simd_load(x, first);
+      vlo = x < vlo ? x : vlo;
+      vhi = vhi < x ? x : vhi;
+      bad |= x != x;
+    }
+    for (size_t i = 0; i < lanes; ++i) {
+      lo = vlo[i] < lo ? vlo[i] : lo;
+      hi = hi < vhi[i] ? vhi[i] : hi;
+      nan |= bad[i] != 0;
+    }
+  }
+  for (; first != last; ++first) {
+    const T x = *first;
+    lo = x < lo ? x : lo;
+    hi = hi < x ? x : hi;
+    nan |= x != x;
+  }
+  *min_out = lo;
+  *max_out = hi;
+  return !nan;
+}
+
+// 第一处 *first1 != *first2 的下标，没有则返回 last1 - first1
+template <class Isa, class T>
+__attribute__((always_inline)) inline size_t simd_mismatch_kernel(const T* first1, const T* last1, const T* first2) {
+  typedef typename simd_vector<T, Isa::width>::type V;
+  const size_t lanes = Isa::width / sizeof(T);
+  const size_t n = static_cast<size_t>(last1 - first1);
+  V x;
+  V y;
+  size_t i = 0;
+  for (; n - i >= lanes; i += lanes) {
+    simd_load(x, first1 + i);
+    simd_load(y, first2 + i);
+    const uint64_t mask = Isa::movemask(x != y);
+    if (mask != 0) {
+      return i + __builtin_ctzll(mask) / sizeof(T);
+    }
+  }
+  for (; i < n; ++i) {
+    if (first1[i] != first2[i]) {
+      return i;
+    }
+  }
+  return n;
+}
+
+// 在 [first1, last1) 中查找 [first2, last2) 第一次出现的位置，没有则返回 last1，要求 2 <= 模式长度 <= 文本长度
+// 一次比较一个向量宽度的候选位置：首字节与末字节都相同的位置才用 memcmp 比较中间部分
+template <class Isa, class T>
+__attribute__((always_inline)) inline const T* simd_search_kernel(const T* first1, const T* last1,
+                                                                 const T* first2, const T* last2) {
+  typedef typename simd_vector<T, Isa::width>::type V;
+  const size_t n = static_cast<size_t>(last1 - first1);
+  const size_t m = static_cast<size_t>(last2 - first2);
+  V head;
+  V tail;
+  simd_broadcast(head, first2[0]);
+  simd_broadcast(tail, first2[m - 1]);
+  V x;
+  V y;
+  size_t i = 0;
+  for (; i + m - 1 + Isa::width <= n; i += Isa::width) {
+    simd_load(x, first1 + i);
+    simd_load(y, first1 + i + m - 1);
+    uint64_t mask = Isa::movemask(x == head) & Isa::movemask(y == tail);
+    while (mask != 0) {
+      const size_t k = i + __builtin_ctzll(mask);
+      if (__builtin_memcmp(first1 + k + 1, first2 + 1, m - 2) == 0) {
+        return first1 + k;
+      }
+      mask &= mask - 1;
+    }
+  }
+  for (; i + m <= n; ++i) {
+    if (first1[i] == first2[0] && __builtin_memcmp(first1 + i + 1, first2 + 1, m - 1) == 0) {
+      return first1 + i;
+    }
+  }
+  return last1;
+}
+
+// 两个有序区间的交集写入 result，返回输出的尾部，*stop1 / *stop2 为两个区间处理到的位置，剩余部分由调用者串行处理
+// 每次取两个区间各一个向量宽度的块，把块2 的每个元素广播后与块1 比较，块1 中命中的元素按顺序输出，再前进末元素较小的块
+// 只在元素严格递增时正确：每次比较前检查块内以及块尾与下一个元素是否相等，有重复元素就停下
+template <class Isa, class T>
+__attribute__((always_inline)) inline T* simd_set_intersection_kernel(const T* first1, const T* last1,
+                                                                     const T* first2, const T* last2, T* result,
+                                                                     const T** stop1, const T** stop2) {
+  typedef typename simd_vector<T, Isa::width>::type V;
+  const size_t lanes = Isa::width / sizeof(T);
+  const uint64_t lane_bits = ~0ULL / ((1ULL << sizeof(T)) - 1);  // 每个元素只保留最低位
+  V a;
+  V b;
+  V a_next;
+  V b_next;
+  while (static_cast<size_t>(last1 - first1) > lanes && static_cast<size_t>(last2 - first2) > lanes) {
+    simd_load(a, first1);
+    simd_load(a_next, first1 + 1);
+    simd_load(b, first2);
+    simd_load(b_next, first2 + 1);
+    if ((Isa::movemask(a == a_next) | Isa::movemask(b == b_next)) != 0) {
+      break;
+    }
+    uint64_t mask = 0;
+    for (size_t k = 0; k < lanes; ++k) {
+      V x;
+      simd_broadcast(x, first2[k]);
+      mask |= Isa::movemask(a == x);
+    }
+    for (mask &= lane_bits; mask != 0; mask &= mask - 1) {
+      *result++ = first1[__builtin_ctzll(mask) / sizeof(T)];
+    }
+    const T max1 = first1[lanes - 1];
+    const T max2 = first2[lanes - 1];
+    if (!(max2 < max1)) {
+      first1 += lanes;
+    }
+    if (!(max1 < max2)) {
+      first2 += lanes;
+    }
+  }
+  *stop1 = first1;
+  *stop2 = first2;
+  return result;
+}
+
+// 把 stripes 个 64 字节的条带累加到 8 个 64 位累加器 acc 中，第 s 个条带使用密钥 secret[s, s + 8)
+// 每个 64 位字 d 与密钥异或得到 dk，acc[i] += lo32(dk) * hi32(dk)，同时把 d 加到相邻的累加器 acc[i ^ 1]
+// 各指令集版本与串行版本的结果完全相同
+template <class Isa, class T>
+__attribute__((always_inline)) inline void simd_hash_stripes_kernel(T* acc, const unsigned char* p,
+                                                                   size_t stripes, const T* secret) {
+  typedef typename simd_vector<T, Isa::width>::type V;
+  const size_t lanes = Isa::width / sizeof(T);
+  const size_t count = 64 / Isa::width;  // 每个条带的向量个数
+  V a[count];
+  for (size_t i = 0; i < count; ++i) {
+    simd_load(a[i], acc + i * lanes);
+  }
+  V swap_pair;
+  for (size_t j = 0; j < lanes; ++j) {
+    swap_pair[j] = j ^ 1;
+  }
+  for (size_t s = 0; s < stripes; ++s, p += 64) {
+    for (size_t i = 0; i < count; ++i) {
+      V d;
+      V k;
+      simd_load(d, p + i * Isa::width);
+      simd_load(k, secret + s + i * lanes);
+      const V dk = d ^ k;
+      V prod;
+      Isa::mul_u32(prod, dk, dk >> 32);
+      a[i] += prod;
+      a[i] += __builtin_shuffle(d, swap_pair);
+    }
+  }
+  for (size_t i = 0; i < count; ++i) {
+    __builtin_memcpy(acc + i * lanes, &a[i], sizeof(V));
+  }
+}
+
+/*****************************************************************************************/
+// 入口函数：每个内核生成三个指令集版本，按 simd_level() 分派
+/*****************************************************************************************/
+#define YASTL_SIMD_ENTRY(name, ret, params, args)                                              \
+  template <class T>                                                                          \
+  __attribute__((target("avx512f,avx512bw,popcnt"))) ret name##_avx512 params {               \
+    return name##_kernel<simd_avx512> args;                                                   \
+  }                                                                                           \
+  template <class T>                                                                          \
+  __attribute__((target("avx2,popcnt"))) ret name##_avx2 params {                             \
+    return name##_kernel<simd_avx2> args;                                                     \
+  }                                                                                           \
+  template <class T>                                                                          \
+  ret name##_sse2 params {                                                                    \
+    return name##_kernel<simd_sse2> args;                                                     \
+  }                                                                                           \
+  template <class T>                                                                          \
+  ret name params {                                                                           \
+    switch (simd_level()) {                                                                   \
+      case simd_level_avx512: return name##_avx512 args;                                      \
+      case simd_level_avx2: return name##_avx2 args;                                          \
+      default: return name##_sse2 args;                                                       \
+    }                                                                                         \
+  }
+
+YASTL_SIMD_ENTRY(simd_find, const T*, (const T* first, const T* last, T value), (first, last, value))
+YASTL_SIMD_ENTRY(simd_find_last, const T*, (const T* first, const T* last, T value), (first, last, value))
+YASTL_SIMD_ENTRY(simd_count, size_t, (const T* first, const T* last, T value), (first, last, value))
+YASTL_SIMD_ENTRY(simd_minmax, bool, (const T* first, const T* last, T* min_out, T* max_out),
+                 (first, last, min_out, max_out))
+YASTL_SIMD_ENTRY(simd_search, const T*, (const T* first1, const T* last1, const T* first2, const T* last2),
+                 (first1, last1, first2, last2))
+YASTL_SIMD_ENTRY(simd_mismatch, size_t, (const T* first1, const T* last1, const T* first2),
+                 (first1, last1, first2))
+YASTL_SIMD_ENTRY(simd_set_intersection, T*,
+                 (const T* first1, const T* last1, const T* first2, const T* last2, T* result,
+                  const T** stop1, const T** stop2),
+                 (first1, last1, first2, last2, result, stop1, stop2))
+YASTL_SIMD_ENTRY(simd_hash_stripes, void, (T* acc, const unsigned char* p, size_t stripes, const T* secret),
+                 (acc, p, stripes, secret))
+
+#undef YASTL_SIMD_ENTRY
+
+#else // !YASTL_HAS_SIMD
+
+// 没有 SIMD 时 simd_contiguous 恒为 false，这些函数不会被调用，只为让分派代码能够编译
+template <class T>
+const T* simd_find(const T* first, const T* last, T value) {
+  for (; first != last && !(*first == value); ++first) {}
+  return first;
+}
+
+template <class T>
+const T* simd_find_last(const T* first, const T* last, T value) {
+  for (const T* cur = last; cur != first; ) {
+    if (*--cur == value) {
+      return cur;
+    }
+  }
+  return last;
+}
+
+template <class T>
+size_t simd_count(const T* first, const T* last, T value) {
+  size_t n = 0;
+  for (; first != last; ++first) {
+    n += *first == value ? 1 : 0;
+  }
+  return n;
+}
+
+template <class T>
+bool simd_minmax(const T*, const T*, T*, T*) {
+  return false;
+}
+
+template <class T>
+const T* simd_search(const T* first1, const T* last1, const T* first2, const T* last2) {
+  const size_t m = static_cast<size_t>(last2 - first2);
+  for (const T* cur = first1; static_cast<size_t>(last1 - cur) >= m; ++cur) {
+    if (std::memcmp(cur, first2, m) == 0) {
+      return cur;
+    }
+  }
+  return last1;
+}
+
+template <class T>
+size_t simd_mismatch(const T* first1, const T* last1, const T* first2) {
+  size_t i = 0;
+  for (; first1 + i != last1 && first1[i] == first2[i]; ++i) {}
+  return i;
+}
+
+template <class T>
+T* simd_set_intersection(const T* first1, const T*, const T* first2, const T*, T* result,
+                         const T** stop1, const T** stop2) {
+  *stop1 = first1;
+  *stop2 = first2;
+  return result;
+}
+
+// 与 SIMD 版本的结果相同
+template <class T>
+void simd_hash_stripes(T* acc, const unsigned char* p, size_t stripes, const T* secret) {
+  for (size_t s = 0; s < stripes; ++s, p += 64) {
+    for (size_t i = 0; i < 8; ++i) {
+      T d;
+      std::memcpy(&d, p + i * 8, sizeof(T));
+      const T dk = d ^ secret[s + i];
+      acc[i] += (dk & 0xffffffffu) * (dk >> 32);
+      acc[i ^ 1] += d;
+    }
+  }
+}
+
+#endif // YASTL_HAS_SIMD
+
+} // namespace yastl
+#endif // _INCLUDE_SIMD_H_
@@ -0,0 +1,271 @@
+﻿#ifndef _INCLUDE_THREAD_POOL_H_
+#define _INCLUDE_THREAD_POOL_H_
+
+// 这个头文件包含了两个类 thread_pool 和 task_group
+// thread_pool : 工作窃取（work-stealing）线程池
+// task_group  : 一组提交到线程池的任务，可以等待它们全部完成
+
+// notes:
+//
+// 每个工作线程有自己的任务队列：自己从尾部取（后进先出，缓存友好），其他线程从头部偷（先进先出，偷到的是大任务）
+// 工作线程内部提交的任务放入自己的队列，外部线程提交的任务放入一个公共队列
+// task_group::wait 在等待期间会帮忙执行任务，所以任务里可以再分出子任务并等待，不会因为线程耗尽而死锁
+// 任务抛出的第一个异常会在 task_group::wait 中重新抛出，直接用 submit 提交的任务不能抛出异常
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <exception>
+
+#include "deque.h"
+#include "concurrent_queue.h"
+
+namespace yastl {
+
+class thread_pool {
+public:
+  typedef std::function<void()> task_type;
+  typedef size_t size_type;
+
+private:
+  // 一个任务队列，各占一个缓存行
+  struct task_queue {
+    std::mutex lock;
+    yastl::deque<task_type> tasks;
+    char pad[YASTL_CACHE_LINE_SIZE];
+  };
+
+  // 当前线程所属的线程池和队列编号
+  struct worker_slot {
+    thread_pool* pool;
+    size_type index;
+  };
+
+  size_type thread_count_;
+  std::thread* threads_;
+  task_queue* queues_;             // 前 thread_count_ 个属于工作线程，最后一个是公共队列
+  std::atomic<size_type> queued_;  // 尚未被取走的任务个数
+  std::atomic<bool> stop_;
+  atomic_waiter wake_;
+
+public:
+  // 构造、析构函数
+
+  // n 为 0 时使用硬件线程数
+  explicit thread_pool(size_type n = 0) : thread_count_(n), threads_(nullptr), queues_(nullptr), queued_(0), stop_(false) {
+    if (thread_count_ == 0) {
+      thread_count_ = static_cast<size_type>(std::thread::hardware_concurrency());
+    }
+    if (thread_count_ == 0) {
+      thread_count_ = 1;
+    }
+    queues_ = new task_queue[thread_count_ + 1];
+    threads_ = new std::thread[thread_count_];
+    for (size_type i = 0; i < thread_count_; ++i) {
+      threads_[i] = std::thread(&thread_pool::worker_loop, this, i);
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  // 等待所有工作线程退出，尚未执行的任务被丢弃
+  ~thread_pool() {
+    stop_.store(true);
+    wake_.notify_all();
+    for (size_type i = 0; i < thread_count_; ++i) {
+      threads_[i].join();
+    }
+    delete[] threads_;
+    delete[] queues_;
+  }
+
+  size_type size() const noexcept {
+    return thread_count_;
+  }
+
+  // 进程内共享的线程池，第一次使用时创建
+  static thread_pool& default_pool() {
+    static thread_pool pool;
+    return pool;
+  }
+
+  // 提交一个任务
+  void submit(task_type task) {
+    worker_slot& self = current();
+    task_queue& q = self.pool == this ? queues_[self.index] : queues_[thread_count_];
+    {
+      std::lock_guard<std::mutex> guard(q.lock);
+      q.tasks.push_back(yastl::move(task));
+    }
+    queued_.fetch_add(1);
+    wake_.notify_one();
+  }
+
+  // 取出并执行一个任务，没有任务时返回 false
+  bool try_run_one() {
+    task_type task;
+    if (!take(task)) {
+      return false;
+    }
+    task();
+    return true;
+  }
+
+private:
+  // helper functions
+
+  static worker_slot& current() noexcept {
+    static thread_local worker_slot slot = {nullptr, 0};
+    return slot;
+  }
+
+  static bool pop_back(task_queue& q, task_type& out) {
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.tasks.empty()) {
+      return false;
+    }
+    out = yastl::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+  }
+
+  static bool pop_front(task_queue& q, task_type& out) {
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.tasks.empty()) {
+      return false;
+    }
+    out = yastl::move(q.tasks.front());
+    q.tasks.pop_front();
+    return true;
+  }
+
+  // 依次尝试自己的队列、公共队列、其他线程的队列
+  bool take(task_type& out) {
+    if (queued_.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+    worker_slot& self = current();
+    const bool own = self.pool == this;
+    if ((own && pop_back(queues_[self.index], out)) || pop_front(queues_[thread_count_], out)) {
+      queued_.fetch_sub(1);
+      return true;
+    }
+    const size_type start = own ? self.index + 1 : static_cast<size_type>(concurrent_random() % thread_count_);
+    for (size_type k = 0; k < thread_count_; ++k) {
+      const size_type victim = (start + k) % thread_count_;
+      if (own && victim == self.index) {
+        continue;
+      }
+      if (pop_front(queues_[victim], out)) {
+        queued_.fetch_sub(1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void worker_loop(size_type index) {
+    worker_slot& self = current();
+    self.pool = this;
+    self.index = index;
+    while (!stop_.load()) {
+      if (try_run_one()) {
+        continue;
+      }
+      const uint32_t epoch = wake_.prepare_wait();
+      if (stop_.load() || queued_.load() != 0) {
+        wake_.cancel_wait();
+        continue;
+      }
+      wake_.wait(epoch);
+    }
+  }
+};
+
+/*****************************************************************************************/
+// task_group
+
+class task_group {
+private:
+  thread_pool& pool_;
+  std::atomic<size_t> pending_;
+  std::atomic<size_t> finishing_;  // 正在收尾（可能还会访问本对象）的任务个数
+  std::mutex error_lock_;
+  std::exception_ptr error_;
+  atomic_waiter done_;
+
+public:
+  explicit task_group(thread_pool& pool = thread_pool::default_pool()) : pool_(pool), pending_(0), finishing_(0) {}
+
+  task_group(const task_group&) = delete;
+  task_group& operator=(const task_group&) = delete;
+
+  ~task_group() {
+    wait_all();
+  }
+
+  thread_pool& pool() noexcept {
+    return pool_;
+  }
+
+  // 提交一个任务，f 需要可以拷贝
+  template <class Func>
+  void run(Func f) {
+    pending_.fetch_add(1);
+    try {
+      pool_.submit([this, f]() {
+        try {
+          f();
+        } catch (...) {
+          std::lock_guard<std::mutex> guard(error_lock_);
+          if (!error_) {
+            error_ = std::current_exception();
+          }
+        }
+        finishing_.fetch_add(1);
+        if (pending_.fetch_sub(1) == 1) {
+          done_.notify_all();
+        }
+        finishing_.fetch_sub(1, std::memory_order_release);
+      });
+    } catch (...) {
+      pending_.fetch_sub(1);
+      throw;
+    }
+  }
+
+  // 等待所有任务完成，期间帮忙执行线程池中的任务，有任务抛出异常时重新抛出第一个
+  void wait() {
+    wait_all();
+    if (error_) {
+      std::exception_ptr e = error_;
+      error_ = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+
+private:
+  void wait_all() noexcept {
+    while (pending_.load() != 0) {
+      if (pool_.try_run_one()) {
+        continue;
+      }
+      const uint32_t epoch = done_.prepare_wait();
+      if (pending_.load() == 0) {
+        done_.cancel_wait();
+        break;
+      }
+      // 剩下的任务都在其他线程上执行，新的子任务会由执行它的线程自己处理
+      done_.wait(epoch);
+    }
+    // 最后一个任务可能还在调用 notify_all，等它离开之后本对象才能析构
+    while (finishing_.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+  }
+};
+
+} // namespace yastl
+#endif // _INCLUDE_THREAD_POOL_H_
@@ -0,0 +1,364 @@
+﻿#ifndef _INCLUDE_TIMER_WHEEL_H_
+#define _INCLUDE_TIMER_WHEEL_H_
+
+// 这个头文件包含了一个模板类 timer_wheel
+// timer_wheel : 分层时间轮，插入、取消定时器都是 O(1)
+
+// notes:
+//
+// 时间以整数 tick 表示，共 TIMER_WHEEL_LEVELS 层，每层 2^TIMER_WHEEL_BITS 个槽
+// 第 0 层的一个槽对应一个 tick，第 l 层的一个槽对应 2^(l * TIMER_WHEEL_BITS) 个 tick，
+// 时间走到上层槽的边界时，把那个槽里的定时器重新分配到下层（cascade）
+// 超出最高层范围的定时器先放在最高层最远的槽里，cascade 时重新计算位置
+//
+// 每个定时器是节点池中的一个节点，槽里是以节点下标串起来的双向链表
+// schedule 返回 timer_handle，节点回收后代数加一，所以对已经触发或取消的句柄调用 cancel 是安全的
+// timer_wheel 本身不是线程安全的，多线程使用时由调用者加锁，或者每个线程各用一个
+
+#include <cstdint>
+
+#include "deque.h"
+#include "util.h"
+#include "exceptdef.h"
+
+namespace yastl {
+
+#ifndef TIMER_WHEEL_BITS
+#define TIMER_WHEEL_BITS 6
+#endif
+
+#ifndef TIMER_WHEEL_LEVELS
+#define TIMER_WHEEL_LEVELS 4
+#endif
+
+// 定时器句柄
+struct timer_handle {
+  uint32_t index;
+  uint32_t generation;
+
+  timer_handle() noexcept : index(UINT32_MAX), generation(0) {}
+  timer_handle(uint32_t i, uint32_t g) noexcept : index(i), generation(g) {}
+
+  bool valid() const noexcept {
+    return index != UINT32_MAX;
+  }
+};
+
+// 模板类 timer_wheel
+// 模板参数代表定时器携带的数据类型
+template <class T>
+class timer_wheel {
+public:
+  typedef T value_type;
+  typedef size_t size_type;
+  typedef uint64_t tick_type;
+
+  static constexpr uint32_t slot_bits = TIMER_WHEEL_BITS;
+  static constexpr uint32_t slot_count = 1u << TIMER_WHEEL_BITS;
+  static constexpr uint32_t slot_mask = slot_count - 1;
+  static constexpr uint32_t level_count = TIMER_WHEEL_LEVELS;
+
+private:
+  static constexpr uint32_t nil = UINT32_MAX;
+
+  // 定时器节点
+  struct timer_node {
+    tick_type expire;
+    uint32_t prev;
+    uint32_t next;
+    uint32_t slot;        // 所在槽的编号，空闲时为 nil
+    uint32_t generation;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+    timer_node() noexcept : expire(0), prev(nil), next(nil), slot(nil), generation(0) {}
+
+    T* value() noexcept {
+      return reinterpret_cast<T*>(&storage);
+    }
+  };
+
+  // 槽中链表的头尾
+  struct slot_list {
+    uint32_t head;
+    uint32_t tail;
+  };
+
+  yastl::deque<timer_node> nodes_;                 // 节点池，deque 尾部插入不会移动已有节点
+  uint32_t free_;                                  // 空闲节点链表
+  slot_list slots_[level_count * slot_count];      // 各层的槽
+  size_type level_size_[level_count];              // 各层的定时器个数
+  tick_type now_;                                  // 下一个要处理的 tick
+  size_type size_;                                 // 等待中的定时器个数
+
+public:
+  // 构造、析构函数
+
+  explicit timer_wheel(tick_type start = 0) : free_(nil), now_(start), size_(0) {
+    for (uint32_t i = 0; i < level_count * slot_count; ++i) {
+      slots_[i].head = slots_[i].tail = nil;
+    }
+    for (uint32_t l = 0; l < level_count; ++l) {
+      level_size_[l] = 0;
+    }
+  }
+
+  timer_wheel(const timer_wheel&) = delete;
+  timer_wheel& operator=(const timer_wheel&) = delete;
+
+  ~timer_wheel() {
+    clear();
+  }
+
+  // 容量相关操作
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+  size_type size() const noexcept {
+    return size_;
+  }
+  // 下一个要处理的 tick，早于它的定时器都已触发
+  tick_type now() const noexcept {
+    return now_;
+  }
+
+  // 在 expire 时刻触发，expire 早于 now() 时在下一次 advance 中触发
+  timer_handle schedule(tick_type expire, const value_type& value) {
+    return emplace_at(expire, value);
+  }
+  timer_handle schedule(tick_type expire, value_type&& value) {
+    return emplace_at(expire, yastl::move(value));
+  }
+  timer_handle schedule_after(tick_type delay, const value_type& value) {
+    return emplace_at(now_ + delay, value);
+  }
+  timer_handle schedule_after(tick_type delay, value_type&& value) {
+    return emplace_at(now_ + delay, yastl::move(value));
+  }
+  template <class ...Args>
+  timer_handle emplace_at(tick_type expire, Args&& ...args);
+
+  // 取消定时器，句柄已经触发或取消时返回 false
+  bool cancel(timer_handle h);
+
+  // 处理 [now(), to] 中的每个 tick，对每个到期的定时器调用 f(value)，返回触发的个数
+  template <class Func>
+  size_type advance(tick_type to, Func f);
+
+  void clear();
+
+private:
+  // helper functions
+
+  uint32_t allocate_node();
+  void release_node(uint32_t i);
+  void link(uint32_t i);
+  void unlink(uint32_t i);
+  void cascade(uint32_t level);
+};
+
+template <class T>
+constexpr uint32_t timer_wheel<T>::slot_bits;
+template <class T>
+constexpr uint32_t timer_wheel<T>::slot_count;
+template <class T>
+constexpr uint32_t timer_wheel<T>::slot_mask;
+template <class T>
+constexpr uint32_t timer_wheel<T>::level_count;
+template <class T>
+constexpr uint32_t timer_wheel<T>::nil;
+
+/*****************************************************************************************/
+
+template <class T>
+template <class ...Args>
+timer_handle timer_wheel<T>::emplace_at(tick_type expire, Args&& ...args) {
+  const uint32_t i = allocate_node();
+  timer_node& node = nodes_[i];
+  try {
+    yastl::construct(node.value(), yastl::forward<Args>(args)...);
+  } catch (...) {
+    node.next = free_;
+    free_ = i;
+    throw;
+  }
+  node.expire = expire;
+  link(i);
+  ++size_;
+  return timer_handle(i, node.generation);
+}
+
+template <class T>
+bool timer_wheel<T>::cancel(timer_handle h) {
+  if (!h.valid() || h.index >= nodes_.size()) {
+    return false;
+  }
+  timer_node& node = nodes_[h.index];
+  if (node.generation != h.generation || node.slot == nil) {
+    return false;
+  }
+  unlink(h.index);
+  yastl::destroy(node.value());
+  release_node(h.index);
+  --size_;
+  return true;
+}
+
+template <class T>
+template <class Func>
+typename timer_wheel<T>::size_type timer_wheel<T>::advance(tick_type to, Func f) {
+  size_type fired = 0;
+  while (now_ <= to) {
+    if (size_ == 0) {
+      // 没有定时器时直接跳到终点
+      now_ = to + 1;
+      break;
+    }
+    // 低层都为空时，下一次有事可做是在最低的非空层的槽边界上，直接跳过去
+    uint32_t low = 0;
+    while (level_size_[low] == 0) {
+      ++low;
+    }
+    if (low > 0) {
+      const tick_type step = tick_type(1) << (low * slot_bits);
+      const tick_type next = (now_ | (step - 1)) + 1;
+      if ((now_ & (step - 1)) != 0) {
+        if (next > to) {
+          now_ = to + 1;
+          break;
+        }
+        now_ = next;
+      }
+    }
+    // 走到上层槽的边界时，从高到低把对应的槽分配到下层
+    if ((now_ & slot_mask) == 0) {
+      uint32_t top = 1;
+      while (top + 1 < level_count && ((now_ >> (top * slot_bits)) & slot_mask) == 0) {
+        ++top;
+      }
+      for (uint32_t level = top; level >= 1; --level) {
+        cascade(level);
+      }
+    }
+    // 触发第 0 层当前槽中的定时器，回调中新加入的已到期定时器也会在这个 tick 触发
+    slot_list& list = slots_[now_ & slot_mask];
+    while (list.head != nil) {
+      const uint32_t i = list.head;
+      timer_node& node = nodes_[i];
+      unlink(i);
+      value_type value(yastl::move(*node.value()));
+      yastl::destroy(node.value());
+      release_node(i);
+      --size_;
+      ++fired;
+      f(value);
+    }
+    ++now_;
+  }
+  return fired;
+}
+
+template <class T>
+void timer_wheel<T>::clear() {
+  for (uint32_t s = 0; s < level_count * slot_count; ++s) {
+    while (slots_[s].head != nil) {
+      const uint32_t i = slots_[s].head;
+      unlink(i);
+      yastl::destroy(nodes_[i].value());
+      release_node(i);
+    }
+  }
+  size_ = 0;
+}
+
+/*****************************************************************************************/
+// helper function
+
+template <class T>
+uint32_t timer_wheel<T>::allocate_node() {
+  if (free_ != nil) {
+    const uint32_t i = free_;
+    free_ = nodes_[i].next;
+    return i;
+  }
+  THROW_LENGTH_ERROR_IF(nodes_.size() >= nil, "timer_wheel<T> has too many timers");
+  nodes_.emplace_back();
+  return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+// 回收节点，代数加一使旧句柄失效
+template <class T>
+void timer_wheel<T>::release_node(uint32_t i) {
+  timer_node& node = nodes_[i];
+  ++node.generation;
+  node.slot = nil;
+  node.prev = nil;
+  node.next = free_;
+  free_ = i;
+}
+
+// 按到期时间与 now_ 的距离选择层和槽，挂到槽的尾部
+template <class T>
+void timer_wheel<T>::link(uint32_t i) {
+  timer_node& node = nodes_[i];
+  tick_type expire = node.expire < now_ ? now_ : node.expire;
+  const tick_type delta = expire - now_;
+  uint32_t level = 0;
+  while (level + 1 < level_count && delta >= (tick_type(1) << ((level + 1) * slot_bits))) {
+    ++level;
+  }
+  if (level + 1 == level_count) {
+    const tick_type horizon = (tick_type(1) << (level_count * slot_bits)) - 1;
+    if (delta > horizon) {
+      expire = now_ + horizon;
+    }
+  }
+  const uint32_t s = level * slot_count + static_cast<uint32_t>((expire >> (level * slot_bits)) & slot_mask);
+  slot_list& list = slots_[s];
+  ++level_size_[level];
+  node.slot = s;
+  node.prev = list.tail;
+  node.next = nil;
+  if (list.tail == nil) {
+    list.head = i;
+  } else {
+    nodes_[list.tail].next = i;
+  }
+  list.tail = i;
+}
+
+template <class T>
+void timer_wheel<T>::unlink(uint32_t i) {
+  timer_node& node = nodes_[i];
+  slot_list& list = slots_[node.slot];
+  --level_size_[node.slot / slot_count];
+  if (node.prev == nil) {
+    list.head = node.next;
+  } else {
+    nodes_[node.prev].next = node.next;
+  }
+  if (node.next == nil) {
+    list.tail = node.prev;
+  } else {
+    nodes_[node.next].prev = node.prev;
+  }
+  node.prev = node.next = nil;
+}
+
+// 把第 level 层当前的槽整个摘下，按新的距离重新挂到下层
+template <class T>
+void timer_wheel<T>::cascade(uint32_t level) {
+  slot_list& list = slots_[level * slot_count + ((now_ >> (level * slot_bits)) & slot_mask)];
+  uint32_t i = list.head;
+  list.head = list.tail = nil;
+  for (uint32_t j = i; j != nil; j = nodes_[j].next) {
+    --level_size_[level];
+  }
+  while (i != nil) {
+    const uint32_t next = nodes_[i].next;
+    link(i);
+    i = next;
+  }
+}
+
+} // namespace yastl
+#endif // _INCLUDE_TIMER_WHEEL_H_
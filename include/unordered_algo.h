@@ -0,0 +1,216 @@
+﻿#ifndef _INCLUDE_UNORDERED_ALGO_H_
+#define _INCLUDE_UNORDERED_ALGO_H_
+
+// 这个头文件包含基于哈希计数的 is_permutation 以及无序区间的集合算法:
+// unordered_set_union, unordered_set_intersection, unordered_set_difference, unordered_set_symmetric_difference
+
+// notes:
+//
+// 这些函数不要求序列有序，用 Hash / KeyEqual 把一个区间的元素计数到 unordered_map 中，期望时间复杂度为 O(n + m)
+// 重复元素按多重集合处理，与 set_algo.h 一致：交集保留 min(c1, c2) 个，并集保留 max(c1, c2) 个，差集保留 c1 - c2 个
+// 输出顺序：先按 [first1, last1) 中出现的顺序，再按 [first2, last2) 中出现的顺序
+
+#include "algo.h"
+#include "functional.h"
+#include "unordered_map.h"
+
+namespace yastl {
+
+/*****************************************************************************************/
+// 计数表：以 [first, last) 中的元素为键，出现次数为值
+/*****************************************************************************************/
+template <class T, class Hash, class KeyEqual>
+using unordered_count_table = yastl::unordered_map<T, size_t, Hash, KeyEqual>;
+
+template <class ForwardIter, class Hash, class KeyEqual>
+void unordered_count(ForwardIter first, ForwardIter last,
+                     unordered_count_table<typename iterator_traits<ForwardIter>::value_type, Hash, KeyEqual>& table) {
+  for (; first != last; ++first) {
+    ++table[*first];
+  }
+}
+
+// 在表中把 value 的计数减一，value 不在表中或计数已经为 0 时返回 false
+template <class T, class Hash, class KeyEqual>
+bool unordered_take(unordered_count_table<T, Hash, KeyEqual>& table, const T& value) {
+  auto it = table.find(value);
+  if (it == table.end() || it->second == 0) {
+    return false;
+  }
+  --it->second;
+  return true;
+}
+
+/*****************************************************************************************/
+// is_permutation
+// 重载版本使用哈希函数 hf 与 pred 计数，期望 O(n) 判断 [first1,last1) 是否为 [first2, last2) 的排列组合
+/*****************************************************************************************/
+template <class ForwardIter1, class ForwardIter2, class Hash, class BinaryPred>
+bool is_permutation(ForwardIter1 first1, ForwardIter1 last1,
+                    ForwardIter2 first2, ForwardIter2 last2,
+                    Hash hf, BinaryPred pred) {
+  typedef typename iterator_traits<ForwardIter1>::value_type v1;
+  typedef typename iterator_traits<ForwardIter2>::value_type v2;
+  static_assert(std::is_same<v1, v2>::value, "the type should be same in yastl::is_permutation");
+
+  // 先跳过相同的前缀段
+  for (; first1 != last1 && first2 != last2; ++first1, (void) ++first2) {
+    if (!pred(*first1, *first2)) {
+      break;
+    }
+  }
+  auto len1 = yastl::distance(first1, last1);
+  auto len2 = yastl::distance(first2, last2);
+  if (len1 != len2) {
+    return false;
+  }
+  if (len1 == 0) {
+    return true;
+  }
+
+  unordered_count_table<v1, Hash, BinaryPred> table(static_cast<size_t>(len1), hf, pred);
+  unordered_count(first1, last1, table);
+  // 长度相等，区间2 的每个元素都能在表中抵消掉时两者互为排列
+  for (; first2 != last2; ++first2) {
+    if (!unordered_take(table, *first2)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*****************************************************************************************/
+// unordered_set_union
+// 计算 S1∪S2 的结果并保存到 result 中，返回一个迭代器指向输出结果的尾部
+/*****************************************************************************************/
+template <class InputIter1, class ForwardIter2, class OutputIter, class Hash, class KeyEqual>
+OutputIter unordered_set_union(InputIter1 first1, InputIter1 last1,
+                               ForwardIter2 first2, ForwardIter2 last2,
+                               OutputIter result, Hash hf, KeyEqual eq) {
+  typedef typename iterator_traits<ForwardIter2>::value_type value_type;
+  unordered_count_table<value_type, Hash, KeyEqual> table(
+    static_cast<size_t>(yastl::distance(first2, last2)), hf, eq);
+  unordered_count(first2, last2, table);
+  // 集合1 的元素全部放入，同时抵消集合2 中相同的元素
+  for (; first1 != last1; ++first1) {
+    unordered_take(table, *first1);
+    *result = *first1;
+    ++result;
+  }
+  // 放入集合2 中没有被抵消的元素
+  for (; first2 != last2; ++first2) {
+    if (unordered_take(table, *first2)) {
+      *result = *first2;
+      ++result;
+    }
+  }
+  return result;
+}
+
+template <class InputIter1, class ForwardIter2, class OutputIter>
+OutputIter unordered_set_union(InputIter1 first1, InputIter1 last1,
+                               ForwardIter2 first2, ForwardIter2 last2,
+                               OutputIter result) {
+  typedef typename iterator_traits<ForwardIter2>::value_type value_type;
+  return yastl::unordered_set_union(first1, last1, first2, last2, result,
+                                    yastl::hash<value_type>(), yastl::equal_to<value_type>());
+}
+
+/*****************************************************************************************/
+// unordered_set_intersection
+// 计算 S1∩S2 的结果并保存到 result 中，返回一个迭代器指向输出结果的尾部
+/*****************************************************************************************/
+template <class InputIter1, class ForwardIter2, class OutputIter, class Hash, class KeyEqual>
+OutputIter unordered_set_intersection(InputIter1 first1, InputIter1 last1,
+                                      ForwardIter2 first2, ForwardIter2 last2,
+                                      OutputIter result, Hash hf, KeyEqual eq) {
+  typedef typename iterator_traits<ForwardIter2>::value_type value_type;
+  unordered_count_table<value_type, Hash, KeyEqual> table(
+    static_cast<size_t>(yastl::distance(first2, last2)), hf, eq);
+  unordered_count(first2, last2, table);
+  for (; first1 != last1; ++first1) {
+    if (unordered_take(table, *first1)) { // 集合2 中还有相同的元素
+      *result = *first1;
+      ++result;
+    }
+  }
+  return result;
+}
+
+template <class InputIter1, class ForwardIter2, class OutputIter>
+OutputIter unordered_set_intersection(InputIter1 first1, InputIter1 last1,
+                                      ForwardIter2 first2, ForwardIter2 last2,
+                                      OutputIter result) {
+  typedef typename iterator_traits<ForwardIter2>::value_type value_type;
+  return yastl::unordered_set_intersection(first1, last1, first2, last2, result,
+                                           yastl::hash<value_type>(), yastl::equal_to<value_type>());
+}
+
+/*****************************************************************************************/
+// unordered_set_difference
+// 计算 S1-S2 的结果并保存到 result 中，返回一个迭代器指向输出结果的尾部
+/*****************************************************************************************/
+template <class InputIter1, class ForwardIter2, class OutputIter, class Hash, class KeyEqual>
+OutputIter unordered_set_difference(InputIter1 first1, InputIter1 last1,
+                                    ForwardIter2 first2, ForwardIter2 last2,
+                                    OutputIter result, Hash hf, KeyEqual eq) {
+  typedef typename iterator_traits<ForwardIter2>::value_type value_type;
+  unordered_count_table<value_type, Hash, KeyEqual> table(
+    static_cast<size_t>(yastl::distance(first2, last2)), hf, eq);
+  unordered_count(first2, last2, table);
+  for (; first1 != last1; ++first1) {
+    if (!unordered_take(table, *first1)) { // 集合2 中的相同元素已经抵消完
+      *result = *first1;
+      ++result;
+    }
+  }
+  return result;
+}
+
+template <class InputIter1, class ForwardIter2, class OutputIter>
+OutputIter unordered_set_difference(InputIter1 first1, InputIter1 last1,
+                                    ForwardIter2 first2, ForwardIter2 last2,
+                                    OutputIter result) {
+  typedef typename iterator_traits<ForwardIter2>::value_type value_type;
+  return yastl::unordered_set_difference(first1, last1, first2, last2, result,
+                                         yastl::hash<value_type>(), yastl::equal_to<value_type>());
+}
+
+/*****************************************************************************************/
+// unordered_set_symmetric_difference
+// 计算 (S1-S2)∪(S2-S1) 的结果并保存到 result 中，返回一个迭代器指向输出结果的尾部
+/*****************************************************************************************/
+template <class InputIter1, class ForwardIter2, class OutputIter, class Hash, class KeyEqual>
+OutputIter unordered_set_symmetric_difference(InputIter1 first1, InputIter1 last1,
+                                              ForwardIter2 first2, ForwardIter2 last2,
+                                              OutputIter result, Hash hf, KeyEqual eq) {
+  typedef typename iterator_traits<ForwardIter2>::value_type value_type;
+  unordered_count_table<value_type, Hash, KeyEqual> table(
+    static_cast<size_t>(yastl::distance(first2, last2)), hf, eq);
+  unordered_count(first2, last2, table);
+  for (; first1 != last1; ++first1) {
+    if (!unordered_take(table, *first1)) {
+      *result = *first1;
+      ++result;
+    }
+  }
+  for (; first2 != last2; ++first2) {
+    if (unordered_take(table, *first2)) {
+      *result = *first2;
+      ++result;
+    }
+  }
+  return result;
+}
+
+template <class InputIter1, class ForwardIter2, class OutputIter>
+OutputIter unordered_set_symmetric_difference(InputIter1 first1, InputIter1 last1,
+                                              ForwardIter2 first2, ForwardIter2 last2,
+                                              OutputIter result) {
+  typedef typename iterator_traits<ForwardIter2>::value_type value_type;
+  return yastl::unordered_set_symmetric_difference(first1, last1, first2, last2, result,
+                                                   yastl::hash<value_type>(), yastl::equal_to<value_type>());
+}
+
+} // namespace yastl
+#endif // _INCLUDE_UNORDERED_ALGO_H_
@@ -55,7 +55,7 @@ public:
 public:
   // 构造、复制、移动、析构函数
 
-  unordered_map() : ht_(100, Hash(), KeyEqual()) {}
+  unordered_map() : ht_(0, Hash(), KeyEqual()) {}
 
   explicit unordered_map(size_type bucket_count,
                          const Hash& hash = Hash(),
@@ -161,14 +161,14 @@ public:
     return ht_.insert_unique(value);
   }
   pair<iterator, bool> insert(value_type&& value) {
-    return ht_.emplace_unique(yastl::move(value));
+    return ht_.insert_unique(yastl::move(value));
   }
 
   iterator insert(const_iterator hint, const value_type& value) {
     return ht_.insert_unique_use_hint(hint, value);
   }
   iterator insert(const_iterator hint, value_type&& value) {
-    return ht_.emplace_unique_use_hint(hint, yastl::move(value));
+    return ht_.insert_unique_use_hint(hint, yastl::move(value));
   }
 
   template <class InputIterator>
@@ -176,6 +176,51 @@ public:
     ht_.insert_unique(first, last);
   }
 
+  // try_emplace / insert_or_assign
+  // 先按 key 查找，key 不存在时才申请节点并用 args 构造实值，key 已存在时不会申请节点，args 也不会被移动
+  template <class ...Args>
+  pair<iterator, bool> try_emplace(const key_type& key, Args&& ...args) {
+    return ht_.try_emplace_unique(key, yastl::forward<Args>(args)...);
+  }
+  template <class ...Args>
+  pair<iterator, bool> try_emplace(key_type&& key, Args&& ...args) {
+    return ht_.try_emplace_unique(yastl::move(key), yastl::forward<Args>(args)...);
+  }
+  template <class ...Args>
+  iterator try_emplace(const_iterator /*hint*/, const key_type& key, Args&& ...args) {
+    return ht_.try_emplace_unique(key, yastl::forward<Args>(args)...).first;
+  }
+  template <class ...Args>
+  iterator try_emplace(const_iterator /*hint*/, key_type&& key, Args&& ...args) {
+    return ht_.try_emplace_unique(yastl::move(key), yastl::forward<Args>(args)...).first;
+  }
+
+  // key 已存在时把 obj 赋值给它的实值，否则插入，返回值的 bool 表示是否插入了新元素
+  template <class M>
+  pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj) {
+    auto res = ht_.try_emplace_unique(key, yastl::forward<M>(obj));
+    if (!res.second) {
+      res.first->second = yastl::forward<M>(obj);
+    }
+    return res;
+  }
+  template <class M>
+  pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj) {
+    auto res = ht_.try_emplace_unique(yastl::move(key), yastl::forward<M>(obj));
+    if (!res.second) {
+      res.first->second = yastl::forward<M>(obj);
+    }
+    return res;
+  }
+  template <class M>
+  iterator insert_or_assign(const_iterator /*hint*/, const key_type& key, M&& obj) {
+    return insert_or_assign(key, yastl::forward<M>(obj)).first;
+  }
+  template <class M>
+  iterator insert_or_assign(const_iterator /*hint*/, key_type&& key, M&& obj) {
+    return insert_or_assign(yastl::move(key), yastl::forward<M>(obj)).first;
+  }
+
   // erase / clear
 
   void erase(iterator it) {
@@ -210,20 +255,12 @@ public:
     return it->second;
   }
 
-  // 构造一个空的 返回 insert 成功与否
+  // key 不存在时插入一个值初始化的实值，只计算一次哈希、查找一次
   mapped_type& operator[](const key_type& key) {
-    iterator it = ht_.find(key);
-    if (it.node == nullptr) {
-      it = ht_.emplace_unique(key, T{}).first;
-    }
-    return it->second;
+    return ht_.try_emplace_unique(key).first->second;
   }
   mapped_type& operator[](key_type&& key) {
-    iterator it = ht_.find(key);
-    if (it.node == nullptr) {
-      it = ht_.emplace_unique(yastl::move(key), T{}).first;
-    }
-    return it->second;
+    return ht_.try_emplace_unique(yastl::move(key)).first->second;
   }
 
   size_type count(const key_type& key) const {
@@ -377,7 +414,7 @@ public:
 public:
   // 构造、复制、移动函数
 
-  unordered_multimap() : ht_(100, Hash(), KeyEqual()) {}
+  unordered_multimap() : ht_(0, Hash(), KeyEqual()) {}
 
   explicit unordered_multimap(size_type bucket_count,
                               const Hash& hash = Hash(),
@@ -53,7 +53,7 @@ public:
 public:
   // 构造、复制、移动函数
   // 默认大小100个
-  unordered_set() : ht_(100, Hash(), KeyEqual()) {}
+  unordered_set() : ht_(0, Hash(), KeyEqual()) {}
 
   explicit unordered_set(size_type bucket_count, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
     : ht_(bucket_count, hash, equal) {}
@@ -157,14 +157,14 @@ public:
   }
   // move insert
   pair<iterator, bool> insert(value_type&& value) {
-    return ht_.emplace_unique(yastl::move(value));
+    return ht_.insert_unique(yastl::move(value));
   }
 
   iterator insert(const_iterator hint, const value_type& value) {
     return ht_.insert_unique_use_hint(hint, value);
   }
   iterator insert(const_iterator hint, value_type&& value) {
-    return ht_.emplace_unique_use_hint(hint, yastl::move(value));
+    return ht_.insert_unique_use_hint(hint, yastl::move(value));
   }
 
   template <class InputIterator>
@@ -345,7 +345,7 @@ public:
 public:
   // 构造、复制、移动函数
 
-  unordered_multiset() : ht_(100, Hash(), KeyEqual()) {}
+  unordered_multiset() : ht_(0, Hash(), KeyEqual()) {}
 
   explicit unordered_multiset(size_type bucket_count,
                               const Hash& hash = Hash(),
@@ -0,0 +1,215 @@
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include "algo.h"
+#include "radix_algo.h"
+#include "searcher.h"
+#include "set_algo.h"
+#include "unordered_algo.h"
+#include "vector.h"
+#include "list.h"
+#include "functional.h"
+
+struct record {
+    unsigned key;
+    int id;
+};
+int main()
+{
+    // 随机、已排序、逆序、大量重复以及部分有序的输入
+    const int n = 100000;
+    yastl::vector<int> inputs[5];
+    for (int i = 0; i < n; ++i) {
+        inputs[0].push_back(rand());
+        inputs[1].push_back(i);
+        inputs[2].push_back(n - i);
+        inputs[3].push_back(rand() % 4);
+        inputs[4].push_back(i % 64 == 0 ? rand() : i);
+    }
+    for (int k = 0; k < 5; ++k) {
+        yastl::vector<int> a(inputs[k]);
+        yastl::vector<int> b(inputs[k]);
+        yastl::sort(a.begin(), a.end());
+        yastl::sort(b.begin(), b.end(), yastl::greater<int>());
+        yastl::reverse(b.begin(), b.end());
+        std::cout << yastl::is_sorted(a.begin(), a.end()) << (a == b) << " ";
+    }
+    std::cout << std::endl;
+
+    // 基数排序：有符号整数、浮点数、pair、按字段排序的结构体以及字符串
+    yastl::vector<long long> ll;
+    yastl::vector<double> d;
+    yastl::vector<yastl::pair<int, unsigned short>> pr;
+    yastl::vector<record> rec;
+    yastl::vector<std::string> str;
+    for (int i = 0; i < n; ++i) {
+        ll.push_back((static_cast<long long>(rand()) << 20) - rand());
+        d.push_back((rand() - RAND_MAX / 2) / 7.0);
+        pr.push_back(yastl::make_pair(rand() % 100 - 50, static_cast<unsigned short>(rand())));
+        rec.push_back(record{static_cast<unsigned>(rand() % 1000), i});
+        str.push_back(std::string(rand() % 8, 'a' + rand() % 3) + std::to_string(rand() % 1000));
+    }
+    yastl::vector<long long> ll2(ll);
+    yastl::vector<double> d2(d);
+    yastl::vector<yastl::pair<int, unsigned short>> pr2(pr);
+    yastl::vector<std::string> str2(str);
+    yastl::radix_sort(ll.begin(), ll.end());
+    yastl::sort(ll2.begin(), ll2.end());
+    yastl::radix_sort(d.data(), d.data() + d.size());
+    yastl::sort(d2.begin(), d2.end());
+    yastl::radix_sort(pr.begin(), pr.end());
+    yastl::sort(pr2.begin(), pr2.end());
+    yastl::radix_sort(str.begin(), str.end());
+    yastl::sort(str2.begin(), str2.end());
+    yastl::radix_sort_by_key(rec.begin(), rec.end(), [](const record& r) { return r.key; });
+    bool stable = true;
+    for (int i = 1; i < n; ++i) {
+        if (rec[i - 1].key > rec[i].key || (rec[i - 1].key == rec[i].key && rec[i - 1].id > rec[i].id)) {
+            stable = false;
+        }
+    }
+    std::cout << (ll == ll2) << (d == d2) << (pr == pr2) << stable << (str == str2) << std::endl;
+
+    // 稳定排序与稳定分割：按 key 排序或分割后，key 相同的记录保持 id 的顺序
+    for (int k = 0; k < 5; ++k) {
+        yastl::vector<record> r;
+        for (int i = 0; i < n; ++i) {
+            r.push_back(record{static_cast<unsigned>(inputs[k][i] % 1000), i});
+        }
+        yastl::vector<record> p(r);
+        yastl::stable_sort(r.begin(), r.end(), [](const record& x, const record& y) { return x.key < y.key; });
+        bool ok = true;
+        for (int i = 1; i < n; ++i) {
+            if (r[i - 1].key > r[i].key || (r[i - 1].key == r[i].key && r[i - 1].id > r[i].id)) {
+                ok = false;
+            }
+        }
+        auto mid = yastl::stable_partition(p.begin(), p.end(), [](const record& x) { return x.key % 2 == 0; });
+        bool part = true;
+        for (auto it = p.begin(); it != p.end(); ++it) {
+            if ((it < mid) != (it->key % 2 == 0) ||
+                (it + 1 != p.end() && it + 1 != mid && it->id > (it + 1)->id)) {
+                part = false;
+            }
+        }
+        std::cout << ok << part << " ";
+    }
+    std::cout << std::endl;
+
+    // 连续算术区间的 find、count、min/max_element、minmax_element、equal、mismatch、lexicographical_compare
+    yastl::vector<int> x(inputs[3]);
+    x[n / 3] = -1;
+    x[n / 2] = 9;
+    x[n - 2] = 9;
+    yastl::vector<int> y(x);
+    y[n - 10] = 5;
+    auto mm = yastl::minmax_element(x.begin(), x.end());
+    std::cout << (yastl::find(x.begin(), x.end(), 9) - x.begin() == n / 2)
+              << (yastl::count(x.begin(), x.end(), 9) == 2)
+              << (yastl::min_element(x.begin(), x.end()) - x.begin() == n / 3)
+              << (yastl::max_element(x.begin(), x.end()) - x.begin() == n / 2)
+              << (mm.first - x.begin() == n / 3) << (mm.second - x.begin() == n - 2)
+              << !yastl::equal(x.begin(), x.end(), y.begin())
+              << (yastl::mismatch(x.begin(), x.end(), y.begin()).first - x.begin() == n - 10)
+              << (yastl::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end()) == (x[n - 10] < 5));
+    double f[40];
+    for (int i = 0; i < 40; ++i) {
+        f[i] = i % 5 - 2.0;
+    }
+    f[7] = 0.0 / 0.0;
+    f[33] = -3.0;
+    std::cout << " " << (yastl::min_element(f, f + 40) - f) << " " << (yastl::max_element(f, f + 40) - f)
+              << " " << (yastl::count(f, f + 40, 2.0)) << std::endl;
+
+    // 子串查找：字节区间的快速路径、三种搜索器以及 find_first_of
+    std::string text;
+    for (int i = 0; i < 5000; ++i) {
+        text += static_cast<char>('a' + rand() % 4);
+    }
+    text += "abcdabcdx";
+    const char* t = text.data();
+    const char* t_end = t + text.size();
+    const char pat[] = "cdabcdx";
+    const char* p_end = pat + 7;
+    const char* pos = yastl::search(t, t_end, pat, p_end);
+    std::cout << (pos - t == static_cast<long>(text.size()) - 7)
+              << (yastl::search(t, t_end, yastl::default_searcher<const char*>(pat, p_end)) == pos)
+              << (yastl::search(t, t_end, yastl::boyer_moore_horspool_searcher<const char*>(pat, p_end)) == pos)
+              << (yastl::search(t, t_end, yastl::boyer_moore_searcher<const char*>(pat, p_end)) == pos)
+              << (yastl::search(t, t_end, pat, pat) == t)
+              << (*yastl::find_first_of(t, t_end, "xz", "xz" + 2) == 'x') << std::endl;
+
+    // 无序区间的 is_permutation 与集合算法，结果排序后与有序区间的集合算法比较
+    yastl::vector<int> u1, u2;
+    for (int i = 0; i < 1000; ++i) {
+        u1.push_back(rand() % 300);
+        u2.push_back(rand() % 300);
+    }
+    yastl::vector<int> s1(u1), s2(u2), shuffled(u1);
+    yastl::sort(s1.begin(), s1.end());
+    yastl::sort(s2.begin(), s2.end());
+    yastl::random_shuffle(shuffled.begin(), shuffled.end());
+    std::cout << yastl::is_permutation(u1.begin(), u1.end(), shuffled.begin(), shuffled.end(),
+                                       yastl::hash<int>(), yastl::equal_to<int>())
+              << !yastl::is_permutation(u1.begin(), u1.end(), u2.begin(), u2.end(),
+                                        yastl::hash<int>(), yastl::equal_to<int>());
+    for (int k = 0; k < 4; ++k) {
+        yastl::vector<int> r1(2000), r2(2000);
+        int* e1 = nullptr;
+        int* e2 = nullptr;
+        switch (k) {
+        case 0:
+            e1 = yastl::unordered_set_union(u1.begin(), u1.end(), u2.begin(), u2.end(), r1.begin());
+            e2 = yastl::set_union(s1.begin(), s1.end(), s2.begin(), s2.end(), r2.begin());
+            break;
+        case 1:
+            e1 = yastl::unordered_set_intersection(u1.begin(), u1.end(), u2.begin(), u2.end(), r1.begin());
+            e2 = yastl::set_intersection(s1.begin(), s1.end(), s2.begin(), s2.end(), r2.begin());
+            break;
+        case 2:
+            e1 = yastl::unordered_set_difference(u1.begin(), u1.end(), u2.begin(), u2.end(), r1.begin());
+            e2 = yastl::set_difference(s1.begin(), s1.end(), s2.begin(), s2.end(), r2.begin());
+            break;
+        default:
+            e1 = yastl::unordered_set_symmetric_difference(u1.begin(), u1.end(), u2.begin(), u2.end(), r1.begin());
+            e2 = yastl::set_symmetric_difference(s1.begin(), s1.end(), s2.begin(), s2.end(), r2.begin());
+            break;
+        }
+        yastl::sort(r1.begin(), e1);
+        std::cout << (e1 - r1.begin() == e2 - r2.begin() && yastl::equal(r1.begin(), e1, r2.begin()));
+    }
+    std::cout << std::endl;
+
+    // 有序区间的集合算法：长度相近（SIMD 分块比较）与长度悬殊（倍增查找）两种情况，与链表上的逐个合并比较
+    yastl::vector<int> big, small;
+    for (int i = 0; i < n; ++i) {
+        big.push_back(i * 3);
+        if (i % 2000 == 0) {
+            small.push_back(i * 3 + (i % 4000 == 0 ? 0 : 1));
+        }
+    }
+    yastl::list<int> big_list(big.begin(), big.end());
+    for (int k = 0; k < 2; ++k) {
+        const yastl::vector<int>& a = k == 0 ? big : small;
+        yastl::vector<int> b(big);
+        if (k == 0) {
+            b.erase(b.begin() + 100, b.begin() + 200);
+        }
+        yastl::list<int> a_list(a.begin(), a.end());
+        yastl::vector<int> r1(2 * n), r2(2 * n);
+        int* e1 = yastl::set_intersection(a.begin(), a.end(), b.begin(), b.end(), r1.begin());
+        int* e2 = yastl::set_intersection(a_list.begin(), a_list.end(), b.begin(), b.end(), r2.begin());
+        bool ok = (e1 - r1.begin() == e2 - r2.begin()) && yastl::equal(r1.begin(), e1, r2.begin());
+        e1 = yastl::set_union(small.begin(), small.end(), big.begin(), big.end(), r1.begin());
+        e2 = yastl::set_union(small.begin(), small.end(), big_list.begin(), big_list.end(), r2.begin());
+        ok = ok && (e1 - r1.begin() == e2 - r2.begin()) && yastl::equal(r1.begin(), e1, r2.begin());
+        e1 = yastl::set_difference(big.begin(), big.end(), small.begin(), small.end(), r1.begin());
+        e2 = yastl::set_difference(big_list.begin(), big_list.end(), small.begin(), small.end(), r2.begin());
+        ok = ok && (e1 - r1.begin() == e2 - r2.begin()) && yastl::equal(r1.begin(), e1, r2.begin());
+        std::cout << ok;
+    }
+    std::cout << yastl::includes(big.begin(), big.end(), big.begin() + 10, big.begin() + 20)
+              << !yastl::includes(big.begin(), big.end(), small.begin(), small.end()) << std::endl;
+
+    std::cout << "end!" << std::endl;
+}
@@ -0,0 +1,45 @@
+#include <iostream>
+#include <climits>
+#include "aggregate_map.h"
+#include "interval_map.h"
+#include "vector.h"
+// 用于 aggregate_map 的最小值聚合
+struct min_op {
+    int operator()(int a, int b) const { return a < b ? a : b; }
+};
+
+int main()
+{
+    yastl::aggregate_map<int, int> sum;
+    yastl::aggregate_map<int, int, min_op> low;
+    for (int i = 0; i < 100; ++i) {
+        sum.assign(i, i);
+        low.assign(i, 100 - i);
+    }
+    sum.assign(10, 1000);
+    sum.erase(20);
+    // [10, 30) 的和为 10..29 的和，10 被覆盖为 1000，20 被删除
+    std::cout << sum.accumulate(10, 30, 0) << " " << sum.accumulate(0) << " "
+              << low.accumulate(0, 50, INT_MAX) << " " << low.accumulate(60, 60, INT_MAX) << std::endl;
+
+    yastl::interval_map<int, int> windows;
+    windows.insert(0, 10, 1);
+    windows.insert(5, 15, 2);
+    windows.insert(8, 9, 3);
+    windows.insert(20, 30, 4);
+    yastl::vector<int> hits;
+    yastl::vector<yastl::interval_map<int, int>::const_iterator> found(4);
+    auto last = windows.find_containing(8, found.begin());
+    for (auto it = found.begin(); it != last; ++it) {
+        hits.push_back((*it)->second);
+    }
+    last = windows.find_overlapping(12, 21, found.begin());
+    for (auto it = found.begin(); it != last; ++it) {
+        hits.push_back((*it)->second);
+    }
+    for (auto h : hits) {
+        std::cout << h;
+    }
+    std::cout << " " << (windows.find_containing(15, found.begin()) == found.begin()) << std::endl;
+    std::cout << "end!" << std::endl;
+}
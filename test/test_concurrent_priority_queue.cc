@@ -0,0 +1,36 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "concurrent_priority_queue.h"
+int main()
+{
+    // 多个线程放入期限，一个调度线程按近似的先后顺序取出
+    yastl::concurrent_priority_queue<int, yastl::greater<int>> pq(8);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([&pq, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                pq.push(i * 4 + t);
+            }
+        });
+    }
+    for (auto& th : producers) {
+        th.join();
+    }
+    std::cout << pq.size() << std::endl;
+
+    long long sum = 0;
+    int count = 0;
+    int first = -1;
+    int v;
+    while (pq.try_pop(v)) {
+        if (first < 0) {
+            first = v;
+        }
+        sum += v;
+        ++count;
+    }
+    std::cout << count << " " << sum << " " << (first < 100) << " " << pq.empty() << std::endl;
+
+    std::cout << "end!" << std::endl;
+}
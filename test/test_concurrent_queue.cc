@@ -0,0 +1,65 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "concurrent_queue.h"
+int main()
+{
+    // 单生产者单消费者，批量入队出队
+    yastl::spsc_queue<int> sq(64);
+    long long spsc_sum = 0;
+    std::thread producer([&sq]() {
+        int batch[8];
+        for (int i = 0; i < 100000; i += 8) {
+            for (int k = 0; k < 8; ++k) {
+                batch[k] = i + k;
+            }
+            int done = 0;
+            while (done < 8) {
+                done += static_cast<int>(sq.push_n(batch + done, 8 - done));
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (int got = 0; got < 100000; ) {
+        int v;
+        if (sq.try_pop(v)) {
+            spsc_sum += v;
+            ++got;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    std::cout << spsc_sum << " " << sq.empty() << std::endl;
+
+    // 多生产者多消费者，使用阻塞的包装
+    yastl::blocking_queue<yastl::mpmc_queue<int>> mq(128);
+    std::vector<std::thread> threads;
+    std::vector<long long> sums(4, 0);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&mq, t]() {
+            for (int i = 0; i < 25000; ++i) {
+                mq.push(t * 25000 + i);
+            }
+        });
+    }
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&mq, &sums, t]() {
+            int buf[16];
+            int got = 0;
+            while (got < 25000) {
+                size_t n = mq.pop_n(buf, 25000 - got < 16 ? 25000 - got : 16);
+                for (size_t k = 0; k < n; ++k) {
+                    sums[t] += buf[k];
+                }
+                got += static_cast<int>(n);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    std::cout << sums[0] + sums[1] + sums[2] + sums[3] << " " << mq.size() << std::endl;
+
+    std::cout << "end!" << std::endl;
+}
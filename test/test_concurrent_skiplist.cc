@@ -0,0 +1,58 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "concurrent_skiplist.h"
+int main()
+{
+    // 多个线程交错插入，其中一半的键值随后被删除，遍历结果有序且不重复
+    yastl::concurrent_map<int, int> mp;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&mp, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                mp.try_emplace(i * 4 + t, i);
+                mp.insert({i * 4 + t, -1});
+            }
+            for (int i = 0; i < 10000; i += 2) {
+                mp.erase(i * 4 + t);
+            }
+        });
+    }
+    for (auto& th : workers) {
+        th.join();
+    }
+    int count = 0;
+    int prev = -1;
+    bool sorted = true;
+    for (auto& kv : mp) {
+        sorted = sorted && prev < kv.first && kv.second == kv.first / 4;
+        prev = kv.first;
+        ++count;
+    }
+    std::cout << mp.size() << " " << count << " " << sorted << std::endl;
+    std::cout << mp.lower_bound(8)->first << " " << mp.upper_bound(12)->first << " "
+              << mp.contains(16) << mp.contains(39999) << (mp.find(40000) == mp.end()) << std::endl;
+
+    // 查找与插入、删除并发
+    yastl::concurrent_set<std::string> st;
+    std::thread writer([&st]() {
+        for (int i = 0; i < 2000; ++i) {
+            st.emplace(std::to_string(i));
+            st.erase(std::to_string(i - 1000));
+        }
+    });
+    size_t seen = 0;
+    for (int i = 0; i < 100; ++i) {
+        for (auto it = st.begin(); it != st.end(); ++it) {
+            ++seen;
+        }
+    }
+    writer.join();
+    std::cout << st.size() << " " << *st.begin() << " " << (seen <= 100 * 2000) << std::endl;
+    st.clear();
+    st.insert("a");
+    std::cout << st.size() << *st.begin() << std::endl;
+
+    std::cout << "end!" << std::endl;
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include "deque.h"
+#include "algo.h"
 #include "iterator.h"
 #include "util.h"
 int main()
@@ -11,5 +12,45 @@ int main()
     dq.push_back(99);
     std::cout << dq[0] << " " << dq[9] << std::endl;
 
+    // 每个缓冲区 4 个元素，作为队列反复进出时复用腾空的缓冲区
+    yastl::deque<int, 4> fifo;
+    for (int i = 0; i < 1000; ++i) {
+        fifo.push_back(i);
+        if (fifo.size() > 10) {
+            fifo.pop_front();
+        }
+    }
+    std::cout << fifo.front() << " " << fifo.back() << " " << fifo.size() << std::endl;
+
+    // 跨越多个缓冲区的算法逐个缓冲区处理
+    yastl::deque<int, 4> seg;
+    for (int i = 0; i < 30; ++i) {
+        seg.push_back(i);
+    }
+    int buf[30];
+    yastl::copy(seg.begin() + 3, seg.end(), buf);
+    yastl::fill(seg.begin() + 1, seg.begin() + 10, -1);
+    auto pos = yastl::copy(buf, buf + 5, seg.begin() + 2);
+    int sum = 0;
+    yastl::for_each(seg.begin(), seg.end(), [&sum](int x) { sum += x; });
+    std::cout << buf[0] << buf[26] << " " << (pos - seg.begin()) << " " << sum << " "
+              << (yastl::find(seg.begin(), seg.end(), 20) - seg.begin()) << " "
+              << yastl::equal(seg.begin() + 2, seg.begin() + 7, buf) << std::endl;
+
+    // 批量进出，跨越多个缓冲区
+    yastl::deque<int, 4> bulk;
+    int src[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    bulk.append(src, 10);
+    bulk.prepend(src, 5);
+    bulk.emplace_back_n(3, 7);
+    int out[8];
+    auto popped = bulk.pop_front_n(8, out);
+    int consumed = 0;
+    bulk.consume_front(6, [&consumed](int* p, size_t len) {
+        for (size_t i = 0; i < len; ++i) consumed += p[i];
+    });
+    std::cout << popped << " " << out[0] << out[4] << out[7] << " " << consumed << " "
+              << bulk.size() << " " << bulk.front() << " " << bulk.back() << std::endl;
+
     std::cout << "end!" << std::endl;
 }
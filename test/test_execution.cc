@@ -0,0 +1,80 @@
+#include <iostream>
+#include <cstdlib>
+#include "execution.h"
+#include "vector.h"
+int main()
+{
+    const int n = 1000000;
+    yastl::vector<int> v(n);
+    srand(1);
+    for (int i = 0; i < n; ++i) {
+        v[i] = rand() % 1000000;
+    }
+
+    yastl::vector<int> a(v);
+    yastl::vector<int> b(v);
+    yastl::sort(yastl::execution::par, a.begin(), a.end());
+    yastl::sort(b.begin(), b.end());
+    std::cout << (a == b) << std::endl;
+
+    // 降序排序并与一段有序数据并行归并
+    yastl::vector<int> c(v);
+    yastl::sort(yastl::execution::par, c.begin(), c.end(), yastl::greater<int>());
+    std::cout << (c.front() == b.back()) << " " << (c.back() == b.front()) << std::endl;
+    yastl::vector<int> merged(2 * n);
+    yastl::merge(yastl::execution::par, a.begin(), a.end(), b.begin(), b.end(), merged.begin());
+    std::cout << yastl::is_sorted(merged.begin(), merged.end()) << std::endl;
+
+    // 稳定排序：按高位排序后，高位相同的元素保持原来的下标顺序
+    yastl::vector<long long> keyed(n);
+    for (int i = 0; i < n; ++i) {
+        keyed[i] = static_cast<long long>(v[i] / 1000) * n + i;
+    }
+    yastl::stable_sort(yastl::execution::par, keyed.begin(), keyed.end(),
+                       [n](long long x, long long y) { return x / n < y / n; });
+    std::cout << yastl::is_sorted(keyed.begin(), keyed.end()) << std::endl;
+
+    // 并行选择：p50 / p99 与排序结果相同，partial_sort 的前 1000 个元素与排序结果的前 1000 个相同
+    yastl::vector<int> e(v);
+    yastl::nth_element(yastl::execution::par, e.begin(), e.begin() + n / 2, e.end());
+    int p50 = e[n / 2];
+    yastl::nth_element(yastl::execution::par, e.begin(), e.begin() + n / 100 * 99, e.end());
+    std::cout << (p50 == b[n / 2]) << (e[n / 100 * 99] == b[n / 100 * 99]) << " ";
+    yastl::partial_sort(yastl::execution::par, e.begin(), e.begin() + 1000, e.end());
+    std::cout << yastl::equal(e.begin(), e.begin() + 1000, b.begin()) << std::endl;
+
+    yastl::vector<long long> squares(n);
+    yastl::transform(yastl::execution::par, v.begin(), v.end(), squares.begin(),
+                     [](int x) { return static_cast<long long>(x) * x; });
+    long long s1 = yastl::reduce(yastl::execution::par, squares.begin(), squares.end(), 0LL);
+    long long s2 = yastl::reduce(squares.begin(), squares.end(), 0LL);
+    std::cout << (s1 == s2) << std::endl;
+
+    size_t even = yastl::count_if(yastl::execution::par, v.begin(), v.end(), [](int x) { return x % 2 == 0; });
+    std::cout << (even == yastl::count_if(v.begin(), v.end(), [](int x) { return x % 2 == 0; })) << std::endl;
+
+    auto it = yastl::find_if(yastl::execution::par, a.begin(), a.end(), [](int x) { return x >= 500000; });
+    std::cout << (it == yastl::lower_bound(a.begin(), a.end(), 500000)) << std::endl;
+
+    yastl::vector<int> d(n);
+    yastl::copy(yastl::execution::par, v.begin(), v.end(), d.begin());
+    yastl::for_each(yastl::execution::par, d.begin(), d.end(), [](int& x) { x += 1; });
+    std::cout << (d[0] == v[0] + 1) << " " << (d[n - 1] == v[n - 1] + 1) << std::endl;
+
+    // k 路归并：把已排序的 a 按下标模 k 拆成 k 段有序序列，串行与并行归并的结果都应与 a 相同
+    const int k = 13;
+    yastl::vector<yastl::vector<int>> shards(k);
+    for (int i = 0; i < n; ++i) {
+        shards[i % k].push_back(a[i]);
+    }
+    yastl::vector<yastl::pair<int*, int*>> runs;
+    for (int i = 0; i < k; ++i) {
+        runs.push_back(yastl::make_pair(shards[i].begin(), shards[i].end()));
+    }
+    yastl::vector<int> fan_in(n), par_fan_in(n);
+    yastl::multiway_merge(runs.begin(), runs.end(), fan_in.begin());
+    yastl::multiway_merge(yastl::execution::par, runs.begin(), runs.end(), par_fan_in.begin());
+    std::cout << (fan_in == a) << (par_fan_in == a) << std::endl;
+
+    std::cout << "end!" << std::endl;
+}
@@ -1,9 +1,17 @@
 #include <iostream>
+#include <string>
 #include "hashtable.h"
 #include "unordered_map.h"
 #include "iterator.h"
 #include "functional.h"
 #include "util.h"
+// 种子为 0 时所有键值都落在同一个桶中，用来检查链表过长时 hashtable 会换种子
+struct weak_hash {
+    uint64_t seed = 0;
+    size_t operator()(int key) const { return seed == 0 ? 0 : yastl::hash_seeded(key, seed); }
+    void reseed(uint64_t s) { seed = s; }
+};
+
 int main()
 {
     yastl::hashtable<int, std::hash<int>, yastl::equal_to<int>> ht1(10, std::hash<int>(), yastl::equal_to<int>());
@@ -19,5 +27,47 @@ int main()
     ht2.insert_multi(5);
     yastl::unordered_map<int, int> mp;
     mp[3] = 4;
+    // try_emplace 遇到已有的 key 不修改实值，insert_or_assign 覆盖实值
+    std::cout << mp.try_emplace(3, 5).second << mp[3] << " ";
+    std::cout << mp.insert_or_assign(3, 6).second << mp[3] << " ";
+    std::cout << mp.insert_or_assign(7, 8).second << mp[7] << std::endl;
+
+    // 字符串键值：相同内容的哈希值相同，长输入走条带累加
+    yastl::unordered_map<std::string, int> words;
+    words["alpha"] = 1;
+    words[std::string(1000, 'x')] = 2;
+    std::cout << words["alpha"] << words[std::string(1000, 'x')] << words.size() << " ";
+    std::string a(300, 'y'), b(300, 'y');
+    b[299] = 'z';
+    std::cout << (yastl::hash<std::string>()(a) == yastl::hash<std::string>()(std::string(300, 'y')))
+              << (yastl::hash<std::string>()(a) != yastl::hash<std::string>()(b)) << " ";
+    size_t s1 = 0, s2 = 0;
+    yastl::hash_combine(s1, 1);
+    yastl::hash_combine(s1, 2);
+    yastl::hash_combine(s2, 2);
+    yastl::hash_combine(s2, 1);
+    std::cout << (s1 != s2) << (yastl::mixed_hash<int>()(1) != yastl::mixed_hash<int>()(2)) << std::endl;
+
+    yastl::unordered_map<int, int, weak_hash> hostile;
+    for (int i = 0; i < 10000; ++i) {
+        hostile[i] = i;
+    }
+    size_t longest = 0;
+    for (size_t i = 0; i < hostile.bucket_count(); ++i) {
+        longest = yastl::max(longest, hostile.bucket_size(i));
+    }
+    yastl::unordered_map<std::string, int, yastl::seeded_hash<std::string>> seeded;
+    seeded["key"] = 1;
+    std::cout << (longest <= yastl::kHtChainLimit) << (hostile[9999] == 9999) << seeded["key"] << std::endl;
+
+    // 默认构造的空表不分配桶，查找、复制、移动之后都能正常插入
+    yastl::unordered_map<int, int> lazy;
+    std::cout << lazy.bucket_count() << (lazy.find(1) == lazy.end()) << lazy.count(1) << lazy.erase(1) << " ";
+    yastl::unordered_map<int, int> lazy_copy(lazy);
+    yastl::unordered_map<int, int> lazy_move(yastl::move(lazy));
+    lazy[1] = 1;
+    lazy_copy[2] = 2;
+    lazy_move.insert({3, 3});
+    std::cout << (lazy.bucket_count() > 1) << lazy[1] << lazy_copy[2] << lazy_move[3] << std::endl;
     std::cout << "end!" << std::endl;
 }
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "persistent_map.h"
+#include "persistent_vector.h"
+int main()
+{
+    // 每次修改产生新版本，旧版本保持不变
+    yastl::persistent_map<int, std::string> v0{{1, "a"}, {3, "c"}};
+    auto v1 = v0.insert({2, "b"});
+    auto v2 = v1.set(1, "A").erase(3);
+    for (auto& kv : v1) {
+        std::cout << kv.first << kv.second << " ";
+    }
+    std::cout << "| ";
+    for (auto& kv : v2) {
+        std::cout << kv.first << kv.second << " ";
+    }
+    std::cout << "| " << v0.size() << v1.size() << v2.size() << v0.at(1) << v2.at(1)
+              << v1.lower_bound(2)->second << (v2.upper_bound(2) == v2.end()) << v2.count(3) << std::endl;
+
+    yastl::persistent_vector<int> p0;
+    for (int i = 0; i < 1000; ++i) {
+        p0 = p0.push_back(i);
+    }
+    auto p1 = p0.set(500, -1).pop_back();
+    long long sum = 0;
+    for (int x : p1) {
+        sum += x;
+    }
+    std::cout << p0.size() << " " << p1.size() << " " << p0[500] << " " << p1[500] << " " << sum << " "
+              << p1.back() << " " << *(p1.end() - 2) << std::endl;
+
+    // 写线程在锁内发布新版本，读线程取出当前版本后不加锁地遍历
+    std::mutex lock;
+    yastl::persistent_map<int, int> current;
+    std::thread writer([&]() {
+        yastl::persistent_map<int, int> next;
+        for (int i = 0; i < 2000; ++i) {
+            next = next.set(i % 100, i);
+            std::lock_guard<std::mutex> guard(lock);
+            current = next;
+        }
+    });
+    bool ordered = true;
+    for (int i = 0; i < 200; ++i) {
+        yastl::persistent_map<int, int> snapshot;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            snapshot = current;
+        }
+        int prev = -1;
+        for (auto& kv : snapshot) {
+            ordered = ordered && prev < kv.first;
+            prev = kv.first;
+        }
+    }
+    writer.join();
+    std::cout << ordered << " " << current.size() << " " << current.at(99) << std::endl;
+
+    std::cout << "end!" << std::endl;
+}
@@ -26,7 +26,17 @@ int main()
     for (auto p : mp) {
         std::cout << p.first << ":" << p.second << std::endl;
     }
+    std::cout << mp.try_emplace(1, "x").second << mp[1] << " ";
+    std::cout << mp.insert_or_assign(1, "1").second << mp[1] << " ";
+    std::cout << mp.try_emplace(3, 4, '3').second << mp[3] << std::endl;
 
+    // 颜色存放在父节点指针的最低位，节点只有三个指针加上值的大小
+    std::cout << (sizeof(yastl::rb_tree_node_base<int>) == 3 * sizeof(void*)) << " ";
+    yastl::multiset<int> ms;
+    for (int i = 0; i < 100; ++i) {
+        ms.insert(i % 10);
+    }
+    std::cout << ms.erase(3) << ms.size() << (ms.count(3) == 0) << *ms.begin() << *ms.rbegin() << std::endl;
 
     std::cout << "end!" << std::endl;
 }
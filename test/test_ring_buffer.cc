@@ -0,0 +1,48 @@
+#include <iostream>
+#include "ring_buffer.h"
+#include "queue.h"
+#include "stack.h"
+int main()
+{
+    yastl::ring_buffer<int> rb;
+    for (int i = 0; i < 20; ++i) {
+        rb.push_back(i);
+    }
+    rb.push_front(-1);
+    std::cout << rb.front() << " " << rb.back() << " " << rb.size() << " " << rb.capacity() << std::endl;
+
+    // 固定容量的队列，满了之后 try_push 返回 false
+    yastl::ring_buffer<int> buf;
+    buf.reserve(8);
+    buf.set_bounded(true);
+    yastl::queue<int, yastl::ring_buffer<int>> q(yastl::move(buf));
+    int accepted = 0;
+    for (int i = 0; i < 10; ++i) {
+        accepted += q.try_push(i);
+    }
+    q.pop();
+    q.push(100);
+    std::cout << accepted << " " << q.front() << " " << q.back() << std::endl;
+
+    yastl::stack<int, yastl::ring_buffer<int>> s;
+    for (int i = 0; i < 5; ++i) {
+        s.push(i);
+    }
+    s.pop();
+    std::cout << s.top() << " " << s.size() << std::endl;
+
+    // 批量追加和批量弹出，数据跨越缓冲区末尾
+    yastl::ring_buffer<int> batch;
+    batch.reserve(8);
+    batch.set_bounded(true);
+    int src[6] = {1, 2, 3, 4, 5, 6};
+    int dst[6] = {0};
+    batch.append(src, 6);
+    batch.pop_front_n(4, dst);
+    size_t n = batch.append(src, 6);
+    std::cout << n << " " << batch.first_span().second << " " << batch.second_span().second << std::endl;
+    n = batch.pop_front_n(6, dst);
+    std::cout << n << " " << dst[0] << " " << dst[5] << std::endl;
+
+    std::cout << "end!" << std::endl;
+}
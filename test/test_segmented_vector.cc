@@ -0,0 +1,48 @@
+#include <iostream>
+#include <thread>
+#include "segmented_vector.h"
+#include "iterator.h"
+#include "util.h"
+int main()
+{
+    yastl::segmented_vector<int, 64> sv;
+    sv.push_back(1);
+    int* first = &sv[0];
+    for (int i = 2; i <= 10000; ++i) {
+        sv.push_back(i);
+    }
+    // 扩容之后第一个元素的地址不变
+    std::cout << (first == &sv[0]) << " " << sv.size() << " " << sv.back() << std::endl;
+
+    long long sum = 0;
+    for (auto i : sv) {
+        sum += i;
+    }
+    std::cout << sum << " " << *(sv.end() - 1) << " " << (sv.end() - sv.begin()) << std::endl;
+
+    sv.pop_back();
+    sv.resize(100);
+    sv.shrink_to_fit();
+    std::cout << sv.size() << " " << sv.capacity() << std::endl;
+
+    // 四个线程并发追加
+    yastl::segmented_vector<int, 64> log;
+    std::thread workers[4];
+    for (int t = 0; t < 4; ++t) {
+        workers[t] = std::thread([&log, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                log.concurrent_push_back(t);
+            }
+        });
+    }
+    for (int t = 0; t < 4; ++t) {
+        workers[t].join();
+    }
+    long long total = 0;
+    for (auto i : log) {
+        total += i;
+    }
+    std::cout << log.size() << " " << total << std::endl;
+
+    std::cout << "end!" << std::endl;
+}
@@ -0,0 +1,26 @@
+#include <iostream>
+#include "timer_wheel.h"
+#include "vector.h"
+int main()
+{
+    yastl::timer_wheel<int> tw;
+    yastl::vector<yastl::timer_handle> handles;
+    // 覆盖第 0 层到最高层以及超出范围的定时器
+    unsigned long long delays[] = {0, 5, 63, 64, 100, 4095, 4096, 300000, 20000000, 5000000000ull};
+    for (int i = 0; i < 10; ++i) {
+        handles.push_back(tw.schedule_after(delays[i], i));
+    }
+    std::cout << tw.cancel(handles[4]) << " " << tw.cancel(handles[4]) << " " << tw.size() << std::endl;
+
+    unsigned long long last = 0;
+    bool ordered = true;
+    size_t fired = tw.advance(5000000000ull, [&](int v) {
+        if (tw.now() != delays[v] || tw.now() < last) {
+            ordered = false;
+        }
+        last = tw.now();
+    });
+    std::cout << fired << " " << ordered << " " << tw.empty() << " " << tw.cancel(handles[0]) << std::endl;
+
+    std::cout << "end!" << std::endl;
+}